@@ -8,6 +8,7 @@
 #include <primitives/transaction.h>
 #include <random.h>
 #include <script/script.h>
+#include <streams.h>
 #include <sync.h>
 #include <test/util/mining.h>
 #include <test/util/script.h>
@@ -18,6 +19,7 @@
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <span>
 #include <vector>
 
 using node::BlockAssembler;
@@ -69,5 +71,53 @@ static void BlockAssemblerAddPackageTxns(benchmark::Bench& bench)
     });
 }
 
+
+/**
+ * Compare following a template update by refetching the whole block against
+ * computing and serializing a delta. The previous template is the new one
+ * with its last 10% of transactions missing, as if those had just arrived in
+ * the mempool.
+ */
+static std::unique_ptr<node::CBlockTemplate> PrepareTemplateUpdate(TestChain100Setup& setup)
+{
+    FastRandomContext det_rand{true};
+    setup.PopulateMempool(det_rand, /*num_transactions=*/1000, /*submit=*/true);
+    BlockAssembler::Options assembler_options;
+    assembler_options.test_block_validity = false;
+    assembler_options.coinbase_output_script = P2WSH_OP_TRUE;
+    return BlockAssembler{setup.m_node.chainman->ActiveChainstate(), setup.m_node.mempool.get(), assembler_options}.CreateNewBlock();
+}
+
+static void BlockTemplateUpdateRefetch(benchmark::Bench& bench)
+{
+    auto testing_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    const auto tmpl{PrepareTemplateUpdate(*testing_setup)};
+
+    bench.run([&] {
+        DataStream stream;
+        stream << TX_WITH_WITNESS(tmpl->block) << tmpl->vTxFees << tmpl->vTxSigOpsCost;
+        assert(stream.size() > 0);
+    });
+}
+
+static void BlockTemplateUpdateDelta(benchmark::Bench& bench)
+{
+    auto testing_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    const auto tmpl{PrepareTemplateUpdate(*testing_setup)};
+    const std::span<const CTransactionRef> txs{std::span{tmpl->block.vtx}.subspan(1)};
+    const auto previous_txs{txs.first(txs.size() - txs.size() / 10)};
+
+    bench.run([&] {
+        const auto delta{node::GetBlockTemplateDelta(previous_txs, *tmpl)};
+        DataStream stream;
+        stream << delta.header << delta.removed_positions << delta.added_positions;
+        for (const auto& tx : delta.added_txs) stream << TX_WITH_WITNESS(tx);
+        stream << delta.added_tx_fees << delta.added_tx_sigops << delta.coinbase_value << delta.coinbase_commitment << delta.coinbase_merkle_path;
+        assert(stream.size() > 0);
+    });
+}
+
 BENCHMARK(AssembleBlock, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockAssemblerAddPackageTxns, benchmark::PriorityLevel::LOW);
+BENCHMARK(BlockTemplateUpdateRefetch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockTemplateUpdateDelta, benchmark::PriorityLevel::HIGH);
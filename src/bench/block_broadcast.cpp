@@ -0,0 +1,58 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data/block413567.raw.h>
+#include <net.h>
+#include <netmessagemaker.h>
+#include <primitives/block.h>
+#include <protocol.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <util/check.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Hand a block message to the v1 transports of many peers and drain them, like
+ * announcing a block to every connection. Without a shared payload, each peer
+ * gets its own copy of the serialized block and computes its own checksum.
+ */
+static void BlockBroadcast(benchmark::Bench& bench, bool share)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>(ChainType::MAIN)};
+    constexpr size_t NUM_PEERS{128};
+
+    DataStream stream{benchmark::data::block413567};
+    CBlock block;
+    stream >> TX_WITH_WITNESS(block);
+
+    std::vector<std::unique_ptr<V1Transport>> transports;
+    for (size_t i{0}; i < NUM_PEERS; ++i) {
+        transports.push_back(std::make_unique<V1Transport>(/*node_id=*/i));
+    }
+
+    CSerializedNetMsg msg{NetMsg::Make(NetMsgType::BLOCK, TX_WITH_WITNESS(block))};
+    if (share) msg.Share();
+
+    bench.batch(NUM_PEERS).unit("peer").run([&] {
+        for (auto& transport : transports) {
+            CSerializedNetMsg peer_msg{msg.Copy()};
+            Assert(transport->SetMessageToSend(peer_msg));
+            while (true) {
+                const auto& [to_send, _more, _msg_type] = transport->GetBytesToSend(/*have_next_message=*/false);
+                if (to_send.empty()) break;
+                transport->MarkBytesSent(to_send.size());
+            }
+        }
+    });
+}
+
+static void BlockBroadcastCopied(benchmark::Bench& bench) { BlockBroadcast(bench, /*share=*/false); }
+static void BlockBroadcastShared(benchmark::Bench& bench) { BlockBroadcast(bench, /*share=*/true); }
+
+BENCHMARK(BlockBroadcastCopied, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockBroadcastShared, benchmark::PriorityLevel::HIGH);
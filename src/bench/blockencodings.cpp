@@ -72,7 +72,7 @@ static void BlockEncodingBench(benchmark::Bench& bench, size_t n_pool, size_t n_
     std::array<std::byte,200> sigspam;
     sigspam.fill(std::byte(42));
 
-    // a reasonably large mempool of 50k txs, ~10MB total
+    // a mempool of n_pool txs of ~200 bytes each, e.g. ~10MB for 50k txs
     std::vector<CTransactionRef> refs;
     refs.reserve(n_pool + n_extra);
     for (size_t i = 0; i < n_pool + n_extra; ++i) {
@@ -126,6 +126,13 @@ static void BlockEncodingLargeExtra(benchmark::Bench& bench)
     BlockEncodingBench(bench, 50000, 5000);
 }
 
+static void BlockEncodingLargeMempool(benchmark::Bench& bench)
+{
+    // A full default-sized mempool, where hashing the short IDs dominates
+    BlockEncodingBench(bench, 300000, 100);
+}
+
 BENCHMARK(BlockEncodingNoExtra, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockEncodingStdExtra, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockEncodingLargeExtra, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockEncodingLargeMempool, benchmark::PriorityLevel::HIGH);
@@ -29,6 +29,17 @@ static void CHACHA20(benchmark::Bench& bench, size_t buffersize)
     });
 }
 
+static void CHACHA20_KEYSTREAM(benchmark::Bench& bench, size_t buffersize)
+{
+    std::vector<std::byte> key(32, {});
+    ChaCha20 ctx(key);
+    ctx.Seek({0, 0}, 0);
+    std::vector<std::byte> out(buffersize, {});
+    bench.batch(out.size()).unit("byte").run([&] {
+        ctx.Keystream(out);
+    });
+}
+
 static void FSCHACHA20POLY1305(benchmark::Bench& bench, size_t buffersize)
 {
     std::vector<std::byte> key(32);
@@ -56,6 +67,11 @@ static void CHACHA20_1MB(benchmark::Bench& bench)
     CHACHA20(bench, BUFFER_SIZE_LARGE);
 }
 
+static void CHACHA20_KEYSTREAM_1MB(benchmark::Bench& bench)
+{
+    CHACHA20_KEYSTREAM(bench, BUFFER_SIZE_LARGE);
+}
+
 static void FSCHACHA20POLY1305_64BYTES(benchmark::Bench& bench)
 {
     FSCHACHA20POLY1305(bench, BUFFER_SIZE_TINY);
@@ -74,6 +90,7 @@ static void FSCHACHA20POLY1305_1MB(benchmark::Bench& bench)
 BENCHMARK(CHACHA20_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(CHACHA20_256BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(CHACHA20_1MB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(CHACHA20_KEYSTREAM_1MB, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_64BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_256BYTES, benchmark::PriorityLevel::HIGH);
 BENCHMARK(FSCHACHA20POLY1305_1MB, benchmark::PriorityLevel::HIGH);
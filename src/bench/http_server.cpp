@@ -0,0 +1,119 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <httprpc.h>
+#include <httpserver.h>
+#include <netaddress.h>
+#include <netbase.h>
+#include <rpc/server.h>
+#include <test/util/setup_common.h>
+#include <tinyformat.h>
+#include <util/check.h>
+#include <util/sock.h>
+#include <util/strencodings.h>
+#include <util/threadinterrupt.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr int NUM_CLIENTS{8};
+constexpr int REQUESTS_PER_CLIENT{50};
+constexpr auto CLIENT_TIMEOUT{std::chrono::seconds{30}};
+
+/** A loopback port that is free at the time of the call. */
+uint16_t FreeLoopbackPort()
+{
+    const auto sock{Assert(CreateSock(AF_INET, SOCK_STREAM, IPPROTO_TCP))};
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    Assert(sock->Bind(reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+    socklen_t len{sizeof(addr)};
+    Assert(sock->GetSockName(reinterpret_cast<sockaddr*>(&addr), &len) == 0);
+    return ntohs(addr.sin_port);
+}
+
+/** Send a request on a keep-alive connection and read the whole reply. */
+void Roundtrip(const Sock& sock, const std::string& request, CThreadInterrupt& interrupt)
+{
+    sock.SendComplete(request, CLIENT_TIMEOUT, interrupt);
+    const std::string status{sock.RecvUntilTerminator('\n', CLIENT_TIMEOUT, interrupt, 1024)};
+    Assert(status.starts_with("HTTP/1.1 200"));
+    while (sock.RecvUntilTerminator('\n', CLIENT_TIMEOUT, interrupt, 1024) != "\r") {}
+    // JSON replies are written on a single line.
+    (void)sock.RecvUntilTerminator('\n', CLIENT_TIMEOUT, interrupt, 1 << 20);
+}
+
+/**
+ * Run the HTTP server in-process and measure the request throughput of
+ * several clients sending small requests over keep-alive connections.
+ */
+void HTTPServerLoad(benchmark::Bench& bench, int event_threads, bool rest)
+{
+    const uint16_t port{FreeLoopbackPort()};
+    const std::string port_arg{strprintf("-rpcport=%d", port)};
+    const std::string event_threads_arg{strprintf("-rpceventthreads=%d", event_threads)};
+    const auto testing_setup{MakeNoLogFileContext<TestingSetup>(ChainType::REGTEST, {
+        .extra_args = {"-rpcuser=bench", "-rpcpassword=bench", "-rest", port_arg.c_str(), event_threads_arg.c_str()},
+    })};
+    node::NodeContext& node{testing_setup->m_node};
+    Assert(InitHTTPServer(*Assert(node.shutdown_signal)));
+    // The RPC interrupt and stop can only happen once per process, so leave
+    // the RPC state alone. None of the requests depends on it.
+    SetRPCWarmupFinished();
+    Assert(StartHTTPRPC(&node));
+    StartREST(&node);
+    StartHTTPServer();
+
+    std::string request;
+    if (rest) {
+        request = "GET /rest/chaininfo.json HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    } else {
+        const std::string body{R"({"jsonrpc":"2.0","id":0,"method":"getblockcount","params":[]})"};
+        request = strprintf("POST / HTTP/1.1\r\nHost: 127.0.0.1\r\nAuthorization: Basic %s\r\n"
+                            "Content-Type: application/json\r\nContent-Length: %d\r\n\r\n%s",
+                            EncodeBase64("bench:bench"), body.size(), body);
+    }
+
+    const CService addr{LookupNumeric("127.0.0.1", port)};
+    std::vector<std::unique_ptr<Sock>> socks;
+    for (int i{0}; i < NUM_CLIENTS; ++i) socks.push_back(Assert(ConnectDirectly(addr, /*manual_connection=*/true)));
+
+    bench.batch(NUM_CLIENTS * REQUESTS_PER_CLIENT).unit("request").run([&] {
+        std::vector<std::thread> clients;
+        for (const auto& sock : socks) {
+            clients.emplace_back([&] {
+                CThreadInterrupt interrupt;
+                for (int i{0}; i < REQUESTS_PER_CLIENT; ++i) Roundtrip(*sock, request, interrupt);
+            });
+        }
+        for (std::thread& client : clients) client.join();
+    });
+
+    // Idle connections would keep the event loops running.
+    socks.clear();
+    InterruptHTTPServer();
+    InterruptHTTPRPC();
+    InterruptREST();
+    StopHTTPRPC();
+    StopREST();
+    StopHTTPServer();
+}
+
+void HTTPServerRPC(benchmark::Bench& bench) { HTTPServerLoad(bench, /*event_threads=*/1, /*rest=*/false); }
+void HTTPServerRPCEventThreads(benchmark::Bench& bench) { HTTPServerLoad(bench, /*event_threads=*/4, /*rest=*/false); }
+void HTTPServerREST(benchmark::Bench& bench) { HTTPServerLoad(bench, /*event_threads=*/1, /*rest=*/true); }
+void HTTPServerRESTEventThreads(benchmark::Bench& bench) { HTTPServerLoad(bench, /*event_threads=*/4, /*rest=*/true); }
+} // namespace
+
+BENCHMARK(HTTPServerRPC, benchmark::PriorityLevel::LOW);
+BENCHMARK(HTTPServerRPCEventThreads, benchmark::PriorityLevel::LOW);
+BENCHMARK(HTTPServerREST, benchmark::PriorityLevel::LOW);
+BENCHMARK(HTTPServerRESTEventThreads, benchmark::PriorityLevel::LOW);
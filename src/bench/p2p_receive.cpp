@@ -0,0 +1,145 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data/block413567.raw.h>
+#include <key.h>
+#include <net.h>
+#include <netmessagemaker.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <protocol.h>
+#include <random.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <util/check.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace {
+constexpr size_t NUM_MESSAGES{1000};
+
+/** A message mix like a connection's: mostly invs and transactions, a few blocks. */
+std::vector<CSerializedNetMsg> MakeMessageMix()
+{
+    DataStream stream{benchmark::data::block413567};
+    CBlock block;
+    stream >> TX_WITH_WITNESS(block);
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<CSerializedNetMsg> msgs;
+    for (size_t i{0}; i < NUM_MESSAGES; ++i) {
+        const size_t kind{i % 100};
+        if (i % 250 == 249) {
+            msgs.push_back(NetMsg::Make(NetMsgType::BLOCK, TX_WITH_WITNESS(block)));
+        } else if (kind < 55 || kind >= 95) {
+            std::vector<CInv> invs(1 + rng.randrange(35));
+            for (CInv& inv : invs) inv = CInv{MSG_WTX, rng.rand256()};
+            msgs.push_back(NetMsg::Make(kind < 55 ? NetMsgType::INV : NetMsgType::GETDATA, invs));
+        } else if (kind < 85) {
+            msgs.push_back(NetMsg::Make(NetMsgType::TX, TX_WITH_WITNESS(*block.vtx[1 + rng.randrange(block.vtx.size() - 1)])));
+        } else {
+            msgs.push_back(NetMsg::Make(NetMsgType::PING, rng.rand64()));
+        }
+    }
+    return msgs;
+}
+
+/** Drain the bytes a transport has to send, appending them to out if given. */
+void Drain(Transport& from, std::vector<uint8_t>* out, Transport* to)
+{
+    while (true) {
+        const auto& [bytes, _more, _msg_type] = from.GetBytesToSend(/*have_next_message=*/false);
+        if (bytes.empty()) break;
+        std::vector<uint8_t> copy{bytes.begin(), bytes.end()};
+        from.MarkBytesSent(copy.size());
+        if (out) out->insert(out->end(), copy.begin(), copy.end());
+        if (to) {
+            std::span<const uint8_t> remaining{copy};
+            while (!remaining.empty()) Assert(to->ReceivedBytes(remaining));
+        }
+    }
+}
+
+/**
+ * Replay the wire bytes of a recorded message mix into a fresh receiving
+ * transport, and deserialize the received messages, with or without recycling
+ * receive buffers.
+ */
+void P2PReceive(benchmark::Bench& bench, bool v2, bool pooled)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>(ChainType::MAIN)};
+
+    // Fixed keys, so that every replay derives the same session as recorded.
+    CKey sender_key, receiver_key;
+    sender_key.MakeNewKey(true);
+    receiver_key.MakeNewKey(true);
+    const uint256 sender_ent{uint256::ONE}, receiver_ent{uint256::ZERO};
+    const auto make_receiver{[&](std::shared_ptr<RecvBufferPool> pool) -> std::unique_ptr<Transport> {
+        if (!v2) return std::make_unique<V1Transport>(/*node_id=*/1, std::move(pool));
+        return std::make_unique<V2Transport>(/*nodeid=*/1, /*initiating=*/false, receiver_key, MakeByteSpan(receiver_ent), std::vector<uint8_t>{}, std::move(pool));
+    }};
+
+    std::unique_ptr<Transport> sender;
+    if (v2) {
+        sender = std::make_unique<V2Transport>(/*nodeid=*/0, /*initiating=*/true, sender_key, MakeByteSpan(sender_ent), std::vector<uint8_t>{});
+    } else {
+        sender = std::make_unique<V1Transport>(/*node_id=*/0);
+    }
+    std::vector<uint8_t> wire;
+    {
+        // Record the sender's bytes, including its side of the handshake.
+        auto receiver{make_receiver(nullptr)};
+        Drain(*sender, &wire, receiver.get());
+        Drain(*receiver, nullptr, sender.get());
+        Drain(*sender, &wire, receiver.get());
+        for (CSerializedNetMsg& msg : MakeMessageMix()) {
+            Assert(sender->SetMessageToSend(msg));
+            Drain(*sender, &wire, nullptr);
+        }
+    }
+
+    const auto pool{pooled ? std::make_shared<RecvBufferPool>() : nullptr};
+    bench.batch(NUM_MESSAGES).unit("message").run([&] {
+        auto receiver{make_receiver(pool)};
+        size_t received{0};
+        std::span<const uint8_t> remaining{wire};
+        while (!remaining.empty()) {
+            Assert(receiver->ReceivedBytes(remaining));
+            if (!receiver->ReceivedMessageComplete()) continue;
+            bool reject{false};
+            CNetMessage msg{receiver->GetReceivedMessage(std::chrono::microseconds{0}, reject)};
+            Assert(!reject);
+            ++received;
+            if (msg.m_type == NetMsgType::TX) {
+                CTransactionRef tx;
+                msg.m_recv >> TX_WITH_WITNESS(tx);
+            } else if (msg.m_type == NetMsgType::BLOCK) {
+                CBlock block;
+                msg.m_recv >> TX_WITH_WITNESS(block);
+            } else if (msg.m_type == NetMsgType::INV || msg.m_type == NetMsgType::GETDATA) {
+                std::vector<CInv> invs;
+                msg.m_recv >> invs;
+            }
+        }
+        Assert(received == NUM_MESSAGES);
+    });
+}
+
+void P2PReceiveV1(benchmark::Bench& bench) { P2PReceive(bench, /*v2=*/false, /*pooled=*/false); }
+void P2PReceiveV1Pooled(benchmark::Bench& bench) { P2PReceive(bench, /*v2=*/false, /*pooled=*/true); }
+void P2PReceiveV2(benchmark::Bench& bench) { P2PReceive(bench, /*v2=*/true, /*pooled=*/false); }
+void P2PReceiveV2Pooled(benchmark::Bench& bench) { P2PReceive(bench, /*v2=*/true, /*pooled=*/true); }
+} // namespace
+
+BENCHMARK(P2PReceiveV1, benchmark::PriorityLevel::HIGH);
+BENCHMARK(P2PReceiveV1Pooled, benchmark::PriorityLevel::HIGH);
+BENCHMARK(P2PReceiveV2, benchmark::PriorityLevel::HIGH);
+BENCHMARK(P2PReceiveV2Pooled, benchmark::PriorityLevel::HIGH);
@@ -9,16 +9,20 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
 #include <univalue.h>
+#include <util/check.h>
 #include <validation.h>
 
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace {
@@ -86,3 +90,32 @@ static void BlockToJsonVerboseWrite(benchmark::Bench& bench)
 }
 
 BENCHMARK(BlockToJsonVerboseWrite, benchmark::PriorityLevel::HIGH);
+
+static void BlockToJsonVerboseRead(benchmark::Bench& bench)
+{
+    TestBlockAndIndex data;
+    const uint256 pow_limit{data.testing_setup->m_node.chainman->GetParams().GetConsensus().powLimit};
+    const std::string json{blockToJSON(data.testing_setup->m_node.chainman->m_blockman, data.block, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, pow_limit).write()};
+    bench.batch(json.size()).unit("byte").run([&] {
+        UniValue univalue;
+        Assert(univalue.read(json));
+        ankerl::nanobench::doNotOptimizeAway(univalue);
+    });
+}
+
+BENCHMARK(BlockToJsonVerboseRead, benchmark::PriorityLevel::HIGH);
+
+static void BlockToJsonStream(benchmark::Bench& bench)
+{
+    TestBlockAndIndex data;
+    const uint256 pow_limit{data.testing_setup->m_node.chainman->GetParams().GetConsensus().powLimit};
+    bench.run([&] {
+        size_t written{0};
+        JSONStreamWriter stream{[&](std::string_view chunk) { written += chunk.size(); }};
+        blockToJSON(stream, data.testing_setup->m_node.chainman->m_blockman, data.block, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, pow_limit);
+        stream.Flush();
+        ankerl::nanobench::doNotOptimizeAway(written);
+    });
+}
+
+BENCHMARK(BlockToJsonStream, benchmark::PriorityLevel::HIGH);
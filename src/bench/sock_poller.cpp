@@ -0,0 +1,65 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat/compat.h>
+#include <util/check.h>
+#include <util/sock.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#ifndef WIN32 // Windows does not have socketpair(2).
+
+using namespace std::chrono_literals;
+
+/**
+ * Mimic a socket handler thread servicing many mostly idle connections: every round, one
+ * peer sends a small message, and the loop registers all sockets, waits for readiness and
+ * receives from the ready ones.
+ */
+static void SockPollerPeers(benchmark::Bench& bench, size_t num_peers, bool use_epoll)
+{
+    std::vector<std::shared_ptr<Sock>> local;
+    std::vector<std::unique_ptr<Sock>> remote;
+    for (size_t i{0}; i < num_peers; ++i) {
+        int s[2];
+        Assert(socketpair(AF_UNIX, SOCK_STREAM, 0, s) == 0);
+        local.push_back(std::make_shared<Sock>(s[0]));
+        remote.push_back(std::make_unique<Sock>(s[1]));
+    }
+
+    SockPoller poller{use_epoll};
+    Sock::EventsPerSock events_per_sock;
+    size_t sender{0};
+    bench.unit("message").run([&] {
+        Assert(remote[sender]->Send("x", 1, 0) == 1);
+        sender = (sender + 7) % num_peers;
+
+        size_t received{0};
+        while (received == 0) {
+            for (const auto& sock : local) {
+                poller.Watch(sock, Sock::RECV);
+            }
+            Assert(poller.Wait(1s, events_per_sock));
+            for (const auto& [sock, events] : events_per_sock) {
+                if (!(events.occurred & Sock::RECV)) continue;
+                char buf[64];
+                const ssize_t ret{sock->Recv(buf, sizeof(buf), MSG_DONTWAIT)};
+                if (ret > 0) received += ret;
+                if (ret < (ssize_t)sizeof(buf)) poller.Consumed(sock, Sock::RECV);
+            }
+        }
+    });
+}
+
+static void SockPoll500Peers(benchmark::Bench& bench) { SockPollerPeers(bench, 500, /*use_epoll=*/false); }
+static void SockEpoll500Peers(benchmark::Bench& bench) { SockPollerPeers(bench, 500, /*use_epoll=*/true); }
+
+BENCHMARK(SockPoll500Peers, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SockEpoll500Peers, benchmark::PriorityLevel::HIGH);
+
+#endif // WIN32
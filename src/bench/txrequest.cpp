@@ -0,0 +1,79 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <net.h>
+#include <primitives/transaction_identifier.h>
+#include <random.h>
+#include <txrequest.h>
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/**
+ * Simulate a round of transaction relay: every transaction is announced by
+ * several peers, requested from one of them, and either received or timed
+ * out and requested again from another peer, after which all peers
+ * disconnect.
+ */
+static void TxRequestCommon(benchmark::Bench& bench, int num_peers)
+{
+    constexpr size_t NUM_TXS{2000};
+    constexpr int ANNOUNCERS_PER_TX{8};
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<GenTxid> gtxids;
+    std::vector<std::vector<NodeId>> announcers(NUM_TXS);
+    for (size_t i{0}; i < NUM_TXS; ++i) {
+        gtxids.emplace_back(Wtxid::FromUint256(rng.rand256()));
+        for (int j{0}; j < ANNOUNCERS_PER_TX; ++j) {
+            announcers[i].push_back(rng.randrange(num_peers));
+        }
+    }
+
+    bench.batch(NUM_TXS).unit("tx").run([&] {
+        TxRequestTracker tracker{/*deterministic=*/true};
+        std::chrono::microseconds now{1s};
+        for (size_t i{0}; i < NUM_TXS; ++i) {
+            for (NodeId peer : announcers[i]) {
+                const bool preferred{peer % 4 == 0};
+                tracker.ReceivedInv(peer, gtxids[i], preferred, preferred ? now : now + 2s);
+            }
+        }
+
+        const auto request_all{[&] {
+            for (NodeId peer{0}; peer < num_peers; ++peer) {
+                for (const GenTxid& gtxid : tracker.GetRequestable(peer, now, nullptr)) {
+                    tracker.RequestedTx(peer, gtxid.ToUint256(), now + 60s);
+                }
+            }
+        }};
+
+        now += 3s;
+        request_all();
+        // Half of the transactions arrive, the other requests time out.
+        for (size_t i{0}; i < NUM_TXS; i += 2) {
+            tracker.ForgetTxHash(gtxids[i].ToUint256());
+        }
+        now += 61s;
+        request_all();
+
+        for (NodeId peer{0}; peer < num_peers; ++peer) {
+            tracker.DisconnectedPeer(peer);
+        }
+        assert(tracker.Size() == 0);
+    });
+}
+
+static void TxRequest8Peers(benchmark::Bench& bench) { TxRequestCommon(bench, 8); }
+static void TxRequest125Peers(benchmark::Bench& bench) { TxRequestCommon(bench, 125); }
+static void TxRequest1000Peers(benchmark::Bench& bench) { TxRequestCommon(bench, 1000); }
+
+BENCHMARK(TxRequest8Peers, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxRequest125Peers, benchmark::PriorityLevel::HIGH);
+BENCHMARK(TxRequest1000Peers, benchmark::PriorityLevel::HIGH);
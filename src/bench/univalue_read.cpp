@@ -0,0 +1,54 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <random.h>
+#include <univalue.h>
+#include <util/check.h>
+#include <util/strencodings.h>
+
+#include <string>
+
+namespace {
+/** A batch of sendrawtransaction requests, mostly transaction hex, of a few MB. */
+UniValue MakeRawTransactionBatch()
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    UniValue batch{UniValue::VARR};
+    for (int i{0}; i < 300; ++i) {
+        UniValue request{UniValue::VOBJ};
+        request.pushKV("jsonrpc", "2.0");
+        request.pushKV("id", i);
+        request.pushKV("method", "sendrawtransaction");
+        UniValue params{UniValue::VARR};
+        params.push_back(HexStr(rng.randbytes(10000)));
+        params.push_back(UniValue{UniValue::VNUM, "0.10"});
+        request.pushKV("params", std::move(params));
+        batch.push_back(std::move(request));
+    }
+    return batch;
+}
+
+void UniValueRead(benchmark::Bench& bench, const std::string& json)
+{
+    bench.batch(json.size()).unit("byte").run([&] {
+        UniValue value;
+        Assert(value.read(json));
+        ankerl::nanobench::doNotOptimizeAway(value);
+    });
+}
+
+void UniValueReadBatch(benchmark::Bench& bench)
+{
+    UniValueRead(bench, MakeRawTransactionBatch().write());
+}
+
+void UniValueReadBatchPretty(benchmark::Bench& bench)
+{
+    UniValueRead(bench, MakeRawTransactionBatch().write(/*prettyIndent=*/4));
+}
+} // namespace
+
+BENCHMARK(UniValueReadBatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(UniValueReadBatchPretty, benchmark::PriorityLevel::HIGH);
@@ -15,8 +15,14 @@
 #include <txmempool.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <array>
+#include <span>
 #include <unordered_map>
 
+/** Number of short IDs PartiallyDownloadedBlock::InitData computes at once. */
+static constexpr size_t SHORTID_BATCH_SIZE{64};
+
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce) :
         nonce(nonce),
         shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
@@ -45,6 +51,14 @@ uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const Wtxid& wtxid) const {
     return SipHashUint256(shorttxidk0, shorttxidk1, wtxid.ToUint256()) & 0xffffffffffffL;
 }
 
+void CBlockHeaderAndShortTxIDs::GetShortIDs(std::span<const uint256* const> wtxids, std::span<uint64_t> shortids) const {
+    static_assert(SHORTTXIDS_LENGTH == 6, "shorttxids calculation assumes 6-byte shorttxids");
+    SipHashUint256Batch(shorttxidk0, shorttxidk1, wtxids, shortids);
+    for (size_t i = 0; i < wtxids.size(); i++) {
+        shortids[i] &= 0xffffffffffffL;
+    }
+}
+
 /* Reconstructing a compact block is in the hot-path for block relay,
  * so we want to do it as quickly as possible. Because this often
  * involves iterating over the entire mempool, we put all the data we
@@ -111,11 +125,25 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     if (shorttxids.size() != cmpctblock.shorttxids.size())
         return READ_STATUS_FAILED; // Short ID collision
 
+    // Short IDs are computed in batches, which is faster than one at a time,
+    // at the cost of hashing up to a batch too many on an early exit.
+    std::array<const uint256*, SHORTID_BATCH_SIZE> batch_wtxids;
+    std::array<uint64_t, SHORTID_BATCH_SIZE> batch_shortids;
+
     std::vector<bool> have_txn(txn_available.size());
     {
     LOCK(pool->cs);
-    for (const auto& [wtxid, txit] : pool->txns_randomized) {
-        uint64_t shortid = cmpctblock.GetShortID(wtxid);
+    for (size_t i = 0; i < pool->txns_randomized.size(); i++) {
+        const size_t batch_pos = i % SHORTID_BATCH_SIZE;
+        if (batch_pos == 0) {
+            const size_t batch_len = std::min(SHORTID_BATCH_SIZE, pool->txns_randomized.size() - i);
+            for (size_t j = 0; j < batch_len; j++) {
+                batch_wtxids[j] = &pool->txns_randomized[i + j].first.ToUint256();
+            }
+            cmpctblock.GetShortIDs(std::span{batch_wtxids}.first(batch_len), batch_shortids);
+        }
+        const auto& txit = pool->txns_randomized[i].second;
+        uint64_t shortid = batch_shortids[batch_pos];
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
@@ -141,7 +169,15 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     }
 
     for (size_t i = 0; i < extra_txn.size(); i++) {
-        uint64_t shortid = cmpctblock.GetShortID(extra_txn[i].first);
+        const size_t batch_pos = i % SHORTID_BATCH_SIZE;
+        if (batch_pos == 0) {
+            const size_t batch_len = std::min(SHORTID_BATCH_SIZE, extra_txn.size() - i);
+            for (size_t j = 0; j < batch_len; j++) {
+                batch_wtxids[j] = &extra_txn[i + j].first.ToUint256();
+            }
+            cmpctblock.GetShortIDs(std::span{batch_wtxids}.first(batch_len), batch_shortids);
+        }
+        uint64_t shortid = batch_shortids[batch_pos];
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
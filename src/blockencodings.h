@@ -8,6 +8,7 @@
 #include <primitives/block.h>
 
 #include <functional>
+#include <span>
 
 class CTxMemPool;
 class BlockValidationState;
@@ -116,6 +117,9 @@ public:
 
     uint64_t GetShortID(const Wtxid& wtxid) const;
 
+    /** Compute shortids[i] = GetShortID(*wtxids[i]) for every wtxid, several at a time. */
+    void GetShortIDs(std::span<const uint256* const> wtxids, std::span<uint64_t> shortids) const;
+
     size_t BlockTxCount() const { return shorttxids.size() + prefilledtxn.size(); }
 
     SERIALIZE_METHODS(CBlockHeaderAndShortTxIDs, obj)
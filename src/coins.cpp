@@ -18,6 +18,12 @@ uint256 CCoinsView::GetBestBlock() const { return uint256(); }
 std::vector<uint256> CCoinsView::GetHeadBlocks() const { return std::vector<uint256>(); }
 bool CCoinsView::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) { return false; }
 std::unique_ptr<CCoinsViewCursor> CCoinsView::Cursor() const { return nullptr; }
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsView::Cursors(size_t count) const
+{
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    if (auto cursor{Cursor()}) cursors.push_back(std::move(cursor));
+    return cursors;
+}
 
 bool CCoinsView::HaveCoin(const COutPoint &outpoint) const
 {
@@ -32,6 +38,7 @@ std::vector<uint256> CCoinsViewBacked::GetHeadBlocks() const { return base->GetH
 void CCoinsViewBacked::SetBackend(CCoinsView &viewIn) { base = &viewIn; }
 bool CCoinsViewBacked::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) { return base->BatchWrite(cursor, hashBlock); }
 std::unique_ptr<CCoinsViewCursor> CCoinsViewBacked::Cursor() const { return base->Cursor(); }
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsViewBacked::Cursors(size_t count) const { return base->Cursors(count); }
 size_t CCoinsViewBacked::EstimateSize() const { return base->EstimateSize(); }
 
 CCoinsViewCache::CCoinsViewCache(CCoinsView* baseIn, bool deterministic) :
@@ -11,6 +11,7 @@
 #include <memusage.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
+#include <span.h>
 #include <support/allocators/pool.h>
 #include <uint256.h>
 #include <util/check.h>
@@ -20,7 +21,9 @@
 #include <cstdint>
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -230,6 +233,22 @@ using CCoinsMap = std::unordered_map<COutPoint,
 
 using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
 
+/** Number of distinct CoinsCursorPrefix() values */
+static constexpr uint32_t COINS_CURSOR_PREFIXES{0x10000};
+
+/** The first two bytes of an outpoint's txid, in the order the coins database sorts them */
+inline uint32_t CoinsCursorPrefix(const COutPoint& outpoint)
+{
+    const auto* txid{UCharCast(outpoint.hash.begin())};
+    return 0x100 * txid[0] + txid[1];
+}
+
+/** The first prefix of range i when splitting the prefixes into count ranges */
+inline uint32_t CoinsCursorRangeBegin(size_t i, size_t count)
+{
+    return i * COINS_CURSOR_PREFIXES / count;
+}
+
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
 {
@@ -329,6 +348,14 @@ public:
     //! Get a cursor to iterate over the whole state
     virtual std::unique_ptr<CCoinsViewCursor> Cursor() const;
 
+    //! Get up to count cursors over disjoint ranges of the state, all as of
+    //! the same moment, to iterate over the whole state in parallel. Of n
+    //! returned cursors, cursor i covers the outpoints whose
+    //! CoinsCursorPrefix() is in [CoinsCursorRangeBegin(i, n),
+    //! CoinsCursorRangeBegin(i + 1, n)). Views that cannot split their state
+    //! return the single cursor of Cursor(), if any.
+    virtual std::vector<std::unique_ptr<CCoinsViewCursor>> Cursors(size_t count) const;
+
     //! As we use CCoinsViews polymorphically, have a virtual destructor
     virtual ~CCoinsView() = default;
 
@@ -352,6 +379,7 @@ public:
     void SetBackend(CCoinsView &viewIn);
     bool BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
+    std::vector<std::unique_ptr<CCoinsViewCursor>> Cursors(size_t count) const override;
     size_t EstimateSize() const override;
 };
 
@@ -22,5 +22,29 @@ void static inline GetCPUID(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32
 #endif
 }
 
+/** Which register sets (XCR0 bits) the OS saves and restores, or 0 if the CPU cannot tell. */
+uint32_t static inline GetEnabledXSaveFeatures()
+{
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    const bool have_osxsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    if (!have_osxsave || !have_avx) return 0;
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return a;
+}
+
+/** Whether the CPU supports AVX2 and the OS has enabled the AVX registers. */
+bool static inline HaveAVX2()
+{
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(0, 0, eax, ebx, ecx, edx);
+    if (eax < 7) return false;
+    if ((GetEnabledXSaveFeatures() & 6) != 6) return false;
+    GetCPUID(7, 0, eax, ebx, ecx, edx);
+    return (ebx >> 5) & 1;
+}
+
 #endif // defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
 #endif // BITCOIN_COMPAT_CPUID_H
@@ -13,6 +13,86 @@
 #include <algorithm>
 #include <bit>
 #include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__amd64__) || defined(__aarch64__))
+// SSE2 and NEON are part of the baseline of these targets.
+#define ENABLE_CHACHA20_VEC128
+#include <crypto/chacha20_vec.h>
+#endif
+
+#if defined(ENABLE_AVX2) || defined(ENABLE_AVX512)
+#include <compat/cpuid.h>
+#endif
+
+namespace chacha20_avx2
+{
+void Multi_8way(uint32_t input[12], std::byte* out, const std::byte* in, size_t blocks);
+}
+
+namespace chacha20_avx512
+{
+void Multi_16way(uint32_t input[12], std::byte* out, const std::byte* in, size_t blocks);
+}
+
+namespace {
+/** A multi-block implementation, processing a multiple of lanes blocks per call. */
+struct MultiBlock {
+    void (*fn)(uint32_t input[12], std::byte* out, const std::byte* in, size_t blocks);
+    size_t lanes;
+};
+
+#if defined(ENABLE_CHACHA20_VEC128)
+void Multi_4way(uint32_t input[12], std::byte* out, const std::byte* in, size_t blocks)
+{
+    using Vec = uint32_t __attribute__((vector_size(16)));
+    chacha20_vec::Multi<Vec>(input, out, in, blocks);
+}
+#endif
+
+/** The multi-block implementations usable on this CPU, widest first. */
+std::vector<MultiBlock> DetectMultiBlock()
+{
+    std::vector<MultiBlock> ret;
+#if defined(HAVE_GETCPUID) && (defined(ENABLE_AVX2) || defined(ENABLE_AVX512))
+    const uint32_t xcr0{GetEnabledXSaveFeatures()};
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(0, 0, eax, ebx, ecx, edx);
+    const uint32_t max_leaf{eax};
+    GetCPUID(7, 0, eax, ebx, ecx, edx);
+    if (max_leaf < 7) ebx = 0;
+#if defined(ENABLE_AVX512)
+    // AVX512F, and the OS saving the opmask and upper ZMM registers.
+    if (((ebx >> 16) & 1) && (xcr0 & 0xe6) == 0xe6) {
+        ret.push_back({chacha20_avx512::Multi_16way, 16});
+    }
+#endif
+#if defined(ENABLE_AVX2)
+    if (((ebx >> 5) & 1) && (xcr0 & 6) == 6) {
+        ret.push_back({chacha20_avx2::Multi_8way, 8});
+    }
+#endif
+#endif
+#if defined(ENABLE_CHACHA20_VEC128)
+    ret.push_back({Multi_4way, 4});
+#endif
+    return ret;
+}
+
+/** Process as many of blocks as the multi-block implementations can, and return how many that was. */
+size_t MultiBlockCrypt(uint32_t input[12], std::byte* out, const std::byte* in, size_t blocks)
+{
+    static const std::vector<MultiBlock> impls{DetectMultiBlock()};
+    size_t done{0};
+    for (const MultiBlock& impl : impls) {
+        if (blocks - done < impl.lanes) continue;
+        const size_t n{(blocks - done) - (blocks - done) % impl.lanes};
+        impl.fn(input, out + done * ChaCha20Aligned::BLOCKLEN, in ? in + done * ChaCha20Aligned::BLOCKLEN : nullptr, n);
+        done += n;
+    }
+    return done;
+}
+} // namespace
 
 #define QUARTERROUND(a,b,c,d) \
   a += b; d = std::rotl(d ^ a, 16); \
@@ -68,6 +148,11 @@ inline void ChaCha20Aligned::Keystream(std::span<std::byte> output) noexcept
 
     if (!blocks) return;
 
+    const size_t multi_blocks{MultiBlockCrypt(input, c, nullptr, blocks)};
+    if (multi_blocks == blocks) return;
+    c += multi_blocks * BLOCKLEN;
+    blocks -= multi_blocks;
+
     j4 = input[0];
     j5 = input[1];
     j6 = input[2];
@@ -171,6 +256,12 @@ inline void ChaCha20Aligned::Crypt(std::span<const std::byte> in_bytes, std::spa
 
     if (!blocks) return;
 
+    const size_t multi_blocks{MultiBlockCrypt(input, c, m, blocks)};
+    if (multi_blocks == blocks) return;
+    c += multi_blocks * BLOCKLEN;
+    m += multi_blocks * BLOCKLEN;
+    blocks -= multi_blocks;
+
     j4 = input[0];
     j5 = input[1];
     j6 = input[2];
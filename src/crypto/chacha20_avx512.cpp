@@ -0,0 +1,23 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX512
+
+#include <crypto/chacha20_vec.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chacha20_avx512 {
+
+using Vec = uint32_t __attribute__((vector_size(64)));
+
+void Multi_16way(uint32_t input[12], std::byte* out, const std::byte* in, size_t blocks)
+{
+    chacha20_vec::Multi<Vec>(input, out, in, blocks);
+}
+
+} // namespace chacha20_avx512
+
+#endif
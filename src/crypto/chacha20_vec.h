@@ -0,0 +1,102 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_CHACHA20_VEC_H
+#define BITCOIN_CRYPTO_CHACHA20_VEC_H
+
+// Multi-block ChaCha20, computing one 64-byte block per vector lane. This is
+// only included by the translation units that instantiate it, each compiled
+// for its own instruction set, so everything here has internal linkage.
+
+#include <attributes.h>
+#include <crypto/common.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+namespace chacha20_vec {
+
+template <int N, typename Vec>
+ALWAYS_INLINE Vec RotL(Vec x) { return (x << N) | (x >> (32 - N)); }
+
+#define VEC_QUARTERROUND(a,b,c,d) \
+  a += b; d = RotL<16>(d ^ a); \
+  c += d; b = RotL<12>(b ^ c); \
+  a += b; d = RotL<8>(d ^ a); \
+  c += d; b = RotL<7>(b ^ c);
+
+/**
+ * Process blocks (a multiple of the number of lanes of Vec) of keystream,
+ * XORed with in if it is not nullptr, and advance the block counter in
+ * input (laid out as in ChaCha20Aligned) accordingly.
+ */
+template <typename Vec>
+void Multi(uint32_t input[12], std::byte* out, const std::byte* in, size_t blocks)
+{
+    constexpr size_t LANES{sizeof(Vec) / sizeof(uint32_t)};
+    static_assert(LANES >= 2 && sizeof(Vec) == LANES * sizeof(uint32_t));
+
+    Vec lane_index;
+    for (size_t i = 0; i < LANES; ++i) lane_index[i] = i;
+
+    const Vec j4 = Vec{} + input[0], j5 = Vec{} + input[1], j6 = Vec{} + input[2], j7 = Vec{} + input[3];
+    const Vec j8 = Vec{} + input[4], j9 = Vec{} + input[5], j10 = Vec{} + input[6], j11 = Vec{} + input[7];
+    const Vec j14 = Vec{} + input[10], j15 = Vec{} + input[11];
+    uint32_t ctr_lo = input[8], ctr_hi = input[9];
+
+    while (blocks) {
+        // Each lane has its own block counter, carrying into the nonce like
+        // the single-block code does.
+        const Vec base = Vec{} + ctr_lo;
+        const Vec j12 = base + lane_index;
+        const Vec j13 = (Vec{} + ctr_hi) - (Vec)(j12 < base);
+
+        Vec x0 = Vec{} + 0x61707865, x1 = Vec{} + 0x3320646e, x2 = Vec{} + 0x79622d32, x3 = Vec{} + 0x6b206574;
+        Vec x4 = j4, x5 = j5, x6 = j6, x7 = j7, x8 = j8, x9 = j9, x10 = j10, x11 = j11;
+        Vec x12 = j12, x13 = j13, x14 = j14, x15 = j15;
+
+        for (int round = 0; round < 10; ++round) {
+            VEC_QUARTERROUND( x0, x4, x8,x12);
+            VEC_QUARTERROUND( x1, x5, x9,x13);
+            VEC_QUARTERROUND( x2, x6,x10,x14);
+            VEC_QUARTERROUND( x3, x7,x11,x15);
+            VEC_QUARTERROUND( x0, x5,x10,x15);
+            VEC_QUARTERROUND( x1, x6,x11,x12);
+            VEC_QUARTERROUND( x2, x7, x8,x13);
+            VEC_QUARTERROUND( x3, x4, x9,x14);
+        }
+
+        // Word w of block l is words[w][l]; write the blocks out one by one.
+        Vec words[16] = {
+            x0 + 0x61707865, x1 + 0x3320646e, x2 + 0x79622d32, x3 + 0x6b206574,
+            x4 + j4, x5 + j5, x6 + j6, x7 + j7, x8 + j8, x9 + j9, x10 + j10, x11 + j11,
+            x12 + j12, x13 + j13, x14 + j14, x15 + j15,
+        };
+        for (size_t l = 0; l < LANES; ++l) {
+            for (size_t w = 0; w < 16; ++w) {
+                uint32_t word = words[w][l];
+                if (in) word ^= ReadLE32(in + 4 * w);
+                WriteLE32(out + 4 * w, word);
+            }
+            out += 64;
+            if (in) in += 64;
+        }
+
+        ctr_lo += LANES;
+        if (ctr_lo < LANES) ++ctr_hi;
+        blocks -= LANES;
+    }
+
+    input[8] = ctr_lo;
+    input[9] = ctr_hi;
+}
+
+#undef VEC_QUARTERROUND
+
+} // namespace chacha20_vec
+} // namespace
+
+#endif // BITCOIN_CRYPTO_CHACHA20_VEC_H
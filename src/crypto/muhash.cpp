@@ -34,58 +34,6 @@ constexpr limb_t MAX_PRIME_DIFF = 1103717;
 constexpr limb_t MODULUS_INVERSE = limb_t(0x70a1421da087d93);
 
 
-/** Extract the lowest limb of [c0,c1,c2] into n, and left shift the number by 1 limb. */
-inline void extract3(limb_t& c0, limb_t& c1, limb_t& c2, limb_t& n)
-{
-    n = c0;
-    c0 = c1;
-    c1 = c2;
-    c2 = 0;
-}
-
-/** [c0,c1] = a * b */
-inline void mul(limb_t& c0, limb_t& c1, const limb_t& a, const limb_t& b)
-{
-    double_limb_t t = (double_limb_t)a * b;
-    c1 = t >> LIMB_SIZE;
-    c0 = t;
-}
-
-/* [c0,c1,c2] += n * [d0,d1,d2]. c2 is 0 initially */
-inline void mulnadd3(limb_t& c0, limb_t& c1, limb_t& c2, limb_t& d0, limb_t& d1, limb_t& d2, const limb_t& n)
-{
-    double_limb_t t = (double_limb_t)d0 * n + c0;
-    c0 = t;
-    t >>= LIMB_SIZE;
-    t += (double_limb_t)d1 * n + c1;
-    c1 = t;
-    t >>= LIMB_SIZE;
-    c2 = t + d2 * n;
-}
-
-/* [c0,c1] *= n */
-inline void muln2(limb_t& c0, limb_t& c1, const limb_t& n)
-{
-    double_limb_t t = (double_limb_t)c0 * n;
-    c0 = t;
-    t >>= LIMB_SIZE;
-    t += (double_limb_t)c1 * n;
-    c1 = t;
-}
-
-/** [c0,c1,c2] += a * b */
-inline void muladd3(limb_t& c0, limb_t& c1, limb_t& c2, const limb_t& a, const limb_t& b)
-{
-    double_limb_t t = (double_limb_t)a * b;
-    limb_t th = t >> LIMB_SIZE;
-    limb_t tl = t;
-
-    c0 += tl;
-    th += (c0 < tl) ? 1 : 0;
-    c1 += th;
-    c2 += (c1 < th) ? 1 : 0;
-}
-
 /**
  * Add limb a to [c0,c1]: [c0,c1] += a. Then extract the lowest
  * limb of [c0,c1] into n, and left shift the number by 1 limb.
@@ -109,6 +57,50 @@ inline void addnextract2(limb_t& c0, limb_t& c1, const limb_t& a, limb_t& n)
     c1 = c2;
 }
 
+/** Number of limbs in each half of a Num3072 in Karatsuba multiplication. */
+constexpr int HALF_LIMBS = LIMBS / 2;
+
+/** out[0..2*HALF_LIMBS) = a[0..HALF_LIMBS) * b[0..HALF_LIMBS), by product scanning. */
+inline void mul_half(limb_t* out, const limb_t* a, const limb_t* b)
+{
+    double_limb_t acc = 0;
+    limb_t acc_top = 0;
+    for (int k = 0; k < 2 * HALF_LIMBS - 1; ++k) {
+        const int first = k < HALF_LIMBS ? 0 : k - HALF_LIMBS + 1;
+        const int last = k < HALF_LIMBS ? k : HALF_LIMBS - 1;
+        for (int i = first; i <= last; ++i) {
+            const double_limb_t t = (double_limb_t)a[i] * b[k - i];
+            acc += t;
+            acc_top += acc < t;
+        }
+        out[k] = acc;
+        acc = (acc >> LIMB_SIZE) | ((double_limb_t)acc_top << LIMB_SIZE);
+        acc_top = 0;
+    }
+    out[2 * HALF_LIMBS - 1] = acc;
+}
+
+/** out[0..HALF_LIMBS) = |a - b| for HALF_LIMBS-limb a and b. Returns whether a < b. */
+inline bool sub_abs_half(limb_t* out, const limb_t* a, const limb_t* b)
+{
+    limb_t borrow = 0;
+    for (int i = 0; i < HALF_LIMBS; ++i) {
+        const limb_t d = a[i] - b[i];
+        const limb_t next_borrow = (a[i] < b[i]) | (d < borrow);
+        out[i] = d - borrow;
+        borrow = next_borrow;
+    }
+    if (borrow) {
+        // Negate: out = 2^(HALF_LIMBS*LIMB_SIZE) - out.
+        limb_t carry = 1;
+        for (int i = 0; i < HALF_LIMBS; ++i) {
+            out[i] = ~out[i] + carry;
+            carry = carry && out[i] == 0;
+        }
+    }
+    return borrow;
+}
+
 } // namespace
 
 /** Indicates whether d is larger than the modulus. */
@@ -454,39 +446,92 @@ Num3072 Num3072::GetInverse() const
 
 void Num3072::Multiply(const Num3072& a)
 {
-    limb_t c0 = 0, c1 = 0, c2 = 0;
-    Num3072 tmp;
-
-    /* Compute limbs 0..N-2 of this*a into tmp, including one reduction. */
-    for (int j = 0; j < LIMBS - 1; ++j) {
-        limb_t d0 = 0, d1 = 0, d2 = 0;
-        mul(d0, d1, this->limbs[1 + j], a.limbs[LIMBS + j - (1 + j)]);
-        for (int i = 2 + j; i < LIMBS; ++i) muladd3(d0, d1, d2, this->limbs[i], a.limbs[LIMBS + j - i]);
-        mulnadd3(c0, c1, c2, d0, d1, d2, MAX_PRIME_DIFF);
-        for (int i = 0; i < j + 1; ++i) muladd3(c0, c1, c2, this->limbs[i], a.limbs[j - i]);
-        extract3(c0, c1, c2, tmp.limbs[j]);
+    /* Compute the full product this*a = lo + mid*2^(3072/2) + hi*2^3072 with
+     * one level of Karatsuba: three half-size products instead of four. */
+    limb_t lo[LIMBS], hi[LIMBS], diff_this[HALF_LIMBS], diff_a[HALF_LIMBS], cross[LIMBS];
+    mul_half(lo, this->limbs, a.limbs);
+    mul_half(hi, this->limbs + HALF_LIMBS, a.limbs + HALF_LIMBS);
+    const bool neg_this = sub_abs_half(diff_this, this->limbs, this->limbs + HALF_LIMBS);
+    const bool neg_a = sub_abs_half(diff_a, a.limbs + HALF_LIMBS, a.limbs);
+    mul_half(cross, diff_this, diff_a);
+
+    /* mid = lo + hi + (this_lo - this_hi) * (a_hi - a_lo), which is never
+     * negative, and fits in LIMBS limbs plus a small top limb. */
+    limb_t mid[LIMBS];
+    limb_t mid_top = 0;
+    {
+        double_limb_t carry = 0;
+        for (int i = 0; i < LIMBS; ++i) {
+            carry += (double_limb_t)lo[i] + hi[i];
+            mid[i] = carry;
+            carry >>= LIMB_SIZE;
+        }
+        mid_top = carry;
+        if (neg_this == neg_a) {
+            limb_t c = 0;
+            for (int i = 0; i < LIMBS; ++i) {
+                const limb_t t = mid[i] + c;
+                c = t < c;
+                mid[i] = t + cross[i];
+                c += mid[i] < cross[i];
+            }
+            mid_top += c;
+        } else {
+            limb_t borrow = 0;
+            for (int i = 0; i < LIMBS; ++i) {
+                const limb_t d = mid[i] - cross[i];
+                const limb_t next_borrow = (mid[i] < cross[i]) | (d < borrow);
+                mid[i] = d - borrow;
+                borrow = next_borrow;
+            }
+            mid_top -= borrow;
+        }
     }
 
-    /* Compute limb N-1 of a*b into tmp. */
-    assert(c2 == 0);
-    for (int i = 0; i < LIMBS; ++i) muladd3(c0, c1, c2, this->limbs[i], a.limbs[LIMBS - 1 - i]);
-    extract3(c0, c1, c2, tmp.limbs[LIMBS - 1]);
-
-    /* Perform a second reduction. */
-    muln2(c0, c1, MAX_PRIME_DIFF);
-    for (int j = 0; j < LIMBS; ++j) {
-        addnextract2(c0, c1, tmp.limbs[j], this->limbs[j]);
+    /* Add mid*2^(3072/2) into [lo,hi]. The product is below 2^6144, so
+     * nothing carries out of hi. */
+    {
+        limb_t c = 0;
+        for (int i = 0; i < LIMBS; ++i) {
+            limb_t& dst = i < HALF_LIMBS ? lo[HALF_LIMBS + i] : hi[i - HALF_LIMBS];
+            const limb_t t = dst + c;
+            c = t < c;
+            dst = t + mid[i];
+            c += dst < mid[i];
+        }
+        limb_t* rest = hi + HALF_LIMBS;
+        const limb_t t = rest[0] + c;
+        c = t < c;
+        rest[0] = t + mid_top;
+        c += rest[0] < mid_top;
+        for (int i = 1; i < HALF_LIMBS && c; ++i) {
+            rest[i] += c;
+            c = rest[i] == 0;
+        }
     }
 
-    assert(c1 == 0);
-    assert(c0 == 0 || c0 == 1);
+    /* Reduce: 2^3072 is MAX_PRIME_DIFF modulo the modulus, so the product
+     * equals lo + hi*MAX_PRIME_DIFF, and then top*MAX_PRIME_DIFF for what
+     * carries out of that. */
+    double_limb_t carry = 0;
+    for (int i = 0; i < LIMBS; ++i) {
+        carry += (double_limb_t)hi[i] * MAX_PRIME_DIFF + lo[i];
+        this->limbs[i] = carry;
+        carry >>= LIMB_SIZE;
+    }
+    carry *= MAX_PRIME_DIFF;
+    for (int i = 0; i < LIMBS && carry; ++i) {
+        carry += this->limbs[i];
+        this->limbs[i] = carry;
+        carry >>= LIMB_SIZE;
+    }
 
     /* Perform up to two more reductions if the internal state has already
      * overflown the MAX of Num3072 or if it is larger than the modulus or
      * if both are the case.
      * */
     if (this->IsOverflow()) this->FullReduce();
-    if (c0) this->FullReduce();
+    if (carry) this->FullReduce();
 }
 
 void Num3072::SetToOne()
@@ -7,6 +7,22 @@
 
 #include <cstring>
 
+#if defined(ENABLE_AVX2)
+#include <compat/cpuid.h>
+#endif
+
+namespace poly1305_avx2
+{
+void Blocks_4way(uint32_t h[5], const uint32_t r[5], const unsigned char* m, size_t blocks);
+}
+
+namespace {
+#if defined(HAVE_GETCPUID) && defined(ENABLE_AVX2)
+/** Below this many bytes the scalar code is faster, as the 4-way code computes r^2..r^4 first. */
+constexpr size_t AVX2_MIN_BYTES{16 * POLY1305_BLOCK_SIZE};
+#endif
+} // namespace
+
 namespace poly1305_donna {
 
 // Based on the public domain implementation by Andrew Moon
@@ -62,6 +78,21 @@ static void poly1305_blocks(poly1305_context *st, const unsigned char *m, size_t
     h3 = st->h[3];
     h4 = st->h[4];
 
+#if defined(HAVE_GETCPUID) && defined(ENABLE_AVX2)
+    static const bool have_avx2{HaveAVX2()};
+    if (have_avx2 && !st->final && bytes >= AVX2_MIN_BYTES) {
+        const size_t want = bytes & ~(4 * POLY1305_BLOCK_SIZE - 1);
+        poly1305_avx2::Blocks_4way(st->h, st->r, m, want / POLY1305_BLOCK_SIZE);
+        h0 = st->h[0];
+        h1 = st->h[1];
+        h2 = st->h[2];
+        h3 = st->h[3];
+        h4 = st->h[4];
+        m += want;
+        bytes -= want;
+    }
+#endif
+
     while (bytes >= POLY1305_BLOCK_SIZE) {
         /* h += m[i] */
         h0 += (ReadLE32(m+ 0)     ) & 0x3ffffff;
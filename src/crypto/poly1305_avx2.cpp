@@ -0,0 +1,140 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace poly1305_avx2 {
+namespace {
+
+/** out = a * b (partially reduced), in the radix 2^26 representation of poly1305_donna. */
+void MulMod(uint32_t out[5], const uint32_t a[5], const uint32_t b[5])
+{
+    const uint32_t s1 = b[1] * 5, s2 = b[2] * 5, s3 = b[3] * 5, s4 = b[4] * 5;
+    uint64_t d0 = ((uint64_t)a[0] * b[0]) + ((uint64_t)a[1] * s4) + ((uint64_t)a[2] * s3) + ((uint64_t)a[3] * s2) + ((uint64_t)a[4] * s1);
+    uint64_t d1 = ((uint64_t)a[0] * b[1]) + ((uint64_t)a[1] * b[0]) + ((uint64_t)a[2] * s4) + ((uint64_t)a[3] * s3) + ((uint64_t)a[4] * s2);
+    uint64_t d2 = ((uint64_t)a[0] * b[2]) + ((uint64_t)a[1] * b[1]) + ((uint64_t)a[2] * b[0]) + ((uint64_t)a[3] * s4) + ((uint64_t)a[4] * s3);
+    uint64_t d3 = ((uint64_t)a[0] * b[3]) + ((uint64_t)a[1] * b[2]) + ((uint64_t)a[2] * b[1]) + ((uint64_t)a[3] * b[0]) + ((uint64_t)a[4] * s4);
+    uint64_t d4 = ((uint64_t)a[0] * b[4]) + ((uint64_t)a[1] * b[3]) + ((uint64_t)a[2] * b[2]) + ((uint64_t)a[3] * b[1]) + ((uint64_t)a[4] * b[0]);
+
+    uint32_t c;
+                  c = (uint32_t)(d0 >> 26); out[0] = (uint32_t)d0 & 0x3ffffff;
+    d1 += c;      c = (uint32_t)(d1 >> 26); out[1] = (uint32_t)d1 & 0x3ffffff;
+    d2 += c;      c = (uint32_t)(d2 >> 26); out[2] = (uint32_t)d2 & 0x3ffffff;
+    d3 += c;      c = (uint32_t)(d3 >> 26); out[3] = (uint32_t)d3 & 0x3ffffff;
+    d4 += c;      c = (uint32_t)(d4 >> 26); out[4] = (uint32_t)d4 & 0x3ffffff;
+    out[0] += c * 5; c = out[0] >> 26; out[0] &= 0x3ffffff;
+    out[1] += c;
+}
+
+__m256i inline Mul(__m256i x, __m256i y) { return _mm256_mul_epu32(x, y); }
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+__m256i inline Add(__m256i x, __m256i y, __m256i z, __m256i w, __m256i v) { return Add(Add(Add(x, y), Add(z, w)), v); }
+__m256i inline And(__m256i x, __m256i y) { return _mm256_and_si256(x, y); }
+__m256i inline Or(__m256i x, __m256i y) { return _mm256_or_si256(x, y); }
+__m256i inline ShR(__m256i x, int n) { return _mm256_srli_epi64(x, n); }
+__m256i inline ShL(__m256i x, int n) { return _mm256_slli_epi64(x, n); }
+__m256i inline K(uint64_t x) { return _mm256_set1_epi64x(x); }
+
+} // namespace
+
+/**
+ * Absorb blocks (a multiple of 4) full 16-byte blocks into h, like
+ * poly1305_blocks does one at a time.
+ *
+ * Lane j of each 64-bit vector element accumulates blocks j, j+4, j+8, ...,
+ * multiplying by r^4 in between. The last multiplication is by r^4, r^3, r^2
+ * and r respectively, after which the sum of the lanes is the result.
+ */
+void Blocks_4way(uint32_t h[5], const uint32_t r[5], const unsigned char* m, size_t blocks)
+{
+    uint32_t r2[5], r3[5], r4[5];
+    MulMod(r2, r, r);
+    MulMod(r3, r2, r);
+    MulMod(r4, r2, r2);
+
+    const __m256i mask = K(0x3ffffff);
+    const __m256i hibit = K(1UL << 24); /* 1 << 128 */
+
+    const __m256i p0 = K(r4[0]), p1 = K(r4[1]), p2 = K(r4[2]), p3 = K(r4[3]), p4 = K(r4[4]);
+    const __m256i q1 = K(r4[1] * 5), q2 = K(r4[2] * 5), q3 = K(r4[3] * 5), q4 = K(r4[4] * 5);
+    const __m256i f0 = _mm256_set_epi64x(r[0], r2[0], r3[0], r4[0]);
+    const __m256i f1 = _mm256_set_epi64x(r[1], r2[1], r3[1], r4[1]);
+    const __m256i f2 = _mm256_set_epi64x(r[2], r2[2], r3[2], r4[2]);
+    const __m256i f3 = _mm256_set_epi64x(r[3], r2[3], r3[3], r4[3]);
+    const __m256i f4 = _mm256_set_epi64x(r[4], r2[4], r3[4], r4[4]);
+    const __m256i g1 = _mm256_set_epi64x(r[1] * 5, r2[1] * 5, r3[1] * 5, r4[1] * 5);
+    const __m256i g2 = _mm256_set_epi64x(r[2] * 5, r2[2] * 5, r3[2] * 5, r4[2] * 5);
+    const __m256i g3 = _mm256_set_epi64x(r[3] * 5, r2[3] * 5, r3[3] * 5, r4[3] * 5);
+    const __m256i g4 = _mm256_set_epi64x(r[4] * 5, r2[4] * 5, r3[4] * 5, r4[4] * 5);
+
+    // The current value of h continues in lane 0.
+    __m256i h0 = _mm256_set_epi64x(0, 0, 0, h[0]);
+    __m256i h1 = _mm256_set_epi64x(0, 0, 0, h[1]);
+    __m256i h2 = _mm256_set_epi64x(0, 0, 0, h[2]);
+    __m256i h3 = _mm256_set_epi64x(0, 0, 0, h[3]);
+    __m256i h4 = _mm256_set_epi64x(0, 0, 0, h[4]);
+
+    for (; blocks; blocks -= 4, m += 64) {
+        /* h += m[i], with 64-bit halves of blocks 0..3 in the lanes of lo and hi */
+        const __m256i a = _mm256_loadu_si256((const __m256i*)m);
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(m + 32));
+        const __m256i lo = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xd8);
+        const __m256i hi = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xd8);
+        h0 = Add(h0, And(lo, mask));
+        h1 = Add(h1, And(ShR(lo, 26), mask));
+        h2 = Add(h2, And(Or(ShR(lo, 52), ShL(hi, 12)), mask));
+        h3 = Add(h3, And(ShR(hi, 14), mask));
+        h4 = Add(h4, Or(ShR(hi, 40), hibit));
+
+        /* h *= r^4, or by r^4..r for the last blocks */
+        const bool last = blocks == 4;
+        const __m256i r0v = last ? f0 : p0, r1v = last ? f1 : p1, r2v = last ? f2 : p2, r3v = last ? f3 : p3, r4v = last ? f4 : p4;
+        const __m256i s1v = last ? g1 : q1, s2v = last ? g2 : q2, s3v = last ? g3 : q3, s4v = last ? g4 : q4;
+        __m256i d0 = Add(Mul(h0, r0v), Mul(h1, s4v), Mul(h2, s3v), Mul(h3, s2v), Mul(h4, s1v));
+        __m256i d1 = Add(Mul(h0, r1v), Mul(h1, r0v), Mul(h2, s4v), Mul(h3, s3v), Mul(h4, s2v));
+        __m256i d2 = Add(Mul(h0, r2v), Mul(h1, r1v), Mul(h2, r0v), Mul(h3, s4v), Mul(h4, s3v));
+        __m256i d3 = Add(Mul(h0, r3v), Mul(h1, r2v), Mul(h2, r1v), Mul(h3, r0v), Mul(h4, s4v));
+        __m256i d4 = Add(Mul(h0, r4v), Mul(h1, r3v), Mul(h2, r2v), Mul(h3, r1v), Mul(h4, r0v));
+
+        /* (partial) h %= p */
+        __m256i c;
+                          c = ShR(d0, 26); h0 = And(d0, mask);
+        d1 = Add(d1, c);  c = ShR(d1, 26); h1 = And(d1, mask);
+        d2 = Add(d2, c);  c = ShR(d2, 26); h2 = And(d2, mask);
+        d3 = Add(d3, c);  c = ShR(d3, 26); h3 = And(d3, mask);
+        d4 = Add(d4, c);  c = ShR(d4, 26); h4 = And(d4, mask);
+        h0 = Add(h0, Add(c, ShL(c, 2)));
+        c = ShR(h0, 26); h0 = And(h0, mask);
+        h1 = Add(h1, c);
+    }
+
+    /* h = sum of the lanes */
+    alignas(32) uint64_t t[5][4];
+    _mm256_store_si256((__m256i*)t[0], h0);
+    _mm256_store_si256((__m256i*)t[1], h1);
+    _mm256_store_si256((__m256i*)t[2], h2);
+    _mm256_store_si256((__m256i*)t[3], h3);
+    _mm256_store_si256((__m256i*)t[4], h4);
+    uint64_t d[5];
+    for (int i = 0; i < 5; ++i) d[i] = t[i][0] + t[i][1] + t[i][2] + t[i][3];
+
+    uint64_t c;
+                  c = d[0] >> 26; d[0] &= 0x3ffffff;
+    d[1] += c;    c = d[1] >> 26; d[1] &= 0x3ffffff;
+    d[2] += c;    c = d[2] >> 26; d[2] &= 0x3ffffff;
+    d[3] += c;    c = d[3] >> 26; d[3] &= 0x3ffffff;
+    d[4] += c;    c = d[4] >> 26; d[4] &= 0x3ffffff;
+    d[0] += c * 5; c = d[0] >> 26; d[0] &= 0x3ffffff;
+    d[1] += c;
+
+    for (int i = 0; i < 5; ++i) h[i] = (uint32_t)d[i];
+}
+
+} // namespace poly1305_avx2
+
+#endif
@@ -567,18 +567,6 @@ bool SelfTest() {
 
     return true;
 }
-
-#if !defined(DISABLE_OPTIMIZED_SHA256)
-#if (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
-/** Check whether the OS has enabled AVX registers. */
-bool AVXEnabled()
-{
-    uint32_t a, d;
-    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
-    return (a & 6) == 6;
-}
-#endif
-#endif // DISABLE_OPTIMIZED_SHA256
 } // namespace
 
 
@@ -608,7 +596,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     have_xsave = (ecx >> 27) & 1;
     have_avx = (ecx >> 28) & 1;
     if (have_xsave && have_avx) {
-        enabled_avx = AVXEnabled();
+        enabled_avx = (GetEnabledXSaveFeatures() & 6) == 6;
     }
     if (have_sse4) {
         GetCPUID(7, 0, eax, ebx, ecx, edx);
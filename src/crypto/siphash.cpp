@@ -5,6 +5,17 @@
 #include <crypto/siphash.h>
 
 #include <bit>
+#include <cassert>
+#include <optional>
+
+#if defined(ENABLE_AVX2)
+#include <compat/cpuid.h>
+#endif
+
+namespace siphash_avx2
+{
+void Uint256_4way(uint64_t k0, uint64_t k1, const uint256* const* vals, uint64_t* out, size_t n);
+}
 
 #define SIPROUND do { \
     v0 += v1; v1 = std::rotl(v1, 13); v1 ^= v0; \
@@ -172,3 +183,38 @@ uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint3
     SIPROUND;
     return v0 ^ v1 ^ v2 ^ v3;
 }
+
+namespace {
+/** A multi-lane implementation of SipHashUint256, hashing a multiple of lanes values per call. */
+struct MultiLane {
+    void (*fn)(uint64_t k0, uint64_t k1, const uint256* const* vals, uint64_t* out, size_t n);
+    size_t lanes;
+};
+
+/**
+ * The multi-lane implementation usable on this CPU, if any. Vectors of two
+ * 64-bit lanes (SSE2, NEON) lose to the scalar code, which already has
+ * enough parallelism within a SipHash round for them.
+ */
+std::optional<MultiLane> DetectMultiLane()
+{
+#if defined(HAVE_GETCPUID) && defined(ENABLE_AVX2)
+    if (HaveAVX2()) return MultiLane{siphash_avx2::Uint256_4way, 4};
+#endif
+    return std::nullopt;
+}
+} // namespace
+
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, std::span<const uint256* const> vals, std::span<uint64_t> out)
+{
+    assert(out.size() >= vals.size());
+    static const std::optional<MultiLane> impl{DetectMultiLane()};
+    size_t done{0};
+    if (impl) {
+        done = vals.size() - vals.size() % impl->lanes;
+        if (done) impl->fn(k0, k1, vals.data(), out.data(), done);
+    }
+    for (size_t i{done}; i < vals.size(); ++i) {
+        out[i] = SipHashUint256(k0, k1, *vals[i]);
+    }
+}
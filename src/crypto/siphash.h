@@ -5,6 +5,7 @@
 #ifndef BITCOIN_CRYPTO_SIPHASH_H
 #define BITCOIN_CRYPTO_SIPHASH_H
 
+#include <cstddef>
 #include <cstdint>
 
 #include <span.h>
@@ -45,4 +46,9 @@ public:
 uint64_t SipHashUint256(uint64_t k0, uint64_t k1, const uint256& val);
 uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint32_t extra);
 
+/** Compute out[i] = SipHashUint256(k0, k1, *vals[i]) for every value, several
+ *  at a time where the CPU allows. out must be at least as long as vals.
+ */
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, std::span<const uint256* const> vals, std::span<uint64_t> out);
+
 #endif // BITCOIN_CRYPTO_SIPHASH_H
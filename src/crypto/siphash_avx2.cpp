@@ -0,0 +1,80 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <attributes.h>
+#include <uint256.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace siphash_avx2 {
+namespace {
+
+using Vec = uint64_t __attribute__((vector_size(32)));
+
+template <int N>
+ALWAYS_INLINE Vec RotL(Vec x) { return (x << N) | (x >> (64 - N)); }
+
+#define VEC_SIPROUND do { \
+    v0 += v1; v1 = RotL<13>(v1); v1 ^= v0; \
+    v0 = RotL<32>(v0); \
+    v2 += v3; v3 = RotL<16>(v3); v3 ^= v2; \
+    v0 += v3; v3 = RotL<21>(v3); v3 ^= v0; \
+    v2 += v1; v1 = RotL<17>(v1); v1 ^= v2; \
+    v2 = RotL<32>(v2); \
+} while (0)
+
+} // namespace
+
+/**
+ * Compute out[i] = SipHashUint256(k0, k1, *vals[i]) for the first n (a
+ * multiple of 4) values, one per 64-bit lane.
+ */
+void Uint256_4way(uint64_t k0, uint64_t k1, const uint256* const* vals, uint64_t* out, size_t n)
+{
+    constexpr size_t LANES{sizeof(Vec) / sizeof(uint64_t)};
+
+    for (; n; n -= LANES, vals += LANES, out += LANES) {
+        // Transpose the inputs, so that d[w] holds word w of every value.
+        uint64_t words[4][LANES];
+        for (size_t l = 0; l < LANES; ++l) {
+            for (int w = 0; w < 4; ++w) words[w][l] = vals[l]->GetUint64(w);
+        }
+        Vec d[4];
+        std::memcpy(d, words, sizeof(d));
+
+        Vec v0 = Vec{} + (0x736f6d6570736575ULL ^ k0);
+        Vec v1 = Vec{} + (0x646f72616e646f6dULL ^ k1);
+        Vec v2 = Vec{} + (0x6c7967656e657261ULL ^ k0);
+        Vec v3 = Vec{} + (0x7465646279746573ULL ^ k1);
+
+        for (int w = 0; w < 4; ++w) {
+            v3 ^= d[w];
+            VEC_SIPROUND;
+            VEC_SIPROUND;
+            v0 ^= d[w];
+        }
+        v3 ^= (uint64_t{4}) << 59;
+        VEC_SIPROUND;
+        VEC_SIPROUND;
+        v0 ^= (uint64_t{4}) << 59;
+        v2 ^= 0xFF;
+        VEC_SIPROUND;
+        VEC_SIPROUND;
+        VEC_SIPROUND;
+        VEC_SIPROUND;
+
+        const Vec result = v0 ^ v1 ^ v2 ^ v3;
+        std::memcpy(out, &result, sizeof(result));
+    }
+}
+
+#undef VEC_SIPROUND
+
+} // namespace siphash_avx2
+
+#endif
@@ -362,6 +362,22 @@ CDBIterator* CDBWrapper::NewIterator()
     return new CDBIterator{*this, std::make_unique<CDBIterator::IteratorImpl>(DBContext().pdb->NewIterator(DBContext().iteroptions))};
 }
 
+std::vector<std::unique_ptr<CDBIterator>> CDBWrapper::NewIterators(size_t count)
+{
+    // An iterator keeps the data it reads alive by itself, so the snapshot
+    // is only needed to create all of them at the same sequence number.
+    const leveldb::Snapshot* snapshot{DBContext().pdb->GetSnapshot()};
+    leveldb::ReadOptions options{DBContext().iteroptions};
+    options.snapshot = snapshot;
+    std::vector<std::unique_ptr<CDBIterator>> iterators;
+    iterators.reserve(count);
+    for (size_t i{0}; i < count; ++i) {
+        iterators.push_back(std::make_unique<CDBIterator>(*this, std::make_unique<CDBIterator::IteratorImpl>(DBContext().pdb->NewIterator(options))));
+    }
+    DBContext().pdb->ReleaseSnapshot(snapshot);
+    return iterators;
+}
+
 void CDBIterator::SeekImpl(std::span<const std::byte> key)
 {
     leveldb::Slice slKey(CharCast(key.data()), key.size());
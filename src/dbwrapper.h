@@ -18,6 +18,7 @@
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
@@ -269,6 +270,12 @@ public:
 
     CDBIterator* NewIterator();
 
+    /**
+     * Create count iterators that all see the database as it is at the time
+     * of the call, so that it can be read in parallel from a consistent state.
+     */
+    std::vector<std::unique_ptr<CDBIterator>> NewIterators(size_t count);
+
     /**
      * Return true if the database managed by this class contains no entries.
      */
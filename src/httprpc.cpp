@@ -9,8 +9,10 @@
 #include <httpserver.h>
 #include <logging.h>
 #include <netaddress.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
+#include <sync.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/strencodings.h>
@@ -18,12 +20,16 @@
 #include <walletinitinterface.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 using util::SplitString;
@@ -37,6 +43,77 @@ static std::vector<std::vector<std::string>> g_rpcauth;
 /* RPC Auth Whitelist */
 static std::map<std::string, std::set<std::string>> g_rpc_whitelist;
 static bool g_rpc_whitelist_default = false;
+/* Most requests of a JSON-RPC batch executed at once */
+static int g_rpc_batch_parallelism{DEFAULT_RPC_BATCH_PARALLELISM};
+
+/** A JSON-RPC batch being executed by one or more HTTP worker threads. */
+struct RPCBatch {
+    /** The request the batch came in, without method and parameters */
+    const JSONRPCRequest jreq;
+    const UniValue requests;
+    /** Index of the next request to execute */
+    std::atomic<size_t> next{0};
+    /** The response to each request, if it is not a notification */
+    std::vector<std::optional<UniValue>> responses;
+    Mutex mutex;
+    std::condition_variable cond;
+    size_t done GUARDED_BY(mutex){0};
+
+    RPCBatch(JSONRPCRequest jreq_in, UniValue requests_in)
+        : jreq{std::move(jreq_in)}, requests{std::move(requests_in)}, responses(requests.size()) {}
+};
+
+/** Execute requests of a batch until none are left to start. */
+static void ExecuteBatchRequests(RPCBatch& batch)
+{
+    for (size_t i; (i = batch.next++) < batch.requests.size();) {
+        // Batches never throw HTTP errors, they are always just included
+        // in "HTTP OK" responses. Notifications never get any response.
+        JSONRPCRequest jreq{batch.jreq};
+        UniValue response;
+        try {
+            jreq.parse(batch.requests[i]);
+            response = JSONRPCExec(jreq, /*catch_errors=*/true);
+        } catch (UniValue& e) {
+            response = JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
+        } catch (const std::exception& e) {
+            response = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, jreq.m_json_version);
+        }
+        if (!jreq.IsNotification()) {
+            batch.responses[i] = std::move(response);
+        }
+        LOCK(batch.mutex);
+        if (++batch.done == batch.requests.size()) batch.cond.notify_all();
+    }
+}
+
+/**
+ * Execute the requests of a batch, up to g_rpc_batch_parallelism of them at
+ * once. The calling worker executes requests too, and others join it through
+ * the HTTP work queue while it has room, so a batch never waits for a worker
+ * that is not already executing one of its requests. Return the responses in
+ * the order of the requests.
+ */
+static UniValue ExecuteBatch(JSONRPCRequest jreq, UniValue requests)
+{
+    const auto batch{std::make_shared<RPCBatch>(std::move(jreq), std::move(requests))};
+    const size_t workers{std::min<size_t>(g_rpc_batch_parallelism, batch->requests.size())};
+    for (size_t i{1}; i < workers; ++i) {
+        // Helpers that start after all requests did return right away.
+        if (!QueueHTTPTask([batch] { ExecuteBatchRequests(*batch); })) break;
+    }
+    ExecuteBatchRequests(*batch);
+    {
+        WAIT_LOCK(batch->mutex, lock);
+        batch->cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(batch->mutex) { return batch->done == batch->requests.size(); });
+    }
+
+    UniValue reply{UniValue::VARR};
+    for (std::optional<UniValue>& response : batch->responses) {
+        if (response) reply.push_back(std::move(*response));
+    }
+    return reply;
+}
 
 static void JSONErrorReply(HTTPRequest* req, UniValue objError, const JSONRPCRequest& jreq)
 {
@@ -101,6 +178,32 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return CheckUserAuthorized(user, pass);
 }
 
+/**
+ * The reply to a request whose result is streamed, as the text before and
+ * after the result.
+ */
+static std::pair<std::string, std::string> JSONRPCReplyFrame(const JSONRPCRequest& jreq)
+{
+    // Write the fields of a reply without result around the result.
+    const UniValue reply{JSONRPCReplyObj(NullUniValue, NullUniValue, jreq.id, jreq.m_json_version)};
+    std::string head{"{"};
+    std::string tail;
+    bool after_result{false};
+    for (size_t i{0}; i < reply.size(); ++i) {
+        const std::string& key{reply.getKeys()[i]};
+        std::string& out{after_result ? tail : head};
+        if (i > 0) out += ',';
+        out += UniValue{key}.write() + ':';
+        if (key == "result") {
+            after_result = true;
+        } else {
+            out += reply.getValues()[i].write();
+        }
+    }
+    tail += "}\n";
+    return {std::move(head), std::move(tail)};
+}
+
 static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
 {
     // JSONRPC handles only POST
@@ -162,7 +265,44 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
             // 2.0 behavior is to catch exceptions and return HTTP success with
             // RPC errors, as long as there is not an actual HTTP server error.
             const bool catch_errors{jreq.m_json_version == JSONRPCVersion::V2};
-            reply = JSONRPCExec(jreq, catch_errors);
+
+            // Methods with large results may write them to a stream, which is
+            // sent as a chunked reply while the result is produced.
+            const auto [reply_head, reply_tail]{JSONRPCReplyFrame(jreq)};
+            bool reply_started{false};
+            JSONStreamWriter stream{[&](std::string_view data) {
+                if (!reply_started) {
+                    req->WriteHeader("Content-Type", "application/json");
+                    req->WriteReplyStart(HTTP_OK);
+                    req->WriteReplyChunk(reply_head);
+                    reply_started = true;
+                }
+                req->WriteReplyChunk(data);
+            }};
+            if (!jreq.IsNotification()) jreq.m_stream = &stream;
+            try {
+                reply = JSONRPCExec(jreq, catch_errors);
+            } catch (...) {
+                if (!reply_started) throw;
+                reply = NullUniValue;
+            }
+            jreq.m_stream = nullptr;
+            if (reply_started || !stream.Empty()) {
+                if (reply.isObject() && reply.find_value("error").isNull()) {
+                    stream.Flush();
+                    req->WriteReplyChunk(reply_tail);
+                    req->WriteReplyEnd();
+                    return true;
+                }
+                if (reply_started) {
+                    // Part of the result was sent already, so the error can
+                    // not be. Drop the connection without ending the reply,
+                    // so the client cannot take it for complete.
+                    LogPrintf("RPC method %s failed while sending its result\n", jreq.strMethod);
+                    req->WriteReplyAbort();
+                    return false;
+                }
+            }
 
             if (jreq.IsNotification()) {
                 // Even though we do execute notifications, we do not respond to them
@@ -191,23 +331,8 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
             }
 
             // Execute each request
-            reply = UniValue::VARR;
-            for (size_t i{0}; i < valRequest.size(); ++i) {
-                // Batches never throw HTTP errors, they are always just included
-                // in "HTTP OK" responses. Notifications never get any response.
-                UniValue response;
-                try {
-                    jreq.parse(valRequest[i]);
-                    response = JSONRPCExec(jreq, /*catch_errors=*/true);
-                } catch (UniValue& e) {
-                    response = JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
-                } catch (const std::exception& e) {
-                    response = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, jreq.m_json_version);
-                }
-                if (!jreq.IsNotification()) {
-                    reply.push_back(std::move(response));
-                }
-            }
+            const size_t num_requests{valRequest.size()};
+            reply = ExecuteBatch(jreq, std::move(valRequest));
             // Return no response for an all-notification batch, but only if the
             // batch request is non-empty. Technically according to the JSON-RPC
             // 2.0 spec, an empty batch request should also return no response,
@@ -217,7 +342,7 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
             // relying on previous behavior. Return an empty array instead of an
             // empty response in this case to favor being backwards compatible
             // over complying with the JSON-RPC 2.0 spec in this case.
-            if (reply.size() == 0 && valRequest.size() > 0) {
+            if (reply.size() == 0 && num_requests > 0) {
                 req->WriteReply(HTTP_NO_CONTENT);
                 return true;
             }
@@ -333,6 +458,7 @@ bool StartHTTPRPC(const std::any& context)
     LogDebug(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
+    g_rpc_batch_parallelism = std::max<int64_t>(gArgs.GetIntArg("-rpcbatchparallelism", DEFAULT_RPC_BATCH_PARALLELISM), 1);
 
     auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
     RegisterHTTPHandler("/", true, handle_rpc);
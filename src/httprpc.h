@@ -7,6 +7,9 @@
 
 #include <any>
 
+/** Default for -rpcbatchparallelism, the most requests of a JSON-RPC batch executed at once. */
+static const int DEFAULT_RPC_BATCH_PARALLELISM{1};
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
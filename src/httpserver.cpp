@@ -16,6 +16,7 @@
 #include <util/check.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/threadnames.h>
 #include <util/translation.h>
 
@@ -39,6 +40,7 @@
 #include <event2/http.h>
 #include <event2/http_struct.h>
 #include <event2/keyvalq_struct.h>
+#include <event2/listener.h>
 #include <event2/thread.h>
 #include <event2/util.h>
 
@@ -69,6 +71,20 @@ private:
     HTTPRequestHandler func;
 };
 
+/** Work item for a task queued by a request handler */
+class HTTPTaskItem final : public HTTPClosure
+{
+public:
+    explicit HTTPTaskItem(std::function<void()> task) : m_task(std::move(task)) {}
+    void operator()() override
+    {
+        m_task();
+    }
+
+private:
+    std::function<void()> m_task;
+};
+
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
  */
@@ -137,12 +153,20 @@ struct HTTPPathHandler
     HTTPRequestHandler handler;
 };
 
+/** A libevent event loop with its own HTTP server */
+struct HTTPEventLoop {
+    struct event_base* base{nullptr};
+    struct evhttp* http{nullptr};
+    //! Listening sockets, bound to the same addresses in every loop
+    std::vector<evhttp_bound_socket*> sockets;
+    std::thread thread;
+};
+
 /** HTTP module state */
 
-//! libevent event loop
-static struct event_base* eventBase = nullptr;
-//! HTTP server
-static struct evhttp* eventHTTP = nullptr;
+//! libevent event loops, which all listen on the same addresses with
+//! SO_REUSEPORT, so that the kernel spreads connections over them
+static std::vector<HTTPEventLoop> g_event_loops;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
 //! Work queue for handling longer requests off the event loop thread
@@ -150,8 +174,8 @@ static std::unique_ptr<WorkQueue<HTTPClosure>> g_work_queue{nullptr};
 //! Handlers for (sub)paths
 static GlobalMutex g_httppathhandlers_mutex;
 static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_mutex);
-//! Bound listening sockets
-static std::vector<evhttp_bound_socket *> boundSockets;
+//! Seconds a connection may be idle, as given by -rpcservertimeout
+static int64_t g_http_server_timeout{DEFAULT_HTTP_SERVER_TIMEOUT};
 
 /**
  * @brief Helps keep track of open `evhttp_connection`s with active `evhttp_requests`
@@ -348,17 +372,60 @@ static void http_reject_request_cb(struct evhttp_request* req, void*)
 }
 
 /** Event dispatcher thread */
-static void ThreadHTTP(struct event_base* base)
+static void ThreadHTTP(struct event_base* base, int loop_num)
 {
-    util::ThreadRename("http");
+    util::ThreadRename(loop_num == 0 ? "http" : strprintf("http.%i", loop_num));
     LogDebug(BCLog::HTTP, "Entering http event loop\n");
     event_base_dispatch(base);
     // Event loop will be interrupted by InterruptHTTPServer()
     LogDebug(BCLog::HTTP, "Exited http event loop\n");
 }
 
-/** Bind HTTP server to specified addresses */
-static bool HTTPBindAddresses(struct evhttp* http)
+/** Set the no-delay option (disable Nagle's algorithm) on a listening socket, which its connections inherit. */
+static void HTTPSetNoDelay(evhttp_bound_socket* bind_handle)
+{
+    evutil_socket_t fd = evhttp_bound_socket_get_fd(bind_handle);
+    int one = 1;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&one), sizeof(one)) == SOCKET_ERROR) {
+        LogInfo("WARNING: Unable to set TCP_NODELAY on RPC server socket, continuing anyway\n");
+    }
+}
+
+/**
+ * Listen on an address with SO_REUSEPORT, so that each event loop can have a
+ * listening socket of its own for it. The kernel then hands each connection
+ * to one of the sockets, rather than waking every loop to race for it.
+ */
+static evhttp_bound_socket* HTTPBindReusePort(struct evhttp* http, struct event_base* base, const sockaddr* addr, socklen_t addr_len)
+{
+    evconnlistener* listener{evconnlistener_new_bind(base, nullptr, nullptr,
+                                                     LEV_OPT_CLOSE_ON_FREE | LEV_OPT_CLOSE_ON_EXEC | LEV_OPT_REUSEABLE | LEV_OPT_REUSEABLE_PORT,
+                                                     -1, addr, addr_len)};
+    if (!listener) return nullptr;
+    evhttp_bound_socket* bind_handle{evhttp_bind_listener(http, listener)};
+    if (!bind_handle) evconnlistener_free(listener);
+    return bind_handle;
+}
+
+/** Like evhttp_bind_socket_with_handle, but with SO_REUSEPORT. */
+static evhttp_bound_socket* HTTPBindReusePort(struct evhttp* http, struct event_base* base, const std::string& host, uint16_t port)
+{
+    struct evutil_addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = EVUTIL_AI_PASSIVE | EVUTIL_AI_ADDRCONFIG;
+    struct evutil_addrinfo* ai{nullptr};
+    if (evutil_getaddrinfo(host.empty() ? nullptr : host.c_str(), util::ToString(port).c_str(), &hints, &ai) != 0) return nullptr;
+    evhttp_bound_socket* bind_handle{HTTPBindReusePort(http, base, ai->ai_addr, ai->ai_addrlen)};
+    evutil_freeaddrinfo(ai);
+    return bind_handle;
+}
+
+/**
+ * Bind HTTP server to specified addresses. With reuse_port, other event loops
+ * can then listen on the same addresses with HTTPBindAgain.
+ */
+static bool HTTPBindAddresses(struct evhttp* http, struct event_base* base, bool reuse_port, std::vector<evhttp_bound_socket*>& bound_sockets)
 {
     uint16_t http_port{static_cast<uint16_t>(gArgs.GetIntArg("-rpcport", BaseParams().RPCPort()))};
     std::vector<std::pair<std::string, uint16_t>> endpoints;
@@ -392,24 +459,35 @@ static bool HTTPBindAddresses(struct evhttp* http)
     // Bind addresses
     for (std::vector<std::pair<std::string, uint16_t> >::iterator i = endpoints.begin(); i != endpoints.end(); ++i) {
         LogInfo("Binding RPC on address %s port %i", i->first, i->second);
-        evhttp_bound_socket *bind_handle = evhttp_bind_socket_with_handle(http, i->first.empty() ? nullptr : i->first.c_str(), i->second);
+        evhttp_bound_socket *bind_handle = reuse_port ? HTTPBindReusePort(http, base, i->first, i->second) :
+                                                        evhttp_bind_socket_with_handle(http, i->first.empty() ? nullptr : i->first.c_str(), i->second);
         if (bind_handle) {
             const std::optional<CNetAddr> addr{LookupHost(i->first, false)};
             if (i->first.empty() || (addr.has_value() && addr->IsBindAny())) {
                 LogPrintf("WARNING: the RPC server is not safe to expose to untrusted networks such as the public internet\n");
             }
-            // Set the no-delay option (disable Nagle's algorithm) on the TCP socket.
-            evutil_socket_t fd = evhttp_bound_socket_get_fd(bind_handle);
-            int one = 1;
-            if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&one), sizeof(one)) == SOCKET_ERROR) {
-                LogInfo("WARNING: Unable to set TCP_NODELAY on RPC server socket, continuing anyway\n");
-            }
-            boundSockets.push_back(bind_handle);
+            HTTPSetNoDelay(bind_handle);
+            bound_sockets.push_back(bind_handle);
         } else {
             LogPrintf("Binding RPC on address %s port %i failed.\n", i->first, i->second);
         }
     }
-    return !boundSockets.empty();
+    return !bound_sockets.empty();
+}
+
+/** Listen on the addresses of the listening sockets of another event loop, which were bound with SO_REUSEPORT */
+static bool HTTPBindAgain(struct evhttp* http, struct event_base* base, const std::vector<evhttp_bound_socket*>& listening, std::vector<evhttp_bound_socket*>& bound_sockets)
+{
+    for (evhttp_bound_socket* other : listening) {
+        struct sockaddr_storage addr;
+        socklen_t addr_len{sizeof(addr)};
+        if (getsockname(evhttp_bound_socket_get_fd(other), reinterpret_cast<sockaddr*>(&addr), &addr_len) == SOCKET_ERROR) return false;
+        evhttp_bound_socket* bind_handle{HTTPBindReusePort(http, base, reinterpret_cast<const sockaddr*>(&addr), addr_len)};
+        if (!bind_handle) return false;
+        HTTPSetNoDelay(bind_handle);
+        bound_sockets.push_back(bind_handle);
+    }
+    return true;
 }
 
 /** Simple wrapper to set thread name and run work queue */
@@ -456,34 +534,61 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
     evthread_use_pthreads();
 #endif
 
-    raii_event_base base_ctr = obtain_event_base();
-
-    /* Create a new evhttp object to handle requests. */
-    raii_evhttp http_ctr = obtain_evhttp(base_ctr.get());
-    struct evhttp* http = http_ctr.get();
-    if (!http) {
-        LogPrintf("couldn't create evhttp. Exiting.\n");
-        return false;
+    int event_threads = std::max((long)gArgs.GetIntArg("-rpceventthreads", DEFAULT_HTTP_EVENT_THREADS), 1L);
+#ifndef __linux__
+    // Elsewhere, libevent does not set SO_REUSEPORT, or it does not spread
+    // connections over the sockets.
+    if (event_threads > 1) {
+        LogPrintf("WARNING: -rpceventthreads is only supported on Linux, using a single event loop\n");
+        event_threads = 1;
     }
+#endif
+    g_http_server_timeout = gArgs.GetIntArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT);
+
+    std::vector<std::pair<raii_event_base, raii_evhttp>> loops;
+    std::vector<std::vector<evhttp_bound_socket*>> loop_sockets;
+    for (int i = 0; i < event_threads; i++) {
+        raii_event_base base_ctr = obtain_event_base();
+
+        /* Create a new evhttp object to handle requests. */
+        raii_evhttp http_ctr = obtain_evhttp(base_ctr.get());
+        struct evhttp* http = http_ctr.get();
+        if (!http) {
+            LogPrintf("couldn't create evhttp. Exiting.\n");
+            return false;
+        }
 
-    evhttp_set_timeout(http, gArgs.GetIntArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
-    evhttp_set_max_headers_size(http, MAX_HEADERS_SIZE);
-    evhttp_set_max_body_size(http, MAX_SIZE);
-    evhttp_set_gencb(http, http_request_cb, (void*)&interrupt);
+        evhttp_set_timeout(http, g_http_server_timeout);
+        evhttp_set_max_headers_size(http, MAX_HEADERS_SIZE);
+        evhttp_set_max_body_size(http, MAX_SIZE);
+        evhttp_set_gencb(http, http_request_cb, (void*)&interrupt);
 
-    if (!HTTPBindAddresses(http)) {
-        LogPrintf("Unable to bind any endpoint for RPC server\n");
-        return false;
+        std::vector<evhttp_bound_socket*> bound_sockets;
+        if (i == 0) {
+            if (!HTTPBindAddresses(http, base_ctr.get(), /*reuse_port=*/event_threads > 1, bound_sockets)) {
+                LogPrintf("Unable to bind any endpoint for RPC server\n");
+                return false;
+            }
+        } else if (!HTTPBindAgain(http, base_ctr.get(), loop_sockets[0], bound_sockets)) {
+            LogPrintf("WARNING: Unable to bind the RPC server addresses for another event loop, using %d event loops\n", i);
+            break;
+        }
+        loops.emplace_back(std::move(base_ctr), std::move(http_ctr));
+        loop_sockets.push_back(std::move(bound_sockets));
     }
 
-    LogDebug(BCLog::HTTP, "Initialized HTTP server\n");
+    LogDebug(BCLog::HTTP, "Initialized HTTP server with %d event loops\n", loops.size());
     int workQueueDepth = std::max((long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogDebug(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
 
     g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
-    // transfer ownership to eventBase/HTTP via .release()
-    eventBase = base_ctr.release();
-    eventHTTP = http_ctr.release();
+    // transfer ownership to the event loops via .release()
+    for (size_t i = 0; i < loops.size(); i++) {
+        HTTPEventLoop& loop = g_event_loops.emplace_back();
+        loop.base = loops[i].first.release();
+        loop.http = loops[i].second.release();
+        loop.sockets = std::move(loop_sockets[i]);
+    }
     return true;
 }
 
@@ -495,14 +600,15 @@ void UpdateHTTPServerLogging(bool enable) {
     }
 }
 
-static std::thread g_thread_http;
 static std::vector<std::thread> g_thread_http_workers;
 
 void StartHTTPServer()
 {
     int rpcThreads = std::max((long)gArgs.GetIntArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogInfo("Starting HTTP server with %d worker threads\n", rpcThreads);
-    g_thread_http = std::thread(ThreadHTTP, eventBase);
+    LogInfo("Starting HTTP server with %d event loops and %d worker threads\n", g_event_loops.size(), rpcThreads);
+    for (size_t i = 0; i < g_event_loops.size(); i++) {
+        g_event_loops[i].thread = std::thread(ThreadHTTP, g_event_loops[i].base, i);
+    }
 
     for (int i = 0; i < rpcThreads; i++) {
         g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), i);
@@ -512,9 +618,9 @@ void StartHTTPServer()
 void InterruptHTTPServer()
 {
     LogDebug(BCLog::HTTP, "Interrupting HTTP server\n");
-    if (eventHTTP) {
+    for (HTTPEventLoop& loop : g_event_loops) {
         // Reject requests on current connections
-        evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
+        evhttp_set_gencb(loop.http, http_reject_request_cb, nullptr);
     }
     if (g_work_queue) {
         g_work_queue->Interrupt();
@@ -533,30 +639,34 @@ void StopHTTPServer()
     }
     // Unlisten sockets, these are what make the event loop running, which means
     // that after this and all connections are closed the event loop will quit.
-    for (evhttp_bound_socket *socket : boundSockets) {
-        evhttp_del_accept_socket(eventHTTP, socket);
+    for (HTTPEventLoop& loop : g_event_loops) {
+        for (evhttp_bound_socket *socket : loop.sockets) {
+            evhttp_del_accept_socket(loop.http, socket);
+        }
+        loop.sockets.clear();
     }
-    boundSockets.clear();
     {
         if (const auto n_connections{g_requests.CountActiveConnections()}; n_connections != 0) {
             LogDebug(BCLog::HTTP, "Waiting for %d connections to stop HTTP server\n", n_connections);
         }
         g_requests.WaitUntilEmpty();
     }
-    if (eventHTTP) {
+    for (HTTPEventLoop& loop : g_event_loops) {
         // Schedule a callback to call evhttp_free in the event base thread, so
         // that evhttp_free does not need to be called again after the handling
         // of unfinished request connections that follows.
-        event_base_once(eventBase, -1, EV_TIMEOUT, [](evutil_socket_t, short, void*) {
-            evhttp_free(eventHTTP);
-            eventHTTP = nullptr;
-        }, nullptr, nullptr);
+        event_base_once(loop.base, -1, EV_TIMEOUT, [](evutil_socket_t, short, void* http) {
+            evhttp_free(static_cast<struct evhttp*>(http));
+        }, loop.http, nullptr);
+        loop.http = nullptr;
     }
-    if (eventBase) {
-        LogDebug(BCLog::HTTP, "Waiting for HTTP event thread to exit\n");
-        if (g_thread_http.joinable()) g_thread_http.join();
-        event_base_free(eventBase);
-        eventBase = nullptr;
+    if (!g_event_loops.empty()) {
+        LogDebug(BCLog::HTTP, "Waiting for HTTP event threads to exit\n");
+        for (HTTPEventLoop& loop : g_event_loops) {
+            if (loop.thread.joinable()) loop.thread.join();
+            event_base_free(loop.base);
+        }
+        g_event_loops.clear();
     }
     g_work_queue.reset();
     LogDebug(BCLog::HTTP, "Stopped HTTP server\n");
@@ -564,7 +674,16 @@ void StopHTTPServer()
 
 struct event_base* EventBase()
 {
-    return eventBase;
+    return g_event_loops.empty() ? nullptr : g_event_loops.front().base;
+}
+
+bool QueueHTTPTask(std::function<void()> task)
+{
+    if (!g_work_queue) return false;
+    auto item{std::make_unique<HTTPTaskItem>(std::move(task))};
+    if (!g_work_queue->Enqueue(item.get())) return false;
+    item.release(); /* if true, queue took ownership */
+    return true;
 }
 
 static void httpevent_callback_fn(evutil_socket_t, short, void* data)
@@ -593,14 +712,52 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
+/** Bytes of a chunked reply that may wait to be read by the client before sending more blocks */
+static constexpr size_t MAX_CHUNKED_REPLY_BUFFER{4 << 20};
+
+/** Flow control of a chunked reply, shared with the main http thread. */
+struct HTTPRequest::ChunkedReply {
+    Mutex mutex;
+    std::condition_variable cond;
+    //! Bytes of chunks not yet handed to libevent
+    size_t queued GUARDED_BY(mutex){0};
+    //! Bytes in the connection's output buffer
+    size_t buffered GUARDED_BY(mutex){0};
+    //! Whether the client stopped reading, so that chunks are dropped
+    bool failed GUARDED_BY(mutex){false};
+};
+
+/** Re-enable reading from the socket once a reply is complete. This is the
+ * second part of the libevent workaround in http_request_cb.
+ */
+static void EnableReadingAfterReply(evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 HTTPRequest::HTTPRequest(struct evhttp_request* _req, const util::SignalInterrupt& interrupt, bool _replySent)
-    : req(_req), m_interrupt(interrupt), replySent(_replySent)
+    : req(_req), m_base(nullptr), m_interrupt(interrupt), replySent(_replySent)
 {
+    if (evhttp_connection* conn = evhttp_request_get_connection(req)) {
+        m_base = evhttp_connection_get_base(conn);
+    }
 }
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (m_chunked && !replySent) {
+        // A chunked reply was cut short; drop the connection rather than leak
+        // the request or pass the partial body off as complete
+        WriteReplyAbort();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -662,19 +819,107 @@ void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
     assert(evb);
     evbuffer_add(evb, reply.data(), reply.size());
     auto req_copy = req;
-    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+        EnableReadingAfterReply(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+/** Chunked replies are sent through events on the main http thread like
+ * WriteReply, which libevent runs in the order they were triggered.
+ */
+void HTTPRequest::WriteReplyStart(int nStatus)
+{
+    assert(!replySent && req && !m_chunked);
+    if (m_interrupt) {
+        WriteHeader("Connection", "close");
+    }
+    m_chunked = std::make_shared<ChunkedReply>();
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, nStatus]{
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::WriteReplyChunk(std::string_view chunk)
+{
+    assert(!replySent && req && m_chunked);
+    if (chunk.empty()) return;
+    ChunkedReply& state{*m_chunked};
+    {
+        WAIT_LOCK(state.mutex, lock);
+        // Wait for the client to read, but give up on it after the same time
+        // libevent closes an idle connection after.
+        const bool ready{state.cond.wait_for(lock, std::chrono::seconds{g_http_server_timeout}, [&]() EXCLUSIVE_LOCKS_REQUIRED(state.mutex) {
+            return state.failed || state.queued + state.buffered < MAX_CHUNKED_REPLY_BUFFER;
+        })};
+        if (!ready && !state.failed) {
+            LogDebug(BCLog::HTTP, "Client stopped reading a chunked reply, dropping the rest\n");
+            state.failed = true;
+        }
+        if (state.failed) return;
+        state.queued += chunk.size();
+    }
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, chunk.data(), chunk.size());
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, evb, chunked = m_chunked]{
+        const size_t size{evbuffer_get_length(evb)};
+        // The callback runs when the connection's output buffer is drained,
+        // and only while this request has the connection; the request holds
+        // the state until WriteReplyEnd replaces the callback.
+        evhttp_send_reply_chunk_with_cb(req_copy, evb, [](evhttp_connection*, void* arg) {
+            ChunkedReply& state{*static_cast<ChunkedReply*>(arg)};
+            WITH_LOCK(state.mutex, state.buffered = 0);
+            state.cond.notify_all();
+        }, chunked.get());
+        evbuffer_free(evb);
+        size_t buffered{0};
+        if (evhttp_connection* conn = evhttp_request_get_connection(req_copy)) {
+            if (bufferevent* bev = evhttp_connection_get_bufferevent(conn)) {
+                buffered = evbuffer_get_length(bufferevent_get_output(bev));
             }
         }
+        {
+            LOCK(chunked->mutex);
+            chunked->queued -= size;
+            chunked->buffered = buffered;
+        }
+        chunked->cond.notify_all();
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::WriteReplyEnd()
+{
+    assert(!replySent && req && m_chunked);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy, chunked = m_chunked]{
+        evhttp_send_reply_end(req_copy);
+        EnableReadingAfterReply(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+void HTTPRequest::WriteReplyAbort()
+{
+    assert(!replySent && req && m_chunked);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(m_base, true, [req_copy]{
+        // Freeing the connection frees the request too, and its chunks not
+        // written yet.
+        if (evhttp_connection* conn = evhttp_request_get_connection(req_copy)) {
+            evhttp_connection_free(conn);
+        } else {
+            evhttp_request_free(req_copy);
+        }
     });
     ev->trigger(nullptr);
     replySent = true;
@@ -6,6 +6,7 @@
 #define BITCOIN_HTTPSERVER_H
 
 #include <functional>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
@@ -27,6 +28,12 @@ static const int DEFAULT_HTTP_WORKQUEUE=64;
 
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
+/**
+ * The default value for `-rpceventthreads`, the number of libevent event loops
+ * that accept connections and read requests and write replies.
+ */
+static const int DEFAULT_HTTP_EVENT_THREADS=1;
+
 struct evhttp_request;
 struct event_base;
 class CService;
@@ -59,20 +66,31 @@ void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPR
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
-/** Return evhttp event base. This can be used by submodules to
- * queue timers or custom events.
+/** Return the event base of the first event loop. This can be used by
+ * submodules to queue timers or custom events.
  */
 struct event_base* EventBase();
 
+/** Queue a task to run on an HTTP worker thread, like a request.
+ * Returns false if the work queue is full or the server is stopping.
+ */
+bool QueueHTTPTask(std::function<void()> task);
+
 /** In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
  */
 class HTTPRequest
 {
 private:
+    struct ChunkedReply;
+
     struct evhttp_request* req;
+    //! Event base of the loop that owns the request's connection
+    struct event_base* m_base;
     const util::SignalInterrupt& m_interrupt;
     bool replySent;
+    //! Flow control state of a reply begun with WriteReplyStart
+    std::shared_ptr<ChunkedReply> m_chunked;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, const util::SignalInterrupt& interrupt, bool replySent = false);
@@ -143,6 +161,37 @@ public:
         WriteReply(nStatus, std::as_bytes(std::span{reply}));
     }
     void WriteReply(int nStatus, std::span<const std::byte> reply);
+
+    /**
+     * Start a chunked HTTP reply, for a body that is sent while it is being
+     * produced. Send the body with WriteReplyChunk, then finish the reply with
+     * WriteReplyEnd, or cut it short with WriteReplyAbort.
+     *
+     * @note Call this instead of WriteReply, after any WriteHeader calls.
+     */
+    void WriteReplyStart(int nStatus);
+
+    /**
+     * Send a part of the body of a reply begun with WriteReplyStart.
+     * Blocks while too much of the body is waiting to be read by the client.
+     * Parts are dropped once the client has not read for the server timeout.
+     */
+    void WriteReplyChunk(std::string_view chunk);
+
+    /**
+     * Finish a reply begun with WriteReplyStart.
+     *
+     * @note Like WriteReply, this gives the request back to the main thread.
+     */
+    void WriteReplyEnd();
+
+    /**
+     * Give up on a reply begun with WriteReplyStart: close the connection
+     * without the final chunk, so the client sees the reply is incomplete.
+     *
+     * @note Like WriteReply, this gives the request back to the main thread.
+     */
+    void WriteReplyAbort();
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
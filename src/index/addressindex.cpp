@@ -0,0 +1,211 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <common/args.h>
+#include <compressor.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <interfaces/chain.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <uint256.h>
+#include <undo.h>
+
+#include <cassert>
+#include <utility>
+
+constexpr uint8_t DB_ADDRESS{'a'};
+
+std::unique_ptr<AddressIndex> g_address_index;
+
+namespace {
+
+enum class EntryKind : uint8_t {
+    FUNDING = 0,
+    SPENDING = 1,
+};
+
+/** Key of an entry: the script hash, height, kind and outpoint. The height and output index are big-endian, so entries
+ *  are in order of height, but the txid is in internal byte order, so entries of one height and kind are ordered by
+ *  its raw bytes. */
+struct DBKey {
+    uint256 script_hash;
+    uint32_t height{0};
+    EntryKind kind{EntryKind::FUNDING};
+    COutPoint outpoint;
+
+    DBKey() = default;
+    DBKey(const uint256& script_hash_in, const AddressIndexEntry& entry)
+        : script_hash{script_hash_in}, height{static_cast<uint32_t>(entry.height)},
+          kind{entry.spending ? EntryKind::SPENDING : EntryKind::FUNDING}, outpoint{entry.outpoint} {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS);
+        s << script_hash;
+        ser_writedata32be(s, height);
+        ser_writedata8(s, static_cast<uint8_t>(kind));
+        s << outpoint.hash;
+        ser_writedata32be(s, outpoint.n);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_ADDRESS) {
+            throw std::ios_base::failure("Invalid format for addressindex DB key");
+        }
+        s >> script_hash;
+        height = ser_readdata32be(s);
+        kind = static_cast<EntryKind>(ser_readdata8(s));
+        s >> outpoint.hash;
+        outpoint.n = ser_readdata32be(s);
+    }
+};
+
+struct DBFundingVal {
+    CAmount amount{0};
+
+    SERIALIZE_METHODS(DBFundingVal, obj) { READWRITE(Using<AmountCompression>(obj.amount)); }
+};
+
+struct DBSpendingVal {
+    CAmount amount{0};
+    Txid txid;
+    uint32_t input{0};
+
+    SERIALIZE_METHODS(DBSpendingVal, obj) { READWRITE(Using<AmountCompression>(obj.amount), obj.txid, VARINT(obj.input)); }
+};
+
+uint256 ScriptHash(const CScript& script)
+{
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+
+/** Pass each output of a block and each input spending an output, with the script paid to, to fn. */
+template <typename Fn>
+void ForEachEntry(const interfaces::BlockInfo& block, Fn&& fn)
+{
+    assert(block.data);
+    assert(block.undo_data);
+    AddressIndexEntry entry;
+    entry.height = block.height;
+    for (size_t i{0}; i < block.data->vtx.size(); ++i) {
+        const CTransaction& tx{*block.data->vtx[i]};
+        entry.spending = false;
+        for (uint32_t n{0}; n < tx.vout.size(); ++n) {
+            const CTxOut& out{tx.vout[n]};
+            if (out.scriptPubKey.IsUnspendable()) continue;
+            entry.outpoint = COutPoint{tx.GetHash(), n};
+            entry.amount = out.nValue;
+            fn(out.scriptPubKey, entry);
+        }
+        if (tx.IsCoinBase()) continue;
+        const CTxUndo& tx_undo{block.undo_data->vtxundo.at(i - 1)};
+        entry.spending = true;
+        entry.spending_txid = tx.GetHash();
+        for (uint32_t j{0}; j < tx.vin.size(); ++j) {
+            const CTxOut& spent{tx_undo.vprevout.at(j).out};
+            entry.outpoint = tx.vin[j].prevout;
+            entry.amount = spent.nValue;
+            entry.spending_input = j;
+            fn(spent.scriptPubKey, entry);
+        }
+    }
+}
+
+} // namespace
+
+AddressIndex::AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "addressindex"),
+      m_db{std::make_unique<BaseIndex::DB>(gArgs.GetDataDirNet() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe)}
+{}
+
+interfaces::Chain::NotifyOptions AddressIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    options.connect_undo_data = true;
+    options.disconnect_data = true;
+    options.disconnect_undo_data = true;
+    return options;
+}
+
+bool AddressIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (block.height == 0) return true;
+
+    CDBBatch batch(*m_db);
+    ForEachEntry(block, [&](const CScript& script, const AddressIndexEntry& entry) {
+        const DBKey key{ScriptHash(script), entry};
+        if (entry.spending) {
+            batch.Write(key, DBSpendingVal{entry.amount, entry.spending_txid, entry.spending_input});
+        } else {
+            batch.Write(key, DBFundingVal{entry.amount});
+        }
+    });
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    if (block.height == 0) return true;
+
+    CDBBatch batch(*m_db);
+    ForEachEntry(block, [&](const CScript& script, const AddressIndexEntry& entry) {
+        batch.Erase(DBKey{ScriptHash(script), entry});
+    });
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::FindScriptHistory(const CScript& script, int start_height, int end_height, std::vector<AddressIndexEntry>& entries,
+                                     size_t skip, size_t max_count) const
+{
+    const uint256 script_hash{ScriptHash(script)};
+    std::unique_ptr<CDBIterator> it{m_db->NewIterator()};
+    AddressIndexEntry first;
+    first.height = start_height;
+    first.outpoint = COutPoint{Txid{}, 0};
+    it->Seek(DBKey{script_hash, first});
+    for (size_t found{0}; it->Valid() && found < max_count; it->Next()) {
+        DBKey key;
+        if (!it->GetKey(key) || key.script_hash != script_hash || key.height > uint32_t(end_height)) break;
+        if (skip > 0) {
+            --skip;
+            continue;
+        }
+        ++found;
+
+        AddressIndexEntry& entry{entries.emplace_back()};
+        entry.height = key.height;
+        entry.spending = key.kind == EntryKind::SPENDING;
+        entry.outpoint = key.outpoint;
+        if (entry.spending) {
+            DBSpendingVal value;
+            if (!it->GetValue(value)) {
+                LogError("Cannot read spending entry of %s from %s", key.outpoint.ToString(), GetName());
+                return false;
+            }
+            entry.amount = value.amount;
+            entry.spending_txid = value.txid;
+            entry.spending_input = value.input;
+        } else {
+            DBFundingVal value;
+            if (!it->GetValue(value)) {
+                LogError("Cannot read funding entry of %s from %s", key.outpoint.ToString(), GetName());
+                return false;
+            }
+            entry.amount = value.amount;
+        }
+    }
+    return true;
+}
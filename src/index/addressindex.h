@@ -0,0 +1,81 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_ADDRESSINDEX_H
+#define BITCOIN_INDEX_ADDRESSINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <primitives/transaction.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+class CScript;
+
+static constexpr bool DEFAULT_ADDRESSINDEX{false};
+
+/** An output paying to a script, or an input spending such an output. */
+struct AddressIndexEntry {
+    //! Height of the block of the transaction
+    int height{0};
+    //! Whether the entry is an input spending the output, rather than the output
+    bool spending{false};
+    //! The output paying to the script
+    COutPoint outpoint;
+    //! Amount of the output
+    CAmount amount{0};
+    //! For a spending entry, the spending transaction and its input
+    Txid spending_txid;
+    uint32_t spending_input{0};
+};
+
+/**
+ * AddressIndex is used to look up the history of a scriptPubKey: the outputs
+ * paying to it and the inputs spending them, with the heights of their blocks.
+ *
+ * Entries are keyed by the SHA256 of the scriptPubKey followed by the
+ * big-endian height, so the history of a script over a range of heights is a
+ * single range of keys. The full hash keeps the histories of different scripts
+ * apart, as finding two scripts with the same SHA256 is infeasible.
+ */
+class AddressIndex final : public BaseIndex
+{
+private:
+    const std::unique_ptr<BaseIndex::DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Look up the history of a script in the blocks from start_height to
+    /// end_height inclusive, in order of height.
+    ///
+    /// @param[in]   script  The scriptPubKey to look up.
+    /// @param[out]  entries  The entries found, appended in order of height.
+    /// @param[in]   skip  The number of entries to skip first.
+    /// @param[in]   max_count  The most entries to append.
+    /// @return  false if the database could not be read, true otherwise
+    bool FindScriptHistory(const CScript& script, int start_height, int end_height, std::vector<AddressIndexEntry>& entries,
+                           size_t skip = 0, size_t max_count = std::numeric_limits<size_t>::max()) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_address_index;
+
+#endif // BITCOIN_INDEX_ADDRESSINDEX_H
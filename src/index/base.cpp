@@ -13,26 +13,38 @@
 #include <node/context.h>
 #include <node/database_args.h>
 #include <node/interface_ui.h>
+#include <sync.h>
 #include <tinyformat.h>
 #include <undo.h>
 #include <util/string.h>
 #include <util/thread.h>
+#include <util/threadnames.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
 
+//! Number of blocks read and computed ahead of the one appended next in a parallel initial sync
+constexpr size_t SYNC_WINDOW_SIZE{16};
+//! Maximum number of threads reading and computing blocks in a parallel initial sync
+constexpr size_t MAX_SYNC_WORKERS{8};
+
 template <typename... Args>
 void BaseIndex::FatalErrorf(util::ConstevalFormatString<sizeof...(Args)> fmt, const Args&... args)
 {
@@ -182,10 +194,171 @@ bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data
     return true;
 }
 
+/**
+ * Reads and computes blocks for the initial sync of an index that allows it,
+ * on worker threads that live for the whole sync. Blocks are queued in chain
+ * order and handed back in the same order once computed, so that the sync
+ * thread appends them one at a time while the workers carry on with the
+ * blocks after them.
+ */
+class BaseIndex::SyncPipeline
+{
+public:
+    struct Slot {
+        const CBlockIndex* block_index{nullptr};
+        CBlock block;
+        CBlockUndo block_undo;
+        std::any result;
+        std::string error;
+        bool done{false};
+    };
+
+private:
+    BaseIndex& m_index;
+    const bool m_read_undo;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Queued blocks, the one to append next first. Workers keep references
+    //! to the slots they compute, which std::deque leaves valid when slots are
+    //! added or removed at either end.
+    std::deque<Slot> m_slots GUARDED_BY(m_mutex);
+    //! Number of slots at the front of m_slots taken by a worker.
+    size_t m_taken GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_workers;
+
+    void Compute(Slot& slot)
+    {
+        const CBlockIndex& block_index{*slot.block_index};
+        if (!m_index.m_chainstate->m_blockman.ReadBlock(slot.block, block_index)) {
+            slot.error = strprintf("Failed to read block %s from disk", block_index.GetBlockHash().ToString());
+        } else if (m_read_undo && block_index.nHeight > 0 && !m_index.m_chainstate->m_blockman.ReadBlockUndo(slot.block_undo, block_index)) {
+            slot.error = strprintf("Failed to read undo block data %s from disk", block_index.GetBlockHash().ToString());
+        } else if (!m_index.CustomComputeBlock(BlockInfo(slot), slot.result)) {
+            slot.error = strprintf("Failed to compute block %s for index", block_index.GetBlockHash().ToString());
+        }
+    }
+
+    void Work() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        while (true) {
+            Slot* slot;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_taken < m_slots.size(); });
+                if (m_stop) return;
+                slot = &m_slots[m_taken++];
+            }
+            Compute(*slot);
+            WITH_LOCK(m_mutex, slot->done = true);
+            m_cv.notify_all();
+        }
+    }
+
+public:
+    explicit SyncPipeline(BaseIndex& index)
+        : m_index{index}, m_read_undo{index.CustomOptions().connect_undo_data}
+    {
+        const size_t num_workers{std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_SYNC_WORKERS)};
+        m_workers.reserve(num_workers);
+        for (size_t n{0}; n < num_workers; ++n) {
+            m_workers.emplace_back([this, n] {
+                util::ThreadRename(strprintf("%s.%d", m_index.GetName(), n));
+                Work();
+            });
+        }
+    }
+
+    /** Let the workers finish the blocks they are computing, and join them. */
+    ~SyncPipeline()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        for (std::thread& thread : m_workers) thread.join();
+    }
+
+    interfaces::BlockInfo BlockInfo(Slot& slot) const
+    {
+        interfaces::BlockInfo block_info = kernel::MakeBlockInfo(slot.block_index, &slot.block);
+        if (m_read_undo) block_info.undo_data = &slot.block_undo;
+        return block_info;
+    }
+
+    size_t Size() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) { return WITH_LOCK(m_mutex, return m_slots.size()); }
+    const CBlockIndex* Front() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) { return WITH_LOCK(m_mutex, return m_slots.empty() ? nullptr : m_slots.front().block_index); }
+    const CBlockIndex* Back() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) { return WITH_LOCK(m_mutex, return m_slots.empty() ? nullptr : m_slots.back().block_index); }
+
+    /** Queue a block to be read and computed after the ones already queued. */
+    void Push(const CBlockIndex* block_index) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_slots.emplace_back().block_index = block_index);
+        m_cv.notify_all();
+    }
+
+    /** Wait for the first queued block to be computed, and take it out of the queue. */
+    Slot Pop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        assert(!m_slots.empty());
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_slots.front().done; });
+        Slot slot{std::move(m_slots.front())};
+        m_slots.pop_front();
+        --m_taken;
+        return slot;
+    }
+
+    /** Drop the queued blocks, waiting for those a worker is computing. */
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_slots.erase(m_slots.begin() + m_taken, m_slots.end());
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return std::ranges::all_of(m_slots, [](const Slot& slot) { return slot.done; });
+        });
+        m_slots.clear();
+        m_taken = 0;
+    }
+};
+
+bool BaseIndex::ProcessQueuedBlock(SyncPipeline& pipeline, const CBlockIndex* pindex)
+{
+    // Blocks queued from a chain that a reorg has since left are of no use.
+    if (pipeline.Front() != pindex) {
+        pipeline.Clear();
+        pipeline.Push(pindex);
+    }
+    // Top the queue up once it is half empty, to take cs_main less often.
+    if (pipeline.Size() <= SYNC_WINDOW_SIZE / 2) {
+        LOCK(::cs_main);
+        for (const CBlockIndex* block{pipeline.Back()}; pipeline.Size() < SYNC_WINDOW_SIZE;) {
+            block = m_chainstate->m_chain.Next(block);
+            if (!block) break;
+            pipeline.Push(block);
+        }
+    }
+
+    SyncPipeline::Slot slot{pipeline.Pop()};
+    if (!slot.error.empty()) {
+        FatalErrorf("%s", slot.error);
+        return false;
+    }
+    if (!CustomAppendComputed(pipeline.BlockInfo(slot), slot.result)) {
+        FatalErrorf("Failed to write block %s to index database",
+                    pindex->GetBlockHash().ToString());
+        return false;
+    }
+    return true;
+}
+
 void BaseIndex::Sync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
+        // Indexes that allow it read and compute blocks ahead on worker
+        // threads, which stop when the sync loop exits.
+        std::optional<SyncPipeline> pipeline;
+        if (AllowParallelSync()) pipeline.emplace(*this);
         auto last_log_time{NodeClock::now()};
         auto last_locator_write_time{last_log_time};
         while (true) {
@@ -226,8 +399,11 @@ void BaseIndex::Sync()
             }
             pindex = pindex_next;
 
-
-            if (!ProcessBlock(pindex)) return; // error logged internally
+            if (pipeline) {
+                if (!ProcessQueuedBlock(*pipeline, pindex)) return; // error logged internally
+            } else {
+                if (!ProcessBlock(pindex)) return; // error logged internally
+            }
 
             auto current_time{NodeClock::now()};
             if (current_time - last_log_time >= SYNC_LOG_INTERVAL) {
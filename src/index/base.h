@@ -12,7 +12,9 @@
 #include <util/threadinterrupt.h>
 #include <validationinterface.h>
 
+#include <any>
 #include <string>
+#include <vector>
 
 class CBlock;
 class CBlockIndex;
@@ -95,8 +97,20 @@ private:
 
     bool ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data = nullptr);
 
+    /// Worker threads that read and compute blocks ahead of the initial sync.
+    class SyncPipeline;
+
+    /// Append the next block of a parallel initial sync, after queueing the
+    /// blocks that follow it in the chain to be read and computed ahead.
+    bool ProcessQueuedBlock(SyncPipeline& pipeline, const CBlockIndex* pindex);
+
     virtual bool AllowPrune() const = 0;
 
+    /// Whether the index computes the data of a block in CustomComputeBlock()
+    /// independently of other blocks, so that the initial sync can read and
+    /// compute several blocks at once.
+    virtual bool AllowParallelSync() const { return false; }
+
     template <typename... Args>
     void FatalErrorf(util::ConstevalFormatString<sizeof...(Args)> fmt, const Args&... args);
 
@@ -116,7 +130,20 @@ protected:
     [[nodiscard]] virtual bool CustomInit(const std::optional<interfaces::BlockRef>& block) { return true; }
 
     /// Write update index entries for a newly connected block.
-    [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
+    [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block)
+    {
+        std::any result;
+        return CustomComputeBlock(block, result) && CustomAppendComputed(block, result);
+    }
+
+    /// Compute the entries of a block that do not depend on other blocks or on
+    /// the state of the index. During the initial sync of an index that allows
+    /// it, this is called on several threads at once, for blocks in any order.
+    [[nodiscard]] virtual bool CustomComputeBlock(const interfaces::BlockInfo& block, std::any& result) { return true; }
+
+    /// Write the entries of a block computed by CustomComputeBlock(). Called in
+    /// block order.
+    [[nodiscard]] virtual bool CustomAppendComputed(const interfaces::BlockInfo& block, std::any& result) { return true; }
 
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
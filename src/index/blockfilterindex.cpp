@@ -271,9 +271,16 @@ std::optional<uint256> BlockFilterIndex::ReadFilterHeader(int height, const uint
     return read_out.second.header;
 }
 
-bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+bool BlockFilterIndex::CustomComputeBlock(const interfaces::BlockInfo& block, std::any& result)
 {
-    BlockFilter filter(m_filter_type, *Assert(block.data), *Assert(block.undo_data));
+    result = BlockFilter(m_filter_type, *Assert(block.data), *Assert(block.undo_data));
+    return true;
+}
+
+bool BlockFilterIndex::CustomAppendComputed(const interfaces::BlockInfo& block, std::any& result)
+{
+    // The header commits to the previous one, so it is computed in block order.
+    const BlockFilter& filter{std::any_cast<const BlockFilter&>(result)};
     const uint256& header = filter.ComputeHeader(m_last_header);
     bool res = Write(filter, block.height, header);
     if (res) m_last_header = header; // update last header
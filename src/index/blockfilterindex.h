@@ -47,6 +47,8 @@ private:
 
     bool AllowPrune() const override { return true; }
 
+    bool AllowParallelSync() const override { return true; }
+
     bool Write(const BlockFilter& filter, uint32_t block_height, const uint256& filter_header);
 
     std::optional<uint256> ReadFilterHeader(int height, const uint256& expected_block_hash);
@@ -58,7 +60,9 @@ protected:
 
     bool CustomCommit(CDBBatch& batch) override;
 
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    bool CustomComputeBlock(const interfaces::BlockInfo& block, std::any& result) override;
+
+    bool CustomAppendComputed(const interfaces::BlockInfo& block, std::any& result) override;
 
     bool CustomRemove(const interfaces::BlockInfo& block) override;
 
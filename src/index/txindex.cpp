@@ -12,6 +12,10 @@
 #include <primitives/transaction_identifier.h>
 #include <validation.h>
 
+#include <any>
+#include <utility>
+#include <vector>
+
 constexpr uint8_t DB_TXINDEX{'t'};
 
 std::unique_ptr<TxIndex> g_txindex;
@@ -55,7 +59,7 @@ TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size,
 
 TxIndex::~TxIndex() = default;
 
-bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+bool TxIndex::CustomComputeBlock(const interfaces::BlockInfo& block, std::any& result)
 {
     // Exclude genesis block transaction because outputs are not spendable.
     if (block.height == 0) return true;
@@ -68,7 +72,14 @@ bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
         vPos.emplace_back(tx->GetHash(), pos);
         pos.nTxOffset += ::GetSerializeSize(TX_WITH_WITNESS(*tx));
     }
-    return m_db->WriteTxs(vPos);
+    result = std::move(vPos);
+    return true;
+}
+
+bool TxIndex::CustomAppendComputed(const interfaces::BlockInfo& block, std::any& result)
+{
+    if (!result.has_value()) return true;
+    return m_db->WriteTxs(std::any_cast<const std::vector<std::pair<Txid, CDiskTxPos>>&>(result));
 }
 
 BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
@@ -24,8 +24,12 @@ private:
 
     bool AllowPrune() const override { return false; }
 
+    bool AllowParallelSync() const override { return true; }
+
 protected:
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    bool CustomComputeBlock(const interfaces::BlockInfo& block, std::any& result) override;
+
+    bool CustomAppendComputed(const interfaces::BlockInfo& block, std::any& result) override;
 
     BaseIndex::DB& GetDB() const override;
 
@@ -72,6 +72,16 @@ public:
      * the tip is more than 20 minutes old.
      */
     virtual std::unique_ptr<BlockTemplate> waitNext(const node::BlockWaitOptions options = {}) = 0;
+
+    /**
+     * Changes relative to the template waitNext() was called on to produce
+     * this one. For a template returned by createNewBlock() the delta is
+     * relative to an empty template, i.e. every transaction is added.
+     *
+     * Lets clients which keep a copy of the previous template follow
+     * template updates without refetching the whole block.
+     */
+    virtual node::BlockTemplateDelta getDelta() = 0;
 };
 
 //! Interface giving clients (RPC, Stratum v2 Template Provider in the future)
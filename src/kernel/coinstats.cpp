@@ -20,15 +20,23 @@
 #include <uint256.h>
 #include <util/check.h>
 #include <util/overflow.h>
+#include <util/threadnames.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <iosfwd>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace kernel {
 
@@ -55,7 +63,94 @@ static void TxOutSer(T& ss, const COutPoint& outpoint, const Coin& coin)
     ss << coin.out;
 }
 
-static void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin)
+namespace {
+/**
+ * Hashes like a HashWriter, but serializes into buffers that a separate thread
+ * hashes, so that reading and serializing the coins overlaps with SHA256.
+ */
+class PipelinedHashWriter
+{
+    //! Buffer size at which it is handed to the hashing thread
+    static constexpr size_t BUFFER_SIZE{1 << 20};
+    //! Maximum number of buffers waiting to be hashed
+    static constexpr size_t MAX_QUEUED{4};
+
+    HashWriter m_hasher;
+    DataStream m_buffer;
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<DataStream> m_queue GUARDED_BY(m_mutex);
+    bool m_done GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+
+    void ThreadHash() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        util::ThreadRename("coinstats.hash");
+        while (true) {
+            DataStream buffer;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_done || !m_queue.empty(); });
+                if (m_queue.empty()) return;
+                buffer = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            m_cv.notify_all();
+            m_hasher.write(buffer);
+        }
+    }
+
+    void Push() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        if (m_buffer.empty()) return;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queue.size() < MAX_QUEUED; });
+            m_queue.push_back(std::move(m_buffer));
+        }
+        m_cv.notify_all();
+        m_buffer = DataStream{};
+        m_buffer.reserve(BUFFER_SIZE);
+    }
+
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_done = true);
+        m_cv.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+public:
+    PipelinedHashWriter()
+    {
+        m_buffer.reserve(BUFFER_SIZE);
+        m_thread = std::thread{&PipelinedHashWriter::ThreadHash, this};
+    }
+    ~PipelinedHashWriter() { Stop(); }
+
+    template <typename T>
+    PipelinedHashWriter& operator<<(const T& obj)
+    {
+        m_buffer << obj;
+        if (m_buffer.size() >= BUFFER_SIZE) Push();
+        return *this;
+    }
+
+    uint256 GetHash() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        Push();
+        Stop();
+        return m_hasher.GetHash();
+    }
+};
+} // namespace
+
+static void ApplyCoinHash(PipelinedHashWriter& ss, const COutPoint& outpoint, const Coin& coin)
+{
+    TxOutSer(ss, outpoint, coin);
+}
+
+void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin)
 {
     TxOutSer(ss, outpoint, coin);
 }
@@ -76,6 +171,9 @@ void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& c
 
 static void ApplyCoinHash(std::nullptr_t, const COutPoint& outpoint, const Coin& coin) {}
 
+static void CombineHash(MuHash3072& muhash, const MuHash3072& range) { muhash *= range; }
+static void CombineHash(std::nullptr_t, std::nullptr_t) {}
+
 //! Warning: be very careful when changing this! assumeutxo and UTXO snapshot
 //! validation commitments are reliant on the hash constructed by this
 //! function.
@@ -111,20 +209,17 @@ static void ApplyStats(CCoinsStats& stats, const std::map<uint32_t, Coin>& outpu
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
+//! Calculate statistics about the coins of a cursor
 template <typename T>
-static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+static bool ComputeUTXOStats(CCoinsViewCursor& cursor, CCoinsStats& stats, T& hash_obj, const std::function<void()>& interruption_point)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
-
     Txid prevkey;
     std::map<uint32_t, Coin> outputs;
-    while (pcursor->Valid()) {
+    while (cursor.Valid()) {
         if (interruption_point) interruption_point();
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+        if (cursor.GetKey(key) && cursor.GetValue(coin)) {
             if (!outputs.empty() && key.hash != prevkey) {
                 ApplyStats(stats, outputs);
                 ApplyHash(hash_obj, prevkey, outputs);
@@ -137,12 +232,110 @@ static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, c
             LogError("%s: unable to read value\n", __func__);
             return false;
         }
-        pcursor->Next();
+        cursor.Next();
     }
     if (!outputs.empty()) {
         ApplyStats(stats, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool ComputeUTXOStats(CCoinsView* view, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point)
+{
+    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
+    assert(pcursor);
+
+    if (!ComputeUTXOStats(*pcursor, stats, hash_obj, interruption_point)) return false;
+
+    FinalizeHash(hash_obj, stats);
+
+    stats.nDiskSize = view->EstimateSize();
+
+    return true;
+}
+
+//! Maximum number of threads that read the UTXO set for order-independent statistics
+static constexpr size_t MAX_STATS_THREADS{16};
+
+//! Calculate statistics about the unspent transaction output set, reading
+//! its ranges in parallel. Only for hashes of the set that do not depend on
+//! the order of the coins.
+template <typename T>
+static bool ComputeUTXOStatsParallel(CCoinsView* view, CCoinsStats& stats, const std::function<void()>& interruption_point)
+{
+    const size_t threads{std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_STATS_THREADS)};
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors{view->Cursors(threads)};
+    assert(!cursors.empty());
+
+    struct Range {
+        CCoinsStats stats;
+        T hash_obj{};
+        bool complete{false};
+    };
+    std::vector<Range> ranges(cursors.size());
+    // Set when any range stops early, so that the others stop too.
+    std::atomic<bool> stop{false};
+    struct RangeStopped {};
+    const auto compute{[&](size_t i, const std::function<void()>& interrupt) {
+        Range& range{ranges[i]};
+        range.complete = ComputeUTXOStats(*cursors[i], range.stats, range.hash_obj, interrupt);
+        if (!range.complete) stop = true;
+    }};
+    const auto check_stop{[&] {
+        if (stop) throw RangeStopped{};
+    }};
+
+    // The first range is read on this thread, which also handles interruption,
+    // until all ranges are done.
+    std::vector<std::thread> workers;
+    std::atomic<size_t> running{cursors.size() - 1};
+    for (size_t i{1}; i < cursors.size(); ++i) {
+        workers.emplace_back([&, i] {
+            util::ThreadRename(strprintf("coinstats.%d", i));
+            try {
+                compute(i, check_stop);
+            } catch (const RangeStopped&) {
+            } catch (const std::exception& e) {
+                LogError("%s: %s\n", __func__, e.what());
+                stop = true;
+            }
+            --running;
+        });
+    }
+    try {
+        compute(0, [&] {
+            if (interruption_point) interruption_point();
+            check_stop();
+        });
+        while (running > 0) {
+            if (interruption_point) interruption_point();
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+    } catch (const RangeStopped&) {
+    } catch (...) {
+        stop = true;
+        for (std::thread& worker : workers) worker.join();
+        throw;
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    T hash_obj{};
+    for (Range& range : ranges) {
+        if (!range.complete) return false;
+        stats.nTransactions += range.stats.nTransactions;
+        stats.nTransactionOutputs += range.stats.nTransactionOutputs;
+        stats.nBogoSize += range.stats.nBogoSize;
+        stats.coins_count += range.stats.coins_count;
+        if (stats.total_amount.has_value() && range.stats.total_amount.has_value()) {
+            stats.total_amount = CheckedAdd(*stats.total_amount, *range.stats.total_amount);
+        } else {
+            stats.total_amount.reset();
+        }
+        CombineHash(hash_obj, range.hash_obj);
+    }
 
     FinalizeHash(hash_obj, stats);
 
@@ -159,15 +352,16 @@ std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsV
     bool success = [&]() -> bool {
         switch (hash_type) {
         case(CoinStatsHashType::HASH_SERIALIZED): {
-            HashWriter ss{};
-            return ComputeUTXOStats(view, stats, ss, interruption_point);
+            // The hash depends on the order of the coins, so they are read in
+            // order, with hashing on a separate thread.
+            PipelinedHashWriter ss{};
+            return ComputeUTXOStats<PipelinedHashWriter&>(view, stats, ss, interruption_point);
         }
         case(CoinStatsHashType::MUHASH): {
-            MuHash3072 muhash;
-            return ComputeUTXOStats(view, stats, muhash, interruption_point);
+            return ComputeUTXOStatsParallel<MuHash3072>(view, stats, interruption_point);
         }
         case(CoinStatsHashType::NONE): {
-            return ComputeUTXOStats(view, stats, nullptr, interruption_point);
+            return ComputeUTXOStatsParallel<std::nullptr_t>(view, stats, interruption_point);
         }
         } // no default case, so the compiler can warn about missing cases
         assert(false);
@@ -179,7 +373,7 @@ std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsV
     return stats;
 }
 
-static void FinalizeHash(HashWriter& ss, CCoinsStats& stats)
+static void FinalizeHash(PipelinedHashWriter& ss, CCoinsStats& stats)
 {
     stats.hashSerialized = ss.GetHash();
 }
@@ -18,6 +18,7 @@
 class CCoinsView;
 class Coin;
 class COutPoint;
+class HashWriter;
 class CScript;
 namespace node {
 class BlockManager;
@@ -76,6 +77,8 @@ struct CCoinsStats {
 uint64_t GetBogoSize(const CScript& script_pub_key);
 
 void ApplyCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
+//! Add a coin to a HASH_SERIALIZED hash, which takes coins in outpoint order.
+void ApplyCoinHash(HashWriter& ss, const COutPoint& outpoint, const Coin& coin);
 void RemoveCoinHash(MuHash3072& muhash, const COutPoint& outpoint, const Coin& coin);
 
 std::optional<CCoinsStats> ComputeUTXOStats(CoinStatsHashType hash_type, CCoinsView* view, node::BlockManager& blockman, const std::function<void()>& interruption_point = {});
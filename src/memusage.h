@@ -9,6 +9,7 @@
 #include <prevector.h>
 #include <support/allocators/pool.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <list>
@@ -147,6 +148,25 @@ static inline size_t IncrementalDynamicUsage(const indirectmap<X, Y>& m)
     return MallocUsage(sizeof(stl_tree_node<std::pair<const X*, Y> >));
 }
 
+template <typename X, typename Y, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+static inline size_t DynamicUsage(const indirectmap<X,
+                                                   Y,
+                                                   PoolAllocator<std::pair<const X* const, Y>,
+                                                                 MAX_BLOCK_SIZE_BYTES,
+                                                                 ALIGN_BYTES>>& m)
+{
+    auto* pool_resource = m.get_allocator().resource();
+
+    // Count the nodes at their size in the pool, without a malloc overhead each,
+    // but no less than the chunks the pool keeps after the map shrinks. The
+    // first chunk is allocated ahead of use and not counted, so that an empty
+    // map does not count towards -maxmempool.
+    constexpr size_t node_size{(MAX_BLOCK_SIZE_BYTES + ALIGN_BYTES - 1) / ALIGN_BYTES * ALIGN_BYTES};
+    size_t estimated_list_node_size = MallocUsage(sizeof(void*) * 3);
+    size_t usage_chunks = (estimated_list_node_size + MallocUsage(pool_resource->ChunkSizeBytes())) * (pool_resource->NumAllocatedChunks() - 1);
+    return std::max(node_size * m.size(), usage_chunks);
+}
+
 template<typename X>
 static inline size_t DynamicUsage(const std::unique_ptr<X>& p)
 {
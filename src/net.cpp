@@ -39,6 +39,7 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstring>
 #include <cmath>
 #include <cstdint>
@@ -89,6 +90,9 @@ static constexpr auto FEELER_SLEEP_WINDOW{1s};
 /** Frequency to attempt extra connections to reachable networks we're not connected to yet **/
 static constexpr auto EXTRA_NETWORK_PEER_INTERVAL{5min};
 
+/** How far ahead of the received bytes a V1 message receive buffer is allocated. */
+static constexpr uint32_t V1_RECV_ALLOC_AHEAD{256 * 1024};
+
 /** Used to pass flags to the Bind() function */
 enum BindFlags {
     BF_NONE         = 0,
@@ -118,9 +122,18 @@ GlobalMutex g_maplocalhost_mutex;
 std::map<CNetAddr, LocalServiceInfo> mapLocalHost GUARDED_BY(g_maplocalhost_mutex);
 std::string strSubVersion;
 
+void CSerializedNetMsg::ClearPayload() noexcept
+{
+    ClearShrink(data);
+    m_shared_payload.reset();
+}
+
 size_t CSerializedNetMsg::GetMemoryUsage() const noexcept
 {
-    return sizeof(*this) + memusage::DynamicUsage(m_type) + memusage::DynamicUsage(data);
+    // A shared payload is accounted in full to every message referring to it,
+    // so that send buffer limits do not depend on how a message was built.
+    return sizeof(*this) + memusage::DynamicUsage(m_type) + memusage::DynamicUsage(data) +
+           (m_shared_payload ? memusage::DynamicUsage(m_shared_payload->data) : 0);
 }
 
 size_t CNetMessage::GetMemoryUsage() const noexcept
@@ -128,6 +141,53 @@ size_t CNetMessage::GetMemoryUsage() const noexcept
     return sizeof(*this) + memusage::DynamicUsage(m_type) + m_recv.GetMemoryUsage();
 }
 
+CNetMessage::~CNetMessage()
+{
+    if (m_buffer_pool) m_buffer_pool->Put(std::move(m_recv));
+}
+
+DataStream RecvBufferPool::Get(size_t size)
+{
+    DataStream buffer;
+    if (size == 0) return buffer;
+    // The smallest size class whose buffers all fit size.
+    const int bits{std::max<int>(MIN_CLASS_BITS, std::bit_width(size - 1))};
+    if (bits <= MAX_CLASS_BITS) {
+        LOCK(m_mutex);
+        // Also take buffers of the next class, at most four times as large as needed.
+        for (int c{bits}; c <= std::min(bits + 1, MAX_CLASS_BITS); ++c) {
+            auto& free{m_free[c - MIN_CLASS_BITS]};
+            if (free.empty()) continue;
+            buffer = std::move(free.back());
+            free.pop_back();
+            m_pooled_bytes -= buffer.capacity();
+            return buffer;
+        }
+    }
+    // Round small buffers up to their size class, so that they serve any
+    // message of the class once returned.
+    buffer.reserve(bits <= MAX_ROUNDED_BITS ? size_t{1} << bits : size);
+    return buffer;
+}
+
+void RecvBufferPool::Put(DataStream&& buffer)
+{
+    buffer.clear();
+    const size_t capacity{buffer.capacity()};
+    if (capacity < size_t{1} << MIN_CLASS_BITS) return;
+    const int bits{std::min<int>(std::bit_width(capacity) - 1, MAX_CLASS_BITS)};
+    LOCK(m_mutex);
+    auto& free{m_free[bits - MIN_CLASS_BITS]};
+    if (free.size() >= MAX_BUFFERS_PER_CLASS || m_pooled_bytes + capacity > m_max_bytes) return;
+    m_pooled_bytes += capacity;
+    free.push_back(std::move(buffer));
+}
+
+size_t RecvBufferPool::GetPooledBytes() const
+{
+    return WITH_LOCK(m_mutex, return m_pooled_bytes);
+}
+
 void CConnman::AddAddrFetch(const std::string& strDest)
 {
     LOCK(m_addr_fetches_mutex);
@@ -539,6 +599,7 @@ CNode* CConnman::ConnectNode(CAddress addrConnect,
                                     .i2p_sam_session = std::move(i2p_transient_session),
                                     .recv_flood_size = nReceiveFloodSize,
                                     .use_v2transport = use_v2transport,
+                                    .recv_buffer_pool = m_recv_buffer_pool,
                                 });
         pnode->AddRef();
 
@@ -713,8 +774,8 @@ std::string CNode::DisconnectMsg(bool log_ip) const
                      LogIP(log_ip));
 }
 
-V1Transport::V1Transport(const NodeId node_id) noexcept
-    : m_magic_bytes{Params().MessageStart()}, m_node_id{node_id}
+V1Transport::V1Transport(const NodeId node_id, std::shared_ptr<RecvBufferPool> buffer_pool) noexcept
+    : m_magic_bytes{Params().MessageStart()}, m_node_id{node_id}, m_buffer_pool{std::move(buffer_pool)}
 {
     LOCK(m_recv_mutex);
     Reset();
@@ -764,6 +825,8 @@ int V1Transport::readHeader(std::span<const uint8_t> msg_bytes)
 
     // switch state to reading message data
     in_data = true;
+    // Start from a recycled buffer, allocating no further ahead than readData() would.
+    if (m_buffer_pool) vRecv = m_buffer_pool->Get(std::min<uint32_t>(hdr.nMessageSize, V1_RECV_ALLOC_AHEAD));
 
     return nCopy;
 }
@@ -776,7 +839,7 @@ int V1Transport::readData(std::span<const uint8_t> msg_bytes)
 
     if (vRecv.size() < nDataPos + nCopy) {
         // Allocate up to 256 KiB ahead, but never more than the total message size.
-        vRecv.resize(std::min(hdr.nMessageSize, nDataPos + nCopy + 256 * 1024));
+        vRecv.resize(std::min(hdr.nMessageSize, nDataPos + nCopy + V1_RECV_ALLOC_AHEAD));
     }
 
     hasher.Write(msg_bytes.first(nCopy));
@@ -803,6 +866,7 @@ CNetMessage V1Transport::GetReceivedMessage(const std::chrono::microseconds time
     // decompose a single CNetMessage from the TransportDeserializer
     LOCK(m_recv_mutex);
     CNetMessage msg(std::move(vRecv));
+    msg.m_buffer_pool = m_buffer_pool;
 
     // store message type string, time, and sizes
     msg.m_type = hdr.GetMessageType();
@@ -839,13 +903,13 @@ bool V1Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
     AssertLockNotHeld(m_send_mutex);
     // Determine whether a new message can be set.
     LOCK(m_send_mutex);
-    if (m_sending_header || m_bytes_sent < m_message_to_send.data.size()) return false;
+    if (m_sending_header || m_bytes_sent < m_message_to_send.Payload().size()) return false;
 
-    // create dbl-sha256 checksum
-    uint256 hash = Hash(msg.data);
+    // create dbl-sha256 checksum, unless already computed for a shared payload
+    const uint256 hash = msg.m_shared_payload ? msg.m_shared_payload->hash : Hash(msg.data);
 
     // create header
-    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), msg.data.size());
+    CMessageHeader hdr(m_magic_bytes, msg.m_type.c_str(), msg.Payload().size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     // serialize header
@@ -867,11 +931,11 @@ Transport::BytesToSend V1Transport::GetBytesToSend(bool have_next_message) const
         return {std::span{m_header_to_send}.subspan(m_bytes_sent),
                 // We have more to send after the header if the message has payload, or if there
                 // is a next message after that.
-                have_next_message || !m_message_to_send.data.empty(),
+                have_next_message || !m_message_to_send.Payload().empty(),
                 m_message_to_send.m_type
                };
     } else {
-        return {std::span{m_message_to_send.data}.subspan(m_bytes_sent),
+        return {m_message_to_send.Payload().subspan(m_bytes_sent),
                 // We only have more to send after this message's payload if there is another
                 // message.
                 have_next_message,
@@ -889,9 +953,9 @@ void V1Transport::MarkBytesSent(size_t bytes_sent) noexcept
         // We're done sending a message's header. Switch to sending its data bytes.
         m_sending_header = false;
         m_bytes_sent = 0;
-    } else if (!m_sending_header && m_bytes_sent == m_message_to_send.data.size()) {
+    } else if (!m_sending_header && m_bytes_sent == m_message_to_send.Payload().size()) {
         // We're done sending a message's data. Wipe the data vector to reduce memory consumption.
-        ClearShrink(m_message_to_send.data);
+        m_message_to_send.ClearPayload();
         m_bytes_sent = 0;
     }
 }
@@ -993,9 +1057,11 @@ void V2Transport::StartSendingHandshake() noexcept
     // We cannot wipe m_send_garbage as it will still be used as AAD later in the handshake.
 }
 
-V2Transport::V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage) noexcept
+V2Transport::V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage,
+                         std::shared_ptr<RecvBufferPool> buffer_pool) noexcept
     : m_cipher{key, ent32}, m_initiating{initiating}, m_nodeid{nodeid},
-      m_v1_fallback{nodeid},
+      m_buffer_pool{std::move(buffer_pool)},
+      m_v1_fallback{nodeid, m_buffer_pool},
       m_recv_state{initiating ? RecvState::KEY : RecvState::KEY_MAYBE_V1},
       m_send_garbage{std::move(garbage)},
       m_send_state{initiating ? SendState::AWAITING_KEY : SendState::MAYBE_V1}
@@ -1008,9 +1074,9 @@ V2Transport::V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::s
     }
 }
 
-V2Transport::V2Transport(NodeId nodeid, bool initiating) noexcept
+V2Transport::V2Transport(NodeId nodeid, bool initiating, std::shared_ptr<RecvBufferPool> buffer_pool) noexcept
     : V2Transport{nodeid, initiating, GenerateRandomKey(),
-                  MakeByteSpan(GetRandHash()), GenerateRandomGarbage()} {}
+                  MakeByteSpan(GetRandHash()), GenerateRandomGarbage(), std::move(buffer_pool)} {}
 
 void V2Transport::SetReceiveState(RecvState recv_state) noexcept
 {
@@ -1221,6 +1287,7 @@ bool V2Transport::ProcessReceivedPacketBytes() noexcept
         // Ciphertext received, decrypt it into m_recv_decode_buffer.
         // Note that it is impossible to reach this branch without hitting the branch above first,
         // as GetMaxBytesToProcess only allows up to LENGTH_LEN into the buffer before that point.
+        if (m_buffer_pool) m_recv_decode_buffer = m_buffer_pool->Get(m_recv_len);
         m_recv_decode_buffer.resize(m_recv_len);
         bool ignore{false};
         bool ret = m_cipher.Decrypt(
@@ -1258,7 +1325,7 @@ bool V2Transport::ProcessReceivedPacketBytes() noexcept
         // Wipe the receive buffer where the next packet will be received into.
         ClearShrink(m_recv_buffer);
         // In all but APP_READY state, we can wipe the decoded contents.
-        if (m_recv_state != RecvState::APP_READY) ClearShrink(m_recv_decode_buffer);
+        if (m_recv_state != RecvState::APP_READY) m_recv_decode_buffer = DataStream{};
     } else {
         // We either have less than 3 bytes, so we don't know the packet's length yet, or more
         // than 3 bytes but less than the packet's full ciphertext. Wait until those arrive.
@@ -1452,23 +1519,27 @@ CNetMessage V2Transport::GetReceivedMessage(std::chrono::microseconds time, bool
     if (m_recv_state == RecvState::V1) return m_v1_fallback.GetReceivedMessage(time, reject_message);
 
     Assume(m_recv_state == RecvState::APP_READY);
-    std::span<const uint8_t> contents{m_recv_decode_buffer};
+    std::span<const uint8_t> contents{UCharCast(m_recv_decode_buffer.data()), m_recv_decode_buffer.size()};
     auto msg_type = GetMessageType(contents);
-    CNetMessage msg{DataStream{}};
     // Note that BIP324Cipher::EXPANSION also includes the length descriptor size.
-    msg.m_raw_message_size = m_recv_decode_buffer.size() + BIP324Cipher::EXPANSION;
+    const size_t decoded_size{m_recv_decode_buffer.size()};
+    // Hand the decoded buffer to the message, skipping the message type,
+    // rather than copying the payload out of it.
+    CNetMessage msg{std::move(m_recv_decode_buffer)};
+    m_recv_decode_buffer = DataStream{};
+    msg.m_buffer_pool = m_buffer_pool;
+    msg.m_raw_message_size = decoded_size + BIP324Cipher::EXPANSION;
     if (msg_type) {
         reject_message = false;
         msg.m_type = std::move(*msg_type);
         msg.m_time = time;
         msg.m_message_size = contents.size();
-        msg.m_recv.resize(contents.size());
-        std::copy(contents.begin(), contents.end(), UCharCast(msg.m_recv.data()));
+        msg.m_recv.ignore(decoded_size - contents.size());
     } else {
-        LogDebug(BCLog::NET, "V2 transport error: invalid message type (%u bytes contents), peer=%d\n", m_recv_decode_buffer.size(), m_nodeid);
+        LogDebug(BCLog::NET, "V2 transport error: invalid message type (%u bytes contents), peer=%d\n", decoded_size, m_nodeid);
         reject_message = true;
+        msg.m_recv.clear();
     }
-    ClearShrink(m_recv_decode_buffer);
     SetReceiveState(RecvState::APP);
 
     return msg;
@@ -1485,24 +1556,25 @@ bool V2Transport::SetMessageToSend(CSerializedNetMsg& msg) noexcept
     if (!(m_send_state == SendState::READY && m_send_buffer.empty())) return false;
     // Construct contents (encoding message type + payload).
     std::vector<uint8_t> contents;
+    const auto payload{msg.Payload()};
     auto short_message_id = V2_MESSAGE_MAP(msg.m_type);
     if (short_message_id) {
-        contents.resize(1 + msg.data.size());
+        contents.resize(1 + payload.size());
         contents[0] = *short_message_id;
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1);
+        std::copy(payload.begin(), payload.end(), contents.begin() + 1);
     } else {
         // Initialize with zeroes, and then write the message type string starting at offset 1.
         // This means contents[0] and the unused positions in contents[1..13] remain 0x00.
-        contents.resize(1 + CMessageHeader::MESSAGE_TYPE_SIZE + msg.data.size(), 0);
+        contents.resize(1 + CMessageHeader::MESSAGE_TYPE_SIZE + payload.size(), 0);
         std::copy(msg.m_type.begin(), msg.m_type.end(), contents.data() + 1);
-        std::copy(msg.data.begin(), msg.data.end(), contents.begin() + 1 + CMessageHeader::MESSAGE_TYPE_SIZE);
+        std::copy(payload.begin(), payload.end(), contents.begin() + 1 + CMessageHeader::MESSAGE_TYPE_SIZE);
     }
     // Construct ciphertext in send buffer.
     m_send_buffer.resize(contents.size() + BIP324Cipher::EXPANSION);
     m_cipher.Encrypt(MakeByteSpan(contents), {}, false, MakeWritableByteSpan(m_send_buffer));
     m_send_type = msg.m_type;
     // Release memory
-    ClearShrink(msg.data);
+    msg.ClearPayload();
     return true;
 }
 
@@ -1847,6 +1919,7 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock>&& sock,
                                  .prefer_evict = discouraged,
                                  .recv_flood_size = nReceiveFloodSize,
                                  .use_v2transport = use_v2transport,
+                                 .recv_buffer_pool = m_recv_buffer_pool,
                              });
     pnode->AddRef();
     m_msgproc->InitializeNode(*pnode, local_services);
@@ -2056,12 +2129,13 @@ bool CConnman::InactivityCheck(const CNode& node) const
     return false;
 }
 
-Sock::EventsPerSock CConnman::GenerateWaitSockets(std::span<CNode* const> nodes)
+void CConnman::GenerateWaitSockets(std::span<CNode* const> nodes, bool listening, SockPoller& poller)
 {
-    Sock::EventsPerSock events_per_sock;
-
-    for (const ListenSocket& hListenSocket : vhListenSocket) {
-        events_per_sock.emplace(hListenSocket.sock, Sock::Events{Sock::RECV});
+    if (listening) {
+        for (const ListenSocket& hListenSocket : vhListenSocket) {
+            // Level-triggered, as accepting a connection doesn't tell whether more are pending.
+            poller.Watch(hListenSocket.sock, Sock::RECV, /*edge_triggered=*/false);
+        }
     }
 
     for (CNode* pnode : nodes) {
@@ -2075,26 +2149,26 @@ Sock::EventsPerSock CConnman::GenerateWaitSockets(std::span<CNode* const> nodes)
             const auto& [to_send, more, _msg_type] = pnode->m_transport->GetBytesToSend(!pnode->vSendMsg.empty());
             select_send = !to_send.empty() || more;
         }
-        if (!select_recv && !select_send) continue;
 
+        // Keep watching sockets that we don't currently want to wait on, so that a
+        // persistent registration (see SockPoller) survives a pause.
         LOCK(pnode->m_sock_mutex);
         if (pnode->m_sock) {
             Sock::Event event = (select_send ? Sock::SEND : 0) | (select_recv ? Sock::RECV : 0);
-            events_per_sock.emplace(pnode->m_sock, Sock::Events{event});
+            poller.Watch(pnode->m_sock, event);
         }
     }
-
-    return events_per_sock;
 }
 
-void CConnman::SocketHandler()
+void CConnman::SocketHandler(int shard, SockPoller& poller)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
     Sock::EventsPerSock events_per_sock;
+    const bool listening{shard == 0};
 
     {
-        const NodesSnapshot snap{*this, /*shuffle=*/false};
+        const NodesSnapshot snap{*this, /*shuffle=*/false, NodesSnapshot::Shard{shard, m_socket_threads}};
 
         const auto timeout = std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS);
 
@@ -2102,21 +2176,22 @@ void CConnman::SocketHandler()
         // listening sockets in one call ("readiness" as in poll(2) or
         // select(2)). If none are ready, wait for a short while and return
         // empty sets.
-        events_per_sock = GenerateWaitSockets(snap.Nodes());
-        if (events_per_sock.empty() || !events_per_sock.begin()->first->WaitMany(timeout, events_per_sock)) {
+        GenerateWaitSockets(snap.Nodes(), listening, poller);
+        if (!poller.Wait(timeout, events_per_sock)) {
             m_interrupt_net->sleep_for(timeout);
         }
 
         // Service (send/receive) each of the already connected nodes.
-        SocketHandlerConnected(snap.Nodes(), events_per_sock);
+        SocketHandlerConnected(snap.Nodes(), events_per_sock, poller);
     }
 
     // Accept new connections from listening sockets.
-    SocketHandlerListening(events_per_sock);
+    if (listening) SocketHandlerListening(events_per_sock);
 }
 
 void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
-                                      const Sock::EventsPerSock& events_per_sock)
+                                      const Sock::EventsPerSock& events_per_sock,
+                                      SockPoller& poller)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
@@ -2131,11 +2206,13 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
         bool recvSet = false;
         bool sendSet = false;
         bool errorSet = false;
+        std::shared_ptr<Sock> sock;
         {
             LOCK(pnode->m_sock_mutex);
             if (!pnode->m_sock) {
                 continue;
             }
+            sock = pnode->m_sock;
             const auto it = events_per_sock.find(pnode->m_sock);
             if (it != events_per_sock.end()) {
                 recvSet = it->second.occurred & Sock::RECV;
@@ -2147,6 +2224,8 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
         if (sendSet) {
             // Send data
             auto [bytes_sent, data_left] = WITH_LOCK(pnode->cs_vSend, return SocketSendData(*pnode));
+            // The send buffer is full (or sending failed), wait until it has room again.
+            if (data_left) poller.Consumed(sock, Sock::SEND);
             if (bytes_sent) {
                 RecordBytesSent(bytes_sent);
 
@@ -2173,6 +2252,9 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
                 }
                 nBytes = pnode->m_sock->Recv(pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
             }
+            // Unless the buffer was filled, the receive queue has been drained (or the
+            // connection is gone), so wait until more data arrives.
+            if (nBytes < (int)sizeof(pchBuf)) poller.Consumed(sock, Sock::RECV);
             if (nBytes > 0)
             {
                 bool notify = false;
@@ -2228,14 +2310,21 @@ void CConnman::SocketHandlerListening(const Sock::EventsPerSock& events_per_sock
     }
 }
 
-void CConnman::ThreadSocketHandler()
+void CConnman::ThreadSocketHandler(int shard)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
 
+    SockPoller poller{m_use_epoll};
+    if (shard == 0) {
+        LogInfo("Using %d socket handler thread(s) with %s", m_socket_threads, poller.UsesEpoll() ? "epoll" : "poll/select");
+    }
+
     while (!m_interrupt_net->interrupted()) {
-        DisconnectNodes();
-        NotifyNumConnectionsChanged();
-        SocketHandler();
+        if (shard == 0) {
+            DisconnectNodes();
+            NotifyNumConnectionsChanged();
+        }
+        SocketHandler(shard, poller);
     }
 }
 
@@ -2244,8 +2333,9 @@ void CConnman::WakeMessageHandler()
     {
         LOCK(mutexMsgProc);
         fMsgProcWake = true;
+        ++m_msgproc_wake_seq;
     }
-    condMsgProc.notify_one();
+    condMsgProc.notify_all();
 }
 
 void CConnman::ThreadDNSAddressSeed()
@@ -3067,7 +3157,7 @@ void CConnman::ThreadMessageHandler()
                     continue;
 
                 // Receive messages
-                bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
+                bool fMoreNodeWork = WITH_LOCK(pnode->m_msg_process_order_mutex, return m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc));
                 fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
                 if (flagInterruptMsgProc)
                     return;
@@ -3087,6 +3177,39 @@ void CConnman::ThreadMessageHandler()
     }
 }
 
+void CConnman::ThreadLightMessageHandler(int worker)
+{
+    const int num_workers{m_msgproc_threads - 1};
+    uint64_t wake_seq{WITH_LOCK(mutexMsgProc, return m_msgproc_wake_seq)};
+
+    while (!flagInterruptMsgProc) {
+        bool more_work{false};
+
+        {
+            const NodesSnapshot snap{*this, /*shuffle=*/true, NodesSnapshot::Shard{worker, num_workers}};
+
+            for (CNode* pnode : snap.Nodes()) {
+                if (pnode->fDisconnect) continue;
+
+                // A node busy in another message handler thread has its next
+                // messages waiting behind the one being processed.
+                TRY_LOCK(pnode->m_msg_process_order_mutex, order_lock);
+                if (!order_lock) continue;
+
+                const bool more_node_work{m_msgproc->ProcessLightMessages(pnode, flagInterruptMsgProc)};
+                more_work |= (more_node_work && !pnode->fPauseSend);
+                if (flagInterruptMsgProc) return;
+            }
+        }
+
+        WAIT_LOCK(mutexMsgProc, lock);
+        if (!more_work) {
+            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [&]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) { return m_msgproc_wake_seq != wake_seq || flagInterruptMsgProc; });
+        }
+        wake_seq = m_msgproc_wake_seq;
+    }
+}
+
 void CConnman::ThreadI2PAcceptIncoming()
 {
     static constexpr auto err_wait_begin = 1s;
@@ -3378,7 +3501,10 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     }
 
     // Send and receive from sockets, accept connections
-    threadSocketHandler = std::thread(&util::TraceThread, "net", [this] { ThreadSocketHandler(); });
+    for (int shard = 0; shard < m_socket_threads; ++shard) {
+        const std::string thread_name{shard == 0 ? "net" : strprintf("net.%d", shard)};
+        m_thread_socket_handlers.emplace_back(&util::TraceThread, thread_name, [this, shard] { ThreadSocketHandler(shard); });
+    }
 
     if (!gArgs.GetBoolArg("-dnsseed", DEFAULT_DNSSEED))
         LogPrintf("DNS seeding disabled\n");
@@ -3404,6 +3530,9 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
 
     // Process messages
     threadMessageHandler = std::thread(&util::TraceThread, "msghand", [this] { ThreadMessageHandler(); });
+    for (int worker = 0; worker < m_msgproc_threads - 1; ++worker) {
+        m_thread_light_message_handlers.emplace_back(&util::TraceThread, strprintf("msghand.%d", worker + 1), [this, worker] { ThreadLightMessageHandler(worker); });
+    }
 
     if (m_i2p_sam_session) {
         threadI2PAcceptIncoming =
@@ -3468,14 +3597,20 @@ void CConnman::StopThreads()
     }
     if (threadMessageHandler.joinable())
         threadMessageHandler.join();
+    for (auto& thread : m_thread_light_message_handlers) {
+        if (thread.joinable()) thread.join();
+    }
+    m_thread_light_message_handlers.clear();
     if (threadOpenConnections.joinable())
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
         threadOpenAddedConnections.join();
     if (threadDNSAddressSeed.joinable())
         threadDNSAddressSeed.join();
-    if (threadSocketHandler.joinable())
-        threadSocketHandler.join();
+    for (auto& thread : m_thread_socket_handlers) {
+        if (thread.joinable()) thread.join();
+    }
+    m_thread_socket_handlers.clear();
 }
 
 void CConnman::StopNodes()
@@ -3802,12 +3937,12 @@ ServiceFlags CConnman::GetLocalServices() const
     return m_local_services;
 }
 
-static std::unique_ptr<Transport> MakeTransport(NodeId id, bool use_v2transport, bool inbound) noexcept
+static std::unique_ptr<Transport> MakeTransport(NodeId id, bool use_v2transport, bool inbound, std::shared_ptr<RecvBufferPool> buffer_pool) noexcept
 {
     if (use_v2transport) {
-        return std::make_unique<V2Transport>(id, /*initiating=*/!inbound);
+        return std::make_unique<V2Transport>(id, /*initiating=*/!inbound, std::move(buffer_pool));
     } else {
-        return std::make_unique<V1Transport>(id);
+        return std::make_unique<V1Transport>(id, std::move(buffer_pool));
     }
 }
 
@@ -3822,7 +3957,7 @@ CNode::CNode(NodeId idIn,
              bool inbound_onion,
              uint64_t network_key,
              CNodeOptions&& node_opts)
-    : m_transport{MakeTransport(idIn, node_opts.use_v2transport, conn_type_in == ConnectionType::INBOUND)},
+    : m_transport{MakeTransport(idIn, node_opts.use_v2transport, conn_type_in == ConnectionType::INBOUND, std::move(node_opts.recv_buffer_pool))},
       m_permission_flags{node_opts.permission_flags},
       m_sock{sock},
       m_connected{GetTime<std::chrono::seconds>()},
@@ -3871,10 +4006,11 @@ void CNode::MarkReceivedMsgsForProcessing()
     fPauseRecv = m_msg_process_queue_size > m_recv_flood_size;
 }
 
-std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage()
+std::optional<std::pair<CNetMessage, bool>> CNode::PollMessage(bool (*accept)(const std::string& msg_type))
 {
     LOCK(m_msg_process_queue_mutex);
     if (m_msg_process_queue.empty()) return std::nullopt;
+    if (accept && !accept(m_msg_process_queue.front().m_type)) return std::nullopt;
 
     std::list<CNetMessage> msgs;
     // Just take one message
@@ -3893,10 +4029,10 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
 void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 {
     AssertLockNotHeld(m_total_bytes_sent_mutex);
-    size_t nMessageSize = msg.data.size();
+    size_t nMessageSize = msg.Payload().size();
     LogDebug(BCLog::NET, "sending %s (%d bytes) peer=%d\n", msg.m_type, nMessageSize, pnode->GetId());
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pnode->addr, msg.m_type, msg.data, /*is_incoming=*/false);
+        CaptureMessage(pnode->addr, msg.m_type, msg.Payload(), /*is_incoming=*/false);
     }
 
     TRACEPOINT(net, outbound_message,
@@ -3904,8 +4040,8 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         pnode->m_addr_name.c_str(),
         pnode->ConnectionTypeAsString().c_str(),
         msg.m_type.c_str(),
-        msg.data.size(),
-        msg.data.data()
+        msg.Payload().size(),
+        msg.Payload().data()
     );
 
     size_t nBytesSent = 0;
@@ -33,6 +33,8 @@
 #include <util/sock.h>
 #include <util/threadinterrupt.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -91,9 +93,19 @@ static constexpr bool DEFAULT_FORCEDNSSEED{false};
 static constexpr bool DEFAULT_DNSSEED{true};
 static constexpr bool DEFAULT_FIXEDSEEDS{true};
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
+/** Bytes of free receive buffers kept for reuse, over all connections. */
+static constexpr size_t DEFAULT_RECV_BUFFER_POOL_SIZE{8 << 20};
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
 
 static constexpr bool DEFAULT_V2_TRANSPORT{true};
+/** Default and maximum number of threads servicing peer sockets */
+static constexpr int DEFAULT_SOCKET_THREADS{1};
+static constexpr int MAX_SOCKET_THREADS{16};
+/** Whether to use epoll(7) for socket readiness by default, where available */
+static constexpr bool DEFAULT_SOCKET_EPOLL{true};
+/** Default and maximum number of threads processing peer messages */
+static constexpr int DEFAULT_MSGPROC_THREADS{1};
+static constexpr int MAX_MSGPROC_THREADS{16};
 
 typedef int64_t NodeId;
 
@@ -120,16 +132,50 @@ struct CSerializedNetMsg {
     CSerializedNetMsg(const CSerializedNetMsg& msg) = delete;
     CSerializedNetMsg& operator=(const CSerializedNetMsg&) = delete;
 
+    /** Payload shared by several messages, see Share(). */
+    struct SharedPayload {
+        std::vector<unsigned char> data;
+        /** Double-SHA256 of data, as used for the v1 transport checksum. */
+        uint256 hash;
+    };
+
     CSerializedNetMsg Copy() const
     {
         CSerializedNetMsg copy;
         copy.data = data;
         copy.m_type = m_type;
+        copy.m_shared_payload = m_shared_payload;
         return copy;
     }
 
+    /**
+     * Move the payload into an immutable, reference-counted buffer, so that
+     * copies made with Copy() refer to it instead of duplicating it. Used for
+     * messages that are sent to many peers, like block announcements.
+     */
+    void Share()
+    {
+        if (m_shared_payload) return;
+        auto payload{std::make_shared<SharedPayload>()};
+        payload->hash = Hash(data);
+        payload->data = std::move(data);
+        data.clear();
+        m_shared_payload = std::move(payload);
+    }
+
+    /** The payload, whether owned by this message or shared. */
+    std::span<const unsigned char> Payload() const noexcept
+    {
+        return m_shared_payload ? std::span{m_shared_payload->data} : std::span{data};
+    }
+
+    /** Drop the payload, releasing this message's reference to a shared one. */
+    void ClearPayload() noexcept;
+
+    /** Payload owned by this message. Empty if the payload is shared. */
     std::vector<unsigned char> data;
     std::string m_type;
+    std::shared_ptr<const SharedPayload> m_shared_payload;
 
     /** Compute total memory usage of this object (own memory + any dynamic memory). */
     size_t GetMemoryUsage() const noexcept;
@@ -225,6 +271,42 @@ public:
 };
 
 
+/**
+ * Free message receive buffers, shared by the transports of all connections,
+ * so that a received message reuses the memory of processed ones instead of
+ * allocating its own. Buffers are kept by size class, a power of two of their
+ * capacity, up to a total number of bytes.
+ *
+ * Thread safe.
+ */
+class RecvBufferPool
+{
+public:
+    explicit RecvBufferPool(size_t max_bytes = DEFAULT_RECV_BUFFER_POOL_SIZE) : m_max_bytes{max_bytes} {}
+
+    /** An empty buffer with capacity for at least size bytes. */
+    DataStream Get(size_t size) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Keep a buffer for reuse, unless the pool is full. */
+    void Put(DataStream&& buffer) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Total capacity of the buffers kept. */
+    size_t GetPooledBytes() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    /** Smallest and largest size class, in bits */
+    static constexpr int MIN_CLASS_BITS{8};
+    static constexpr int MAX_CLASS_BITS{22};
+    /** Above this, buffers are allocated to the requested size rather than its size class. */
+    static constexpr int MAX_ROUNDED_BITS{18};
+    static constexpr size_t MAX_BUFFERS_PER_CLASS{64};
+
+    const size_t m_max_bytes;
+    mutable Mutex m_mutex;
+    std::array<std::vector<DataStream>, MAX_CLASS_BITS - MIN_CLASS_BITS + 1> m_free GUARDED_BY(m_mutex);
+    size_t m_pooled_bytes GUARDED_BY(m_mutex){0};
+};
+
 /** Transport protocol agnostic message container.
  * Ideally it should only contain receive time, payload,
  * type and size.
@@ -237,8 +319,11 @@ public:
     uint32_t m_message_size{0};          //!< size of the payload
     uint32_t m_raw_message_size{0};      //!< used wire size of the message (including header/checksum)
     std::string m_type;
+    /** Where to return the buffer of m_recv when done, if anywhere */
+    std::shared_ptr<RecvBufferPool> m_buffer_pool;
 
     explicit CNetMessage(DataStream&& recv_in) : m_recv(std::move(recv_in)) {}
+    ~CNetMessage();
     // Only one CNetMessage object will exist for the same message on either
     // the receive or processing queue. For performance reasons we therefore
     // delete the copy constructor and assignment operator to avoid the
@@ -371,6 +456,7 @@ class V1Transport final : public Transport
 private:
     const MessageStartChars m_magic_bytes;
     const NodeId m_node_id; // Only for logging
+    const std::shared_ptr<RecvBufferPool> m_buffer_pool;
     mutable Mutex m_recv_mutex; //!< Lock for receive state
     mutable CHash256 hasher GUARDED_BY(m_recv_mutex);
     mutable uint256 data_hash GUARDED_BY(m_recv_mutex);
@@ -412,11 +498,11 @@ private:
     CSerializedNetMsg m_message_to_send GUARDED_BY(m_send_mutex);
     /** Whether we're currently sending header bytes or message bytes. */
     bool m_sending_header GUARDED_BY(m_send_mutex) {false};
-    /** How many bytes have been sent so far (from m_header_to_send, or from m_message_to_send.data). */
+    /** How many bytes have been sent so far (from m_header_to_send, or from m_message_to_send's payload). */
     size_t m_bytes_sent GUARDED_BY(m_send_mutex) {0};
 
 public:
-    explicit V1Transport(const NodeId node_id) noexcept;
+    explicit V1Transport(const NodeId node_id, std::shared_ptr<RecvBufferPool> buffer_pool = nullptr) noexcept;
 
     bool ReceivedMessageComplete() const override EXCLUSIVE_LOCKS_REQUIRED(!m_recv_mutex)
     {
@@ -580,6 +666,8 @@ private:
     const bool m_initiating;
     /** NodeId (for debug logging). */
     const NodeId m_nodeid;
+    /** Where to take message receive buffers from, if anywhere. */
+    const std::shared_ptr<RecvBufferPool> m_buffer_pool;
     /** Encapsulate a V1Transport to fall back to. */
     V1Transport m_v1_fallback;
 
@@ -592,8 +680,8 @@ private:
     std::vector<uint8_t> m_recv_buffer GUARDED_BY(m_recv_mutex);
     /** AAD expected in next received packet (currently used only for garbage). */
     std::vector<uint8_t> m_recv_aad GUARDED_BY(m_recv_mutex);
-    /** Buffer to put decrypted contents in, for converting to CNetMessage. */
-    std::vector<uint8_t> m_recv_decode_buffer GUARDED_BY(m_recv_mutex);
+    /** Buffer to put decrypted contents in, handed to the CNetMessage. */
+    DataStream m_recv_decode_buffer GUARDED_BY(m_recv_mutex);
     /** Current receiver state. */
     RecvState m_recv_state GUARDED_BY(m_recv_mutex);
 
@@ -639,11 +727,13 @@ public:
      *
      * @param[in] nodeid      the node's NodeId (only for debug log output).
      * @param[in] initiating  whether we are the initiator side.
+     * @param[in] buffer_pool where to take message receive buffers from, if anywhere.
      */
-    V2Transport(NodeId nodeid, bool initiating) noexcept;
+    V2Transport(NodeId nodeid, bool initiating, std::shared_ptr<RecvBufferPool> buffer_pool = nullptr) noexcept;
 
     /** Construct a V2 transport with specified keys and garbage (test use only). */
-    V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage) noexcept;
+    V2Transport(NodeId nodeid, bool initiating, const CKey& key, std::span<const std::byte> ent32, std::vector<uint8_t> garbage,
+                std::shared_ptr<RecvBufferPool> buffer_pool = nullptr) noexcept;
 
     // Receive side functions.
     bool ReceivedMessageComplete() const noexcept override EXCLUSIVE_LOCKS_REQUIRED(!m_recv_mutex);
@@ -668,6 +758,7 @@ struct CNodeOptions
     bool prefer_evict = false;
     size_t recv_flood_size{DEFAULT_MAXRECEIVEBUFFER * 1000};
     bool use_v2transport = false;
+    std::shared_ptr<RecvBufferPool> recv_buffer_pool{nullptr};
 };
 
 /** Information about a peer */
@@ -750,12 +841,18 @@ public:
 
     /** Poll the next message from the processing queue of this connection.
      *
-     * Returns std::nullopt if the processing queue is empty, or a pair
-     * consisting of the message and a bool that indicates if the processing
-     * queue has more entries. */
-    std::optional<std::pair<CNetMessage, bool>> PollMessage()
+     * Returns std::nullopt if the processing queue is empty or, if `accept`
+     * is given, if it returns false for the type of the next message.
+     * Otherwise returns a pair consisting of the message and a bool that
+     * indicates if the processing queue has more entries. */
+    std::optional<std::pair<CNetMessage, bool>> PollMessage(bool (*accept)(const std::string& msg_type) = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(!m_msg_process_queue_mutex);
 
+    /** Held while messages from this connection are being processed, so that
+     *  the message handler threads take them one at a time and in the order
+     *  they were received. */
+    Mutex m_msg_process_order_mutex;
+
     /** Account for the total size of a sent message in the per msg type connection stats. */
     void AccountForSentBytes(const std::string& msg_type, size_t sent_bytes)
         EXCLUSIVE_LOCKS_REQUIRED(cs_vSend)
@@ -1046,6 +1143,18 @@ public:
     */
     virtual bool SendMessages(CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex) = 0;
 
+    /**
+    * Process protocol messages received from a given node that need neither
+    * chain state nor anything guarded by g_msgproc_mutex, stopping at the
+    * first message that does. Such messages are left for ProcessMessages().
+    * Called by the auxiliary message handler threads, with the node's
+    * m_msg_process_order_mutex held.
+    *
+    * @param[in]   pnode           The node which we have received messages from.
+    * @param[in]   interrupt       Interrupt condition for processing threads
+    * @return                      True if there is more work to be done
+    */
+    virtual bool ProcessLightMessages(CNode* pnode, std::atomic<bool>& interrupt) EXCLUSIVE_LOCKS_REQUIRED(!g_msgproc_mutex) = 0;
 
 protected:
     /**
@@ -1085,6 +1194,9 @@ public:
         bool m_i2p_accept_incoming;
         bool whitelist_forcerelay = DEFAULT_WHITELISTFORCERELAY;
         bool whitelist_relay = DEFAULT_WHITELISTRELAY;
+        int m_socket_threads = DEFAULT_SOCKET_THREADS;
+        bool m_use_epoll = false;
+        int m_msgproc_threads = DEFAULT_MSGPROC_THREADS;
     };
 
     void Init(const Options& connOptions) EXCLUSIVE_LOCKS_REQUIRED(!m_added_nodes_mutex, !m_total_bytes_sent_mutex)
@@ -1122,6 +1234,9 @@ public:
         m_onion_binds = connOptions.onion_binds;
         whitelist_forcerelay = connOptions.whitelist_forcerelay;
         whitelist_relay = connOptions.whitelist_relay;
+        m_socket_threads = std::clamp(connOptions.m_socket_threads, 1, MAX_SOCKET_THREADS);
+        m_use_epoll = connOptions.m_use_epoll;
+        m_msgproc_threads = std::clamp(connOptions.m_msgproc_threads, 1, MAX_MSGPROC_THREADS);
     }
 
     CConnman(uint64_t seed0,
@@ -1343,6 +1458,7 @@ private:
     void ProcessAddrFetch() EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_unused_i2p_sessions_mutex);
     void ThreadOpenConnections(std::vector<std::string> connect, std::span<const std::string> seed_nodes) EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_added_nodes_mutex, !m_nodes_mutex, !m_unused_i2p_sessions_mutex, !m_reconnections_mutex);
     void ThreadMessageHandler() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
+    void ThreadLightMessageHandler(int worker) EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
     void ThreadI2PAcceptIncoming();
     void AcceptConnection(const ListenSocket& hListenSocket);
 
@@ -1365,24 +1481,30 @@ private:
     bool InactivityCheck(const CNode& node) const;
 
     /**
-     * Generate a collection of sockets to check for IO readiness.
+     * Tell a poller which sockets to check for IO readiness.
      * @param[in] nodes Select from these nodes' sockets.
-     * @return sockets to check for readiness
+     * @param[in] listening Whether to also check the listening sockets.
+     * @param[in,out] poller Poller to pass the sockets to.
      */
-    Sock::EventsPerSock GenerateWaitSockets(std::span<CNode* const> nodes);
+    void GenerateWaitSockets(std::span<CNode* const> nodes, bool listening, SockPoller& poller);
 
     /**
      * Check connected and listening sockets for IO readiness and process them accordingly.
+     * @param[in] shard Only service the nodes assigned to this socket handler thread, see
+     * `m_socket_threads`. Listening sockets are serviced by shard 0.
+     * @param[in,out] poller The poller used by the calling thread.
      */
-    void SocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
+    void SocketHandler(int shard, SockPoller& poller) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
 
     /**
      * Do the read/write for connected sockets that are ready for IO.
      * @param[in] nodes Nodes to process. The socket of each node is checked against `what`.
      * @param[in] events_per_sock Sockets that are ready for IO.
+     * @param[in,out] poller Told about sockets that would block.
      */
     void SocketHandlerConnected(const std::vector<CNode*>& nodes,
-                                const Sock::EventsPerSock& events_per_sock)
+                                const Sock::EventsPerSock& events_per_sock,
+                                SockPoller& poller)
         EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc);
 
     /**
@@ -1391,7 +1513,7 @@ private:
      */
     void SocketHandlerListening(const Sock::EventsPerSock& events_per_sock);
 
-    void ThreadSocketHandler() EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc, !m_nodes_mutex, !m_reconnections_mutex);
+    void ThreadSocketHandler(int shard) EXCLUSIVE_LOCKS_REQUIRED(!m_total_bytes_sent_mutex, !mutexMsgProc, !m_nodes_mutex, !m_reconnections_mutex);
     void ThreadDNSAddressSeed() EXCLUSIVE_LOCKS_REQUIRED(!m_addr_fetches_mutex, !m_nodes_mutex);
 
     uint64_t CalculateKeyedNetGroup(const CNetAddr& ad) const;
@@ -1594,8 +1716,28 @@ private:
     int m_max_inbound;
 
     bool m_use_addrman_outgoing;
+
+    /**
+     * Number of socket handler threads. Each node is serviced by the thread
+     * given by its id modulo this number.
+     */
+    int m_socket_threads{DEFAULT_SOCKET_THREADS};
+    /** Whether socket handler threads wait for readiness with epoll(7), if available. */
+    bool m_use_epoll{false};
+
+    /**
+     * Number of message handler threads. The first one processes every kind of
+     * message and is the only one that touches chain state. The others only
+     * take the messages that `NetEventsInterface::ProcessLightMessages()`
+     * accepts, each for the nodes given by its id modulo their number, so
+     * those do not wait behind a slow block or transaction validation.
+     */
+    int m_msgproc_threads{DEFAULT_MSGPROC_THREADS};
+
     CClientUIInterface* m_client_interface;
     NetEventsInterface* m_msgproc;
+    /** Receive buffers shared by all connections */
+    const std::shared_ptr<RecvBufferPool> m_recv_buffer_pool{std::make_shared<RecvBufferPool>()};
     /** Pointer to this node's banman. May be nullptr - check existence before dereferencing. */
     BanMan* m_banman;
 
@@ -1610,6 +1752,8 @@ private:
 
     /** flag for waking the message processor. */
     bool fMsgProcWake GUARDED_BY(mutexMsgProc);
+    /** Bumped on every wake-up, so each auxiliary message handler notices it. */
+    uint64_t m_msgproc_wake_seq GUARDED_BY(mutexMsgProc){0};
 
     std::condition_variable condMsgProc;
     Mutex mutexMsgProc;
@@ -1629,10 +1773,11 @@ private:
     std::unique_ptr<i2p::sam::Session> m_i2p_sam_session;
 
     std::thread threadDNSAddressSeed;
-    std::thread threadSocketHandler;
+    std::vector<std::thread> m_thread_socket_handlers;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
     std::thread threadMessageHandler;
+    std::vector<std::thread> m_thread_light_message_handlers;
     std::thread threadI2PAcceptIncoming;
 
     /** flag for deciding to connect to an extra outbound peer,
@@ -1714,11 +1859,26 @@ private:
     class NodesSnapshot
     {
     public:
-        explicit NodesSnapshot(const CConnman& connman, bool shuffle)
+        /** Selects the nodes whose id modulo `count` is `index`. */
+        struct Shard {
+            int index;
+            int count;
+        };
+
+        explicit NodesSnapshot(const CConnman& connman, bool shuffle, std::optional<Shard> shard = std::nullopt)
         {
             {
                 LOCK(connman.m_nodes_mutex);
-                m_nodes_copy = connman.m_nodes;
+                if (shard) {
+                    // Only the nodes serviced by the given thread
+                    for (CNode* node : connman.m_nodes) {
+                        if (node->GetId() % shard->count == shard->index) {
+                            m_nodes_copy.push_back(node);
+                        }
+                    }
+                } else {
+                    m_nodes_copy = connman.m_nodes;
+                }
                 for (auto& node : m_nodes_copy) {
                     node->AddRef();
                 }
@@ -30,11 +30,14 @@
 #include <netaddress.h>
 #include <netbase.h>
 #include <netmessagemaker.h>
+#include <node/blockdownloadscheduler.h>
 #include <node/blockstorage.h>
 #include <node/connection_types.h>
 #include <node/protocol_version.h>
 #include <node/timeoffsets.h>
+#include <node/txannouncementlog.h>
 #include <node/txdownloadman.h>
+#include <node/txmessagecache.h>
 #include <node/txorphanage.h>
 #include <node/txreconciliation.h>
 #include <node/warnings.h>
@@ -69,7 +72,6 @@
 #include <deque>
 #include <exception>
 #include <functional>
-#include <future>
 #include <initializer_list>
 #include <iterator>
 #include <limits>
@@ -124,7 +126,8 @@ static const unsigned int MAX_LOCATOR_SZ = 101;
 static const unsigned int MAX_INV_SZ = 50000;
 /** Limit to avoid sending big packets. Not used in processing incoming GETDATA for compatibility */
 static const unsigned int MAX_GETDATA_SZ = 1000;
-/** Number of blocks that can be requested at any given time from a single peer. */
+/** Number of blocks that can be requested at any given time from a single peer, outside of the
+ *  download window. Within it, node::BlockDownloadScheduler sizes the number per peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
 /** Default time during which a peer must stall block download progress before being disconnected.
  * the actual timeout is increased temporarily if peers are disconnected for hitting the timeout */
@@ -298,11 +301,10 @@ struct Peer {
          *  us or we have announced to the peer. We use this to avoid announcing
          *  the same (w)txid to a peer that already has the transaction. */
         CRollingBloomFilter m_tx_inventory_known_filter GUARDED_BY(m_tx_inventory_mutex){50000, 0.000001};
-        /** Set of wtxids we still have to announce. For non-wtxid-relay peers,
-         *  we retrieve the txid from the corresponding mempool transaction when
-         *  constructing the `inv` message. We use the mempool to sort transactions
-         *  in dependency order before relay, so this does not have to be sorted. */
-        std::set<Wtxid> m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
+        /** Wtxids we still have to announce, in dependency order. For
+         *  non-wtxid-relay peers, we retrieve the txid from the corresponding
+         *  mempool transaction when constructing the `inv` message. */
+        node::TxInventoryQueue m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
         /** Whether the peer has requested us to send our complete mempool. Only
          *  permitted if the peer has NetPermissionFlags::Mempool or we advertise
          *  NODE_BLOOM. See BIP35. */
@@ -316,14 +318,16 @@ struct Peer {
 
         /** Minimum fee rate with which to filter transaction announcements to this node. See BIP133. */
         std::atomic<CAmount> m_fee_filter_received{0};
+
+        explicit TxRelay(node::TxAnnouncementLog& announcement_log) : m_tx_inventory_to_send{announcement_log} {}
     };
 
     /* Initializes a TxRelay struct for this peer. Can be called at most once for a peer. */
-    TxRelay* SetTxRelay() EXCLUSIVE_LOCKS_REQUIRED(!m_tx_relay_mutex)
+    TxRelay* SetTxRelay(node::TxAnnouncementLog& announcement_log) EXCLUSIVE_LOCKS_REQUIRED(!m_tx_relay_mutex)
     {
         LOCK(m_tx_relay_mutex);
         Assume(!m_tx_relay);
-        m_tx_relay = std::make_unique<Peer::TxRelay>();
+        m_tx_relay = std::make_unique<Peer::TxRelay>(announcement_log);
         return m_tx_relay.get();
     };
 
@@ -511,6 +515,8 @@ public:
         EXCLUSIVE_LOCKS_REQUIRED(!m_tx_download_mutex);
     void BlockDisconnected(const std::shared_ptr<const CBlock> &block, const CBlockIndex* pindex) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_tx_download_mutex);
+    void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) override;
+    void MempoolTransactionsRemovedForBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block, unsigned int nBlockHeight) override;
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void BlockChecked(const std::shared_ptr<const CBlock>& block, const BlockValidationState& state) override
@@ -526,6 +532,8 @@ public:
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
     bool SendMessages(CNode* pto) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, g_msgproc_mutex, !m_tx_download_mutex);
+    bool ProcessLightMessages(CNode* pfrom, std::atomic<bool>& interrupt) override
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !g_msgproc_mutex, !m_tx_download_mutex);
 
     /** Implement PeerManager */
     void StartScheduledTasks(CScheduler& scheduler) override;
@@ -550,6 +558,18 @@ public:
     ServiceFlags GetDesirableServiceFlags(ServiceFlags services) const override;
 
 private:
+    /**
+     * Handle the messages that need neither chain state nor anything guarded
+     * by g_msgproc_mutex, so any message handler thread may process them.
+     *
+     * @return Whether msg_type is one of them.
+     */
+    bool ProcessLightMessage(CNode& pfrom, Peer& peer, const std::string& msg_type, DataStream& vRecv,
+                             std::chrono::microseconds time_received);
+
+    /** Report a received message to the inbound_message tracepoint and, if enabled, capture it. */
+    void TraceReceivedMessage(const CNode& node, const CNetMessage& msg);
+
     /** Consider evicting an outbound peer based on the amount of time they've been behind our tip */
     void ConsiderEviction(CNode& pto, Peer& peer, std::chrono::seconds time_in_seconds) EXCLUSIVE_LOCKS_REQUIRED(cs_main, g_msgproc_mutex);
 
@@ -709,6 +729,10 @@ private:
 
     /** Send a message to a peer */
     void PushMessage(CNode& node, CSerializedNetMsg&& msg) const { m_connman.PushMessage(&node, std::move(msg)); }
+
+    /** Get a witness block message for the given block, reusing the payload
+     *  serialized for an earlier request if it is the most recent block. */
+    CSerializedNetMsg MakeBlockMessage(const std::shared_ptr<const CBlock>& block) EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
     template <typename... Args>
     void MakeAndPushMessage(CNode& node, std::string msg_type, Args&&... args) const
     {
@@ -739,6 +763,9 @@ private:
      */
     void RelayAddress(NodeId originator, const CAddress& addr, bool fReachable) EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, g_msgproc_mutex);
 
+    /** Queue the transactions a txreconciliation round found the peer missing for announcement to it. */
+    void AnnounceReconciledTxs(Peer& peer, std::span<const Wtxid> wtxids);
+
     /** Send `feefilter` message. */
     void MaybeSendFeefilter(CNode& node, Peer& peer, std::chrono::microseconds current_time) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
 
@@ -786,6 +813,9 @@ private:
       * on extra block-relay-only peers. */
     bool m_initial_sync_finished GUARDED_BY(cs_main){false};
 
+    /** Transactions to announce, shared by the TxRelay of all peers. Outlives them. */
+    node::TxAnnouncementLog m_tx_announcement_log;
+
     /** Protects m_peer_map. This mutex must not be locked while holding a lock
      *  on any of the mutexes inside a Peer object. */
     mutable Mutex m_peer_mutex;
@@ -851,9 +881,16 @@ private:
     Mutex m_most_recent_block_mutex;
     std::shared_ptr<const CBlock> m_most_recent_block GUARDED_BY(m_most_recent_block_mutex);
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> m_most_recent_compact_block GUARDED_BY(m_most_recent_block_mutex);
+    /** m_most_recent_compact_block as a message, serialized once and shared by every peer it is sent to */
+    CSerializedNetMsg m_most_recent_compact_block_msg GUARDED_BY(m_most_recent_block_mutex);
+    /** m_most_recent_block as a witness block message, serialized when first requested */
+    std::optional<CSerializedNetMsg> m_most_recent_block_msg GUARDED_BY(m_most_recent_block_mutex);
     uint256 m_most_recent_block_hash GUARDED_BY(m_most_recent_block_mutex);
     std::unique_ptr<const std::map<GenTxid, CTransactionRef>> m_most_recent_block_txs GUARDED_BY(m_most_recent_block_mutex);
 
+    /** Serialized mempool transactions, to answer getdata requests without serializing each time */
+    node::TxMessageCache m_tx_message_cache;
+
     // Data about the low-work headers synchronization, aggregated from all peers' HeadersSyncStates.
     /** Mutex guarding the other m_headers_presync_* variables. */
     Mutex m_headers_presync_mutex;
@@ -939,6 +976,9 @@ private:
     typedef std::multimap<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator>> BlockDownloadMap;
     BlockDownloadMap mapBlocksInFlight GUARDED_BY(cs_main);
 
+    /** Measures block download performance per peer and follows the requests in mapBlocksInFlight. */
+    node::BlockDownloadScheduler m_block_download_scheduler GUARDED_BY(cs_main);
+
     /** When our tip was last updated. */
     std::atomic<std::chrono::seconds> m_last_tip_update{0s};
 
@@ -946,6 +986,16 @@ private:
     CTransactionRef FindTxForGetData(const Peer::TxRelay& tx_relay, const GenTxid& gtxid)
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, !tx_relay.m_tx_inventory_mutex);
 
+    /**
+     * Send the transactions requested at the front of the peer's getdata queue,
+     * adding those we cannot provide to vNotFound. Does not need chain state.
+     *
+     * @return The first request that was not handled.
+     */
+    std::deque<CInv>::iterator ProcessGetTxData(CNode& pfrom, Peer& peer, std::vector<CInv>& vNotFound, const std::atomic<bool>& interruptMsgProc)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, peer.m_getdata_requests_mutex)
+        LOCKS_EXCLUDED(::cs_main);
+
     void ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
         EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, peer.m_getdata_requests_mutex, NetEventsInterface::g_msgproc_mutex)
         LOCKS_EXCLUDED(::cs_main);
@@ -1198,6 +1248,7 @@ void PeerManagerImpl::RemoveBlockRequest(const uint256& hash, std::optional<Node
             state.m_downloading_since = std::max(state.m_downloading_since, GetTime<std::chrono::microseconds>());
         }
         state.vBlocksInFlight.erase(list_it);
+        m_block_download_scheduler.RequestRemoved(node_id, hash);
 
         if (state.vBlocksInFlight.empty()) {
             // Last validated block on the queue for this peer was received.
@@ -1239,6 +1290,7 @@ bool PeerManagerImpl::BlockRequested(NodeId nodeid, const CBlockIndex& block, st
         m_peers_downloading_from++;
     }
     auto itInFlight = mapBlocksInFlight.insert(std::make_pair(hash, std::make_pair(nodeid, it)));
+    m_block_download_scheduler.BlockRequested(nodeid, hash, block.nHeight, GetTime<std::chrono::microseconds>());
     if (pit) {
         *pit = &itInFlight->second.second;
     }
@@ -1624,6 +1676,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
             }
         }
     }
+    m_block_download_scheduler.PeerDisconnected(nodeid);
     {
         LOCK(m_tx_download_mutex);
         m_txdownloadman.DisconnectedPeer(nodeid);
@@ -1640,6 +1693,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
     if (m_node_states.empty()) {
         // Do a consistency check after the last peer is removed.
         assert(mapBlocksInFlight.empty());
+        assert(m_block_download_scheduler.CountInFlight() == 0);
         assert(m_num_preferred_download_peers == 0);
         assert(m_peers_downloading_from == 0);
         assert(m_outbound_peers_with_protect_from_disconnect == 0);
@@ -1974,6 +2028,18 @@ void PeerManagerImpl::BlockConnected(
     m_txdownloadman.BlockConnected(pblock);
 }
 
+void PeerManagerImpl::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence)
+{
+    m_tx_message_cache.Remove(tx->GetWitnessHash());
+}
+
+void PeerManagerImpl::MempoolTransactionsRemovedForBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block, unsigned int nBlockHeight)
+{
+    for (const auto& removed : txs_removed_for_block) {
+        m_tx_message_cache.Remove(removed.info.m_tx->GetWitnessHash());
+    }
+}
+
 void PeerManagerImpl::BlockDisconnected(const std::shared_ptr<const CBlock> &block, const CBlockIndex* pindex)
 {
     LOCK(m_tx_download_mutex);
@@ -1997,8 +2063,9 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
     if (!DeploymentActiveAt(*pindex, m_chainman, Consensus::DEPLOYMENT_SEGWIT)) return;
 
     uint256 hashBlock(pblock->GetHash());
-    const std::shared_future<CSerializedNetMsg> lazy_ser{
-        std::async(std::launch::deferred, [&] { return NetMsg::Make(NetMsgType::CMPCTBLOCK, *pcmpctblock); })};
+    // Serialize the announcement once; every peer's send queue refers to the same payload.
+    CSerializedNetMsg ser_cmpctblock{NetMsg::Make(NetMsgType::CMPCTBLOCK, *pcmpctblock)};
+    ser_cmpctblock.Share();
 
     {
         auto most_recent_block_txs = std::make_unique<std::map<GenTxid, CTransactionRef>>();
@@ -2011,10 +2078,12 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
         m_most_recent_block_hash = hashBlock;
         m_most_recent_block = pblock;
         m_most_recent_compact_block = pcmpctblock;
+        m_most_recent_compact_block_msg = ser_cmpctblock.Copy();
+        m_most_recent_block_msg.reset();
         m_most_recent_block_txs = std::move(most_recent_block_txs);
     }
 
-    m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    m_connman.ForEachNode([this, pindex, &ser_cmpctblock, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
@@ -2028,7 +2097,6 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
             LogDebug(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
 
-            const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
             PushMessage(*pnode, ser_cmpctblock.Copy());
             state.pindexBestHeaderSent = pindex;
         }
@@ -2127,6 +2195,21 @@ void PeerManagerImpl::SendPings()
 void PeerManagerImpl::RelayTransaction(const Txid& txid, const Wtxid& wtxid)
 {
     LOCK(m_peer_mutex);
+
+    // With txreconciliation, the transaction is flooded to some of the
+    // reconciling peers only, and added to the reconciliation sets of the
+    // others.
+    std::vector<NodeId> fanout_targets;
+    if (m_txreconciliation) {
+        size_t inbounds_nonrcncl_tx_relay{0}, outbounds_nonrcncl_tx_relay{0};
+        for (const auto& [peer_id, peer] : m_peer_map) {
+            if (!peer->GetTxRelay() || m_txreconciliation->IsPeerRegistered(peer_id)) continue;
+            ++(peer->m_is_inbound ? inbounds_nonrcncl_tx_relay : outbounds_nonrcncl_tx_relay);
+        }
+        fanout_targets = m_txreconciliation->GetFanoutTargets(wtxid, inbounds_nonrcncl_tx_relay, outbounds_nonrcncl_tx_relay);
+    }
+
+    const node::TxAnnouncementLog::Seq seq{m_tx_announcement_log.Append(wtxid)};
     for(auto& it : m_peer_map) {
         Peer& peer = *it.second;
         auto tx_relay = peer.GetTxRelay();
@@ -2142,7 +2225,26 @@ void PeerManagerImpl::RelayTransaction(const Txid& txid, const Wtxid& wtxid)
 
         const uint256& hash{peer.m_wtxid_relay ? wtxid.ToUint256() : txid.ToUint256()};
         if (!tx_relay->m_tx_inventory_known_filter.contains(hash)) {
-            tx_relay->m_tx_inventory_to_send.insert(wtxid);
+            if (m_txreconciliation && !std::binary_search(fanout_targets.begin(), fanout_targets.end(), peer.m_id) &&
+                m_txreconciliation->AddToSet(peer.m_id, wtxid)) {
+                continue;
+            }
+            tx_relay->m_tx_inventory_to_send.Push(seq, wtxid);
+        }
+    }
+}
+
+void PeerManagerImpl::AnnounceReconciledTxs(Peer& peer, std::span<const Wtxid> wtxids)
+{
+    auto tx_relay = peer.GetTxRelay();
+    if (!tx_relay) return;
+
+    // They go out with the next trickle, subject to the same filters and
+    // broadcast limits as flooded announcements.
+    LOCK(tx_relay->m_tx_inventory_mutex);
+    for (const Wtxid& wtxid : wtxids) {
+        if (!tx_relay->m_tx_inventory_known_filter.contains(wtxid.ToUint256())) {
+            tx_relay->m_tx_inventory_to_send.Push(wtxid);
         }
     }
 }
@@ -2196,14 +2298,35 @@ void PeerManagerImpl::RelayAddress(NodeId originator,
     }
 }
 
+CSerializedNetMsg PeerManagerImpl::MakeBlockMessage(const std::shared_ptr<const CBlock>& block)
+{
+    {
+        LOCK(m_most_recent_block_mutex);
+        if (m_most_recent_block == block && m_most_recent_block_msg) return m_most_recent_block_msg->Copy();
+    }
+
+    // Serialize outside the lock, it can take a while for a large block.
+    CSerializedNetMsg msg{NetMsg::Make(NetMsgType::BLOCK, TX_WITH_WITNESS(*block))};
+
+    LOCK(m_most_recent_block_mutex);
+    if (m_most_recent_block == block) {
+        // Other peers are likely to ask for the block we just announced too.
+        msg.Share();
+        if (!m_most_recent_block_msg) m_most_recent_block_msg = msg.Copy();
+    }
+    return msg;
+}
+
 void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv& inv)
 {
     std::shared_ptr<const CBlock> a_recent_block;
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> a_recent_compact_block;
+    CSerializedNetMsg a_recent_compact_block_msg;
     {
         LOCK(m_most_recent_block_mutex);
         a_recent_block = m_most_recent_block;
         a_recent_compact_block = m_most_recent_compact_block;
+        a_recent_compact_block_msg = m_most_recent_compact_block_msg.Copy();
     }
 
     bool need_activate_chain = false;
@@ -2307,7 +2430,7 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         if (inv.IsMsgBlk()) {
             MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_NO_WITNESS(*pblock));
         } else if (inv.IsMsgWitnessBlk()) {
-            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_WITH_WITNESS(*pblock));
+            PushMessage(pfrom, MakeBlockMessage(pblock));
         } else if (inv.IsMsgFilteredBlk()) {
             bool sendMerkleBlock = false;
             CMerkleBlock merkleBlock;
@@ -2338,7 +2461,7 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
             // instead we respond with the full, non-compact block.
             if (can_direct_fetch && pindex->nHeight >= tip->nHeight - MAX_CMPCTBLOCK_DEPTH) {
                 if (a_recent_compact_block && a_recent_compact_block->header.GetHash() == inv.hash) {
-                    MakeAndPushMessage(pfrom, NetMsgType::CMPCTBLOCK, *a_recent_compact_block);
+                    PushMessage(pfrom, std::move(a_recent_compact_block_msg));
                 } else {
                     CBlockHeaderAndShortTxIDs cmpctblock{*pblock, m_rng.rand64()};
                     MakeAndPushMessage(pfrom, NetMsgType::CMPCTBLOCK, cmpctblock);
@@ -2388,20 +2511,19 @@ CTransactionRef PeerManagerImpl::FindTxForGetData(const Peer::TxRelay& tx_relay,
     return {};
 }
 
-void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
+std::deque<CInv>::iterator PeerManagerImpl::ProcessGetTxData(CNode& pfrom, Peer& peer, std::vector<CInv>& vNotFound, const std::atomic<bool>& interruptMsgProc)
 {
     AssertLockNotHeld(cs_main);
 
     auto tx_relay = peer.GetTxRelay();
 
     std::deque<CInv>::iterator it = peer.m_getdata_requests.begin();
-    std::vector<CInv> vNotFound;
 
     // Process as many TX items from the front of the getdata queue as
     // possible, since they're common and it's efficient to batch process
     // them.
     while (it != peer.m_getdata_requests.end() && it->IsGenTxMsg()) {
-        if (interruptMsgProc) return;
+        if (interruptMsgProc) break;
         // The send buffer provides backpressure. If there's no space in
         // the buffer, pause processing until the next call.
         if (pfrom.fPauseSend) break;
@@ -2416,14 +2538,24 @@ void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic
 
         if (auto tx{FindTxForGetData(*tx_relay, ToGenTxid(inv))}) {
             // WTX and WITNESS_TX imply we serialize with witness
-            const auto maybe_with_witness = (inv.IsMsgTx() ? TX_NO_WITNESS : TX_WITH_WITNESS);
-            MakeAndPushMessage(pfrom, NetMsgType::TX, maybe_with_witness(*tx));
+            PushMessage(pfrom, m_tx_message_cache.GetMessage(*tx, /*with_witness=*/!inv.IsMsgTx()));
             m_mempool.RemoveUnbroadcastTx(tx->GetHash());
         } else {
             vNotFound.push_back(inv);
         }
     }
 
+    return it;
+}
+
+void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
+{
+    AssertLockNotHeld(cs_main);
+
+    std::vector<CInv> vNotFound;
+    std::deque<CInv>::iterator it = ProcessGetTxData(pfrom, peer, vNotFound, interruptMsgProc);
+    if (interruptMsgProc) return;
+
     // Only process one BLOCK item per call, since they're uncommon and can be
     // expensive to process.
     if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend) {
@@ -3547,7 +3679,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         if (!pfrom.IsBlockOnlyConn() &&
             !pfrom.IsFeelerConn() &&
             (fRelay || (peer->m_our_services & NODE_BLOOM))) {
-            auto* const tx_relay = peer->SetTxRelay();
+            auto* const tx_relay = peer->SetTxRelay(m_tx_announcement_log);
             {
                 LOCK(tx_relay->m_bloom_filter_mutex);
                 tx_relay->m_relay_txs = fRelay; // set to true after we get the first filter* message
@@ -3837,6 +3969,8 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (ProcessLightMessage(pfrom, *peer, msg_type, vRecv, time_received)) return;
+
     if (msg_type == NetMsgType::ADDR || msg_type == NetMsgType::ADDRV2) {
         const auto ser_params{
             msg_type == NetMsgType::ADDRV2 ?
@@ -3984,6 +4118,10 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 }
                 const GenTxid gtxid = ToGenTxid(inv);
                 AddKnownTx(*peer, inv.hash);
+                // The peer has it, so there is no need to reconcile it with them.
+                if (m_txreconciliation && inv.IsMsgWtx()) {
+                    m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), Wtxid::FromUint256(inv.hash));
+                }
 
                 if (!m_chainman.IsInitialBlockDownload()) {
                     const bool fAlreadyHave{m_txdownloadman.AddTxAnnouncement(pfrom.GetId(), gtxid, current_time)};
@@ -4632,6 +4770,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
+        const size_t block_bytes{vRecv.size()};
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
         vRecv >> TX_WITH_WITNESS(*pblock);
 
@@ -4656,6 +4795,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            m_block_download_scheduler.BlockReceived(pfrom.GetId(), hash, block_bytes, time_received);
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -4737,6 +4877,152 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::GETCFILTERS) {
+        ProcessGetCFilters(pfrom, *peer, vRecv);
+        return;
+    }
+
+    if (msg_type == NetMsgType::GETCFHEADERS) {
+        ProcessGetCFHeaders(pfrom, *peer, vRecv);
+        return;
+    }
+
+    if (msg_type == NetMsgType::GETCFCHECKPT) {
+        ProcessGetCFCheckPt(pfrom, *peer, vRecv);
+        return;
+    }
+
+    if (msg_type == NetMsgType::NOTFOUND) {
+        std::vector<CInv> vInv;
+        vRecv >> vInv;
+        std::vector<GenTxid> tx_invs;
+        if (vInv.size() <= node::MAX_PEER_TX_ANNOUNCEMENTS + MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+            for (CInv &inv : vInv) {
+                if (inv.IsGenTxMsg()) {
+                    tx_invs.emplace_back(ToGenTxid(inv));
+                }
+            }
+        }
+        LOCK(m_tx_download_mutex);
+        m_txdownloadman.ReceivedNotFound(pfrom.GetId(), tx_invs);
+        return;
+    }
+
+    if (msg_type == NetMsgType::REQRECON) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "reqrecon from peer=%d ignored, as we do not reconcile transactions with it\n", pfrom.GetId());
+            return;
+        }
+        uint16_t peer_set_size, peer_q;
+        vRecv >> peer_set_size >> peer_q;
+        if (!m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), peer_set_size, peer_q)) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected reqrecon), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+        }
+        return;
+    }
+
+    if (msg_type == NetMsgType::SKETCH) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "sketch from peer=%d ignored, as we do not reconcile transactions with it\n", pfrom.GetId());
+            return;
+        }
+        std::vector<uint8_t> skdata;
+        vRecv >> skdata;
+        const ReconciliationSketchResult result{m_txreconciliation->HandleSketch(pfrom.GetId(), skdata)};
+        if (!result.valid) {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected sketch), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
+        if (result.stale) return;
+        if (result.request_extension) {
+            MakeAndPushMessage(pfrom, NetMsgType::REQSKETCHEXT);
+            return;
+        }
+        MakeAndPushMessage(pfrom, NetMsgType::RECONCILDIFF, uint8_t{result.success}, result.ask_shortids);
+        AnnounceReconciledTxs(*peer, result.announce);
+        return;
+    }
+
+    if (msg_type == NetMsgType::REQSKETCHEXT) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "reqsketchext from peer=%d ignored, as we do not reconcile transactions with it\n", pfrom.GetId());
+            return;
+        }
+        if (const auto extension{m_txreconciliation->HandleExtensionRequest(pfrom.GetId())}) {
+            MakeAndPushMessage(pfrom, NetMsgType::SKETCH, *extension);
+        } else {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected reqsketchext), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+        }
+        return;
+    }
+
+    if (msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogDebug(BCLog::NET, "reconcildiff from peer=%d ignored, as we do not reconcile transactions with it\n", pfrom.GetId());
+            return;
+        }
+        uint8_t success;
+        std::vector<uint32_t> ask_shortids;
+        vRecv >> success >> ask_shortids;
+        if (const auto announce{m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success != 0, ask_shortids)}) {
+            AnnounceReconciledTxs(*peer, *announce);
+        } else {
+            LogDebug(BCLog::NET, "txreconciliation protocol violation (unexpected reconcildiff), %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+        }
+        return;
+    }
+
+    // Ignore unknown commands for extensibility
+    LogDebug(BCLog::NET, "Unknown command \"%s\" from peer=%d\n", SanitizeString(msg_type), pfrom.GetId());
+    return;
+}
+
+bool PeerManagerImpl::MaybeDiscourageAndDisconnect(CNode& pnode, Peer& peer)
+{
+    {
+        LOCK(peer.m_misbehavior_mutex);
+
+        // There's nothing to do if the m_should_discourage flag isn't set
+        if (!peer.m_should_discourage) return false;
+
+        peer.m_should_discourage = false;
+    } // peer.m_misbehavior_mutex
+
+    if (pnode.HasPermission(NetPermissionFlags::NoBan)) {
+        // We never disconnect or discourage peers for bad behavior if they have NetPermissionFlags::NoBan permission
+        LogPrintf("Warning: not punishing noban peer %d!\n", peer.m_id);
+        return false;
+    }
+
+    if (pnode.IsManualConn()) {
+        // We never disconnect or discourage manual peers for bad behavior
+        LogPrintf("Warning: not punishing manually connected peer %d!\n", peer.m_id);
+        return false;
+    }
+
+    if (pnode.addr.IsLocal()) {
+        // We disconnect local peers for bad behavior but don't discourage (since that would discourage
+        // all peers on the same local address)
+        LogDebug(BCLog::NET, "Warning: disconnecting but not discouraging %s peer %d!\n",
+                 pnode.m_inbound_onion ? "inbound onion" : "local", peer.m_id);
+        pnode.fDisconnect = true;
+        return true;
+    }
+
+    // Normal case: Disconnect the peer and discourage all nodes sharing the address
+    LogDebug(BCLog::NET, "Disconnecting and discouraging peer %d!\n", peer.m_id);
+    if (m_banman) m_banman->Discourage(pnode.addr);
+    m_connman.DisconnectNode(pnode.addr);
+    return true;
+}
+
+bool PeerManagerImpl::ProcessLightMessage(CNode& pfrom, Peer& peer, const std::string& msg_type, DataStream& vRecv,
+                                          const std::chrono::microseconds time_received)
+{
     if (msg_type == NetMsgType::PING) {
         if (pfrom.GetCommonVersion() > BIP0031_VERSION) {
             uint64_t nonce = 0;
@@ -4754,7 +5040,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // return very quickly.
             MakeAndPushMessage(pfrom, NetMsgType::PONG, nonce);
         }
-        return;
+        return true;
     }
 
     if (msg_type == NetMsgType::PONG) {
@@ -4768,11 +5054,11 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             vRecv >> nonce;
 
             // Only process pong message if there is an outstanding ping (old ping without nonce should never pong)
-            if (peer->m_ping_nonce_sent != 0) {
-                if (nonce == peer->m_ping_nonce_sent) {
+            if (peer.m_ping_nonce_sent != 0) {
+                if (nonce == peer.m_ping_nonce_sent) {
                     // Matching pong received, this ping is no longer outstanding
                     bPingFinished = true;
-                    const auto ping_time = ping_end - peer->m_ping_start.load();
+                    const auto ping_time = ping_end - peer.m_ping_start.load();
                     if (ping_time.count() >= 0) {
                         // Let connman know about this successful ping-pong
                         pfrom.PongReceived(ping_time);
@@ -4802,21 +5088,21 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             LogDebug(BCLog::NET, "pong peer=%d: %s, %x expected, %x received, %u bytes\n",
                 pfrom.GetId(),
                 sProblem,
-                peer->m_ping_nonce_sent,
+                peer.m_ping_nonce_sent,
                 nonce,
                 nAvail);
         }
         if (bPingFinished) {
-            peer->m_ping_nonce_sent = 0;
+            peer.m_ping_nonce_sent = 0;
         }
-        return;
+        return true;
     }
 
     if (msg_type == NetMsgType::FILTERLOAD) {
-        if (!(peer->m_our_services & NODE_BLOOM)) {
+        if (!(peer.m_our_services & NODE_BLOOM)) {
             LogDebug(BCLog::NET, "filterload received despite not offering bloom services, %s\n", pfrom.DisconnectMsg(fLogIPs));
             pfrom.fDisconnect = true;
-            return;
+            return true;
         }
         CBloomFilter filter;
         vRecv >> filter;
@@ -4824,8 +5110,8 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         if (!filter.IsWithinSizeConstraints())
         {
             // There is no excuse for sending a too-large filter
-            Misbehaving(*peer, "too-large bloom filter");
-        } else if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
+            Misbehaving(peer, "too-large bloom filter");
+        } else if (auto tx_relay = peer.GetTxRelay(); tx_relay != nullptr) {
             {
                 LOCK(tx_relay->m_bloom_filter_mutex);
                 tx_relay->m_bloom_filter.reset(new CBloomFilter(filter));
@@ -4834,14 +5120,14 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             pfrom.m_bloom_filter_loaded = true;
             pfrom.m_relays_txs = true;
         }
-        return;
+        return true;
     }
 
     if (msg_type == NetMsgType::FILTERADD) {
-        if (!(peer->m_our_services & NODE_BLOOM)) {
+        if (!(peer.m_our_services & NODE_BLOOM)) {
             LogDebug(BCLog::NET, "filteradd received despite not offering bloom services, %s\n", pfrom.DisconnectMsg(fLogIPs));
             pfrom.fDisconnect = true;
-            return;
+            return true;
         }
         std::vector<unsigned char> vData;
         vRecv >> vData;
@@ -4851,7 +5137,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         bool bad = false;
         if (vData.size() > MAX_SCRIPT_ELEMENT_SIZE) {
             bad = true;
-        } else if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
+        } else if (auto tx_relay = peer.GetTxRelay(); tx_relay != nullptr) {
             LOCK(tx_relay->m_bloom_filter_mutex);
             if (tx_relay->m_bloom_filter) {
                 tx_relay->m_bloom_filter->insert(vData);
@@ -4860,19 +5146,19 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             }
         }
         if (bad) {
-            Misbehaving(*peer, "bad filteradd message");
+            Misbehaving(peer, "bad filteradd message");
         }
-        return;
+        return true;
     }
 
     if (msg_type == NetMsgType::FILTERCLEAR) {
-        if (!(peer->m_our_services & NODE_BLOOM)) {
+        if (!(peer.m_our_services & NODE_BLOOM)) {
             LogDebug(BCLog::NET, "filterclear received despite not offering bloom services, %s\n", pfrom.DisconnectMsg(fLogIPs));
             pfrom.fDisconnect = true;
-            return;
+            return true;
         }
-        auto tx_relay = peer->GetTxRelay();
-        if (!tx_relay) return;
+        auto tx_relay = peer.GetTxRelay();
+        if (!tx_relay) return true;
 
         {
             LOCK(tx_relay->m_bloom_filter_mutex);
@@ -4881,94 +5167,38 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         }
         pfrom.m_bloom_filter_loaded = false;
         pfrom.m_relays_txs = true;
-        return;
+        return true;
     }
 
     if (msg_type == NetMsgType::FEEFILTER) {
         CAmount newFeeFilter = 0;
         vRecv >> newFeeFilter;
         if (MoneyRange(newFeeFilter)) {
-            if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
+            if (auto tx_relay = peer.GetTxRelay(); tx_relay != nullptr) {
                 tx_relay->m_fee_filter_received = newFeeFilter;
             }
             LogDebug(BCLog::NET, "received: feefilter of %s from peer=%d\n", CFeeRate(newFeeFilter).ToString(), pfrom.GetId());
         }
-        return;
-    }
-
-    if (msg_type == NetMsgType::GETCFILTERS) {
-        ProcessGetCFilters(pfrom, *peer, vRecv);
-        return;
-    }
-
-    if (msg_type == NetMsgType::GETCFHEADERS) {
-        ProcessGetCFHeaders(pfrom, *peer, vRecv);
-        return;
-    }
-
-    if (msg_type == NetMsgType::GETCFCHECKPT) {
-        ProcessGetCFCheckPt(pfrom, *peer, vRecv);
-        return;
-    }
-
-    if (msg_type == NetMsgType::NOTFOUND) {
-        std::vector<CInv> vInv;
-        vRecv >> vInv;
-        std::vector<GenTxid> tx_invs;
-        if (vInv.size() <= node::MAX_PEER_TX_ANNOUNCEMENTS + MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
-            for (CInv &inv : vInv) {
-                if (inv.IsGenTxMsg()) {
-                    tx_invs.emplace_back(ToGenTxid(inv));
-                }
-            }
-        }
-        LOCK(m_tx_download_mutex);
-        m_txdownloadman.ReceivedNotFound(pfrom.GetId(), tx_invs);
-        return;
+        return true;
     }
 
-    // Ignore unknown commands for extensibility
-    LogDebug(BCLog::NET, "Unknown command \"%s\" from peer=%d\n", SanitizeString(msg_type), pfrom.GetId());
-    return;
+    return false;
 }
 
-bool PeerManagerImpl::MaybeDiscourageAndDisconnect(CNode& pnode, Peer& peer)
+void PeerManagerImpl::TraceReceivedMessage(const CNode& node, const CNetMessage& msg)
 {
-    {
-        LOCK(peer.m_misbehavior_mutex);
-
-        // There's nothing to do if the m_should_discourage flag isn't set
-        if (!peer.m_should_discourage) return false;
-
-        peer.m_should_discourage = false;
-    } // peer.m_misbehavior_mutex
-
-    if (pnode.HasPermission(NetPermissionFlags::NoBan)) {
-        // We never disconnect or discourage peers for bad behavior if they have NetPermissionFlags::NoBan permission
-        LogPrintf("Warning: not punishing noban peer %d!\n", peer.m_id);
-        return false;
-    }
-
-    if (pnode.IsManualConn()) {
-        // We never disconnect or discourage manual peers for bad behavior
-        LogPrintf("Warning: not punishing manually connected peer %d!\n", peer.m_id);
-        return false;
-    }
+    TRACEPOINT(net, inbound_message,
+        node.GetId(),
+        node.m_addr_name.c_str(),
+        node.ConnectionTypeAsString().c_str(),
+        msg.m_type.c_str(),
+        msg.m_recv.size(),
+        msg.m_recv.data()
+    );
 
-    if (pnode.addr.IsLocal()) {
-        // We disconnect local peers for bad behavior but don't discourage (since that would discourage
-        // all peers on the same local address)
-        LogDebug(BCLog::NET, "Warning: disconnecting but not discouraging %s peer %d!\n",
-                 pnode.m_inbound_onion ? "inbound onion" : "local", peer.m_id);
-        pnode.fDisconnect = true;
-        return true;
+    if (m_opts.capture_messages) {
+        CaptureMessage(node.addr, msg.m_type, MakeUCharSpan(msg.m_recv), /*is_incoming=*/true);
     }
-
-    // Normal case: Disconnect the peer and discourage all nodes sharing the address
-    LogDebug(BCLog::NET, "Disconnecting and discouraging peer %d!\n", peer.m_id);
-    if (m_banman) m_banman->Discourage(pnode.addr);
-    m_connman.DisconnectNode(pnode.addr);
-    return true;
 }
 
 bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgProc)
@@ -5016,18 +5246,7 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     CNetMessage& msg{poll_result->first};
     bool fMoreWork = poll_result->second;
 
-    TRACEPOINT(net, inbound_message,
-        pfrom->GetId(),
-        pfrom->m_addr_name.c_str(),
-        pfrom->ConnectionTypeAsString().c_str(),
-        msg.m_type.c_str(),
-        msg.m_recv.size(),
-        msg.m_recv.data()
-    );
-
-    if (m_opts.capture_messages) {
-        CaptureMessage(pfrom->addr, msg.m_type, MakeUCharSpan(msg.m_recv), /*is_incoming=*/true);
-    }
+    TraceReceivedMessage(*pfrom, msg);
 
     try {
         ProcessMessage(*pfrom, msg.m_type, msg.m_recv, msg.m_time, interruptMsgProc);
@@ -5052,6 +5271,92 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     return fMoreWork;
 }
 
+/** Whether a message can be handled without chain state, see ProcessLightMessages(). */
+static bool IsLightMessage(const std::string& msg_type)
+{
+    return msg_type == NetMsgType::PING || msg_type == NetMsgType::PONG ||
+           msg_type == NetMsgType::FEEFILTER || msg_type == NetMsgType::GETDATA ||
+           msg_type == NetMsgType::FILTERLOAD || msg_type == NetMsgType::FILTERADD ||
+           msg_type == NetMsgType::FILTERCLEAR;
+}
+
+bool PeerManagerImpl::ProcessLightMessages(CNode* pfrom, std::atomic<bool>& interruptMsgProc)
+{
+    AssertLockNotHeld(g_msgproc_mutex);
+    AssertLockHeld(pfrom->m_msg_process_order_mutex);
+
+    PeerRef peer = GetPeerRef(pfrom->GetId());
+    if (peer == nullptr) return false;
+
+    // The version handshake is left to ProcessMessages
+    if (!pfrom->fSuccessfullyConnected || pfrom->fDisconnect) return false;
+
+    {
+        // Reconsidering orphans is part of processing the message that
+        // provided their parent, so it has to finish before the next message.
+        TRY_LOCK(m_tx_download_mutex, tx_download_lock);
+        if (!tx_download_lock || m_txdownloadman.HaveMoreWork(peer->m_id)) return false;
+    }
+
+    // Serve the transaction requests at the front of the getdata queue. Block
+    // requests are left to ProcessMessages, and responses are sent in the
+    // order they were requested.
+    auto serve_tx_requests{[&]() EXCLUSIVE_LOCKS_REQUIRED(peer->m_getdata_requests_mutex) {
+        std::vector<CInv> vNotFound;
+        const auto it{ProcessGetTxData(*pfrom, *peer, vNotFound, interruptMsgProc)};
+        if (interruptMsgProc) return;
+        peer->m_getdata_requests.erase(peer->m_getdata_requests.begin(), it);
+        if (!vNotFound.empty()) MakeAndPushMessage(*pfrom, NetMsgType::NOTFOUND, vNotFound);
+    }};
+
+    {
+        LOCK(peer->m_getdata_requests_mutex);
+        if (!peer->m_getdata_requests.empty()) {
+            serve_tx_requests();
+            if (interruptMsgProc || !peer->m_getdata_requests.empty()) return false;
+        }
+    }
+
+    if (pfrom->fPauseSend) return false;
+
+    auto poll_result{pfrom->PollMessage(IsLightMessage)};
+    if (!poll_result) return false;
+
+    CNetMessage& msg{poll_result->first};
+    bool fMoreWork = poll_result->second;
+
+    TraceReceivedMessage(*pfrom, msg);
+
+    LogDebug(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(msg.m_type), msg.m_recv.size(), pfrom->GetId());
+
+    try {
+        if (msg.m_type == NetMsgType::GETDATA) {
+            std::vector<CInv> vInv;
+            msg.m_recv >> vInv;
+            if (vInv.size() > MAX_INV_SZ) {
+                Misbehaving(*peer, strprintf("getdata message size = %u", vInv.size()));
+                return fMoreWork;
+            }
+
+            LogDebug(BCLog::NET, "received getdata (%u invsz) peer=%d\n", vInv.size(), pfrom->GetId());
+
+            LOCK(peer->m_getdata_requests_mutex);
+            peer->m_getdata_requests.insert(peer->m_getdata_requests.end(), vInv.begin(), vInv.end());
+            serve_tx_requests();
+            if (interruptMsgProc) return false;
+            if (!peer->m_getdata_requests.empty()) m_connman.WakeMessageHandler();
+        } else {
+            ProcessLightMessage(*pfrom, *peer, msg.m_type, msg.m_recv, msg.m_time);
+        }
+    } catch (const std::exception& e) {
+        LogDebug(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size, e.what(), typeid(e).name());
+    } catch (...) {
+        LogDebug(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size);
+    }
+
+    return fMoreWork;
+}
+
 void PeerManagerImpl::ConsiderEviction(CNode& pto, Peer& peer, std::chrono::seconds time_in_seconds)
 {
     AssertLockHeld(cs_main);
@@ -5422,11 +5727,11 @@ class CompareInvMempoolOrder
 public:
     explicit CompareInvMempoolOrder(CTxMemPool* mempool) : m_mempool{mempool} {}
 
-    bool operator()(std::set<Wtxid>::iterator a, std::set<Wtxid>::iterator b)
+    bool operator()(const Wtxid& a, const Wtxid& b)
     {
         /* As std::make_heap produces a max-heap, we want the entries with the
          * fewest ancestors/highest fee to sort later. */
-        return m_mempool->CompareDepthAndScore(*b, *a);
+        return m_mempool->CompareDepthAndScore(b, a);
     }
 };
 } // namespace
@@ -5635,7 +5940,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     {
                         LOCK(m_most_recent_block_mutex);
                         if (m_most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                            cached_cmpctblock_msg = NetMsg::Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block);
+                            cached_cmpctblock_msg = m_most_recent_compact_block_msg.Copy();
                         }
                     }
                     if (cached_cmpctblock_msg.has_value()) {
@@ -5729,6 +6034,20 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     if (!tx_relay->m_relay_txs) tx_relay->m_tx_inventory_to_send.clear();
                 }
 
+                if (m_txreconciliation) {
+                    // Start reconciliation rounds on our own schedule, and
+                    // answer those the peer starts with our trickle, as the
+                    // sketch reveals what we would otherwise announce.
+                    if (const auto request{m_txreconciliation->InitiateReconciliationRequest(pto->GetId(), current_time)}) {
+                        MakeAndPushMessage(*pto, NetMsgType::REQRECON, request->first, request->second);
+                    }
+                    if (fSendTrickle) {
+                        while (const auto sketch{m_txreconciliation->RespondToReconciliationRequest(pto->GetId())}) {
+                            MakeAndPushMessage(*pto, NetMsgType::SKETCH, *sketch);
+                        }
+                    }
+                }
+
                 // Respond to BIP35 mempool requests
                 if (fSendTrickle && tx_relay->m_send_mempool) {
                     auto vtxinfo = m_mempool.infoAll();
@@ -5743,7 +6062,6 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         const auto inv = peer->m_wtxid_relay ?
                                              CInv{MSG_WTX, wtxid.ToUint256()} :
                                              CInv{MSG_TX, txid.ToUint256()};
-                        tx_relay->m_tx_inventory_to_send.erase(wtxid);
 
                         // Don't send transactions that peers will not put into their mempool
                         if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
@@ -5763,35 +6081,23 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
 
                 // Determine transactions to relay
                 if (fSendTrickle) {
-                    // Produce a vector with all candidates for sending
-                    std::vector<std::set<Wtxid>::iterator> vInvTx;
-                    vInvTx.reserve(tx_relay->m_tx_inventory_to_send.size());
-                    for (std::set<Wtxid>::iterator it = tx_relay->m_tx_inventory_to_send.begin(); it != tx_relay->m_tx_inventory_to_send.end(); it++) {
-                        vInvTx.push_back(it);
-                    }
                     const CFeeRate filterrate{tx_relay->m_fee_filter_received.load()};
-                    // Topologically and fee-rate sort the inventory we send for privacy and priority reasons.
-                    // A heap is used so that not all items need sorting if only a few are being sent.
-                    CompareInvMempoolOrder compareInvMempoolOrder(&m_mempool);
-                    std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
                     // No reason to drain out at many times the network's capacity,
                     // especially since we have many peers and some will draw much shorter delays.
-                    unsigned int nRelayedTransactions = 0;
                     LOCK(tx_relay->m_bloom_filter_mutex);
                     size_t broadcast_max{INVENTORY_BROADCAST_TARGET + (tx_relay->m_tx_inventory_to_send.size()/1000)*5};
                     broadcast_max = std::min<size_t>(INVENTORY_BROADCAST_MAX, broadcast_max);
-                    while (!vInvTx.empty() && nRelayedTransactions < broadcast_max) {
-                        // Fetch the top element from the heap
-                        std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
-                        std::set<Wtxid>::iterator it = vInvTx.back();
-                        vInvTx.pop_back();
-                        auto wtxid = *it;
-                        // Remove it from the to-be-sent set
-                        tx_relay->m_tx_inventory_to_send.erase(it);
+                    // If everything queued fits, it is taken with a linear
+                    // scan. Otherwise the topologically first, highest feerate
+                    // transactions are picked with a heap. Transactions
+                    // answered from a BIP35 mempool request above are dropped
+                    // by the known filter check.
+                    std::vector<std::pair<Wtxid, CInv>> to_announce;
+                    tx_relay->m_tx_inventory_to_send.Pop(broadcast_max, CompareInvMempoolOrder{&m_mempool}, [&](const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(tx_relay->m_tx_inventory_mutex, tx_relay->m_bloom_filter_mutex) {
                         // Not in the mempool anymore? don't bother sending it.
                         auto txinfo = m_mempool.info(wtxid);
                         if (!txinfo.tx) {
-                            continue;
+                            return false;
                         }
                         // `TxRelay::m_tx_inventory_known_filter` contains either txids or wtxids
                         // depending on whether our peer supports wtxid-relay. Therefore, first
@@ -5801,25 +6107,33 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                                              CInv{MSG_TX, txinfo.tx->GetHash().ToUint256()};
                         // Check if not in the filter already
                         if (tx_relay->m_tx_inventory_known_filter.contains(inv.hash)) {
-                            continue;
+                            return false;
                         }
                         // Peer told you to not send transactions at that feerate? Don't bother sending it.
                         if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
-                            continue;
+                            return false;
                         }
-                        if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) continue;
-                        // Send
+                        if (tx_relay->m_bloom_filter && !tx_relay->m_bloom_filter->IsRelevantAndUpdate(*txinfo.tx)) return false;
+                        tx_relay->m_tx_inventory_known_filter.insert(inv.hash);
+                        to_announce.emplace_back(wtxid, inv);
+                        return true;
+                    });
+
+                    LOCK(m_mempool.cs);
+                    // Topologically and fee-rate sort the announcements, so
+                    // that their order does not reveal the order of arrival.
+                    std::sort(to_announce.begin(), to_announce.end(), [&](const auto& a, const auto& b) {
+                        return m_mempool.CompareDepthAndScore(a.first, b.first);
+                    });
+                    for (const auto& [wtxid, inv] : to_announce) {
                         vInv.push_back(inv);
-                        nRelayedTransactions++;
                         if (vInv.size() == MAX_INV_SZ) {
                             MakeAndPushMessage(*pto, NetMsgType::INV, vInv);
                             vInv.clear();
                         }
-                        tx_relay->m_tx_inventory_known_filter.insert(inv.hash);
                     }
 
                     // Ensure we'll respond to GETDATA requests for anything we've just announced
-                    LOCK(m_mempool.cs);
                     tx_relay->m_last_inv_sequence = m_mempool.GetSequence();
                 }
         }
@@ -5897,13 +6211,30 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        const size_t max_blocks_in_flight{m_block_download_scheduler.GetMaxBlocksInFlight(pto->GetId())};
+        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < max_blocks_in_flight) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            auto get_inflight_budget = [&state]() {
-                return std::max(0, MAX_BLOCKS_IN_TRANSIT_PER_PEER - static_cast<int>(state.vBlocksInFlight.size()));
+            auto get_inflight_budget = [&state, max_blocks_in_flight]() {
+                return max_blocks_in_flight - std::min(max_blocks_in_flight, state.vBlocksInFlight.size());
             };
 
+            // First take over the lowest blocks in flight that this peer is
+            // expected to deliver much earlier than the peers they are
+            // requested from, before those hold up the download window.
+            for (const uint256& hash : m_block_download_scheduler.GetBlocksToRerequest(pto->GetId(), get_inflight_budget(), current_time)) {
+                const CBlockIndex* pindex{m_chainman.m_blockman.LookupBlockIndex(hash)};
+                if (!pindex || pindex->nStatus & BLOCK_HAVE_DATA || !state.pindexBestKnownBlock ||
+                    state.pindexBestKnownBlock->GetAncestor(pindex->nHeight) != pindex ||
+                    (!CanServeWitnesses(*peer) && DeploymentActiveAt(*pindex, m_chainman, Consensus::DEPLOYMENT_SEGWIT))) {
+                    continue;
+                }
+                vGetData.emplace_back(MSG_BLOCK | GetFetchFlags(*peer), hash);
+                BlockRequested(pto->GetId(), *pindex);
+                LogDebug(BCLog::NET, "Requesting block %s (%d) peer=%d, expected earlier than from the peer it is in flight from\n",
+                    hash.ToString(), pindex->nHeight, pto->GetId());
+            }
+
             // If a snapshot chainstate is in use, we want to find its next blocks
             // before the background chainstate to prioritize getting to network tip.
             FindNextBlocksToDownload(*peer, get_inflight_budget(), vToDownload, staller);
@@ -0,0 +1,173 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/blockdownloadscheduler.h>
+
+#include <util/time.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace node {
+namespace {
+/** Weight of a new sample in the exponential averages. */
+constexpr double SAMPLE_WEIGHT{0.25};
+/** Shortest delivery time a sample is counted with, as deliveries are timed when processed. */
+constexpr std::chrono::microseconds MIN_DELIVERY_TIME{1ms};
+
+double Average(double avg, double sample)
+{
+    return avg + (sample - avg) * SAMPLE_WEIGHT;
+}
+
+std::chrono::duration<double> ToSeconds(std::chrono::microseconds t)
+{
+    return std::chrono::duration<double>{t};
+}
+} // namespace
+
+void BlockDownloadScheduler::BlockRequested(NodeId peer, const uint256& hash, int height, std::chrono::microseconds now)
+{
+    PeerInfo& info{m_peers[peer]};
+    if (std::ranges::any_of(info.requests, [&](const Request& req) { return req.hash == hash; })) return;
+    info.requests.push_back({hash, now, /*idle=*/info.requests.empty()});
+
+    const auto [it, inserted]{m_blocks.try_emplace(hash, BlockInfo{height, {}})};
+    if (inserted) m_by_height.emplace(height, hash);
+    it->second.peers.push_back(peer);
+}
+
+void BlockDownloadScheduler::BlockReceived(NodeId peer, const uint256& hash, size_t bytes, std::chrono::microseconds now)
+{
+    const auto peer_it{m_peers.find(peer)};
+    if (peer_it == m_peers.end()) return;
+    PeerInfo& info{peer_it->second};
+    const auto req{std::ranges::find(info.requests, hash, &Request::hash)};
+    if (req == info.requests.end()) return;
+
+    m_avg_block_bytes = m_avg_block_bytes == 0 ? bytes : Average(m_avg_block_bytes, bytes);
+    if (const auto block_it{m_blocks.find(hash)}; block_it != m_blocks.end() && !block_it->second.delivered) {
+        block_it->second.delivered = std::make_pair(peer, now);
+    }
+
+    // The peer could not start sending this block before it was requested,
+    // nor (as peers answer requests in order) before the previous delivery.
+    const auto start{std::max(req->requested, info.last_delivery)};
+    const double seconds{ToSeconds(std::max(now - start, MIN_DELIVERY_TIME)).count()};
+    if (!info.stats) {
+        // Attribute the first delivery to throughput alone. Later ones correct
+        // the underestimate if it included latency.
+        info.stats = BlockDownloadStats{.bytes_per_second = bytes / seconds, .latency = 0us};
+    } else if (req->idle) {
+        const double transfer{bytes / info.stats->bytes_per_second};
+        const double latency{std::max(0.0, seconds - transfer)};
+        info.stats->latency = std::chrono::microseconds{std::llround(Average(ToSeconds(info.stats->latency).count(), latency) * 1e6)};
+    } else {
+        info.stats->bytes_per_second = Average(info.stats->bytes_per_second, bytes / seconds);
+    }
+    info.last_delivery = now;
+}
+
+void BlockDownloadScheduler::RequestRemoved(NodeId peer, const uint256& hash)
+{
+    const auto block_it{m_blocks.find(hash)};
+    if (const auto peer_it{m_peers.find(peer)}; peer_it != m_peers.end()) {
+        PeerInfo& info{peer_it->second};
+        const auto req{std::ranges::find(info.requests, hash, &Request::hash)};
+        if (req == info.requests.end()) return;
+        // If another peer delivered the block while this one was sending it,
+        // this one is at most as fast as the time it had so far.
+        if (req == info.requests.begin() && block_it != m_blocks.end() && block_it->second.delivered &&
+            block_it->second.delivered->first != peer) {
+            const auto delivered_at{block_it->second.delivered->second};
+            const auto start{std::max(req->requested, info.last_delivery)};
+            const double bound{m_avg_block_bytes / ToSeconds(std::max(delivered_at - start, MIN_DELIVERY_TIME)).count()};
+            if (!info.stats) {
+                info.stats = BlockDownloadStats{.bytes_per_second = bound, .latency = 0us};
+            } else if (bound < info.stats->bytes_per_second) {
+                info.stats->bytes_per_second = Average(info.stats->bytes_per_second, bound);
+            }
+        }
+        info.requests.erase(req);
+    }
+    if (block_it == m_blocks.end()) return;
+    std::erase(block_it->second.peers, peer);
+    if (block_it->second.peers.empty()) {
+        m_by_height.erase({block_it->second.height, hash});
+        m_blocks.erase(block_it);
+    }
+}
+
+void BlockDownloadScheduler::PeerDisconnected(NodeId peer)
+{
+    const auto peer_it{m_peers.find(peer)};
+    if (peer_it == m_peers.end()) return;
+    // Copy, as RequestRemoved() modifies the requests.
+    const std::vector<Request> requests{peer_it->second.requests};
+    for (const Request& req : requests) {
+        RequestRemoved(peer, req.hash);
+    }
+    m_peers.erase(peer);
+}
+
+size_t BlockDownloadScheduler::GetMaxBlocksInFlight(NodeId peer) const
+{
+    const auto peer_it{m_peers.find(peer)};
+    if (peer_it == m_peers.end() || !peer_it->second.stats) return DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER;
+    const BlockDownloadStats& stats{*peer_it->second.stats};
+    // Enough blocks to cover the latency (the bandwidth-delay product), plus
+    // a queue to keep the peer busy while we process its deliveries.
+    const double blocks_per_second{stats.bytes_per_second / m_avg_block_bytes};
+    const double target{blocks_per_second * ToSeconds(stats.latency + BLOCK_QUEUE_TARGET_TIME).count()};
+    return std::clamp<size_t>(std::ceil(std::min(target, double(MAX_BLOCKS_IN_FLIGHT_PER_PEER))), MIN_BLOCKS_IN_FLIGHT_PER_PEER, MAX_BLOCKS_IN_FLIGHT_PER_PEER);
+}
+
+std::chrono::microseconds BlockDownloadScheduler::ExpectedDelivery(const PeerInfo& info, size_t pos, std::chrono::microseconds now) const
+{
+    const BlockDownloadStats& stats{*info.stats};
+    const auto per_block{std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>{m_avg_block_bytes / stats.bytes_per_second})};
+    auto start{now + stats.latency};
+    if (!info.requests.empty()) {
+        const Request& front{info.requests.front()};
+        start = std::max(front.requested, info.last_delivery);
+        if (front.idle && front.requested >= info.last_delivery) start += stats.latency;
+    }
+    // A delivery that is overdue is expected any moment.
+    return std::max<std::chrono::microseconds>(start + per_block * (pos + 1), now);
+}
+
+std::vector<uint256> BlockDownloadScheduler::GetBlocksToRerequest(NodeId peer, size_t max, std::chrono::microseconds now) const
+{
+    std::vector<uint256> ret;
+    const auto peer_it{m_peers.find(peer)};
+    if (peer_it == m_peers.end() || !peer_it->second.stats) return ret;
+    const PeerInfo& self{peer_it->second};
+
+    size_t examined{0};
+    for (const auto& [height, hash] : m_by_height) {
+        if (ret.size() >= max || examined++ >= BLOCK_REREQUEST_LOOKAHEAD) break;
+        const BlockInfo& block{m_blocks.at(hash)};
+        if (block.peers.size() != 1 || block.peers.front() == peer) continue;
+
+        const PeerInfo& other{m_peers.at(block.peers.front())};
+        const auto req{std::ranges::find(other.requests, hash, &Request::hash)};
+        const size_t pos(req - other.requests.begin());
+        // Without measurements, expect a block to take as long again as it
+        // has been in flight.
+        const auto other_eta{other.stats ? ExpectedDelivery(other, pos, now) : now + (now - req->requested)};
+        const auto self_eta{ExpectedDelivery(self, self.requests.size() + ret.size(), now)};
+        if (other_eta - self_eta >= BLOCK_REREQUEST_MIN_GAIN && other_eta - now >= BLOCK_REREQUEST_SPEEDUP * (self_eta - now)) {
+            ret.push_back(hash);
+        }
+    }
+    return ret;
+}
+
+std::optional<BlockDownloadStats> BlockDownloadScheduler::GetStats(NodeId peer) const
+{
+    const auto peer_it{m_peers.find(peer)};
+    if (peer_it == m_peers.end()) return std::nullopt;
+    return peer_it->second.stats;
+}
+} // namespace node
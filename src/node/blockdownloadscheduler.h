@@ -0,0 +1,128 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCKDOWNLOADSCHEDULER_H
+#define BITCOIN_NODE_BLOCKDOWNLOADSCHEDULER_H
+
+#include <net.h>
+#include <uint256.h>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace node {
+/** Number of blocks in flight from a peer whose throughput has not been measured yet. */
+static constexpr size_t DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER{16};
+/** Fewest blocks in flight from a measured peer, so that its pipeline does not drain between blocks. */
+static constexpr size_t MIN_BLOCKS_IN_FLIGHT_PER_PEER{2};
+/** Most blocks in flight from a measured peer. */
+static constexpr size_t MAX_BLOCKS_IN_FLIGHT_PER_PEER{64};
+/** How much delivery time, on top of its latency, to keep requested from a peer. */
+static constexpr std::chrono::milliseconds BLOCK_QUEUE_TARGET_TIME{2000};
+/** Only blocks among this many of the lowest in flight are re-requested from another peer. */
+static constexpr size_t BLOCK_REREQUEST_LOOKAHEAD{16};
+/** A block is re-requested if another peer is expected to deliver it this much earlier... */
+static constexpr std::chrono::milliseconds BLOCK_REREQUEST_MIN_GAIN{2000};
+/** ...and at least this many times as fast. */
+static constexpr int BLOCK_REREQUEST_SPEEDUP{3};
+
+/** Download performance of a peer, as measured from the blocks it delivered. */
+struct BlockDownloadStats {
+    /** Delivered bytes per second while the peer had requests outstanding. */
+    double bytes_per_second;
+    /** Time from requesting a block from an idle peer to the start of its delivery. */
+    std::chrono::microseconds latency;
+};
+
+/**
+ * Sizes the number of blocks requested from each peer from measurements of
+ * its delivered bytes per second and latency, and finds the blocks to request
+ * from a fast peer again before slow peers stall the block download window.
+ *
+ * Every block request and its outcome must be passed on, so that the blocks
+ * in flight here match those of PeerManager. Only blocks in flight from a
+ * single peer are re-requested, so that a block is downloaded twice at most.
+ *
+ * Deliveries are timed from when the peer could start sending a block: its
+ * request, or the delivery of the block before it if that came later. Timings
+ * of blocks requested while the peer had nothing else in flight include the
+ * request latency, the others estimate throughput. A peer that was still
+ * sending a block when another peer delivered it is at most as fast as that
+ * took; this measures peers whose blocks are always taken over.
+ *
+ * Not thread safe; the caller must synchronize access.
+ */
+class BlockDownloadScheduler
+{
+public:
+    /** Record that a block was requested from a peer. */
+    void BlockRequested(NodeId peer, const uint256& hash, int height, std::chrono::microseconds now);
+
+    /** Record that a peer delivered a requested block of the given serialized size. Call before RequestRemoved(). */
+    void BlockReceived(NodeId peer, const uint256& hash, size_t bytes, std::chrono::microseconds now);
+
+    /** Record that a block is no longer in flight from a peer, whether delivered, failed or superseded. */
+    void RequestRemoved(NodeId peer, const uint256& hash);
+
+    /** Forget a peer and its requests. */
+    void PeerDisconnected(NodeId peer);
+
+    /** How many blocks should be in flight from a peer. */
+    size_t GetMaxBlocksInFlight(NodeId peer) const;
+
+    /**
+     * Blocks in flight from other peers, among the BLOCK_REREQUEST_LOOKAHEAD
+     * lowest, which this peer is expected to deliver much earlier. Lowest
+     * first, at most max of them.
+     */
+    std::vector<uint256> GetBlocksToRerequest(NodeId peer, size_t max, std::chrono::microseconds now) const;
+
+    /** The measured performance of a peer, if it delivered a block yet. */
+    std::optional<BlockDownloadStats> GetStats(NodeId peer) const;
+
+    /** Number of distinct blocks in flight. */
+    size_t CountInFlight() const { return m_blocks.size(); }
+
+private:
+    struct Request {
+        uint256 hash;
+        std::chrono::microseconds requested;
+        /** Whether nothing else was in flight from the peer when requested */
+        bool idle;
+    };
+
+    struct PeerInfo {
+        /** Blocks in flight, in request order */
+        std::vector<Request> requests;
+        /** When the peer last delivered a block */
+        std::chrono::microseconds last_delivery{0};
+        std::optional<BlockDownloadStats> stats;
+    };
+
+    struct BlockInfo {
+        int height;
+        /** The peers the block is in flight from, original first */
+        std::vector<NodeId> peers;
+        /** The peer that delivered the block and when, once one did */
+        std::optional<std::pair<NodeId, std::chrono::microseconds>> delivered{};
+    };
+
+    /** Expected time to deliver the block at position pos of the peer's requests, or of a new request at the end. */
+    std::chrono::microseconds ExpectedDelivery(const PeerInfo& info, size_t pos, std::chrono::microseconds now) const;
+
+    /** Serialized size of received blocks, exponentially averaged. */
+    double m_avg_block_bytes{0};
+    std::map<NodeId, PeerInfo> m_peers;
+    std::map<uint256, BlockInfo> m_blocks;
+    /** The keys of m_blocks, by height */
+    std::set<std::pair<int, uint256>> m_by_height;
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCKDOWNLOADSCHEDULER_H
@@ -863,9 +863,11 @@ class BlockTemplateImpl : public BlockTemplate
 public:
     explicit BlockTemplateImpl(BlockAssembler::Options assemble_options,
                                std::unique_ptr<CBlockTemplate> block_template,
-                               NodeContext& node) : m_assemble_options(std::move(assemble_options)),
-                                                    m_block_template(std::move(block_template)),
-                                                    m_node(node)
+                               NodeContext& node,
+                               std::vector<CTransactionRef> previous_txs = {}) : m_assemble_options(std::move(assemble_options)),
+                                                                                 m_block_template(std::move(block_template)),
+                                                                                 m_previous_txs(std::move(previous_txs)),
+                                                                                 m_node(node)
     {
         assert(m_block_template);
     }
@@ -919,14 +921,23 @@ public:
     std::unique_ptr<BlockTemplate> waitNext(BlockWaitOptions options) override
     {
         auto new_template = WaitAndCreateNewBlock(chainman(), notifications(), m_node.mempool.get(), m_block_template, options, m_assemble_options);
-        if (new_template) return std::make_unique<BlockTemplateImpl>(m_assemble_options, std::move(new_template), m_node);
+        if (new_template) return std::make_unique<BlockTemplateImpl>(m_assemble_options, std::move(new_template), m_node,
+                                                                    std::vector<CTransactionRef>{m_block_template->block.vtx.begin() + 1, m_block_template->block.vtx.end()});
         return nullptr;
     }
 
+    BlockTemplateDelta getDelta() override
+    {
+        return GetBlockTemplateDelta(m_previous_txs, *m_block_template);
+    }
+
     const BlockAssembler::Options m_assemble_options;
 
     const std::unique_ptr<CBlockTemplate> m_block_template;
 
+    //! Non-coinbase transactions of the template this one was derived from.
+    const std::vector<CTransactionRef> m_previous_txs;
+
     ChainstateManager& chainman() { return *Assert(m_node.chainman); }
     KernelNotifications& notifications() { return *Assert(m_node.notifications); }
     NodeContext& m_node;
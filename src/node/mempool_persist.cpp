@@ -4,11 +4,15 @@
 
 #include <node/mempool_persist.h>
 
+#include <checkqueue.h>
 #include <clientversion.h>
+#include <coins.h>
 #include <consensus/amount.h>
 #include <logging.h>
+#include <policy/policy.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <script/interpreter.h>
 #include <serialize.h>
 #include <streams.h>
 #include <sync.h>
@@ -22,6 +26,7 @@
 #include <util/time.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <exception>
@@ -29,6 +34,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -40,6 +46,68 @@ namespace node {
 static const uint64_t MEMPOOL_DUMP_VERSION_NO_XOR_KEY{1};
 static const uint64_t MEMPOOL_DUMP_VERSION{2};
 
+//! Number of transactions read from the file before their scripts are verified in parallel.
+static constexpr size_t MEMPOOL_LOAD_BATCH_SIZE{1000};
+
+struct LoadedMempoolTx {
+    CTransactionRef tx;
+    int64_t nTime;
+    int64_t nFeeDelta;
+};
+
+/**
+ * Verify the scripts of a batch of loaded transactions on the script check
+ * queue, storing valid signatures in the signature cache. The serial
+ * AcceptToMemoryPool calls that follow then mostly hit the cache instead of
+ * verifying every signature on a single thread.
+ *
+ * This is only an optimization: results are ignored and transactions with
+ * missing inputs or invalid scripts are left for AcceptToMemoryPool to reject.
+ *
+ * The checks run on the shared validation check queue, so a block connected
+ * while a batch is being verified waits for the batch to finish before its own
+ * script checks can start. MEMPOOL_LOAD_BATCH_SIZE bounds that wait.
+ */
+static void PreVerifyScripts(Chainstate& active_chainstate, const CTxMemPool& pool, std::span<const LoadedMempoolTx> batch)
+{
+    ChainstateManager& chainman{active_chainstate.m_chainman};
+    auto& queue{chainman.GetCheckQueue()};
+    if (!queue.HasThreads()) return;
+
+    // Must outlive the checks, which keep pointers into it.
+    std::vector<PrecomputedTransactionData> txsdata(batch.size());
+    std::vector<CScriptCheck> checks;
+    {
+        // Look up the coins of the whole batch under a single lock, making
+        // outputs of earlier transactions in the batch available to later ones.
+        LOCK2(::cs_main, pool.cs);
+        CCoinsViewMemPool view{&active_chainstate.CoinsTip(), pool};
+        for (size_t i{0}; i < batch.size(); ++i) {
+            const CTransaction& tx{*batch[i].tx};
+            if (tx.IsCoinBase()) continue;
+            std::vector<CTxOut> spent_outputs;
+            spent_outputs.reserve(tx.vin.size());
+            for (const CTxIn& txin : tx.vin) {
+                const auto coin{view.GetCoin(txin.prevout)};
+                if (!coin) break;
+                spent_outputs.push_back(coin->out);
+            }
+            view.PackageAddTransaction(batch[i].tx);
+            if (spent_outputs.size() != tx.vin.size()) continue;
+
+            txsdata[i].Init(tx, std::move(spent_outputs));
+            for (unsigned int in{0}; in < tx.vin.size(); ++in) {
+                checks.emplace_back(txsdata[i].m_spent_outputs[in], tx, chainman.m_validation_cache.m_signature_cache,
+                                    in, STANDARD_SCRIPT_VERIFY_FLAGS, /*cacheIn=*/true, &txsdata[i]);
+            }
+        }
+    }
+
+    CCheckQueueControl<CScriptCheck> control{queue};
+    control.Add(std::move(checks));
+    (void)control.Complete();
+}
+
 bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active_chainstate, ImportMempoolOptions&& opts)
 {
     if (load_path.empty()) return false;
@@ -76,51 +144,73 @@ bool LoadMempool(CTxMemPool& pool, const fs::path& load_path, Chainstate& active
         uint64_t txns_tried = 0;
         LogInfo("Loading %u mempool transactions from file...\n", total_txns_to_load);
         int next_tenth_to_report = 0;
-        while (txns_tried < total_txns_to_load) {
-            const int percentage_done(100.0 * txns_tried / total_txns_to_load);
-            if (next_tenth_to_report < percentage_done / 10) {
-                LogInfo("Progress loading mempool transactions from file: %d%% (tried %u, %u remaining)\n",
-                        percentage_done, txns_tried, total_txns_to_load - txns_tried);
-                next_tenth_to_report = percentage_done / 10;
-            }
-            ++txns_tried;
-
-            CTransactionRef tx;
-            int64_t nTime;
-            int64_t nFeeDelta;
-            file >> TX_WITH_WITNESS(tx);
-            file >> nTime;
-            file >> nFeeDelta;
+        // Accept a batch of loaded transactions one by one. Returns false if
+        // loading was interrupted.
+        auto accept_batch{[&](std::vector<LoadedMempoolTx>& batch) {
+            PreVerifyScripts(active_chainstate, pool, batch);
+
+            for (auto& [tx, nTime, nFeeDelta] : batch) {
+                const int percentage_done(100.0 * txns_tried / total_txns_to_load);
+                if (next_tenth_to_report < percentage_done / 10) {
+                    LogInfo("Progress loading mempool transactions from file: %d%% (tried %u, %u remaining)\n",
+                            percentage_done, txns_tried, total_txns_to_load - txns_tried);
+                    next_tenth_to_report = percentage_done / 10;
+                }
+                ++txns_tried;
 
-            if (opts.use_current_time) {
-                nTime = TicksSinceEpoch<std::chrono::seconds>(now);
-            }
+                if (opts.use_current_time) {
+                    nTime = TicksSinceEpoch<std::chrono::seconds>(now);
+                }
 
-            CAmount amountdelta = nFeeDelta;
-            if (amountdelta && opts.apply_fee_delta_priority) {
-                pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
-            }
-            if (nTime > TicksSinceEpoch<std::chrono::seconds>(now - pool.m_opts.expiry)) {
-                LOCK(cs_main);
-                const auto& accepted = AcceptToMemoryPool(active_chainstate, tx, nTime, /*bypass_limits=*/false, /*test_accept=*/false);
-                if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
-                    ++count;
-                } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(tx->GetHash())) {
-                        ++already_there;
+                CAmount amountdelta = nFeeDelta;
+                if (amountdelta && opts.apply_fee_delta_priority) {
+                    pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
+                }
+                if (nTime > TicksSinceEpoch<std::chrono::seconds>(now - pool.m_opts.expiry)) {
+                    LOCK(cs_main);
+                    const auto& accepted = AcceptToMemoryPool(active_chainstate, tx, nTime, /*bypass_limits=*/false, /*test_accept=*/false);
+                    if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
+                        ++count;
                     } else {
-                        ++failed;
+                        // mempool may contain the transaction already, e.g. from
+                        // wallet(s) having loaded it while we were processing
+                        // mempool transactions; consider these as valid, instead of
+                        // failed, but mark them as 'already there'
+                        if (pool.exists(tx->GetHash())) {
+                            ++already_there;
+                        } else {
+                            ++failed;
+                        }
                     }
+                } else {
+                    ++expired;
+                }
+                if (active_chainstate.m_chainman.m_interrupt)
+                    return false;
+            }
+            return true;
+        }};
+
+        while (txns_tried < total_txns_to_load) {
+            // Read a batch of transactions and warm the signature cache for
+            // them in parallel before accepting them one by one.
+            std::vector<LoadedMempoolTx> batch;
+            batch.reserve(std::min<uint64_t>(total_txns_to_load - txns_tried, MEMPOOL_LOAD_BATCH_SIZE));
+            try {
+                while (batch.size() < MEMPOOL_LOAD_BATCH_SIZE && txns_tried + batch.size() < total_txns_to_load) {
+                    LoadedMempoolTx entry;
+                    file >> TX_WITH_WITNESS(entry.tx);
+                    file >> entry.nTime;
+                    file >> entry.nFeeDelta;
+                    batch.push_back(std::move(entry));
                 }
-            } else {
-                ++expired;
+            } catch (const std::exception&) {
+                // Accept the transactions read before a truncated or corrupt
+                // record, as loading them one at a time would have.
+                accept_batch(batch);
+                throw;
             }
-            if (active_chainstate.m_chainman.m_interrupt)
-                return false;
+            if (!accept_batch(batch)) return false;
         }
         std::map<Txid, CAmount> mapDeltas;
         file >> mapDeltas;
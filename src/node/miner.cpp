@@ -22,12 +22,14 @@
 #include <policy/policy.h>
 #include <pow.h>
 #include <primitives/transaction.h>
+#include <util/hasher.h>
 #include <util/moneystr.h>
 #include <util/signalinterrupt.h>
 #include <util/time.h>
 #include <validation.h>
 
 #include <algorithm>
+#include <unordered_map>
 #include <utility>
 
 namespace node {
@@ -542,6 +544,72 @@ std::unique_ptr<CBlockTemplate> WaitAndCreateNewBlock(ChainstateManager& chainma
     return nullptr;
 }
 
+BlockTemplateDelta GetBlockTemplateDelta(std::span<const CTransactionRef> previous_txs, const CBlockTemplate& new_template)
+{
+    const CBlock& block{new_template.block};
+    Assume(!block.vtx.empty());
+
+    BlockTemplateDelta delta;
+    delta.header = block.GetBlockHeader();
+    delta.coinbase_value = block.vtx[0]->vout[0].nValue;
+    delta.coinbase_commitment = new_template.vchCoinbaseCommitment;
+    delta.coinbase_merkle_path = TransactionMerklePath(block, 0);
+
+    std::unordered_map<Wtxid, uint32_t, SaltedWtxidHasher> previous_positions;
+    previous_positions.reserve(previous_txs.size());
+    for (uint32_t pos{0}; pos < previous_txs.size(); ++pos) {
+        previous_positions.emplace(previous_txs[pos]->GetWitnessHash(), pos);
+    }
+
+    // Greedily keep transactions which appear in the same relative order in
+    // both templates. Anything else is removed from the previous template
+    // and (re-)added at its new position.
+    std::vector<bool> kept(previous_txs.size(), false);
+    int64_t last_kept{-1};
+    for (uint32_t pos{0}; pos + 1 < block.vtx.size(); ++pos) {
+        const CTransactionRef& tx{block.vtx[pos + 1]};
+        const auto it{previous_positions.find(tx->GetWitnessHash())};
+        if (it != previous_positions.end() && int64_t{it->second} > last_kept) {
+            kept[it->second] = true;
+            last_kept = it->second;
+            continue;
+        }
+        delta.added_positions.push_back(pos);
+        delta.added_txs.push_back(tx);
+        delta.added_tx_fees.push_back(new_template.vTxFees[pos]);
+        delta.added_tx_sigops.push_back(new_template.vTxSigOpsCost[pos]);
+    }
+    for (uint32_t pos{0}; pos < previous_txs.size(); ++pos) {
+        if (!kept[pos]) delta.removed_positions.push_back(pos);
+    }
+    return delta;
+}
+
+std::optional<std::vector<CTransactionRef>> ApplyBlockTemplateDelta(std::span<const CTransactionRef> previous_txs, const BlockTemplateDelta& delta)
+{
+    if (delta.added_positions.size() != delta.added_txs.size()) return std::nullopt;
+
+    std::vector<CTransactionRef> txs;
+    txs.reserve(previous_txs.size() + delta.added_txs.size());
+    auto removed{delta.removed_positions.begin()};
+    for (uint32_t pos{0}; pos < previous_txs.size(); ++pos) {
+        if (removed != delta.removed_positions.end() && *removed == pos) {
+            ++removed;
+            continue;
+        }
+        txs.push_back(previous_txs[pos]);
+    }
+    // Positions must be ascending and in range.
+    if (removed != delta.removed_positions.end()) return std::nullopt;
+
+    for (size_t i{0}; i < delta.added_txs.size(); ++i) {
+        const uint32_t pos{delta.added_positions[i]};
+        if (pos > txs.size() || (i > 0 && pos <= delta.added_positions[i - 1])) return std::nullopt;
+        txs.insert(txs.begin() + pos, delta.added_txs[i]);
+    }
+    return txs;
+}
+
 std::optional<BlockRef> GetTip(ChainstateManager& chainman)
 {
     LOCK(::cs_main);
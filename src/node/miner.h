@@ -16,6 +16,8 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
+#include <vector>
 
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/indexed_by.hpp>
@@ -249,6 +251,19 @@ std::unique_ptr<CBlockTemplate> WaitAndCreateNewBlock(ChainstateManager& chainma
                                                       const BlockWaitOptions& options,
                                                       const BlockAssembler::Options& assemble_options);
 
+/**
+ * Compute the changes needed to turn a template with the given non-coinbase
+ * transactions into new_template. Transactions that are retained but change
+ * their relative order are reported as removed and re-added.
+ */
+BlockTemplateDelta GetBlockTemplateDelta(std::span<const CTransactionRef> previous_txs, const CBlockTemplate& new_template);
+
+/**
+ * Apply a delta to the non-coinbase transactions of a previous template.
+ * Returns nullopt if the delta does not fit previous_txs.
+ */
+std::optional<std::vector<CTransactionRef>> ApplyBlockTemplateDelta(std::span<const CTransactionRef> previous_txs, const BlockTemplateDelta& delta);
+
 /* Locks cs_main and returns the block hash and block height of the active chain if it exists; otherwise, returns nullopt.*/
 std::optional<BlockRef> GetTip(ChainstateManager& chainman);
 
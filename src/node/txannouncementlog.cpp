@@ -0,0 +1,219 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txannouncementlog.h>
+
+#include <util/check.h>
+
+#include <algorithm>
+#include <bit>
+#include <optional>
+#include <utility>
+
+namespace node {
+namespace {
+constexpr size_t WORD_BITS{64};
+/** How many entries a queue reads from the log at once. */
+constexpr size_t POP_BATCH_SIZE{256};
+} // namespace
+
+TxAnnouncementLog::Seq TxAnnouncementLog::Append(const Wtxid& wtxid)
+{
+    LOCK(m_mutex);
+    const Seq seq{m_first + m_entries.size()};
+    m_entries.push_back(wtxid);
+    // Without queues to read it, the entry can go right away.
+    Trim();
+    return seq;
+}
+
+TxAnnouncementLog::Seq TxAnnouncementLog::End() const
+{
+    LOCK(m_mutex);
+    return m_first + m_entries.size();
+}
+
+size_t TxAnnouncementLog::Size() const
+{
+    LOCK(m_mutex);
+    return m_entries.size();
+}
+
+TxAnnouncementLog::Cursor TxAnnouncementLog::AddCursor()
+{
+    LOCK(m_mutex);
+    return m_cursors.insert(m_first + m_entries.size());
+}
+
+void TxAnnouncementLog::MoveCursor(Cursor& cursor, Seq seq)
+{
+    LOCK(m_mutex);
+    if (*cursor == seq) return;
+    m_cursors.erase(cursor);
+    cursor = m_cursors.insert(seq);
+    Trim();
+}
+
+void TxAnnouncementLog::RemoveCursor(Cursor cursor)
+{
+    LOCK(m_mutex);
+    m_cursors.erase(cursor);
+    Trim();
+}
+
+void TxAnnouncementLog::Get(std::span<const Seq> seqs, std::vector<Wtxid>& wtxids) const
+{
+    LOCK(m_mutex);
+    wtxids.clear();
+    for (const Seq seq : seqs) {
+        Assume(seq >= m_first && seq - m_first < m_entries.size());
+        wtxids.push_back(m_entries[seq - m_first]);
+    }
+}
+
+void TxAnnouncementLog::Trim()
+{
+    AssertLockHeld(m_mutex);
+    const Seq end{m_first + m_entries.size()};
+    const Seq keep{m_cursors.empty() ? end : *m_cursors.begin()};
+    while (m_first < keep) {
+        m_entries.pop_front();
+        ++m_first;
+    }
+}
+
+TxInventoryQueue::TxInventoryQueue(TxAnnouncementLog& log)
+    : m_log{log},
+      m_log_cursor{log.AddCursor()},
+      m_cursor{*m_log_cursor},
+      m_base{m_cursor - m_cursor % WORD_BITS}
+{
+}
+
+TxInventoryQueue::~TxInventoryQueue()
+{
+    m_log.RemoveCursor(m_log_cursor);
+}
+
+void TxInventoryQueue::Push(TxAnnouncementLog::Seq seq, const Wtxid& wtxid)
+{
+    // The cursor may have passed an entry appended just before a read, which
+    // was queued after it.
+    if (seq < m_cursor) return Push(wtxid);
+    const size_t offset(seq - m_base);
+    if (offset / WORD_BITS >= m_bits.size()) m_bits.resize(offset / WORD_BITS + 1);
+    uint64_t& word{m_bits[offset / WORD_BITS]};
+    const uint64_t bit{uint64_t{1} << (offset % WORD_BITS)};
+    if (!(word & bit)) {
+        word |= bit;
+        ++m_count;
+    }
+}
+
+void TxInventoryQueue::Push(const Wtxid& wtxid)
+{
+    m_unlogged.push_back(wtxid);
+}
+
+void TxInventoryQueue::Peek(size_t max, std::vector<TxAnnouncementLog::Seq>& seqs) const
+{
+    seqs.clear();
+    size_t offset(m_cursor - m_base);
+    for (size_t w{offset / WORD_BITS}; w < m_bits.size() && seqs.size() < max; ++w) {
+        uint64_t word{m_bits[w]};
+        // Mask off the bits before the cursor.
+        if (w == offset / WORD_BITS) word &= ~uint64_t{0} << (offset % WORD_BITS);
+        while (word && seqs.size() < max) {
+            seqs.push_back(m_base + w * WORD_BITS + std::countr_zero(word));
+            word &= word - 1;
+        }
+    }
+}
+
+void TxInventoryQueue::Pop(size_t max, const std::function<bool(const Wtxid&)>& fn)
+{
+    size_t accepted{0};
+    size_t unlogged{0};
+    while (unlogged < m_unlogged.size() && accepted < max) {
+        if (fn(m_unlogged[unlogged++])) ++accepted;
+    }
+    m_unlogged.erase(m_unlogged.begin(), m_unlogged.begin() + unlogged);
+
+    std::vector<TxAnnouncementLog::Seq> seqs;
+    std::vector<Wtxid> wtxids;
+    while (m_count > 0 && accepted < max) {
+        // Copy entries out of the log first, as fn may take other locks.
+        Peek(POP_BATCH_SIZE, seqs);
+        m_log.Get(seqs, wtxids);
+        for (size_t i{0}; i < seqs.size() && accepted < max; ++i) {
+            Unset(seqs[i]);
+            m_cursor = seqs[i] + 1;
+            if (fn(wtxids[i])) ++accepted;
+        }
+    }
+    // Nothing left to read: skip ahead over entries not queued for us.
+    if (m_count == 0) m_cursor = m_log.End();
+    Advance();
+}
+
+void TxInventoryQueue::Pop(size_t max, const std::function<bool(const Wtxid&, const Wtxid&)>& compare, const std::function<bool(const Wtxid&)>& fn)
+{
+    // Everything goes out anyway, so the order of picking does not matter.
+    if (size() <= max) return Pop(max, fn);
+
+    std::vector<TxAnnouncementLog::Seq> seqs;
+    std::vector<Wtxid> wtxids;
+    Peek(m_count, seqs);
+    m_log.Get(seqs, wtxids);
+    std::vector<std::pair<Wtxid, std::optional<TxAnnouncementLog::Seq>>> heap;
+    heap.reserve(size());
+    for (const Wtxid& wtxid : m_unlogged) heap.emplace_back(wtxid, std::nullopt);
+    for (size_t i{0}; i < seqs.size(); ++i) heap.emplace_back(wtxids[i], seqs[i]);
+    m_unlogged.clear();
+
+    const auto heap_compare{[&](const auto& a, const auto& b) { return compare(a.first, b.first); }};
+    std::make_heap(heap.begin(), heap.end(), heap_compare);
+    size_t accepted{0};
+    while (!heap.empty() && accepted < max) {
+        std::pop_heap(heap.begin(), heap.end(), heap_compare);
+        const auto [wtxid, seq]{heap.back()};
+        heap.pop_back();
+        if (seq) Unset(*seq);
+        if (fn(wtxid)) ++accepted;
+    }
+    for (const auto& [wtxid, seq] : heap) {
+        if (!seq) m_unlogged.push_back(wtxid);
+    }
+    // Move the cursor up to the first entry left.
+    Peek(1, seqs);
+    m_cursor = seqs.empty() ? m_log.End() : seqs.front();
+    Advance();
+}
+
+void TxInventoryQueue::Unset(TxAnnouncementLog::Seq seq)
+{
+    const size_t offset(seq - m_base);
+    m_bits[offset / WORD_BITS] &= ~(uint64_t{1} << (offset % WORD_BITS));
+    --m_count;
+}
+
+void TxInventoryQueue::clear()
+{
+    m_bits.clear();
+    m_count = 0;
+    m_unlogged.clear();
+    m_cursor = m_log.End();
+    Advance();
+}
+
+void TxInventoryQueue::Advance()
+{
+    while (!m_bits.empty() && m_base + WORD_BITS <= m_cursor) {
+        m_bits.pop_front();
+        m_base += WORD_BITS;
+    }
+    if (m_bits.empty()) m_base = m_cursor - m_cursor % WORD_BITS;
+    m_log.MoveCursor(m_log_cursor, m_cursor);
+}
+} // namespace node
@@ -0,0 +1,129 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_TXANNOUNCEMENTLOG_H
+#define BITCOIN_NODE_TXANNOUNCEMENTLOG_H
+
+#include <primitives/transaction_identifier.h>
+#include <sync.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <set>
+#include <span>
+#include <vector>
+
+namespace node {
+class TxInventoryQueue;
+
+/**
+ * The transactions to announce to peers, in the order they were relayed,
+ * shared by all peers. Transactions are relayed after their parents, so this
+ * order is topological.
+ *
+ * Each entry has a sequence number. Peers queue entries by number in their
+ * TxInventoryQueue, which reads them from the log with a linear scan. Entries
+ * are dropped once every queue has read past them.
+ *
+ * Thread safe.
+ */
+class TxAnnouncementLog
+{
+public:
+    using Seq = uint64_t;
+
+    /** Append a transaction and return its sequence number. */
+    Seq Append(const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** The sequence number the next appended transaction will get. */
+    Seq End() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Number of entries retained for queues that have not read them yet. */
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    friend class TxInventoryQueue;
+    using Cursor = std::multiset<Seq>::iterator;
+
+    Cursor AddCursor() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void MoveCursor(Cursor& cursor, Seq seq) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void RemoveCursor(Cursor cursor) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Replace wtxids with the entries of seqs, which must not have been dropped. */
+    void Get(std::span<const Seq> seqs, std::vector<Wtxid>& wtxids) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Trim() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    mutable Mutex m_mutex;
+    std::deque<Wtxid> m_entries GUARDED_BY(m_mutex);
+    /** Sequence number of the first entry in m_entries */
+    Seq m_first GUARDED_BY(m_mutex){0};
+    /** Where each queue reads next */
+    std::multiset<Seq> m_cursors GUARDED_BY(m_mutex);
+};
+
+/**
+ * A peer's transactions to announce: the entries of the shared
+ * TxAnnouncementLog queued for it, as a bitmap from its read cursor, and a
+ * list of transactions queued after the cursor passed them.
+ *
+ * Queuing is constant time and reading is a scan in log order, so there is no
+ * per-peer sorting, and a queued entry costs a bit rather than a set node.
+ *
+ * Not thread safe; the caller must synchronize access.
+ */
+class TxInventoryQueue
+{
+public:
+    explicit TxInventoryQueue(TxAnnouncementLog& log);
+    ~TxInventoryQueue();
+    TxInventoryQueue(const TxInventoryQueue&) = delete;
+    TxInventoryQueue& operator=(const TxInventoryQueue&) = delete;
+
+    /** Queue the log entry seq, holding wtxid. */
+    void Push(TxAnnouncementLog::Seq seq, const Wtxid& wtxid);
+
+    /** Queue a transaction without a log entry ahead of the cursor. */
+    void Push(const Wtxid& wtxid);
+
+    /**
+     * Dequeue transactions, those queued without a log entry first and then
+     * in log order, passing each to fn until it accepted max of them or the
+     * queue is empty.
+     */
+    void Pop(size_t max, const std::function<bool(const Wtxid&)>& fn);
+
+    /**
+     * Like Pop() above, but when more than max transactions are queued, pick
+     * them from all queued ones with a max-heap ordered by compare, so that a
+     * backlogged peer gets the best ones rather than the oldest.
+     */
+    void Pop(size_t max, const std::function<bool(const Wtxid&, const Wtxid&)>& compare, const std::function<bool(const Wtxid&)>& fn);
+
+    void clear();
+    size_t size() const { return m_count + m_unlogged.size(); }
+    bool empty() const { return size() == 0; }
+
+private:
+    /** Collect the up to max next queued sequence numbers into seqs. */
+    void Peek(size_t max, std::vector<TxAnnouncementLog::Seq>& seqs) const;
+    /** Unqueue the log entry seq, which must be queued. */
+    void Unset(TxAnnouncementLog::Seq seq);
+    /** Drop the bitmap words before the cursor and let the log trim. */
+    void Advance();
+
+    TxAnnouncementLog& m_log;
+    TxAnnouncementLog::Cursor m_log_cursor;
+    /** The next sequence number to read */
+    TxAnnouncementLog::Seq m_cursor;
+    /** Sequence number of the first bit in m_bits, a multiple of 64 */
+    TxAnnouncementLog::Seq m_base;
+    std::deque<uint64_t> m_bits;
+    /** Number of bits set in m_bits */
+    size_t m_count{0};
+    std::vector<Wtxid> m_unlogged;
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_TXANNOUNCEMENTLOG_H
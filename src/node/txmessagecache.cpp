@@ -0,0 +1,65 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txmessagecache.h>
+
+#include <netmessagemaker.h>
+#include <protocol.h>
+
+namespace node {
+void TxMessageCache::Remove(const Wtxid& wtxid)
+{
+    LOCK(m_mutex);
+    if (const auto it{m_entries.find(wtxid)}; it != m_entries.end()) Erase(it);
+}
+
+CSerializedNetMsg TxMessageCache::GetMessage(const CTransaction& tx, bool with_witness)
+{
+    if (!with_witness && tx.HasWitness()) return NetMsg::Make(NetMsgType::TX, TX_NO_WITNESS(tx));
+
+    {
+        LOCK(m_mutex);
+        if (const auto it{m_entries.find(tx.GetWitnessHash())}; it != m_entries.end()) return it->second.msg.Copy();
+    }
+
+    // Serialize outside the lock, concurrent lookups need not wait for it.
+    CSerializedNetMsg msg{NetMsg::Make(NetMsgType::TX, TX_WITH_WITNESS(tx))};
+    msg.Share();
+    const size_t bytes{msg.GetMemoryUsage()};
+    if (bytes > m_max_bytes) return msg;
+
+    LOCK(m_mutex);
+    const auto [it, inserted]{m_entries.try_emplace(tx.GetWitnessHash())};
+    // Another request may have added the transaction in the meantime.
+    if (!inserted) return it->second.msg.Copy();
+    it->second.msg = msg.Copy();
+    it->second.order_it = m_order.insert(m_order.end(), tx.GetWitnessHash());
+    m_bytes += bytes;
+
+    while (m_bytes > m_max_bytes) {
+        Erase(m_entries.find(m_order.front()));
+    }
+    return msg;
+}
+
+size_t TxMessageCache::Size() const
+{
+    LOCK(m_mutex);
+    return m_entries.size();
+}
+
+size_t TxMessageCache::Bytes() const
+{
+    LOCK(m_mutex);
+    return m_bytes;
+}
+
+void TxMessageCache::Erase(std::unordered_map<Wtxid, Entry, SaltedWtxidHasher>::iterator it)
+{
+    AssertLockHeld(m_mutex);
+    m_bytes -= it->second.msg.GetMemoryUsage();
+    m_order.erase(it->second.order_it);
+    m_entries.erase(it);
+}
+} // namespace node
@@ -0,0 +1,78 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_TXMESSAGECACHE_H
+#define BITCOIN_NODE_TXMESSAGECACHE_H
+
+#include <net.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <util/hasher.h>
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+namespace node {
+/** Default memory budget of the TxMessageCache */
+static constexpr size_t DEFAULT_TX_MESSAGE_CACHE_BYTES{16 << 20};
+
+/**
+ * Bounded cache of relayed transactions serialized as tx messages, keyed by
+ * wtxid.
+ *
+ * A transaction we announce is typically requested by many peers. Answering
+ * from here costs a lookup and a reference to a shared payload (see
+ * CSerializedNetMsg::Share()) instead of a serialization per request.
+ * Transactions are serialized and added on their first request, so those that
+ * are never requested cost nothing, and removed when they leave the mempool.
+ * Above the memory budget the oldest entries are evicted first, which also
+ * drops transactions that were requested after they left the mempool.
+ *
+ * Only the witness serialization is cached. Requests for the serialization
+ * without witness of a transaction that has one, from peers predating segwit,
+ * are served by serializing it anew.
+ *
+ * Thread safe.
+ */
+class TxMessageCache
+{
+public:
+    explicit TxMessageCache(size_t max_bytes = DEFAULT_TX_MESSAGE_CACHE_BYTES) : m_max_bytes{max_bytes} {}
+
+    /** Forget a transaction, e.g. because it left the mempool. */
+    void Remove(const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Get a tx message for a transaction, sharing the cached payload if there
+     * is one. Otherwise serialize the transaction and remember it, evicting the
+     * oldest entries if over budget.
+     */
+    CSerializedNetMsg GetMessage(const CTransaction& tx, bool with_witness) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Number of cached transactions. */
+    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Memory accounted to the cached messages. */
+    size_t Bytes() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Entry {
+        CSerializedNetMsg msg;
+        /** Position in m_order */
+        std::list<Wtxid>::iterator order_it;
+    };
+
+    void Erase(std::unordered_map<Wtxid, Entry, SaltedWtxidHasher>::iterator it) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    const size_t m_max_bytes;
+    mutable Mutex m_mutex;
+    std::unordered_map<Wtxid, Entry, SaltedWtxidHasher> m_entries GUARDED_BY(m_mutex);
+    /** Cached wtxids, oldest first */
+    std::list<Wtxid> m_order GUARDED_BY(m_mutex);
+    size_t m_bytes GUARDED_BY(m_mutex){0};
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_TXMESSAGECACHE_H
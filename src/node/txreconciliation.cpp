@@ -5,10 +5,20 @@
 #include <node/txreconciliation.h>
 
 #include <common/system.h>
+#include <crypto/siphash.h>
 #include <logging.h>
+#include <node/minisketchwrapper.h>
+#include <random.h>
 #include <util/check.h>
 
+#include <minisketch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 
@@ -29,6 +39,24 @@ uint256 ComputeSalt(uint64_t salt1, uint64_t salt2)
     return (HashWriter(RECON_SALT_HASHER) << std::min(salt1, salt2) << std::max(salt1, salt2)).GetSHA256();
 }
 
+/** Bits of the short IDs of transactions in sketches, see BIP-330. */
+constexpr uint32_t RECON_FIELD_SIZE{32};
+/** Serialized size of one element of sketch capacity. */
+constexpr size_t BYTES_PER_SKETCH_CAPACITY{RECON_FIELD_SIZE / 8};
+
+/**
+ * Phase of a reconciliation round with a peer. The initiator goes through INIT_REQUESTED and, if
+ * it asks for an extension, EXT_REQUESTED. The responder goes through INIT_REQUESTED (a request
+ * is pending), INIT_RESPONDED and, if asked for an extension, EXT_RESPONDED.
+ */
+enum class Phase {
+    NONE,
+    INIT_REQUESTED,
+    INIT_RESPONDED,
+    EXT_REQUESTED,
+    EXT_RESPONDED,
+};
+
 /**
  * Keeps track of txreconciliation-related per-peer state.
  */
@@ -36,9 +64,6 @@ class TxReconciliationState
 {
 public:
     /**
-     * TODO: This field is public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * Reconciliation protocol assumes using one role consistently: either a reconciliation
      * initiator (requesting sketches), or responder (sending sketches). This defines our role,
      * based on the direction of the p2p connection.
@@ -47,16 +72,89 @@ public:
     bool m_we_initiate;
 
     /**
-     * TODO: These fields are public to ignore -Wunused-private-field. Make private once used in
-     * the following commits.
-     *
      * These values are used to salt short IDs, which is necessary for transaction reconciliations.
      */
     uint64_t m_k0, m_k1;
 
+    /** Transactions to reconcile in the next round. */
+    std::set<Wtxid> m_local_set;
+
+    /**
+     * Transactions being reconciled in the ongoing round. They are moved here from m_local_set
+     * when the round starts, so that the set stays fixed for a sketch extension.
+     */
+    std::set<Wtxid> m_local_set_snapshot;
+
+    Phase m_phase{Phase::NONE};
+
+    /** Initiator: when to start the next round. */
+    std::chrono::microseconds m_next_request_time{0};
+
+    /** Initiator: when to give up on the ongoing round if the peer has not completed it. */
+    std::chrono::microseconds m_round_expiry{0};
+
+    /** Initiator: the initial sketch received from the peer, kept to be completed by an extension. */
+    std::vector<uint8_t> m_remote_sketch;
+
+    /**
+     * Initiator: number of sketches the peer still owes for rounds we gave up on. As the peer
+     * answers every request in order, these are the next sketches it sends.
+     */
+    uint32_t m_stale_sketches{0};
+
+    /** Responder: set size and q the peer sent in reqrecon. */
+    uint16_t m_remote_set_size{0};
+    uint16_t m_remote_q{0};
+
+    /** Responder: capacity of the initial sketch we sent. */
+    uint32_t m_sketch_capacity{0};
+
+    /** Responder: number of reqrecon the peer sent before we answered the last one. */
+    uint32_t m_stale_requests{0};
+
     TxReconciliationState(bool we_initiate, uint64_t k0, uint64_t k1) : m_we_initiate(we_initiate), m_k0(k0), m_k1(k1) {}
+
+    /** Short ID of a transaction, as defined by BIP-330. */
+    uint32_t ComputeShortID(const Wtxid& wtxid) const
+    {
+        const uint64_t s{SipHashUint256(m_k0, m_k1, wtxid.ToUint256())};
+        return 1 + uint32_t(s % 0xFFFFFFFF);
+    }
+
+    /** Sketch of the short IDs of the transactions in the ongoing round. capacity must not be 0. */
+    Minisketch ComputeSnapshotSketch(uint32_t capacity) const
+    {
+        Minisketch sketch{node::MakeMinisketch32(capacity)};
+        for (const Wtxid& wtxid : m_local_set_snapshot) {
+            sketch.Add(ComputeShortID(wtxid));
+        }
+        return sketch;
+    }
+
+    /** End the ongoing round. */
+    void FinishRound()
+    {
+        m_local_set_snapshot.clear();
+        m_remote_sketch.clear();
+        m_sketch_capacity = 0;
+        m_phase = Phase::NONE;
+    }
 };
 
+/**
+ * Capacity of the sketch to send for a reconciliation round, sized to the estimated set
+ * difference |local - remote| + q * min(local, remote) + 1, as specified by BIP-330.
+ */
+uint32_t EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, uint16_t remote_q)
+{
+    const double q{double(remote_q) / Q_PRECISION};
+    const size_t set_size_diff{local_set_size > remote_set_size ? local_set_size - remote_set_size : remote_set_size - local_set_size};
+    const size_t min_set_size{std::min(local_set_size, remote_set_size)};
+    const size_t estimated_diff{set_size_diff + size_t(q * min_set_size) + 1};
+    const size_t capacity{Minisketch::ComputeCapacity(RECON_FIELD_SIZE, estimated_diff, RECON_FALSE_POSITIVE_COEF)};
+    return std::min<size_t>(capacity, MAX_SKETCH_CAPACITY);
+}
+
 } // namespace
 
 /** Actual implementation for TxReconciliationTracker's data structure. */
@@ -76,6 +174,50 @@ private:
      */
     std::unordered_map<NodeId, std::variant<uint64_t, TxReconciliationState>> m_states GUARDED_BY(m_txreconciliation_mutex);
 
+    /** Keys for picking fanout destinations per transaction. */
+    const uint64_t m_fanout_k0{FastRandomContext().rand64()};
+    const uint64_t m_fanout_k1{FastRandomContext().rand64()};
+
+    TxReconciliationState* GetRegisteredPeerState(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        AssertLockHeld(m_txreconciliation_mutex);
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return nullptr;
+        return std::get_if<TxReconciliationState>(&recon_state->second);
+    }
+
+    /** Conclude a round as the initiator, given the set difference if it was found. */
+    ReconciliationSketchResult FinishInitiatedRound(NodeId peer_id, TxReconciliationState& state,
+                                                    const std::optional<std::vector<uint64_t>>& difference)
+        EXCLUSIVE_LOCKS_REQUIRED(m_txreconciliation_mutex)
+    {
+        AssertLockHeld(m_txreconciliation_mutex);
+        ReconciliationSketchResult result;
+        result.valid = true;
+        if (difference) {
+            std::unordered_map<uint32_t, Wtxid> local_short_ids;
+            for (const Wtxid& wtxid : state.m_local_set_snapshot) {
+                local_short_ids.emplace(state.ComputeShortID(wtxid), wtxid);
+            }
+            result.success = true;
+            for (const uint64_t short_id : *difference) {
+                if (const auto it{local_short_ids.find(short_id)}; it != local_short_ids.end()) {
+                    result.announce.push_back(it->second);
+                } else {
+                    result.ask_shortids.push_back(short_id);
+                }
+            }
+        } else {
+            // Fall back to announcing everything, the peer does the same on its side.
+            result.announce.assign(state.m_local_set_snapshot.begin(), state.m_local_set_snapshot.end());
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug,
+                      "Reconciliation with peer=%d %s: announcing %d, requesting %d\n", peer_id,
+                      result.success ? "succeeded" : "failed", result.announce.size(), result.ask_shortids.size());
+        state.FinishRound();
+        return result;
+    }
+
 public:
     explicit Impl(uint32_t recon_version) : m_recon_version(recon_version) {}
 
@@ -142,6 +284,243 @@ public:
         return (recon_state != m_states.end() &&
                 std::holds_alternative<TxReconciliationState>(recon_state->second));
     }
+
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_local_set.size() >= MAX_RECONSET_SIZE) return false;
+        // A transaction in the ongoing round will be announced or known to the peer once it ends.
+        if (state->m_local_set_snapshot.contains(wtxid)) return true;
+        state->m_local_set.insert(wtxid);
+        return true;
+    }
+
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        return state && state->m_local_set.erase(wtxid);
+    }
+
+    std::vector<NodeId> GetFanoutTargets(const Wtxid& wtxid, size_t inbounds_nonrcncl_tx_relay,
+                                         size_t outbounds_nonrcncl_tx_relay) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+
+        // Rank the reconciling peers of each direction by a keyed hash of the transaction and the
+        // peer, and take the top ones.
+        std::vector<std::pair<uint64_t, NodeId>> inbounds, outbounds;
+        for (const auto& [peer_id, state] : m_states) {
+            const auto* recon_state = std::get_if<TxReconciliationState>(&state);
+            if (!recon_state) continue;
+            const uint64_t rank{SipHashUint256Extra(m_fanout_k0, m_fanout_k1, wtxid.ToUint256(), uint32_t(peer_id))};
+            (recon_state->m_we_initiate ? outbounds : inbounds).emplace_back(rank, peer_id);
+        }
+
+        const size_t outbound_targets{OUTBOUND_FANOUT_DESTINATIONS - std::min(outbounds_nonrcncl_tx_relay, OUTBOUND_FANOUT_DESTINATIONS)};
+
+        // Non-reconciling inbound peers are flooded anyway and count towards the fraction. The
+        // fractional part of the target is rounded up for a share of the transactions.
+        const double inbound_target{INBOUND_FANOUT_DESTINATIONS_FRACTION * (inbounds.size() + inbounds_nonrcncl_tx_relay)};
+        size_t inbound_targets{size_t(inbound_target)};
+        const uint64_t frac_rank{SipHashUint256(m_fanout_k0, m_fanout_k1, wtxid.ToUint256())};
+        if (double(frac_rank % 1000) < (inbound_target - std::floor(inbound_target)) * 1000) ++inbound_targets;
+        inbound_targets -= std::min(inbound_targets, inbounds_nonrcncl_tx_relay);
+
+        std::vector<NodeId> targets;
+        const auto take_top{[&](std::vector<std::pair<uint64_t, NodeId>>& peers, size_t count) {
+            count = std::min(count, peers.size());
+            std::partial_sort(peers.begin(), peers.begin() + count, peers.end());
+            for (size_t i = 0; i < count; ++i) targets.push_back(peers[i].second);
+        }};
+        take_top(outbounds, outbound_targets);
+        take_top(inbounds, inbound_targets);
+        std::sort(targets.begin(), targets.end());
+        return targets;
+    }
+
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        if (!state || !state->m_we_initiate) return std::nullopt;
+        if (state->m_phase != Phase::NONE) {
+            if (now < state->m_round_expiry) return std::nullopt;
+            // The peer never answered, reconcile the transactions of the round in the next one.
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d timed out\n", peer_id);
+            // The peer still owes the sketch of the request we are waiting for.
+            ++state->m_stale_sketches;
+            state->m_local_set.merge(state->m_local_set_snapshot);
+            state->FinishRound();
+        }
+        if (now < state->m_next_request_time) return std::nullopt;
+
+        state->m_next_request_time = now + RECON_REQUEST_INTERVAL;
+        state->m_round_expiry = now + RECON_RESPONSE_TIMEOUT;
+        state->m_local_set_snapshot = std::move(state->m_local_set);
+        state->m_local_set.clear();
+        state->m_phase = Phase::INIT_REQUESTED;
+
+        const uint16_t set_size = std::min<size_t>(state->m_local_set_snapshot.size(), std::numeric_limits<uint16_t>::max());
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Initiate reconciliation with peer=%d, set size %d\n",
+                      peer_id, set_size);
+        return std::make_pair(set_size, uint16_t(RECON_Q * Q_PRECISION));
+    }
+
+    bool HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_we_initiate) return false;
+        if (state->m_phase == Phase::INIT_REQUESTED) {
+            // The previous request is still to be answered, with a sketch the peer ignores.
+            ++state->m_stale_requests;
+        } else if (state->m_phase != Phase::NONE) {
+            // The peer gave up on the round, reconcile its transactions in the new one.
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Reconciliation with peer=%d abandoned by the peer\n", peer_id);
+            state->m_local_set.merge(state->m_local_set_snapshot);
+            state->FinishRound();
+        }
+
+        state->m_remote_set_size = peer_set_size;
+        state->m_remote_q = peer_q;
+        state->m_phase = Phase::INIT_REQUESTED;
+        return true;
+    }
+
+    std::optional<std::vector<uint8_t>> RespondToReconciliationRequest(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_we_initiate || state->m_phase != Phase::INIT_REQUESTED) return std::nullopt;
+        if (state->m_stale_requests > 0) {
+            --state->m_stale_requests;
+            return std::vector<uint8_t>{};
+        }
+
+        state->m_local_set_snapshot = std::move(state->m_local_set);
+        state->m_local_set.clear();
+        state->m_phase = Phase::INIT_RESPONDED;
+
+        // With nothing to reconcile on either side, an empty sketch tells the peer so.
+        if (state->m_local_set_snapshot.empty() && state->m_remote_set_size == 0) {
+            state->m_sketch_capacity = 0;
+            return std::vector<uint8_t>{};
+        }
+        state->m_sketch_capacity = EstimateSketchCapacity(state->m_local_set_snapshot.size(), state->m_remote_set_size, state->m_remote_q);
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Respond to reconciliation from peer=%d, set size %d, sketch capacity %d\n",
+                      peer_id, state->m_local_set_snapshot.size(), state->m_sketch_capacity);
+        return state->ComputeSnapshotSketch(state->m_sketch_capacity).Serialize();
+    }
+
+    ReconciliationSketchResult HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        if (!state || !state->m_we_initiate) return {};
+        if (skdata.size() % BYTES_PER_SKETCH_CAPACITY != 0) return {};
+        if (state->m_stale_sketches > 0) {
+            --state->m_stale_sketches;
+            ReconciliationSketchResult result;
+            result.valid = true;
+            result.stale = true;
+            return result;
+        }
+
+        std::vector<uint8_t> full_sketch;
+        if (state->m_phase == Phase::INIT_REQUESTED) {
+            if (skdata.size() / BYTES_PER_SKETCH_CAPACITY > MAX_SKETCH_CAPACITY) return {};
+            if (skdata.empty()) {
+                // The peer has nothing, so the difference is our set if it is empty too. Otherwise
+                // there is no sketch to find it with.
+                return FinishInitiatedRound(peer_id, *state, state->m_local_set_snapshot.empty() ? std::make_optional<std::vector<uint64_t>>() : std::nullopt);
+            }
+            full_sketch.assign(skdata.begin(), skdata.end());
+        } else if (state->m_phase == Phase::EXT_REQUESTED) {
+            // The extension holds the second half of a sketch of twice the initial capacity.
+            if (skdata.size() != state->m_remote_sketch.size()) return {};
+            full_sketch = std::move(state->m_remote_sketch);
+            full_sketch.insert(full_sketch.end(), skdata.begin(), skdata.end());
+        } else {
+            return {};
+        }
+
+        const uint32_t capacity = full_sketch.size() / BYTES_PER_SKETCH_CAPACITY;
+        Minisketch remote_sketch{node::MakeMinisketch32(capacity)};
+        remote_sketch.Deserialize(full_sketch);
+        Minisketch sketch{state->ComputeSnapshotSketch(capacity)};
+        sketch.Merge(remote_sketch);
+        auto difference{sketch.Decode(capacity)};
+
+        if (!difference && state->m_phase == Phase::INIT_REQUESTED && capacity * 2 <= MAX_SKETCH_CAPACITY) {
+            LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug, "Request sketch extension from peer=%d\n", peer_id);
+            state->m_remote_sketch = std::move(full_sketch);
+            state->m_phase = Phase::EXT_REQUESTED;
+            ReconciliationSketchResult result;
+            result.valid = true;
+            result.request_extension = true;
+            return result;
+        }
+        return FinishInitiatedRound(peer_id, *state, difference);
+    }
+
+    std::optional<std::vector<uint8_t>> HandleExtensionRequest(NodeId peer_id) EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_we_initiate || state->m_phase != Phase::INIT_RESPONDED) return std::nullopt;
+        const uint32_t capacity{state->m_sketch_capacity};
+        if (capacity == 0 || capacity * 2 > MAX_SKETCH_CAPACITY) return std::nullopt;
+
+        state->m_phase = Phase::EXT_RESPONDED;
+        // The first half of a sketch of twice the capacity is the sketch we sent already.
+        const std::vector<uint8_t> sketch{state->ComputeSnapshotSketch(capacity * 2).Serialize()};
+        return std::vector<uint8_t>(sketch.begin() + capacity * BYTES_PER_SKETCH_CAPACITY, sketch.end());
+    }
+
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success, std::span<const uint32_t> ask_shortids)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto* state = GetRegisteredPeerState(peer_id);
+        if (!state || state->m_we_initiate) return std::nullopt;
+        if (state->m_phase != Phase::INIT_RESPONDED && state->m_phase != Phase::EXT_RESPONDED) return std::nullopt;
+
+        std::vector<Wtxid> announce;
+        if (success) {
+            const std::unordered_set<uint32_t> ask(ask_shortids.begin(), ask_shortids.end());
+            for (const Wtxid& wtxid : state->m_local_set_snapshot) {
+                if (ask.contains(state->ComputeShortID(wtxid))) announce.push_back(wtxid);
+            }
+        } else {
+            announce.assign(state->m_local_set_snapshot.begin(), state->m_local_set_snapshot.end());
+        }
+        LogPrintLevel(BCLog::TXRECONCILIATION, BCLog::Level::Debug,
+                      "Reconciliation with peer=%d %s: announcing %d\n", peer_id, success ? "succeeded" : "failed", announce.size());
+        state->FinishRound();
+        return announce;
+    }
+
+    size_t GetSetSize(NodeId peer_id) const EXCLUSIVE_LOCKS_REQUIRED(!m_txreconciliation_mutex)
+    {
+        AssertLockNotHeld(m_txreconciliation_mutex);
+        LOCK(m_txreconciliation_mutex);
+        auto recon_state = m_states.find(peer_id);
+        if (recon_state == m_states.end()) return 0;
+        const auto* state = std::get_if<TxReconciliationState>(&recon_state->second);
+        return state ? state->m_local_set.size() : 0;
+    }
 };
 
 TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version) : m_impl{std::make_unique<TxReconciliationTracker::Impl>(recon_version)} {}
@@ -168,3 +547,55 @@ bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
 {
     return m_impl->IsPeerRegistered(peer_id);
 }
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->AddToSet(peer_id, wtxid);
+}
+
+bool TxReconciliationTracker::TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid)
+{
+    return m_impl->TryRemovingFromSet(peer_id, wtxid);
+}
+
+std::vector<NodeId> TxReconciliationTracker::GetFanoutTargets(const Wtxid& wtxid, size_t inbounds_nonrcncl_tx_relay,
+                                                              size_t outbounds_nonrcncl_tx_relay) const
+{
+    return m_impl->GetFanoutTargets(wtxid, inbounds_nonrcncl_tx_relay, outbounds_nonrcncl_tx_relay);
+}
+
+std::optional<std::pair<uint16_t, uint16_t>> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now)
+{
+    return m_impl->InitiateReconciliationRequest(peer_id, now);
+}
+
+bool TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q)
+{
+    return m_impl->HandleReconciliationRequest(peer_id, peer_set_size, peer_q);
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::RespondToReconciliationRequest(NodeId peer_id)
+{
+    return m_impl->RespondToReconciliationRequest(peer_id);
+}
+
+ReconciliationSketchResult TxReconciliationTracker::HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata)
+{
+    return m_impl->HandleSketch(peer_id, skdata);
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::HandleExtensionRequest(NodeId peer_id)
+{
+    return m_impl->HandleExtensionRequest(peer_id);
+}
+
+std::optional<std::vector<Wtxid>> TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success,
+                                                                                         std::span<const uint32_t> ask_shortids)
+{
+    return m_impl->HandleReconciliationDifference(peer_id, success, ask_shortids);
+}
+
+size_t TxReconciliationTracker::GetSetSize(NodeId peer_id) const
+{
+    return m_impl->GetSetSize(peer_id);
+}
@@ -6,14 +6,53 @@
 #define BITCOIN_NODE_TXRECONCILIATION_H
 
 #include <net.h>
+#include <primitives/transaction.h>
 #include <sync.h>
+#include <util/time.h>
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 /** Supported transaction reconciliation protocol version */
 static constexpr uint32_t TXRECONCILIATION_VERSION{1};
 
+/**
+ * Coefficient used to estimate the set difference from the set sizes, see BIP-330. It is sent in
+ * reqrecon multiplied by Q_PRECISION.
+ */
+static constexpr double RECON_Q{0.25};
+static constexpr uint16_t Q_PRECISION{(2 << 14) - 1};
+/** Interval between reconciliation rounds initiated with the same peer. */
+static constexpr std::chrono::microseconds RECON_REQUEST_INTERVAL{8s};
+/**
+ * Time the initiator waits for a round to complete before giving up on it and returning its
+ * transactions to the next round. The peer still answers the abandoned round, and the sketches
+ * it sends for it are ignored. A reqrecon ends the round the responder is in, if any.
+ */
+static constexpr std::chrono::microseconds RECON_RESPONSE_TIMEOUT{60s};
+/**
+ * Maximum number of transactions in the set for a peer. Beyond it, transactions are announced to
+ * the peer by flooding.
+ */
+static constexpr size_t MAX_RECONSET_SIZE{3000};
+/** Maximum capacity of a sketch, including an extension. This bounds the cost of decoding. */
+static constexpr uint32_t MAX_SKETCH_CAPACITY{2 << 12};
+/** Probability (as 2^-x) of a decoding failure going unnoticed, used to size sketches. */
+static constexpr uint32_t RECON_FALSE_POSITIVE_COEF{16};
+/**
+ * Number of outbound peers a transaction is flooded to. Outbound peers not reconciling with us
+ * count towards it, reconciling ones are picked per transaction to make up the rest.
+ */
+static constexpr size_t OUTBOUND_FANOUT_DESTINATIONS{4};
+/** Fraction of the inbound peers reconciling with us a transaction is flooded to. */
+static constexpr double INBOUND_FANOUT_DESTINATIONS_FRACTION{0.1};
+
 enum class ReconciliationRegisterResult {
     NOT_FOUND,
     SUCCESS,
@@ -21,6 +60,22 @@ enum class ReconciliationRegisterResult {
     PROTOCOL_VIOLATION,
 };
 
+/** What to do after receiving a sketch (or sketch extension) as the reconciliation initiator. */
+struct ReconciliationSketchResult {
+    /** Whether the sketch was expected. If not, the peer violated the protocol. */
+    bool valid{false};
+    /** Whether the sketch answers a round we gave up on, so that there is nothing to do. */
+    bool stale{false};
+    /** Whether to ask for a sketch extension (reqsketchext) instead of concluding with reconcildiff. */
+    bool request_extension{false};
+    /** Whether the set difference was found, sent in reconcildiff. */
+    bool success{false};
+    /** Short IDs of the transactions the peer should announce to us, sent in reconcildiff. */
+    std::vector<uint32_t> ask_shortids;
+    /** Transactions the peer does not have, which we should announce to it. */
+    std::vector<Wtxid> announce;
+};
+
 /**
  * Transaction reconciliation is a way for nodes to efficiently announce transactions.
  * This object keeps track of all txreconciliation-related communications with the peers.
@@ -84,6 +139,76 @@ public:
      * Check if a peer is registered to reconcile transactions with us.
      */
     bool IsPeerRegistered(NodeId peer_id) const;
+
+    /**
+     * Step 1. Add a transaction to the set we reconcile with the peer at the next round, instead
+     * of announcing it. Returns false if the peer is not registered or its set is full, in which
+     * case the transaction should be flooded to the peer.
+     */
+    bool AddToSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /**
+     * Step 1. Remove a transaction from the set of a peer which is known to have it, e.g. because
+     * it announced it to us. Transactions in an ongoing round are left alone.
+     */
+    bool TryRemovingFromSet(NodeId peer_id, const Wtxid& wtxid);
+
+    /**
+     * Step 1. Pick the registered peers a transaction should be flooded to, while it is reconciled
+     * with the others. The choice is pseudorandom, but the same for all callers. The counts of
+     * non-reconciling transaction relay peers reduce the number of fanout destinations needed.
+     */
+    std::vector<NodeId> GetFanoutTargets(const Wtxid& wtxid, size_t inbounds_nonrcncl_tx_relay,
+                                         size_t outbounds_nonrcncl_tx_relay) const;
+
+    /**
+     * Step 2 (initiator). If it is time for the next round with the peer, move its set aside for
+     * the round and return the set size and encoded q to send in reqrecon. A round the peer has
+     * not completed within RECON_RESPONSE_TIMEOUT is abandoned first.
+     */
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now);
+
+    /**
+     * Step 2 (responder). Remember a reqrecon from the peer, answered by
+     * RespondToReconciliationRequest. As the peer only sends it once it gave up on the previous
+     * round, that round ends and its transactions return to the next one. Returns false if the
+     * peer violated the protocol.
+     */
+    bool HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q);
+
+    /**
+     * Step 2 (responder). If a reqrecon from the peer is pending, move our set aside for the round
+     * and return the sketch to send for it. Each reqrecon is answered by one sketch, so if the
+     * peer sent several before we answered, an empty sketch is returned first for each but the
+     * last one. Call until it returns std::nullopt.
+     */
+    std::optional<std::vector<uint8_t>> RespondToReconciliationRequest(NodeId peer_id);
+
+    /**
+     * Steps 3 and 4 (initiator). Process a sketch received from the peer, or the extension of the
+     * sketch if one was requested. Sketches answering rounds we gave up on come first, and are
+     * ignored.
+     */
+    ReconciliationSketchResult HandleSketch(NodeId peer_id, std::span<const uint8_t> skdata);
+
+    /**
+     * Step 4b (responder). Process reqsketchext and return the sketch extension to send, or
+     * std::nullopt if the peer violated the protocol.
+     */
+    std::optional<std::vector<uint8_t>> HandleExtensionRequest(NodeId peer_id);
+
+    /**
+     * Step 5 (responder). Process the reconcildiff concluding the round, and return the
+     * transactions to announce to the peer: the requested ones, or our whole set for the round
+     * if reconciliation failed. Returns std::nullopt if the peer violated the protocol.
+     */
+    std::optional<std::vector<Wtxid>> HandleReconciliationDifference(NodeId peer_id, bool success,
+                                                                     std::span<const uint32_t> ask_shortids);
+
+    /**
+     * Number of transactions waiting for the next round with the peer.
+     */
+    size_t GetSetSize(NodeId peer_id) const;
 };
 
 #endif // BITCOIN_NODE_TXRECONCILIATION_H
@@ -16,10 +16,15 @@
 #include <consensus/amount.h>
 #include <cstddef>
 #include <policy/policy.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
 #include <script/script.h>
 #include <uint256.h>
 #include <util/time.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace node {
 enum class TransactionError {
     OK, //!< No error
@@ -97,6 +102,38 @@ struct BlockCheckOptions {
      */
     bool check_pow{true};
 };
+
+/**
+ * Changes between two consecutive block templates, sufficient for a client
+ * that holds the older template to reconstruct the newer one without
+ * refetching the whole block.
+ *
+ * Transaction positions exclude the coinbase transaction, i.e. they index
+ * into the getTxFees() / getTxSigops() vectors. To apply a delta, erase the
+ * transactions at removed_positions from the previous template, then insert
+ * each entry of added_txs at the corresponding added_positions index, in
+ * order.
+ */
+struct BlockTemplateDelta {
+    //! Header of the new template. hashMerkleRoot is not meaningful because
+    //! the coinbase transaction is not final.
+    CBlockHeader header;
+    //! Positions of transactions in the previous template which are not part
+    //! of the new template, in ascending order.
+    std::vector<uint32_t> removed_positions;
+    //! Positions of the added transactions in the new template, in ascending order.
+    std::vector<uint32_t> added_positions;
+    //! Added transactions, along with their fees and sigop cost.
+    std::vector<CTransactionRef> added_txs;
+    std::vector<CAmount> added_tx_fees;
+    std::vector<int64_t> added_tx_sigops;
+    //! Value of the new coinbase output: block subsidy plus total fees.
+    CAmount coinbase_value{0};
+    //! New witness commitment, empty if the block has no witness commitment.
+    std::vector<unsigned char> coinbase_commitment;
+    //! Merkle path to the coinbase transaction, ordered from the deepest.
+    std::vector<uint256> coinbase_merkle_path;
+};
 } // namespace node
 
 #endif // BITCOIN_NODE_TYPES_H
@@ -4,6 +4,7 @@
 
 #include <node/utxo_snapshot.h>
 
+#include <kernel/coinstats.h>
 #include <logging.h>
 #include <streams.h>
 #include <sync.h>
@@ -20,6 +21,17 @@
 
 namespace node {
 
+SnapshotChunkInfo WriteSnapshotChunk(DataStream& chunk, std::span<const std::pair<COutPoint, Coin>> coins)
+{
+    SnapshotChunkInfo info;
+    const size_t begin{chunk.size()};
+    SerializeSnapshotCoins(chunk, coins);
+    info.m_coins_count = coins.size();
+    info.m_size = chunk.size() - begin;
+    for (const auto& [outpoint, coin] : coins) kernel::ApplyCoinHash(info.m_muhash, outpoint, coin);
+    return info;
+}
+
 bool WriteSnapshotBaseBlockhash(Chainstate& snapshot_chainstate)
 {
     AssertLockHeld(::cs_main);
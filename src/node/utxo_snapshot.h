@@ -7,8 +7,11 @@
 #define BITCOIN_NODE_UTXO_SNAPSHOT_H
 
 #include <chainparams.h>
+#include <coins.h>
+#include <crypto/muhash.h>
 #include <kernel/chainparams.h>
 #include <kernel/cs_main.h>
+#include <primitives/transaction.h>
 #include <serialize.h>
 #include <sync.h>
 #include <uint256.h>
@@ -18,12 +21,15 @@
 
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <string_view>
+#include <utility>
 
 // UTXO set snapshot magic bytes
 static constexpr std::array<uint8_t, 5> SNAPSHOT_MAGIC_BYTES = {'u', 't', 'x', 'o', 0xff};
 
 class Chainstate;
+class DataStream;
 
 namespace node {
 //! Metadata describing a serialized version of a UTXO set from which an
@@ -32,10 +38,19 @@ namespace node {
 //! before being used. Thus, new fields should be added only if needed.
 class SnapshotMetadata
 {
+public:
+    //! Version of snapshots with the coins in a single stream
     inline static const uint16_t VERSION{2};
-    const std::set<uint16_t> m_supported_versions{VERSION};
+    //! Version of snapshots with the coins in chunks, see SnapshotChunkInfo
+    inline static const uint16_t CHUNKED_VERSION{3};
+
+private:
+    const std::set<uint16_t> m_supported_versions{VERSION, CHUNKED_VERSION};
     const MessageStartChars m_network_magic;
 public:
+    //! The format version of the snapshot.
+    uint16_t m_version{VERSION};
+
     //! The hash of the block that reflects the tip of the chain for the
     //! UTXO set contained in this snapshot.
     uint256 m_base_blockhash;
@@ -51,15 +66,17 @@ public:
     SnapshotMetadata(
         const MessageStartChars network_magic,
         const uint256& base_blockhash,
-        uint64_t coins_count) :
+        uint64_t coins_count,
+        uint16_t version = VERSION) :
             m_network_magic(network_magic),
+            m_version(version),
             m_base_blockhash(base_blockhash),
             m_coins_count(coins_count) { }
 
     template <typename Stream>
     inline void Serialize(Stream& s) const {
         s << SNAPSHOT_MAGIC_BYTES;
-        s << VERSION;
+        s << m_version;
         s << m_network_magic;
         s << m_base_blockhash;
         s << m_coins_count;
@@ -80,6 +97,7 @@ public:
         if (m_supported_versions.find(version) == m_supported_versions.end()) {
             throw std::ios_base::failure(strprintf("Version of snapshot %s does not match any of the supported versions.", version));
         }
+        m_version = version;
 
         // Read the network magic (pchMessageStart)
         MessageStartChars message;
@@ -101,6 +119,59 @@ public:
     }
 };
 
+//! Most coins in a chunk of a chunked snapshot
+static constexpr uint64_t SNAPSHOT_CHUNK_MAX_COINS{1 << 16};
+//! Largest size in bytes of a chunk of a chunked snapshot
+static constexpr uint64_t SNAPSHOT_CHUNK_MAX_SIZE{8 << 20};
+
+/**
+ * Directory entry of a chunk of coins in a chunked snapshot.
+ *
+ * In a chunked snapshot the metadata is followed by the chunks, then by the
+ * directory, a vector of these entries, and at the end of the file by the
+ * offset of the directory as a uint64_t. Each chunk holds coins in the same
+ * serialization as the coins of a version 2 snapshot, so a chunk can be
+ * decoded without the chunks before it, and it starts where the one before it
+ * ends. The chunks together hold the coins in outpoint order.
+ */
+struct SnapshotChunkInfo
+{
+    //! Number of coins in the chunk
+    uint64_t m_coins_count{0};
+    //! Size of the chunk in bytes
+    uint64_t m_size{0};
+    //! MuHash of the coins in the chunk, as in gettxoutsetinfo. Multiplying
+    //! those of all chunks gives the MuHash of the snapshot.
+    MuHash3072 m_muhash;
+
+    SERIALIZE_METHODS(SnapshotChunkInfo, obj) { READWRITE(obj.m_coins_count, obj.m_size, obj.m_muhash); }
+};
+
+/**
+ * Serialize coins in outpoint order as in a snapshot: the coins of each
+ * transaction after its txid and their number.
+ */
+template <typename Stream>
+void SerializeSnapshotCoins(Stream& s, std::span<const std::pair<COutPoint, Coin>> coins)
+{
+    while (!coins.empty()) {
+        const Txid& txid{coins.front().first.hash};
+        size_t count{1};
+        while (count < coins.size() && coins[count].first.hash == txid) ++count;
+        s << txid;
+        WriteCompactSize(s, count);
+        for (const auto& [outpoint, coin] : coins.first(count)) {
+            WriteCompactSize(s, outpoint.n);
+            s << coin;
+        }
+        coins = coins.subspan(count);
+    }
+}
+
+//! Serialize coins in outpoint order into a chunk of a chunked snapshot and
+//! return its directory entry.
+SnapshotChunkInfo WriteSnapshotChunk(DataStream& chunk, std::span<const std::pair<COutPoint, Coin>> coins);
+
 //! The file in the snapshot chainstate dir which stores the base blockhash. This is
 //! needed to reconstruct snapshot chainstates on init.
 //!
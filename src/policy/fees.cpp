@@ -29,6 +29,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <mutex>
 #include <stdexcept>
 #include <utility>
 
@@ -127,6 +128,13 @@ public:
     TxConfirmStats(const std::vector<double>& defaultBuckets, const std::map<double, unsigned int>& defaultBucketMap,
                    unsigned int maxPeriods, double decay, unsigned int scale);
 
+    /**
+     * Copy the tracked data of another TxConfirmStats, referring to the given
+     * bucket boundaries (which must be equal to the ones used by other).
+     */
+    TxConfirmStats(const TxConfirmStats& other, const std::vector<double>& buckets,
+                   const std::map<double, unsigned int>& bucketMap);
+
     /** Roll the circular buffer for unconfirmed txs*/
     void ClearCurrent(unsigned int nBlockHeight);
 
@@ -195,6 +203,16 @@ TxConfirmStats::TxConfirmStats(const std::vector<double>& defaultBuckets,
     resizeInMemoryCounters(buckets.size());
 }
 
+TxConfirmStats::TxConfirmStats(const TxConfirmStats& other, const std::vector<double>& _buckets,
+                               const std::map<double, unsigned int>& _bucketMap)
+    : buckets(_buckets), bucketMap(_bucketMap),
+      txCtAvg(other.txCtAvg), confAvg(other.confAvg), failAvg(other.failAvg), m_feerate_avg(other.m_feerate_avg),
+      decay(other.decay), scale(other.scale),
+      unconfTxs(other.unconfTxs), oldUnconfTxs(other.oldUnconfTxs)
+{
+    assert(buckets == other.buckets);
+}
+
 void TxConfirmStats::resizeInMemoryCounters(size_t newbuckets) {
     // newbuckets must be passed in because the buckets referred to during Read have not been updated yet.
     unconfTxs.resize(GetMaxConfirms());
@@ -519,6 +537,50 @@ void TxConfirmStats::removeTx(unsigned int entryHeight, unsigned int nBestSeenHe
     }
 }
 
+/**
+ * Immutable copy of the estimator state, published by UpdateSnapshot() after
+ * every processed block. All estimate queries are answered from the latest
+ * snapshot, so they don't contend with the validation interface callbacks
+ * updating the live state. Unconfirmed transaction counts are those at the
+ * time the snapshot was taken.
+ */
+class CBlockPolicyEstimator::Snapshot
+{
+private:
+    const std::vector<double> buckets;
+    const std::map<double, unsigned int> bucketMap;
+
+    const TxConfirmStats feeStats;
+    const TxConfirmStats shortStats;
+    const TxConfirmStats longStats;
+
+    const unsigned int nBestSeenHeight;
+    const unsigned int m_max_usable_estimate;
+
+    struct CachedEstimate
+    {
+        std::once_flag computed;
+        CFeeRate feerate;
+        FeeCalculation calc;
+    };
+    /** Smart fee estimates by 2 * confTarget + conservative, computed on first request */
+    mutable std::vector<CachedEstimate> m_smart_fee_cache;
+
+    /** Helper for estimateSmartFee */
+    double estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const;
+    /** Helper for estimateSmartFee */
+    double estimateConservativeFee(unsigned int doubleTarget, EstimationResult *result) const;
+    /** Uncached estimateSmartFee */
+    CFeeRate CalculateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const;
+
+public:
+    explicit Snapshot(const CBlockPolicyEstimator& estimator) EXCLUSIVE_LOCKS_REQUIRED(estimator.m_cs_fee_estimator);
+
+    CFeeRate estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const;
+    CFeeRate estimateRawFee(int confTarget, double successThreshold, FeeEstimateHorizon horizon, EstimationResult* result) const;
+    unsigned int HighestTargetTracked(FeeEstimateHorizon horizon) const;
+};
+
 bool CBlockPolicyEstimator::removeTx(Txid hash)
 {
     LOCK(m_cs_fee_estimator);
@@ -557,6 +619,7 @@ CBlockPolicyEstimator::CBlockPolicyEstimator(const fs::path& estimation_filepath
     feeStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, MED_BLOCK_PERIODS, MED_DECAY, MED_SCALE));
     shortStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, SHORT_BLOCK_PERIODS, SHORT_DECAY, SHORT_SCALE));
     longStats = std::unique_ptr<TxConfirmStats>(new TxConfirmStats(buckets, bucketMap, LONG_BLOCK_PERIODS, LONG_DECAY, LONG_SCALE));
+    WITH_LOCK(m_cs_fee_estimator, UpdateSnapshot());
 
     AutoFile est_file{fsbridge::fopen(m_estimation_filepath, "rb")};
 
@@ -713,6 +776,8 @@ void CBlockPolicyEstimator::processBlock(const std::vector<RemovedMempoolTransac
 
     trackedTxs = 0;
     untrackedTxs = 0;
+
+    UpdateSnapshot();
 }
 
 CFeeRate CBlockPolicyEstimator::estimateFee(int confTarget) const
@@ -726,26 +791,54 @@ CFeeRate CBlockPolicyEstimator::estimateFee(int confTarget) const
 
 CFeeRate CBlockPolicyEstimator::estimateRawFee(int confTarget, double successThreshold, FeeEstimateHorizon horizon, EstimationResult* result) const
 {
-    TxConfirmStats* stats = nullptr;
+    return GetSnapshot()->estimateRawFee(confTarget, successThreshold, horizon, result);
+}
+
+unsigned int CBlockPolicyEstimator::HighestTargetTracked(FeeEstimateHorizon horizon) const
+{
+    return GetSnapshot()->HighestTargetTracked(horizon);
+}
+
+CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
+{
+    return GetSnapshot()->estimateSmartFee(confTarget, feeCalc, conservative);
+}
+
+void CBlockPolicyEstimator::UpdateSnapshot()
+{
+    AssertLockHeld(m_cs_fee_estimator);
+    auto snapshot{std::make_shared<const Snapshot>(*this)};
+    LOCK(m_snapshot_mutex);
+    m_snapshot = std::move(snapshot);
+}
+
+std::shared_ptr<const CBlockPolicyEstimator::Snapshot> CBlockPolicyEstimator::GetSnapshot() const
+{
+    LOCK(m_snapshot_mutex);
+    return m_snapshot;
+}
+
+CFeeRate CBlockPolicyEstimator::Snapshot::estimateRawFee(int confTarget, double successThreshold, FeeEstimateHorizon horizon, EstimationResult* result) const
+{
+    const TxConfirmStats* stats = nullptr;
     double sufficientTxs = SUFFICIENT_FEETXS;
     switch (horizon) {
     case FeeEstimateHorizon::SHORT_HALFLIFE: {
-        stats = shortStats.get();
+        stats = &shortStats;
         sufficientTxs = SUFFICIENT_TXS_SHORT;
         break;
     }
     case FeeEstimateHorizon::MED_HALFLIFE: {
-        stats = feeStats.get();
+        stats = &feeStats;
         break;
     }
     case FeeEstimateHorizon::LONG_HALFLIFE: {
-        stats = longStats.get();
+        stats = &longStats;
         break;
     }
     } // no default case, so the compiler can warn about missing cases
     assert(stats);
 
-    LOCK(m_cs_fee_estimator);
     // Return failure if trying to analyze a target we're not tracking
     if (confTarget <= 0 || (unsigned int)confTarget > stats->GetMaxConfirms())
         return CFeeRate(0);
@@ -760,18 +853,17 @@ CFeeRate CBlockPolicyEstimator::estimateRawFee(int confTarget, double successThr
     return CFeeRate(llround(median));
 }
 
-unsigned int CBlockPolicyEstimator::HighestTargetTracked(FeeEstimateHorizon horizon) const
+unsigned int CBlockPolicyEstimator::Snapshot::HighestTargetTracked(FeeEstimateHorizon horizon) const
 {
-    LOCK(m_cs_fee_estimator);
     switch (horizon) {
     case FeeEstimateHorizon::SHORT_HALFLIFE: {
-        return shortStats->GetMaxConfirms();
+        return shortStats.GetMaxConfirms();
     }
     case FeeEstimateHorizon::MED_HALFLIFE: {
-        return feeStats->GetMaxConfirms();
+        return feeStats.GetMaxConfirms();
     }
     case FeeEstimateHorizon::LONG_HALFLIFE: {
-        return longStats->GetMaxConfirms();
+        return longStats.GetMaxConfirms();
     }
     } // no default case, so the compiler can warn about missing cases
     assert(false);
@@ -805,32 +897,32 @@ unsigned int CBlockPolicyEstimator::MaxUsableEstimate() const
  * time horizon which tracks confirmations up to the desired target.  If
  * checkShorterHorizon is requested, also allow short time horizon estimates
  * for a lower target to reduce the given answer */
-double CBlockPolicyEstimator::estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const
+double CBlockPolicyEstimator::Snapshot::estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const
 {
     double estimate = -1;
-    if (confTarget >= 1 && confTarget <= longStats->GetMaxConfirms()) {
+    if (confTarget >= 1 && confTarget <= longStats.GetMaxConfirms()) {
         // Find estimate from shortest time horizon possible
-        if (confTarget <= shortStats->GetMaxConfirms()) { // short horizon
-            estimate = shortStats->EstimateMedianVal(confTarget, SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, result);
+        if (confTarget <= shortStats.GetMaxConfirms()) { // short horizon
+            estimate = shortStats.EstimateMedianVal(confTarget, SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, result);
         }
-        else if (confTarget <= feeStats->GetMaxConfirms()) { // medium horizon
-            estimate = feeStats->EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
+        else if (confTarget <= feeStats.GetMaxConfirms()) { // medium horizon
+            estimate = feeStats.EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
         }
         else { // long horizon
-            estimate = longStats->EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
+            estimate = longStats.EstimateMedianVal(confTarget, SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, result);
         }
         if (checkShorterHorizon) {
             EstimationResult tempResult;
             // If a lower confTarget from a more recent horizon returns a lower answer use it.
-            if (confTarget > feeStats->GetMaxConfirms()) {
-                double medMax = feeStats->EstimateMedianVal(feeStats->GetMaxConfirms(), SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, &tempResult);
+            if (confTarget > feeStats.GetMaxConfirms()) {
+                double medMax = feeStats.EstimateMedianVal(feeStats.GetMaxConfirms(), SUFFICIENT_FEETXS, successThreshold, nBestSeenHeight, &tempResult);
                 if (medMax > 0 && (estimate == -1 || medMax < estimate)) {
                     estimate = medMax;
                     if (result) *result = tempResult;
                 }
             }
-            if (confTarget > shortStats->GetMaxConfirms()) {
-                double shortMax = shortStats->EstimateMedianVal(shortStats->GetMaxConfirms(), SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, &tempResult);
+            if (confTarget > shortStats.GetMaxConfirms()) {
+                double shortMax = shortStats.EstimateMedianVal(shortStats.GetMaxConfirms(), SUFFICIENT_TXS_SHORT, successThreshold, nBestSeenHeight, &tempResult);
                 if (shortMax > 0 && (estimate == -1 || shortMax < estimate)) {
                     estimate = shortMax;
                     if (result) *result = tempResult;
@@ -844,15 +936,15 @@ double CBlockPolicyEstimator::estimateCombinedFee(unsigned int confTarget, doubl
 /** Ensure that for a conservative estimate, the DOUBLE_SUCCESS_PCT is also met
  * at 2 * target for any longer time horizons.
  */
-double CBlockPolicyEstimator::estimateConservativeFee(unsigned int doubleTarget, EstimationResult *result) const
+double CBlockPolicyEstimator::Snapshot::estimateConservativeFee(unsigned int doubleTarget, EstimationResult *result) const
 {
     double estimate = -1;
     EstimationResult tempResult;
-    if (doubleTarget <= shortStats->GetMaxConfirms()) {
-        estimate = feeStats->EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, result);
+    if (doubleTarget <= shortStats.GetMaxConfirms()) {
+        estimate = feeStats.EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, result);
     }
-    if (doubleTarget <= feeStats->GetMaxConfirms()) {
-        double longEstimate = longStats->EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, &tempResult);
+    if (doubleTarget <= feeStats.GetMaxConfirms()) {
+        double longEstimate = longStats.EstimateMedianVal(doubleTarget, SUFFICIENT_FEETXS, DOUBLE_SUCCESS_PCT, nBestSeenHeight, &tempResult);
         if (longEstimate > estimate) {
             estimate = longEstimate;
             if (result) *result = tempResult;
@@ -868,10 +960,8 @@ double CBlockPolicyEstimator::estimateConservativeFee(unsigned int doubleTarget,
  * estimates, however, required the 95% threshold at 2 * target be met for any
  * longer time horizons also.
  */
-CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
+CFeeRate CBlockPolicyEstimator::Snapshot::CalculateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
 {
-    LOCK(m_cs_fee_estimator);
-
     if (feeCalc) {
         feeCalc->desiredTarget = confTarget;
         feeCalc->returnedTarget = confTarget;
@@ -881,16 +971,15 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
     EstimationResult tempResult;
 
     // Return failure if trying to analyze a target we're not tracking
-    if (confTarget <= 0 || (unsigned int)confTarget > longStats->GetMaxConfirms()) {
+    if (confTarget <= 0 || (unsigned int)confTarget > longStats.GetMaxConfirms()) {
         return CFeeRate(0);  // error condition
     }
 
     // It's not possible to get reasonable estimates for confTarget of 1
     if (confTarget == 1) confTarget = 2;
 
-    unsigned int maxUsableEstimate = MaxUsableEstimate();
-    if ((unsigned int)confTarget > maxUsableEstimate) {
-        confTarget = maxUsableEstimate;
+    if ((unsigned int)confTarget > m_max_usable_estimate) {
+        confTarget = m_max_usable_estimate;
     }
     if (feeCalc) feeCalc->returnedTarget = confTarget;
 
@@ -954,6 +1043,33 @@ CFeeRate CBlockPolicyEstimator::estimateSmartFee(int confTarget, FeeCalculation
     return CFeeRate(llround(median));
 }
 
+CBlockPolicyEstimator::Snapshot::Snapshot(const CBlockPolicyEstimator& estimator)
+    : buckets(estimator.buckets),
+      bucketMap(estimator.bucketMap),
+      feeStats(*estimator.feeStats, buckets, bucketMap),
+      shortStats(*estimator.shortStats, buckets, bucketMap),
+      longStats(*estimator.longStats, buckets, bucketMap),
+      nBestSeenHeight(estimator.nBestSeenHeight),
+      m_max_usable_estimate(estimator.MaxUsableEstimate()),
+      m_smart_fee_cache(2 * (longStats.GetMaxConfirms() + 1))
+{
+}
+
+CFeeRate CBlockPolicyEstimator::Snapshot::estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
+{
+    // Failures for untracked targets aren't cached, see CalculateSmartFee
+    if (confTarget <= 0 || (unsigned int)confTarget > longStats.GetMaxConfirms()) {
+        return CalculateSmartFee(confTarget, feeCalc, conservative);
+    }
+
+    CachedEstimate& cached{m_smart_fee_cache[2 * confTarget + conservative]};
+    std::call_once(cached.computed, [&] {
+        cached.feerate = CalculateSmartFee(confTarget, &cached.calc, conservative);
+    });
+    if (feeCalc) *feeCalc = cached.calc;
+    return cached.feerate;
+}
+
 void CBlockPolicyEstimator::Flush() {
     FlushUnconfirmed();
     FlushFeeEstimates();
@@ -1052,6 +1168,7 @@ bool CBlockPolicyEstimator::Read(AutoFile& filein)
             nBestSeenHeight = nFileBestSeenHeight;
             historicalFirst = nFileHistoricalFirst;
             historicalBest = nFileHistoricalBest;
+            UpdateSnapshot();
         }
     }
     catch (const std::exception& e) {
@@ -1071,6 +1188,7 @@ void CBlockPolicyEstimator::FlushUnconfirmed()
         auto mi = mapMemPoolTxs.begin();
         _removeTx(mi->first, false); // this calls erase() on mapMemPoolTxs
     }
+    UpdateSnapshot();
     const auto endclear{SteadyClock::now()};
     LogDebug(BCLog::ESTIMATEFEE, "Recorded %u unconfirmed txs from mempool in %.3fs\n", num_entries, Ticks<SecondsDouble>(endclear - startclear));
 }
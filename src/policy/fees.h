@@ -205,7 +205,7 @@ public:
     /** Process all the transactions that have been included in a block */
     void processBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block,
                       unsigned int nBlockHeight)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Process a transaction accepted to the mempool*/
     void processTransaction(const NewMempoolTransactionInfo& tx)
@@ -217,7 +217,7 @@ public:
 
     /** DEPRECATED. Return a feerate estimate */
     CFeeRate estimateFee(int confTarget) const
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_snapshot_mutex);
 
     /** Estimate feerate needed to get be included in a block within confTarget
      *  blocks. If no answer can be given at confTarget, return an estimate at
@@ -225,7 +225,7 @@ public:
      *  valid over longer time horizons also.
      */
     CFeeRate estimateSmartFee(int confTarget, FeeCalculation *feeCalc, bool conservative) const
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_snapshot_mutex);
 
     /** Return a specific fee estimate calculation with a given success
      * threshold and time horizon, and optionally return detailed data about
@@ -233,7 +233,7 @@ public:
      */
     CFeeRate estimateRawFee(int confTarget, double successThreshold, FeeEstimateHorizon horizon,
                             EstimationResult* result = nullptr) const
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_snapshot_mutex);
 
     /** Write estimation data to a file */
     bool Write(AutoFile& fileout) const
@@ -241,19 +241,19 @@ public:
 
     /** Read estimation data from a file */
     bool Read(AutoFile& filein)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Empty mempool transactions on shutdown to record failure to confirm for txs still in mempool */
     void FlushUnconfirmed()
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Calculation of highest target that estimates are tracked for */
     unsigned int HighestTargetTracked(FeeEstimateHorizon horizon) const
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_snapshot_mutex);
 
     /** Drop still unconfirmed transactions and record current estimations, if the fee estimation file is present. */
     void Flush()
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
     /** Record current fee estimations. */
     void FlushFeeEstimates()
@@ -269,9 +269,14 @@ protected:
     void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason /*unused*/, uint64_t /*unused*/) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
     void MempoolTransactionsRemovedForBlock(const std::vector<RemovedMempoolTransactionInfo>& txs_removed_for_block, unsigned int nBlockHeight) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_cs_fee_estimator, !m_snapshot_mutex);
 
 private:
+    /**
+     * Access to internals for testing purpose only
+     */
+    friend class BlockPolicyEstimatorTester;
+
     mutable Mutex m_cs_fee_estimator;
 
     unsigned int nBestSeenHeight GUARDED_BY(m_cs_fee_estimator){0};
@@ -303,10 +308,6 @@ private:
     /** Process a transaction confirmed in a block*/
     bool processBlockTx(unsigned int nBlockHeight, const RemovedMempoolTransactionInfo& tx) EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
 
-    /** Helper for estimateSmartFee */
-    double estimateCombinedFee(unsigned int confTarget, double successThreshold, bool checkShorterHorizon, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
-    /** Helper for estimateSmartFee */
-    double estimateConservativeFee(unsigned int doubleTarget, EstimationResult *result) const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Number of blocks of data recorded while fee estimates have been running */
     unsigned int BlockSpan() const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
     /** Number of blocks of recorded fee estimate data represented in saved data file */
@@ -314,6 +315,22 @@ private:
     /** Calculation of highest target that reasonable estimate can be provided for */
     unsigned int MaxUsableEstimate() const EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
 
+    /** Immutable copy of the estimation state, see m_snapshot */
+    class Snapshot;
+
+    /** The estimation state as of the last processed block (or file read).
+     * Estimate queries only copy this pointer under m_snapshot_mutex and
+     * then run against the snapshot, so they never wait for
+     * m_cs_fee_estimator while mempool updates or a block are processed.
+     * Results computed by estimateSmartFee are cached in the snapshot until
+     * the next one is published. */
+    mutable Mutex m_snapshot_mutex;
+    std::shared_ptr<const Snapshot> m_snapshot GUARDED_BY(m_snapshot_mutex);
+
+    /** Publish a new snapshot of the current estimation state */
+    void UpdateSnapshot() EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator, !m_snapshot_mutex);
+    std::shared_ptr<const Snapshot> GetSnapshot() const EXCLUSIVE_LOCKS_REQUIRED(!m_snapshot_mutex);
+
     /** A non-thread-safe helper for the removeTx function */
     bool _removeTx(const Txid& hash, bool inBlock)
         EXCLUSIVE_LOCKS_REQUIRED(m_cs_fee_estimator);
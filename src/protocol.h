@@ -264,6 +264,28 @@ inline constexpr const char* WTXIDRELAY{"wtxidrelay"};
  * txreconciliation, as described by BIP 330.
  */
 inline constexpr const char* SENDTXRCNCL{"sendtxrcncl"};
+/**
+ * Contains a 2-byte local reconciliation set size and a 2-byte q-coefficient,
+ * and requests a sketch of the peer's set to start a txreconciliation round,
+ * as described by BIP 330.
+ */
+inline constexpr const char* REQRECON{"reqrecon"};
+/**
+ * Contains a sketch of the sender's reconciliation set (or the extension of
+ * one), as described by BIP 330.
+ */
+inline constexpr const char* SKETCH{"sketch"};
+/**
+ * Requests an extension of the previously sent sketch, after the initial one
+ * was insufficient to find the set difference, as described by BIP 330.
+ */
+inline constexpr const char* REQSKETCHEXT{"reqsketchext"};
+/**
+ * Concludes a txreconciliation round. Contains a 1-byte success flag and the
+ * short IDs of the transactions the receiver should announce, as described
+ * by BIP 330.
+ */
+inline constexpr const char* RECONCILDIFF{"reconcildiff"};
 }; // namespace NetMsgType
 
 /** All known message types (see above). Keep this in the same order as the list of messages above. */
@@ -303,6 +325,10 @@ inline const std::array ALL_NET_MESSAGE_TYPES{std::to_array<std::string>({
     NetMsgType::CFCHECKPT,
     NetMsgType::WTXIDRELAY,
     NetMsgType::SENDTXRCNCL,
+    NetMsgType::REQRECON,
+    NetMsgType::SKETCH,
+    NetMsgType::REQSKETCHEXT,
+    NetMsgType::RECONCILDIFF,
 })};
 
 /** nServices flags */
@@ -13,6 +13,7 @@
 #include <core_io.h>
 #include <flatfile.h>
 #include <httpserver.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
 #include <node/blockstorage.h>
@@ -20,6 +21,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/mempool.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
@@ -34,6 +36,7 @@
 #include <validation.h>
 
 #include <any>
+#include <string_view>
 #include <vector>
 
 #include <univalue.h>
@@ -44,6 +47,7 @@ using util::SplitString;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
 static constexpr unsigned int MAX_REST_HEADERS_RESULTS = 2000;
+static constexpr unsigned int MAX_REST_ADDRESS_HISTORY_COUNT = 10000;
 
 static const struct {
     RESTResponseFormat rf;
@@ -449,10 +453,20 @@ static bool rest_block(const std::any& context,
         CBlock block{};
         DataStream block_stream{block_data};
         block_stream >> TX_WITH_WITNESS(block);
-        UniValue objBlock = blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
-        std::string strJSON = objBlock.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        // Send the description while it is produced, as a chunked reply.
+        bool reply_started{false};
+        JSONStreamWriter stream{[&](std::string_view data) {
+            if (!reply_started) {
+                req->WriteHeader("Content-Type", "application/json");
+                req->WriteReplyStart(HTTP_OK);
+                reply_started = true;
+            }
+            req->WriteReplyChunk(data);
+        }};
+        blockToJSON(stream, chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
+        stream.Flush();
+        req->WriteReplyChunk("\n");
+        req->WriteReplyEnd();
         return true;
     }
 
@@ -1113,6 +1127,70 @@ static bool rest_blockhash_by_height(const std::any& context, HTTPRequest* req,
     }
 }
 
+static bool rest_address_history(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
+{
+    if (!CheckWarmup(req)) return false;
+    std::string address_or_script;
+    const RESTResponseFormat rf = ParseDataFormat(address_or_script, str_uri_part);
+
+    if (!g_address_index) {
+        return RESTERR(req, HTTP_NOT_FOUND, "Address index not enabled");
+    }
+
+    const std::optional<CScript> script{AddressOrScriptToScript(address_or_script)};
+    if (!script) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid address or scriptPubKey: " + SanitizeString(address_or_script, SAFE_CHARS_URI));
+    }
+
+    std::optional<std::string> raw_from_height, raw_to_height, raw_count, raw_skip;
+    try {
+        raw_from_height = req->GetQueryParameter("from_height");
+        raw_to_height = req->GetQueryParameter("to_height");
+        raw_count = req->GetQueryParameter("count");
+        raw_skip = req->GetQueryParameter("skip");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    const std::optional<int32_t> from_height{raw_from_height ? ToIntegral<int32_t>(*raw_from_height) : 0};
+    const std::optional<int32_t> to_height{raw_to_height ? ToIntegral<int32_t>(*raw_to_height) : std::nullopt};
+    if (!from_height || *from_height < 0 || (raw_to_height && (!to_height || *to_height < *from_height))) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height range");
+    }
+    const std::optional<uint32_t> count{raw_count ? ToIntegral<uint32_t>(*raw_count) : DEFAULT_ADDRESS_HISTORY_COUNT};
+    const std::optional<uint32_t> skip{raw_skip ? ToIntegral<uint32_t>(*raw_skip) : 0};
+    if (!count || !skip) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid count or skip");
+    }
+    if (*count > MAX_REST_ADDRESS_HISTORY_COUNT) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Count is out of acceptable range (0-%u): %u", MAX_REST_ADDRESS_HISTORY_COUNT, *count));
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::JSON: {
+        const bool synced{g_address_index->BlockUntilSyncedToCurrentChain()};
+        const IndexSummary summary{g_address_index->GetSummary()};
+        if (!synced && (!to_height || *to_height > summary.best_block_height)) {
+            return RESTERR(req, HTTP_SERVICE_UNAVAILABLE, strprintf("Address index is still syncing. Current height: %d", summary.best_block_height));
+        }
+
+        std::vector<AddressIndexEntry> entries;
+        if (!g_address_index->FindScriptHistory(*script, *from_height, std::min(to_height.value_or(summary.best_block_height), summary.best_block_height), entries, *skip, *count)) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read the address index");
+        }
+
+        UniValue resp(UniValue::VOBJ);
+        resp.pushKV("height", summary.best_block_height);
+        resp.pushKV("history", AddressHistoryToJSON(entries));
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, resp.write() + "\n");
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    }
+}
+
 static const struct {
     const char* prefix;
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
@@ -1130,6 +1208,7 @@ static const struct {
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
       {"/rest/spenttxouts/", rest_spent_txouts},
+      {"/rest/addresshistory/", rest_address_history},
 };
 
 void StartREST(const std::any& context)
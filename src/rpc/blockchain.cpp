@@ -20,9 +20,11 @@
 #include <deploymentstatus.h>
 #include <flatfile.h>
 #include <hash.h>
+#include <index/addressindex.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
 #include <interfaces/mining.h>
+#include <key_io.h>
 #include <kernel/coinstats.h>
 #include <logging/timer.h>
 #include <net.h>
@@ -33,6 +35,7 @@
 #include <node/utxo_snapshot.h>
 #include <node/warnings.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -48,18 +51,25 @@
 #include <util/fs.h>
 #include <util/strencodings.h>
 #include <util/syserror.h>
+#include <util/threadnames.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <validationinterface.h>
 #include <versionbits.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 
+#include <chrono>
 #include <condition_variable>
+#include <exception>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 
 using kernel::CCoinsStats;
@@ -86,7 +96,8 @@ UniValue WriteUTXOSnapshot(
     AutoFile&& afile,
     const fs::path& path,
     const fs::path& temppath,
-    const std::function<void()>& interruption_point = {});
+    const std::function<void()>& interruption_point = {},
+    uint16_t version = SnapshotMetadata::VERSION);
 
 /* Calculate the difficulty for a given block index.
  */
@@ -178,20 +189,24 @@ UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex
     return result;
 }
 
-UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+/** The fields of a block's description before its transactions. */
+static UniValue BlockSummaryToJSON(const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit)
 {
     UniValue result = blockheaderToJSON(tip, blockindex, pow_limit);
 
     result.pushKV("strippedsize", (int)::GetSerializeSize(TX_NO_WITNESS(block)));
     result.pushKV("size", (int)::GetSerializeSize(TX_WITH_WITNESS(block)));
     result.pushKV("weight", (int)::GetBlockWeight(block));
-    UniValue txs(UniValue::VARR);
-    txs.reserve(block.vtx.size());
+    return result;
+}
 
+/** Pass the description of each of the block's transactions to fn, in order. */
+static void ForEachBlockTxJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& blockindex, TxVerbosity verbosity, const std::function<void(UniValue)>& fn)
+{
     switch (verbosity) {
         case TxVerbosity::SHOW_TXID:
             for (const CTransactionRef& tx : block.vtx) {
-                txs.push_back(tx->GetHash().GetHex());
+                fn(tx->GetHash().GetHex());
             }
             break;
 
@@ -209,16 +224,38 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
                 const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
                 UniValue objTx(UniValue::VOBJ);
                 TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, txundo, verbosity);
-                txs.push_back(std::move(objTx));
+                fn(std::move(objTx));
             }
             break;
     }
+}
 
+UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+{
+    UniValue result = BlockSummaryToJSON(block, tip, blockindex, pow_limit);
+
+    UniValue txs(UniValue::VARR);
+    txs.reserve(block.vtx.size());
+    ForEachBlockTxJSON(blockman, block, blockindex, verbosity, [&](UniValue tx) { txs.push_back(std::move(tx)); });
     result.pushKV("tx", std::move(txs));
 
     return result;
 }
 
+void blockToJSON(JSONStreamWriter& stream, BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+{
+    stream.BeginObject();
+    stream.KeyValues(BlockSummaryToJSON(block, tip, blockindex, pow_limit));
+    stream.Key("tx");
+    stream.BeginArray();
+    ForEachBlockTxJSON(blockman, block, blockindex, verbosity, [&](UniValue tx) {
+        stream.Value(tx);
+        stream.MaybeFlush();
+    });
+    stream.EndArray();
+    stream.EndObject();
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{
@@ -846,6 +883,10 @@ static RPCHelpMan getblock()
         tx_verbosity = TxVerbosity::SHOW_DETAILS_AND_PREVOUT;
     }
 
+    if (request.m_stream && tx_verbosity != TxVerbosity::SHOW_TXID) {
+        blockToJSON(*request.m_stream, chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
+        return UniValue::VNULL;
+    }
     return blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
 },
     };
@@ -2165,15 +2206,23 @@ static RPCHelpMan getblockstats()
 }
 
 namespace {
-//! Search for a given set of pubkey scripts
-bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor* cursor, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results, std::function<void()>& interruption_point)
+//! Maximum number of threads that scan the UTXO set for scantxoutset
+constexpr size_t MAX_SCAN_THREADS{16};
+
+//! Search a range of the UTXO set, [begin, end) in txid prefixes, for a given set of pubkey scripts
+bool FindScriptPubKey(std::atomic<int>& scan_progress, std::atomic<uint32_t>& scanned_prefixes, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor& cursor, uint32_t begin, uint32_t end, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results, const std::function<void()>& interruption_point)
 {
-    scan_progress = 0;
     count = 0;
-    while (cursor->Valid()) {
+    uint32_t done{begin};
+    const auto advance{[&](uint32_t prefix) {
+        const uint32_t scanned{scanned_prefixes.fetch_add(prefix - done) + prefix - done};
+        scan_progress = (int)(scanned * 100.0 / COINS_CURSOR_PREFIXES + 0.5);
+        done = prefix;
+    }};
+    while (cursor.Valid()) {
         COutPoint key;
         Coin coin;
-        if (!cursor->GetKey(key) || !cursor->GetValue(coin)) return false;
+        if (!cursor.GetKey(key) || !cursor.GetValue(coin)) return false;
         if (++count % 8192 == 0) {
             interruption_point();
             if (should_abort) {
@@ -2183,17 +2232,87 @@ bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>&
         }
         if (count % 256 == 0) {
             // update progress reference every 256 item
-            uint32_t high = 0x100 * *UCharCast(key.hash.begin()) + *(UCharCast(key.hash.begin()) + 1);
-            scan_progress = (int)(high * 100.0 / 65536.0 + 0.5);
+            advance(CoinsCursorPrefix(key));
         }
         if (needles.count(coin.out.scriptPubKey)) {
             out_results.emplace(key, coin);
         }
-        cursor->Next();
+        cursor.Next();
     }
-    scan_progress = 100;
+    advance(end);
     return true;
 }
+
+//! Search the UTXO set for a given set of pubkey scripts, scanning the ranges
+//! of cursors, as returned by CCoinsView::Cursors(), in parallel
+bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, std::vector<std::unique_ptr<CCoinsViewCursor>>& cursors, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results, const std::function<void()>& interruption_point)
+{
+    scan_progress = 0;
+    count = 0;
+    struct Range {
+        int64_t count{0};
+        std::map<COutPoint, Coin> results;
+        bool complete{false};
+    };
+    std::vector<Range> ranges(cursors.size());
+    std::atomic<uint32_t> scanned_prefixes{0};
+    // Set when any range stops early, so that the others stop too.
+    std::atomic<bool> stop{false};
+    const auto scan{[&](size_t i, const std::function<void()>& interrupt) {
+        Range& range{ranges[i]};
+        range.complete = FindScriptPubKey(scan_progress, scanned_prefixes, stop, range.count, *cursors[i],
+                                          CoinsCursorRangeBegin(i, cursors.size()), CoinsCursorRangeBegin(i + 1, cursors.size()),
+                                          needles, range.results, interrupt);
+        if (!range.complete) stop = true;
+    }};
+
+    // The first range is scanned on this thread, which also handles
+    // interruption until all ranges are done, and rethrows errors of the
+    // other ranges.
+    std::vector<std::exception_ptr> errors(cursors.size());
+    std::vector<std::thread> threads;
+    std::atomic<size_t> running{cursors.size() - 1};
+    for (size_t i{1}; i < cursors.size(); ++i) {
+        threads.emplace_back([&, i] {
+            util::ThreadRename(strprintf("scantxout.%d", i));
+            try {
+                scan(i, [&] { if (should_abort) stop = true; });
+            } catch (...) {
+                errors[i] = std::current_exception();
+                stop = true;
+            }
+            --running;
+        });
+    }
+    try {
+        const auto interrupt{[&] {
+            interruption_point();
+            if (should_abort) stop = true;
+        }};
+        scan(0, interrupt);
+        while (running > 0) {
+            interrupt();
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+    } catch (...) {
+        stop = true;
+        for (std::thread& thread : threads) thread.join();
+        throw;
+    }
+    for (std::thread& thread : threads) thread.join();
+    for (const std::exception_ptr& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    bool complete{true};
+    for (Range& range : ranges) {
+        count += range.count;
+        out_results.merge(range.results);
+        complete &= range.complete;
+    }
+    if (complete) scan_progress = 100;
+    return complete;
+}
 } // namespace
 
 /** RAII object to prevent concurrency issue when scanning the txout set */
@@ -2377,7 +2496,7 @@ static RPCHelpMan scantxoutset()
         std::map<COutPoint, Coin> coins;
         g_should_abort_scan = false;
         int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
+        std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
         const CBlockIndex* tip;
         NodeContext& node = EnsureAnyNodeContext(request.context);
         {
@@ -2385,10 +2504,11 @@ static RPCHelpMan scantxoutset()
             LOCK(cs_main);
             Chainstate& active_chainstate = chainman.ActiveChainstate();
             active_chainstate.ForceFlushStateToDisk();
-            pcursor = CHECK_NONFATAL(active_chainstate.CoinsDB().Cursor());
+            cursors = active_chainstate.CoinsDB().Cursors(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_SCAN_THREADS));
+            CHECK_NONFATAL(!cursors.empty());
             tip = CHECK_NONFATAL(active_chainstate.m_chain.Tip());
         }
-        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins, node.rpc_interruption_point);
+        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, cursors, needles, coins, node.rpc_interruption_point);
         result.pushKV("success", res);
         result.pushKV("txouts", count);
         result.pushKV("height", tip->nHeight);
@@ -2983,6 +3103,124 @@ static RPCHelpMan getblockfilter()
     };
 }
 
+std::optional<CScript> AddressOrScriptToScript(const std::string& address_or_script)
+{
+    const CTxDestination dest{DecodeDestination(address_or_script)};
+    if (IsValidDestination(dest)) return GetScriptForDestination(dest);
+    if (IsHex(address_or_script)) {
+        const std::vector<unsigned char> script{ParseHex(address_or_script)};
+        return CScript(script.begin(), script.end());
+    }
+    return std::nullopt;
+}
+
+UniValue AddressHistoryToJSON(const std::vector<AddressIndexEntry>& entries)
+{
+    UniValue history(UniValue::VARR);
+    for (const AddressIndexEntry& entry : entries) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("height", entry.height);
+        if (entry.spending) {
+            obj.pushKV("type", "spending");
+            obj.pushKV("txid", entry.spending_txid.GetHex());
+            obj.pushKV("vin", entry.spending_input);
+            obj.pushKV("spent_txid", entry.outpoint.hash.GetHex());
+            obj.pushKV("spent_vout", entry.outpoint.n);
+        } else {
+            obj.pushKV("type", "funding");
+            obj.pushKV("txid", entry.outpoint.hash.GetHex());
+            obj.pushKV("vout", entry.outpoint.n);
+        }
+        obj.pushKV("amount", ValueFromAmount(entry.amount));
+        history.push_back(std::move(obj));
+    }
+    return history;
+}
+
+static RPCHelpMan getaddresshistory()
+{
+    return RPCHelpMan{
+        "getaddresshistory",
+        "Returns the outputs paying to an address or scriptPubKey and the inputs spending them, in order of block height.\n"
+        "Requires -addressindex.\n",
+                {
+                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address, or the hex-encoded scriptPubKey"},
+                    {"from_height", RPCArg::Type::NUM, RPCArg::Default{0}, "The height of the first block to include"},
+                    {"to_height", RPCArg::Type::NUM, RPCArg::DefaultHint{"the height of the index"}, "The height of the last block to include"},
+                    {"count", RPCArg::Type::NUM, RPCArg::Default{DEFAULT_ADDRESS_HISTORY_COUNT}, "The most entries to return"},
+                    {"skip", RPCArg::Type::NUM, RPCArg::Default{0}, "The number of entries to skip, such as those returned by earlier calls for the same range"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "height", "The height to which the index is synced"},
+                        {RPCResult::Type::ARR, "history", "",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::NUM, "height", "The height of the block of the transaction"},
+                                {RPCResult::Type::STR, "type", "\"funding\" for an output paying to the script, \"spending\" for an input spending one"},
+                                {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
+                                {RPCResult::Type::NUM, "vout", /*optional=*/true, "The output index, for a funding entry"},
+                                {RPCResult::Type::NUM, "vin", /*optional=*/true, "The input index, for a spending entry"},
+                                {RPCResult::Type::STR_HEX, "spent_txid", /*optional=*/true, "The transaction id of the spent output, for a spending entry"},
+                                {RPCResult::Type::NUM, "spent_vout", /*optional=*/true, "The output index of the spent output, for a spending entry"},
+                                {RPCResult::Type::STR_AMOUNT, "amount", "The amount of the output in " + CURRENCY_UNIT},
+                            }},
+                        }},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\"") +
+                    HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\" 800000 810000") +
+                    HelpExampleCli("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\" 800000 810000 100 200") +
+                    HelpExampleRpc("getaddresshistory", "\"" + EXAMPLE_ADDRESS[0] + "\", 800000, 810000")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    if (!g_address_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index not enabled. Use -addressindex to enable it.");
+    }
+
+    const std::optional<CScript> script{AddressOrScriptToScript(request.params[0].get_str())};
+    if (!script) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address or scriptPubKey");
+    }
+
+    const int from_height{request.params[1].isNull() ? 0 : request.params[1].getInt<int>()};
+    const std::optional<int> to_height{request.params[2].isNull() ? std::nullopt : std::optional{request.params[2].getInt<int>()}};
+    if (from_height < 0 || (to_height && *to_height < from_height)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid height range");
+    }
+    const int count{request.params[3].isNull() ? DEFAULT_ADDRESS_HISTORY_COUNT : request.params[3].getInt<int>()};
+    const int skip{request.params[4].isNull() ? 0 : request.params[4].getInt<int>()};
+    if (count < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    }
+    if (skip < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative skip");
+    }
+
+    const bool synced{g_address_index->BlockUntilSyncedToCurrentChain()};
+    const IndexSummary summary{g_address_index->GetSummary()};
+    // The history up to a height the index has already synced past can be
+    // returned even though the index is not fully synced yet.
+    if (!synced && (!to_height || *to_height > summary.best_block_height)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, strprintf("Unable to get data because addressindex is still syncing. Current height: %d", summary.best_block_height));
+    }
+
+    std::vector<AddressIndexEntry> entries;
+    if (!g_address_index->FindScriptHistory(*script, from_height, std::min(to_height.value_or(summary.best_block_height), summary.best_block_height), entries, skip, count)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read the address index");
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("height", summary.best_block_height);
+    ret.pushKV("history", AddressHistoryToJSON(entries));
+    return ret;
+},
+    };
+}
+
 /**
  * RAII class that disables the network in its constructor and enables it in its
  * destructor.
@@ -3040,6 +3278,8 @@ static RPCHelpMan dumptxoutset()
                     {"rollback", RPCArg::Type::NUM, RPCArg::Optional::OMITTED,
                         "Height or hash of the block to roll back to before creating the snapshot. Note: The further this number is from the tip, the longer this process will take. Consider setting a higher -rpcclienttimeout value in this case.",
                     RPCArgOptions{.skip_type_check = true, .type_str = {"", "string or numeric"}}},
+                    {"version", RPCArg::Type::NUM, RPCArg::Default{SnapshotMetadata::VERSION},
+                        "The format version of the snapshot. Version 3 splits the coins into chunks with their own hashes, which are checked as they are loaded and are decoded in parallel. It cannot be loaded by older versions of this software."},
                 },
             },
         },
@@ -3082,6 +3322,15 @@ static RPCHelpMan dumptxoutset()
         throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid snapshot type \"%s\" specified. Please specify \"rollback\" or \"latest\"", snapshot_type));
     }
 
+    uint16_t version{SnapshotMetadata::VERSION};
+    if (options.exists("version")) {
+        const int requested{options["version"].getInt<int>()};
+        if (requested != SnapshotMetadata::VERSION && requested != SnapshotMetadata::CHUNKED_VERSION) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid snapshot version %d. Please specify %d or %d", requested, SnapshotMetadata::VERSION, SnapshotMetadata::CHUNKED_VERSION));
+        }
+        version = requested;
+    }
+
     const ArgsManager& args{EnsureAnyArgsman(request.context)};
     const fs::path path = fsbridge::AbsPathJoin(args.GetDataDirNet(), fs::u8path(request.params[0].get_str()));
     // Write to a temporary path and then move into `path` on completion
@@ -3171,7 +3420,8 @@ static RPCHelpMan dumptxoutset()
                                         std::move(afile),
                                         path,
                                         temppath,
-                                        node.rpc_interruption_point);
+                                        node.rpc_interruption_point,
+                                        version);
     fs::rename(temppath, path);
 
     result.pushKV("path", path.utf8string());
@@ -3218,24 +3468,15 @@ PrepareUTXOSnapshot(
     return {std::move(pcursor), *CHECK_NONFATAL(maybe_stats), tip};
 }
 
-UniValue WriteUTXOSnapshot(
-    Chainstate& chainstate,
-    CCoinsViewCursor* pcursor,
-    CCoinsStats* maybe_stats,
-    const CBlockIndex* tip,
-    AutoFile&& afile,
-    const fs::path& path,
-    const fs::path& temppath,
-    const std::function<void()>& interruption_point)
-{
-    LOG_TIME_SECONDS(strprintf("writing UTXO snapshot at height %s (%s) to file %s (via %s)",
-        tip->nHeight, tip->GetBlockHash().ToString(),
-        fs::PathToString(path), fs::PathToString(temppath)));
-
-    SnapshotMetadata metadata{chainstate.m_chainman.GetParams().MessageStart(), tip->GetBlockHash(), maybe_stats->coins_count};
-
-    afile << metadata;
+namespace {
+//! Maximum number of threads that encode the chunks of a snapshot for dumptxoutset
+constexpr size_t MAX_SNAPSHOT_THREADS{16};
+//! Upper bound of the serialized size of a coin in a snapshot, without its script
+constexpr uint64_t MAX_SNAPSHOT_COIN_OVERHEAD{32 + 9 + 5 + 5 + 10 + 5};
 
+//! Write the coins of a cursor as a single stream, returning the number of coins written
+size_t WriteSnapshotCoins(AutoFile& afile, CCoinsViewCursor* pcursor, const std::function<void()>& interruption_point)
+{
     COutPoint key;
     Txid last_hash;
     Coin coin;
@@ -3279,6 +3520,119 @@ UniValue WriteUTXOSnapshot(
     if (!coins.empty()) {
         write_coins_to_file(afile, last_hash, coins, written_coins_count);
     }
+    return written_coins_count;
+}
+
+/**
+ * Write the coins of a cursor as the chunks of a chunked snapshot, followed
+ * by their directory, returning the number of coins written. The chunks are
+ * encoded and hashed a round at a time, one thread per chunk, while the next
+ * round is read from the cursor.
+ */
+size_t WriteSnapshotChunks(AutoFile& afile, CCoinsViewCursor& cursor, const std::function<void()>& interruption_point)
+{
+    using Coins = std::vector<std::pair<COutPoint, Coin>>;
+    const size_t threads{std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_SNAPSHOT_THREADS)};
+    std::vector<node::SnapshotChunkInfo> directory;
+    std::vector<Coins> round;
+    size_t written_coins_count{0};
+
+    //! A round of chunks being encoded and hashed, one thread per chunk.
+    struct PendingRound {
+        std::vector<Coins> coins;
+        std::vector<DataStream> chunks;
+        std::vector<node::SnapshotChunkInfo> infos;
+        std::vector<std::thread> workers;
+
+        void Join()
+        {
+            for (auto& worker : workers) worker.join();
+            workers.clear();
+        }
+        ~PendingRound() { Join(); }
+    };
+    std::optional<PendingRound> pending;
+
+    // Wait for the pending round and append its chunks to the file.
+    const auto finish_round{[&] {
+        if (!pending) return;
+        pending->Join();
+        for (size_t i{0}; i < pending->chunks.size(); ++i) {
+            afile.write(pending->chunks[i]);
+            written_coins_count += pending->infos[i].m_coins_count;
+            directory.push_back(std::move(pending->infos[i]));
+        }
+        pending.reset();
+    }};
+    const auto start_round{[&] {
+        finish_round();
+        PendingRound& next{pending.emplace()};
+        next.coins = std::move(round);
+        round.clear();
+        next.chunks.resize(next.coins.size());
+        next.infos.resize(next.coins.size());
+        for (size_t i{0}; i < next.coins.size(); ++i) {
+            next.workers.emplace_back([&next, i] {
+                util::ThreadRename(strprintf("dumptxoutset.%i", i));
+                next.infos[i] = node::WriteSnapshotChunk(next.chunks[i], next.coins[i]);
+            });
+        }
+    }};
+
+    COutPoint key;
+    Coin coin;
+    unsigned int iter{0};
+    Coins chunk;
+    uint64_t chunk_size{0};
+    while (cursor.Valid()) {
+        if (iter % 5000 == 0) interruption_point();
+        ++iter;
+        if (cursor.GetKey(key) && cursor.GetValue(coin)) {
+            const uint64_t coin_size{MAX_SNAPSHOT_COIN_OVERHEAD + coin.out.scriptPubKey.size()};
+            if (chunk.size() == node::SNAPSHOT_CHUNK_MAX_COINS || chunk_size + coin_size > node::SNAPSHOT_CHUNK_MAX_SIZE) {
+                round.push_back(std::move(chunk));
+                chunk.clear();
+                chunk_size = 0;
+                if (round.size() == threads) start_round();
+            }
+            chunk.emplace_back(key, std::move(coin));
+            chunk_size += coin_size;
+        }
+        cursor.Next();
+    }
+    if (!chunk.empty()) round.push_back(std::move(chunk));
+    if (!round.empty()) start_round();
+    finish_round();
+
+    const uint64_t directory_offset = afile.tell();
+    afile << directory;
+    afile << directory_offset;
+    return written_coins_count;
+}
+} // namespace
+
+UniValue WriteUTXOSnapshot(
+    Chainstate& chainstate,
+    CCoinsViewCursor* pcursor,
+    CCoinsStats* maybe_stats,
+    const CBlockIndex* tip,
+    AutoFile&& afile,
+    const fs::path& path,
+    const fs::path& temppath,
+    const std::function<void()>& interruption_point,
+    uint16_t version)
+{
+    LOG_TIME_SECONDS(strprintf("writing UTXO snapshot at height %s (%s) to file %s (via %s)",
+        tip->nHeight, tip->GetBlockHash().ToString(),
+        fs::PathToString(path), fs::PathToString(temppath)));
+
+    SnapshotMetadata metadata{chainstate.m_chainman.GetParams().MessageStart(), tip->GetBlockHash(), maybe_stats->coins_count, version};
+
+    afile << metadata;
+
+    const size_t written_coins_count{version == SnapshotMetadata::CHUNKED_VERSION ?
+        WriteSnapshotChunks(afile, *pcursor, interruption_point) :
+        WriteSnapshotCoins(afile, pcursor, interruption_point)};
 
     CHECK_NONFATAL(written_coins_count == maybe_stats->coins_count);
 
@@ -3302,7 +3656,8 @@ UniValue CreateUTXOSnapshot(
     Chainstate& chainstate,
     AutoFile&& afile,
     const fs::path& path,
-    const fs::path& tmppath)
+    const fs::path& tmppath,
+    uint16_t version)
 {
     auto [cursor, stats, tip]{WITH_LOCK(::cs_main, return PrepareUTXOSnapshot(chainstate, node.rpc_interruption_point))};
     return WriteUTXOSnapshot(chainstate,
@@ -3312,7 +3667,8 @@ UniValue CreateUTXOSnapshot(
                              std::move(afile),
                              path,
                              tmppath,
-                             node.rpc_interruption_point);
+                             node.rpc_interruption_point,
+                             version);
 }
 
 static RPCHelpMan loadtxoutset()
@@ -3494,6 +3850,7 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &scanblocks},
         {"blockchain", &getdescriptoractivity},
         {"blockchain", &getblockfilter},
+        {"blockchain", &getaddresshistory},
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
         {"blockchain", &getchainstates},
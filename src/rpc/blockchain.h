@@ -7,6 +7,7 @@
 
 #include <consensus/amount.h>
 #include <core_io.h>
+#include <node/utxo_snapshot.h>
 #include <streams.h>
 #include <sync.h>
 #include <util/fs.h>
@@ -14,12 +15,17 @@
 
 #include <any>
 #include <cstdint>
+#include <optional>
+#include <string>
 #include <vector>
 
 class CBlock;
 class CBlockIndex;
+class CScript;
 class Chainstate;
+class JSONStreamWriter;
 class UniValue;
+struct AddressIndexEntry;
 namespace node {
 class BlockManager;
 struct NodeContext;
@@ -27,6 +33,9 @@ struct NodeContext;
 
 static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
 
+/** Default for the most address history entries returned by getaddresshistory and /rest/addresshistory */
+static constexpr int DEFAULT_ADDRESS_HISTORY_COUNT{1000};
+
 /**
  * Get the difficulty of the net wrt to the given block index.
  *
@@ -38,6 +47,9 @@ double GetDifficulty(const CBlockIndex& blockindex);
 /** Block description to JSON */
 UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
+/** Block description to JSON, written to a stream */
+void blockToJSON(JSONStreamWriter& stream, node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
+
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
@@ -53,10 +65,17 @@ UniValue CreateUTXOSnapshot(
     Chainstate& chainstate,
     AutoFile&& afile,
     const fs::path& path,
-    const fs::path& tmppath);
+    const fs::path& tmppath,
+    uint16_t version = node::SnapshotMetadata::VERSION);
 
 //! Return height of highest block that has been pruned, or std::nullopt if no blocks have been pruned
 std::optional<int> GetPruneHeight(const node::BlockManager& blockman, const CChain& chain) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 void CheckBlockDataAvailability(node::BlockManager& blockman, const CBlockIndex& blockindex, bool check_for_undo) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+/** Parse an address, or a hex-encoded scriptPubKey, into the scriptPubKey */
+std::optional<CScript> AddressOrScriptToScript(const std::string& address_or_script);
+
+/** Address index history to JSON */
+UniValue AddressHistoryToJSON(const std::vector<AddressIndexEntry>& entries);
+
 #endif // BITCOIN_RPC_BLOCKCHAIN_H
@@ -112,6 +112,10 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getblock", 1, "verbose" },
     { "getblockheader", 1, "verbose" },
     { "getchaintxstats", 0, "nblocks" },
+    { "getaddresshistory", 1, "from_height" },
+    { "getaddresshistory", 2, "to_height" },
+    { "getaddresshistory", 3, "count" },
+    { "getaddresshistory", 4, "skip" },
     { "gettransaction", 1, "include_watchonly" },
     { "gettransaction", 2, "verbose" },
     { "getrawtransaction", 1, "verbosity" },
@@ -193,6 +197,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "gettxoutsetinfo", 2, "use_index"},
     { "dumptxoutset", 2, "options" },
     { "dumptxoutset", 2, "rollback", /*also_string=*/true },
+    { "dumptxoutset", 2, "version" },
     { "lockunspent", 0, "unlock" },
     { "lockunspent", 1, "transactions" },
     { "lockunspent", 2, "persistent" },
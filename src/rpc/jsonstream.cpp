@@ -0,0 +1,82 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <univalue.h>
+#include <util/check.h>
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, size_t flush_size)
+    : m_sink{std::move(sink)}, m_flush_size{flush_size}
+{
+    m_buffer.reserve(m_flush_size);
+}
+
+void JSONStreamWriter::Separate()
+{
+    m_written = true;
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (m_nonempty.empty()) return;
+    if (m_nonempty.back()) m_buffer += ',';
+    m_nonempty.back() = true;
+}
+
+void JSONStreamWriter::Begin(char open)
+{
+    Separate();
+    m_buffer += open;
+    m_nonempty.push_back(false);
+}
+
+void JSONStreamWriter::End(char close)
+{
+    Assume(!m_nonempty.empty() && !m_after_key);
+    m_nonempty.pop_back();
+    m_buffer += close;
+}
+
+void JSONStreamWriter::BeginObject() { Begin('{'); }
+void JSONStreamWriter::EndObject() { End('}'); }
+void JSONStreamWriter::BeginArray() { Begin('['); }
+void JSONStreamWriter::EndArray() { End(']'); }
+
+void JSONStreamWriter::Key(std::string_view key)
+{
+    Assume(!m_after_key);
+    Separate();
+    m_buffer += UniValue{std::string{key}}.write();
+    m_buffer += ':';
+    m_after_key = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    Separate();
+    m_buffer += value.write();
+}
+
+void JSONStreamWriter::KeyValues(const UniValue& obj)
+{
+    const std::vector<std::string>& keys{obj.getKeys()};
+    const std::vector<UniValue>& values{obj.getValues()};
+    for (size_t i{0}; i < keys.size(); ++i) {
+        Key(keys[i]);
+        Value(values[i]);
+    }
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (m_buffer.empty()) return;
+    m_sink(m_buffer);
+    m_buffer.clear();
+}
+
+void JSONStreamWriter::MaybeFlush()
+{
+    if (m_buffer.size() >= m_flush_size) Flush();
+}
@@ -0,0 +1,67 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class UniValue;
+
+/**
+ * Writes a JSON value piece by piece into a buffer that is handed to a sink,
+ * so that a large value can be sent while it is produced, without building it
+ * as a UniValue first. The output is compact, like UniValue::write().
+ *
+ * Buffered output only goes to the sink in Flush() and MaybeFlush(), which
+ * may block, so callers choose where that happens, e.g. not while holding a
+ * lock.
+ */
+class JSONStreamWriter
+{
+public:
+    using Sink = std::function<void(std::string_view)>;
+
+    static constexpr size_t DEFAULT_FLUSH_SIZE{64 << 10};
+
+    explicit JSONStreamWriter(Sink sink, size_t flush_size = DEFAULT_FLUSH_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    /** Write the key of the next value in the current object. */
+    void Key(std::string_view key);
+    void Value(const UniValue& value);
+    /** Write the key-value pairs of the object obj into the current object. */
+    void KeyValues(const UniValue& obj);
+
+    /** Hand the buffered output to the sink. */
+    void Flush();
+    /** Hand the buffered output to the sink if it has grown to the flush size. */
+    void MaybeFlush();
+
+    /** Whether nothing has been written yet. */
+    bool Empty() const { return !m_written; }
+
+private:
+    /** Write the separator before a key, or a value that has no key. */
+    void Separate();
+    void Begin(char open);
+    void End(char close);
+
+    const Sink m_sink;
+    const size_t m_flush_size;
+    std::string m_buffer;
+    /** For each open object and array, whether it has an element yet */
+    std::vector<bool> m_nonempty;
+    bool m_after_key{false};
+    bool m_written{false};
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
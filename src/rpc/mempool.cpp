@@ -17,6 +17,7 @@
 #include <policy/rbf.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonstream.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
@@ -28,7 +29,9 @@
 #include <util/time.h>
 #include <util/vector.h>
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 using node::DumpMempool;
 
@@ -381,6 +384,41 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+/** How many mempool entries MempoolToJSON describes per lock of the mempool */
+static constexpr size_t MEMPOOL_JSON_BATCH_SIZE{100};
+
+void MempoolToJSON(JSONStreamWriter& stream, const CTxMemPool& pool)
+{
+    // Take the txids first, then describe the entries a batch at a time and
+    // flush the text between batches with the lock released, so that neither
+    // a large mempool nor a slow client holds up the mempool for long.
+    std::vector<Txid> txids;
+    {
+        LOCK(pool.cs);
+        txids.reserve(pool.size());
+        for (const CTxMemPoolEntry& e : pool.entryAll()) {
+            txids.push_back(e.GetTx().GetHash());
+        }
+    }
+    stream.BeginObject();
+    for (size_t i{0}; i < txids.size();) {
+        {
+            LOCK(pool.cs);
+            for (const size_t end{std::min(i + MEMPOOL_JSON_BATCH_SIZE, txids.size())}; i < end; ++i) {
+                const auto it{pool.GetIter(txids[i])};
+                if (!it) continue;
+                UniValue info(UniValue::VOBJ);
+                entryToJSON(pool, info, **it);
+                stream.Key(txids[i].ToString());
+                stream.Value(info);
+            }
+        }
+        stream.MaybeFlush();
+    }
+    stream.EndObject();
+    stream.MaybeFlush();
+}
+
 static RPCHelpMan getrawmempool()
 {
     return RPCHelpMan{
@@ -427,6 +465,10 @@ static RPCHelpMan getrawmempool()
         include_mempool_sequence = request.params[1].get_bool();
     }
 
+    if (request.m_stream && fVerbose && !include_mempool_sequence) {
+        MempoolToJSON(*request.m_stream, EnsureAnyMemPool(request.context));
+        return UniValue::VNULL;
+    }
     return MempoolToJSON(EnsureAnyMemPool(request.context), fVerbose, include_mempool_sequence);
 },
     };
@@ -6,6 +6,7 @@
 #define BITCOIN_RPC_MEMPOOL_H
 
 class CTxMemPool;
+class JSONStreamWriter;
 class UniValue;
 
 /** Mempool information to JSON */
@@ -14,4 +15,10 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool);
 /** Mempool to JSON */
 UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose = false, bool include_mempool_sequence = false);
 
+/**
+ * Verbose mempool to JSON, written to a stream a batch of entries at a time.
+ * Transactions removed from the mempool while it is written are left out.
+ */
+void MempoolToJSON(JSONStreamWriter& stream, const CTxMemPool& pool);
+
 #endif // BITCOIN_RPC_MEMPOOL_H
@@ -13,6 +13,8 @@
 #include <univalue.h>
 #include <util/fs.h>
 
+class JSONStreamWriter;
+
 enum class JSONRPCVersion {
     V1_LEGACY,
     V2
@@ -61,6 +63,12 @@ public:
     std::string peerAddr;
     std::any context;
     JSONRPCVersion m_json_version = JSONRPCVersion::V1_LEGACY;
+    /**
+     * If set, a method with a large result may write it here while producing
+     * it, and return null, instead of returning it. The reply is then sent as
+     * the result is written.
+     */
+    JSONStreamWriter* m_stream{nullptr};
 
     void parse(const UniValue& valRequest);
     [[nodiscard]] bool IsNotification() const { return !id.has_value() && m_json_version == JSONRPCVersion::V2; };
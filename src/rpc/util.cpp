@@ -15,6 +15,7 @@
 #include <node/types.h>
 #include <outputtype.h>
 #include <pow.h>
+#include <rpc/jsonstream.h>
 #include <rpc/util.h>
 #include <script/descriptor.h>
 #include <script/interpreter.h>
@@ -662,7 +663,9 @@ UniValue RPCHelpMan::HandleRequest(const JSONRPCRequest& request) const
     m_req = &request;
     UniValue ret = m_fun(*this, request);
     m_req = nullptr;
-    if (gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK)) {
+    // A result written to the request's stream has been sent, and can not be checked.
+    const bool streamed{request.m_stream && !request.m_stream->Empty()};
+    if (!streamed && gArgs.GetBoolArg("-rpcdoccheck", DEFAULT_RPC_DOC_CHECK)) {
         UniValue mismatch{UniValue::VARR};
         for (const auto& res : m_results.m_results) {
             UniValue match{res.MatchesType(ret)};
@@ -0,0 +1,115 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <index/addressindex.h>
+#include <interfaces/chain.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(addressindex_initial_sync, TestChain100Setup)
+{
+    AddressIndex address_index(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(address_index.Init());
+
+    const CScript coinbase_script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    std::vector<AddressIndexEntry> entries;
+
+    // The history should be empty before the index is started.
+    BOOST_CHECK(address_index.FindScriptHistory(coinbase_script, 0, 200, entries));
+    BOOST_CHECK(entries.empty());
+
+    // BlockUntilSyncedToCurrentChain should return false before the index is started.
+    BOOST_CHECK(!address_index.BlockUntilSyncedToCurrentChain());
+
+    address_index.Sync();
+
+    // Check that the index has the outputs of all blocks but the genesis block,
+    // in order of height.
+    BOOST_CHECK(address_index.FindScriptHistory(coinbase_script, 0, 200, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), m_coinbase_txns.size());
+    for (size_t i{0}; i < entries.size(); ++i) {
+        BOOST_CHECK_EQUAL(entries[i].height, int(i + 1));
+        BOOST_CHECK(!entries[i].spending);
+        BOOST_CHECK(entries[i].outpoint == COutPoint(m_coinbase_txns[i]->GetHash(), 0));
+        BOOST_CHECK_EQUAL(entries[i].amount, m_coinbase_txns[i]->vout[0].nValue);
+    }
+
+    // Check a range of heights.
+    entries.clear();
+    BOOST_CHECK(address_index.FindScriptHistory(coinbase_script, 10, 19, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 10U);
+    BOOST_CHECK_EQUAL(entries.front().height, 10);
+    BOOST_CHECK_EQUAL(entries.back().height, 19);
+
+    // Check that a page of the history starts after the skipped entries.
+    entries.clear();
+    BOOST_CHECK(address_index.FindScriptHistory(coinbase_script, 10, 19, entries, /*skip=*/3, /*max_count=*/4));
+    BOOST_REQUIRE_EQUAL(entries.size(), 4U);
+    BOOST_CHECK_EQUAL(entries.front().height, 13);
+    BOOST_CHECK_EQUAL(entries.back().height, 16);
+    entries.clear();
+    BOOST_CHECK(address_index.FindScriptHistory(coinbase_script, 10, 19, entries, /*skip=*/8, /*max_count=*/4));
+    BOOST_REQUIRE_EQUAL(entries.size(), 2U);
+    BOOST_CHECK_EQUAL(entries.back().height, 19);
+
+    // Check that a spend of a coinbase output in a new block makes it into the
+    // index, along with the output it creates.
+    const CScript dest_script{GetScriptForDestination(WitnessV0ScriptHash(CScript() << OP_TRUE))};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 1, coinbaseKey, dest_script, 1 * COIN, /*submit=*/false)};
+    const CBlock block{CreateAndProcessBlock({spend}, coinbase_script)};
+    BOOST_CHECK(address_index.BlockUntilSyncedToCurrentChain());
+
+    entries.clear();
+    BOOST_CHECK(address_index.FindScriptHistory(coinbase_script, 101, 101, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 2U);
+    BOOST_CHECK(!entries[0].spending);
+    BOOST_CHECK(entries[0].outpoint == COutPoint(block.vtx[0]->GetHash(), 0));
+    BOOST_CHECK(entries[1].spending);
+    BOOST_CHECK(entries[1].outpoint == COutPoint(m_coinbase_txns[0]->GetHash(), 0));
+    BOOST_CHECK(entries[1].spending_txid == spend.GetHash());
+    BOOST_CHECK_EQUAL(entries[1].spending_input, 0U);
+    BOOST_CHECK_EQUAL(entries[1].amount, m_coinbase_txns[0]->vout[0].nValue);
+
+    entries.clear();
+    BOOST_CHECK(address_index.FindScriptHistory(dest_script, 0, 200, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 1U);
+    BOOST_CHECK_EQUAL(entries[0].height, 101);
+    BOOST_CHECK(entries[0].outpoint == COutPoint(spend.GetHash(), 0));
+    BOOST_CHECK_EQUAL(entries[0].amount, 1 * COIN);
+
+    // Check that the entries of a block are removed when it is disconnected.
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    BOOST_CHECK(address_index.BlockUntilSyncedToCurrentChain());
+
+    entries.clear();
+    BOOST_CHECK(address_index.FindScriptHistory(coinbase_script, 101, 200, entries));
+    BOOST_CHECK(entries.empty());
+    BOOST_CHECK(address_index.FindScriptHistory(dest_script, 0, 200, entries));
+    BOOST_CHECK(entries.empty());
+
+    // It is not safe to stop and destroy the index until it finishes handling
+    // the last BlockConnected notification. The BlockUntilSyncedToCurrentChain()
+    // call above is sufficient to ensure this, but the
+    // SyncWithValidationInterfaceQueue() call below is also needed to ensure
+    // TSAN always sees the test thread waiting for the notification thread, and
+    // avoid potential false positive reports.
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    address_index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,234 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <arith_uint256.h>
+#include <node/blockdownloadscheduler.h>
+#include <uint256.h>
+#include <util/time.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <vector>
+
+using namespace std::chrono_literals;
+using node::BlockDownloadScheduler;
+
+static uint256 BlockHash(int height) { return ArithToUint256(arith_uint256{uint64_t(height)}); }
+
+namespace {
+/** A peer of the simulation, serving the blocks requested from it one after the other. */
+struct SimPeer {
+    double bytes_per_second;
+    std::chrono::microseconds latency;
+    /** When the peer will have delivered everything requested from it */
+    std::chrono::microseconds busy_until{0};
+    /** Heights in flight, as tracked by the simulated node */
+    std::set<int> in_flight{};
+};
+
+/**
+ * Download num_blocks blocks of block_bytes each from the peers, assigning
+ * them in height order within a download window like PeerManager does. With
+ * adaptive set, the number of blocks in flight per peer and re-requests come
+ * from the scheduler, else every peer gets DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER
+ * blocks. Returns the time until all blocks are received.
+ */
+std::chrono::microseconds Simulate(BlockDownloadScheduler& scheduler, std::vector<SimPeer>& peers, int num_blocks, size_t block_bytes, bool adaptive)
+{
+    constexpr int WINDOW{64};
+    constexpr auto TICK{100ms};
+    std::chrono::microseconds now{0};
+    std::vector<bool> have(num_blocks);
+    int lowest_missing{0};
+    // Deliveries as (time, peer, height), earliest first
+    using Delivery = std::tuple<std::chrono::microseconds, size_t, int>;
+    std::priority_queue<Delivery, std::vector<Delivery>, std::greater<>> deliveries;
+
+    auto request = [&](size_t p, int height) {
+        SimPeer& peer{peers[p]};
+        const auto transfer{std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double>{block_bytes / peer.bytes_per_second})};
+        peer.busy_until = std::max(now + peer.latency, peer.busy_until) + transfer;
+        deliveries.emplace(peer.busy_until, p, height);
+        peer.in_flight.insert(height);
+        scheduler.BlockRequested(p, BlockHash(height), height, now);
+    };
+    auto is_in_flight = [&](int height) {
+        return std::ranges::any_of(peers, [&](const SimPeer& peer) { return peer.in_flight.contains(height); });
+    };
+
+    while (lowest_missing < num_blocks) {
+        // Send requests, like PeerManager's SendMessages.
+        for (size_t p{0}; p < peers.size(); ++p) {
+            const size_t max_in_flight{adaptive ? scheduler.GetMaxBlocksInFlight(p) : node::DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER};
+            if (peers[p].in_flight.size() >= max_in_flight) continue;
+            if (adaptive) {
+                for (const uint256& hash : scheduler.GetBlocksToRerequest(p, max_in_flight - peers[p].in_flight.size(), now)) {
+                    request(p, int(UintToArith256(hash).GetLow64()));
+                }
+            }
+            for (int height{lowest_missing}; height < std::min(lowest_missing + WINDOW, num_blocks) && peers[p].in_flight.size() < max_in_flight; ++height) {
+                if (!have[height] && !is_in_flight(height)) request(p, height);
+            }
+        }
+
+        // Receive what arrives until the next tick.
+        const auto next_tick{now + TICK};
+        while (!deliveries.empty() && std::get<0>(deliveries.top()) <= next_tick) {
+            const auto [time, p, height]{deliveries.top()};
+            deliveries.pop();
+            now = std::max(now, time);
+            if (!peers[p].in_flight.contains(height)) continue;
+            scheduler.BlockReceived(p, BlockHash(height), block_bytes, now);
+            // The block is no longer needed from any peer.
+            for (size_t other{0}; other < peers.size(); ++other) {
+                if (peers[other].in_flight.erase(height)) scheduler.RequestRemoved(other, BlockHash(height));
+            }
+            have[height] = true;
+            while (lowest_missing < num_blocks && have[lowest_missing]) ++lowest_missing;
+        }
+        now = next_tick;
+    }
+    return now;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(blockdownloadscheduler_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(bookkeeping)
+{
+    BlockDownloadScheduler scheduler;
+    BOOST_CHECK_EQUAL(scheduler.GetMaxBlocksInFlight(0), node::DEFAULT_BLOCKS_IN_FLIGHT_PER_PEER);
+    BOOST_CHECK(!scheduler.GetStats(0));
+
+    scheduler.BlockRequested(0, BlockHash(1), 1, 0s);
+    scheduler.BlockRequested(0, BlockHash(1), 1, 0s); // duplicate
+    scheduler.BlockRequested(0, BlockHash(2), 2, 0s);
+    scheduler.BlockRequested(1, BlockHash(2), 2, 0s);
+    BOOST_CHECK_EQUAL(scheduler.CountInFlight(), 2U);
+
+    // Unrequested deliveries are not measured.
+    scheduler.BlockReceived(1, BlockHash(1), 1000, 1s);
+    BOOST_CHECK(!scheduler.GetStats(1));
+
+    // A delivery from an idle peer is first attributed to throughput.
+    scheduler.BlockReceived(0, BlockHash(1), 1000, 1s);
+    scheduler.RequestRemoved(0, BlockHash(1));
+    BOOST_CHECK_EQUAL(scheduler.CountInFlight(), 1U);
+    BOOST_REQUIRE(scheduler.GetStats(0));
+    BOOST_CHECK_EQUAL(scheduler.GetStats(0)->bytes_per_second, 1000);
+    BOOST_CHECK_EQUAL(scheduler.GetStats(0)->latency.count(), 0);
+
+    // The next delivery was pipelined, timed from the previous one.
+    scheduler.BlockReceived(0, BlockHash(2), 1000, 1500ms);
+    scheduler.RequestRemoved(0, BlockHash(2));
+    BOOST_CHECK_EQUAL(scheduler.GetStats(0)->bytes_per_second, 1000 + (2000 - 1000) * 0.25);
+    BOOST_CHECK_EQUAL(scheduler.CountInFlight(), 1U);
+
+    // Requested from the idle peer again, the delivery beyond the expected
+    // transfer time of 0.8 s is latency.
+    scheduler.BlockRequested(0, BlockHash(3), 3, 5s);
+    scheduler.BlockReceived(0, BlockHash(3), 1000, 6300ms);
+    scheduler.RequestRemoved(0, BlockHash(3));
+    BOOST_CHECK_EQUAL(scheduler.GetStats(0)->bytes_per_second, 1250);
+    BOOST_CHECK_EQUAL(scheduler.GetStats(0)->latency.count(), 125'000);
+
+    scheduler.PeerDisconnected(1);
+    BOOST_CHECK_EQUAL(scheduler.CountInFlight(), 0U);
+    scheduler.PeerDisconnected(0);
+    BOOST_CHECK(!scheduler.GetStats(0));
+}
+
+BOOST_AUTO_TEST_CASE(rerequest)
+{
+    BlockDownloadScheduler scheduler;
+    // Peer 0 delivers 1 MB blocks in 0.1 s, peer 1 in 10 s.
+    scheduler.BlockRequested(0, BlockHash(1), 1, 0s);
+    scheduler.BlockReceived(0, BlockHash(1), 1'000'000, 100ms);
+    scheduler.RequestRemoved(0, BlockHash(1));
+    scheduler.BlockRequested(1, BlockHash(2), 2, 0s);
+    scheduler.BlockReceived(1, BlockHash(2), 1'000'000, 10s);
+    scheduler.RequestRemoved(1, BlockHash(2));
+    BOOST_CHECK_EQUAL(scheduler.GetMaxBlocksInFlight(1), node::MIN_BLOCKS_IN_FLIGHT_PER_PEER);
+    BOOST_CHECK_GT(scheduler.GetMaxBlocksInFlight(0), scheduler.GetMaxBlocksInFlight(1));
+
+    // The next blocks are with the slow peer, and expected to take 10 s each.
+    scheduler.BlockRequested(1, BlockHash(3), 3, 10s);
+    scheduler.BlockRequested(1, BlockHash(4), 4, 10s);
+    BOOST_CHECK(scheduler.GetBlocksToRerequest(1, 10, 10s).empty());
+    BOOST_CHECK(scheduler.GetBlocksToRerequest(0, 0, 10s).empty());
+    BOOST_CHECK(scheduler.GetBlocksToRerequest(0, 10, 10s) == std::vector({BlockHash(3), BlockHash(4)}));
+    BOOST_CHECK(scheduler.GetBlocksToRerequest(0, 1, 10s) == std::vector({BlockHash(3)}));
+
+    // Blocks are not requested from a third peer, nor again from the fast one.
+    scheduler.BlockRequested(0, BlockHash(3), 3, 10s);
+    BOOST_CHECK(scheduler.GetBlocksToRerequest(0, 10, 10s) == std::vector({BlockHash(4)}));
+
+    // A peer that has not delivered anything yet does not take blocks over.
+    BOOST_CHECK(scheduler.GetBlocksToRerequest(2, 10, 10s).empty());
+
+    // Not worth it if the fast peer is not much faster.
+    BlockDownloadScheduler similar;
+    similar.BlockRequested(0, BlockHash(1), 1, 0s);
+    similar.BlockReceived(0, BlockHash(1), 1'000'000, 1s);
+    similar.RequestRemoved(0, BlockHash(1));
+    similar.BlockRequested(1, BlockHash(2), 2, 0s);
+    similar.BlockReceived(1, BlockHash(2), 1'000'000, 2s);
+    similar.RequestRemoved(1, BlockHash(2));
+    similar.BlockRequested(1, BlockHash(3), 3, 2s);
+    BOOST_CHECK(similar.GetBlocksToRerequest(0, 10, 2s).empty());
+
+    // Blocks in flight from an unmeasured peer are taken over once they have
+    // been waited for long enough.
+    similar.BlockRequested(2, BlockHash(4), 4, 2s);
+    BOOST_CHECK(similar.GetBlocksToRerequest(0, 10, 3s).empty());
+    BOOST_CHECK(similar.GetBlocksToRerequest(0, 10, 10s) == std::vector({BlockHash(4)}));
+}
+
+BOOST_AUTO_TEST_CASE(simulated_peers)
+{
+    constexpr int NUM_BLOCKS{500};
+    constexpr size_t BLOCK_BYTES{1'000'000};
+    const std::vector<SimPeer> peers{
+        {.bytes_per_second = 5e6, .latency = 50ms},
+        {.bytes_per_second = 2e6, .latency = 100ms},
+        {.bytes_per_second = 4e6, .latency = 300ms},
+        {.bytes_per_second = 1e5, .latency = 200ms},
+    };
+
+    BlockDownloadScheduler fixed_scheduler;
+    std::vector<SimPeer> fixed_peers{peers};
+    const auto fixed_time{Simulate(fixed_scheduler, fixed_peers, NUM_BLOCKS, BLOCK_BYTES, /*adaptive=*/false)};
+
+    BlockDownloadScheduler scheduler;
+    std::vector<SimPeer> adaptive_peers{peers};
+    const auto adaptive_time{Simulate(scheduler, adaptive_peers, NUM_BLOCKS, BLOCK_BYTES, /*adaptive=*/true)};
+    BOOST_CHECK_EQUAL(scheduler.CountInFlight(), 0U);
+
+    // The measurements approach the peers' actual bandwidths.
+    for (size_t p{0}; p < peers.size(); ++p) {
+        const auto stats{scheduler.GetStats(p)};
+        BOOST_REQUIRE(stats);
+        BOOST_CHECK_GT(stats->bytes_per_second, peers[p].bytes_per_second * 0.75);
+        BOOST_CHECK_LT(stats->bytes_per_second, peers[p].bytes_per_second * 1.25);
+    }
+    // Faster peers get more blocks in flight, the slowest the fewest.
+    BOOST_CHECK_GT(scheduler.GetMaxBlocksInFlight(0), scheduler.GetMaxBlocksInFlight(1));
+    BOOST_CHECK_EQUAL(scheduler.GetMaxBlocksInFlight(3), node::MIN_BLOCKS_IN_FLIGHT_PER_PEER);
+
+    // Without adaptation, the slow peer holds up the download window time and
+    // again. The aggregate bandwidth of the fast peers bounds the adaptive time.
+    BOOST_TEST_MESSAGE("fixed: " << Ticks<std::chrono::milliseconds>(fixed_time) << " ms, adaptive: " << Ticks<std::chrono::milliseconds>(adaptive_time) << " ms");
+    BOOST_CHECK_LT(adaptive_time * 3, fixed_time);
+    BOOST_CHECK_LT(adaptive_time, std::chrono::seconds{NUM_BLOCKS * BLOCK_BYTES / 8'000'000});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -17,6 +17,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <future>
+#include <numeric>
 
 using node::BlockAssembler;
 using node::BlockManager;
@@ -383,4 +384,98 @@ BOOST_FIXTURE_TEST_CASE(index_reorg_crash, BuildChainTestingSetup)
     index.Stop();
 }
 
+class ParallelSyncIndex : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+    const std::optional<int> m_failing_height;
+
+public:
+    //! Heights of the blocks appended, in the order they were appended.
+    std::vector<int> m_appended;
+
+    explicit ParallelSyncIndex(std::unique_ptr<interfaces::Chain> chain, std::optional<int> failing_height = std::nullopt)
+        : BaseIndex(std::move(chain), "parallel test index"), m_failing_height(failing_height)
+    {
+        const fs::path path = gArgs.GetDataDirNet() / "index";
+        fs::create_directories(path);
+        m_db = std::make_unique<BaseIndex::DB>(path / "parallel_db", /*n_cache_size=*/0, /*f_memory=*/true, /*f_wipe=*/false);
+    }
+
+    bool AllowPrune() const override { return false; }
+    bool AllowParallelSync() const override { return true; }
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    bool CustomComputeBlock(const interfaces::BlockInfo& block, std::any& result) override
+    {
+        // Called on worker threads, so leave the checks to CustomAppendComputed.
+        if (block.height == m_failing_height) return false;
+        result = block.height;
+        return true;
+    }
+
+    bool CustomAppendComputed(const interfaces::BlockInfo& block, std::any& result) override
+    {
+        BOOST_CHECK_EQUAL(std::any_cast<int>(result), block.height);
+        m_appended.push_back(block.height);
+        return true;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(parallel_sync_appends_in_order, BuildChainTestingSetup)
+{
+    // The chain is several sync windows long, so blocks are computed ahead
+    // across window boundaries.
+    const int tip_height{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Height())};
+    BOOST_REQUIRE_GT(tip_height, 3 * 16);
+
+    ParallelSyncIndex index(interfaces::MakeChain(m_node));
+    BOOST_REQUIRE(index.Init());
+    index.Sync();
+
+    std::vector<int> expected(tip_height + 1);
+    std::iota(expected.begin(), expected.end(), 0);
+    BOOST_CHECK_EQUAL_COLLECTIONS(index.m_appended.begin(), index.m_appended.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(index.GetSummary().best_block_height, tip_height);
+}
+
+BOOST_FIXTURE_TEST_CASE(parallel_sync_stops_at_failing_block, BuildChainTestingSetup)
+{
+    // Blocks after the failing one are computed ahead, but none of them is
+    // appended.
+    ParallelSyncIndex index(interfaces::MakeChain(m_node), /*failing_height=*/50);
+    BOOST_REQUIRE(index.Init());
+    index.Sync();
+
+    std::vector<int> expected(50);
+    std::iota(expected.begin(), expected.end(), 0);
+    BOOST_CHECK_EQUAL_COLLECTIONS(index.m_appended.begin(), index.m_appended.end(), expected.begin(), expected.end());
+    BOOST_CHECK(!index.GetSummary().synced);
+    BOOST_CHECK_EQUAL(m_node.exit_status.load(), EXIT_FAILURE);
+}
+
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_parallel_sync, BuildChainTestingSetup)
+{
+    // Filter headers chain across blocks that were computed on different
+    // threads. Chain them serially from the filters of the blocks and check
+    // that the index agrees at every height.
+    BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, true);
+    BOOST_REQUIRE(filter_index.Init());
+    filter_index.Sync();
+
+    LOCK(cs_main);
+    uint256 expected_header;
+    for (const CBlockIndex* block_index = m_node.chainman->ActiveChain().Genesis();
+         block_index != nullptr;
+         block_index = m_node.chainman->ActiveChain().Next(block_index)) {
+        BlockFilter filter;
+        BOOST_REQUIRE(ComputeFilter(BlockFilterType::BASIC, *block_index, filter, m_node.chainman->m_blockman));
+        expected_header = filter.ComputeHeader(expected_header);
+
+        uint256 filter_header;
+        BOOST_REQUIRE(filter_index.LookupFilterHeader(block_index, filter_header));
+        BOOST_CHECK_EQUAL(filter_header, expected_header);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -15,6 +15,7 @@
 #include <util/strencodings.h>
 
 #include <map>
+#include <optional>
 #include <string>
 #include <variant>
 #include <vector>
@@ -1121,4 +1122,50 @@ BOOST_AUTO_TEST_CASE(ccoins_emplace_duplicate_keeps_usage_balanced)
     BOOST_CHECK(cache.AccessCoin(outpoint) == coin1);
 }
 
+BOOST_AUTO_TEST_CASE(ccoins_db_cursors)
+{
+    CCoinsViewDB db{{.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    const auto add_coins{[&](int n) {
+        CCoinsViewCache cache{&db};
+        for (int i{0}; i < n; ++i) {
+            const COutPoint outpoint{Txid::FromUint256(m_rng.rand256()), uint32_t(m_rng.randrange(3))};
+            cache.AddCoin(outpoint, Coin{CTxOut{1 + i, CScript{} << i}, 1, false}, /*possible_overwrite=*/false);
+        }
+        cache.SetBestBlock(m_rng.rand256());
+        BOOST_REQUIRE(cache.Flush());
+    }};
+    add_coins(1000);
+
+    for (size_t count : {1, 3, 16}) {
+        std::map<COutPoint, CAmount> expected;
+        for (auto cursor{db.Cursor()}; cursor->Valid(); cursor->Next()) {
+            COutPoint key;
+            Coin coin;
+            BOOST_REQUIRE(cursor->GetKey(key) && cursor->GetValue(coin));
+            expected.emplace(key, coin.out.nValue);
+        }
+        auto cursors{db.Cursors(count)};
+        BOOST_REQUIRE_EQUAL(cursors.size(), count);
+        // Coins written after the cursors were created are not visible to them.
+        add_coins(10);
+
+        // Each cursor returns its range in order, and together they return every coin once.
+        std::map<COutPoint, CAmount> seen;
+        for (size_t i{0}; i < cursors.size(); ++i) {
+            std::optional<COutPoint> prev;
+            for (auto& cursor{cursors[i]}; cursor->Valid(); cursor->Next()) {
+                COutPoint key;
+                Coin coin;
+                BOOST_REQUIRE(cursor->GetKey(key) && cursor->GetValue(coin));
+                BOOST_CHECK(CoinsCursorPrefix(key) >= CoinsCursorRangeBegin(i, count));
+                BOOST_CHECK(CoinsCursorPrefix(key) < CoinsCursorRangeBegin(i + 1, count));
+                if (prev) BOOST_CHECK(CoinsCursorPrefix(*prev) <= CoinsCursorPrefix(key));
+                prev = key;
+                BOOST_CHECK(seen.emplace(key, coin.out.nValue).second);
+            }
+        }
+        BOOST_CHECK(seen == expected);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
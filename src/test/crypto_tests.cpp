@@ -848,6 +848,36 @@ BOOST_AUTO_TEST_CASE(chacha20_midblock)
     BOOST_CHECK(std::ranges::equal(std::span{block}.last(52), b3));
 }
 
+BOOST_AUTO_TEST_CASE(chacha20_multiblock)
+{
+    // Long inputs go through the multi-block implementations, one block at a
+    // time through the single-block one. Both must agree, including when the
+    // block counter overflows into the nonce in the middle of a batch.
+    for (int i = 0; i < 100; ++i) {
+        const auto key{m_rng.randbytes<std::byte>(32)};
+        const ChaCha20::Nonce96 nonce{m_rng.rand32(), m_rng.rand64()};
+        const uint32_t counter{i % 2 ? m_rng.rand32() : uint32_t(0xffffffff - m_rng.randrange(40))};
+        const auto input{m_rng.randbytes<std::byte>(m_rng.randrange(64 * 40))};
+
+        std::vector<std::byte> multi(input.size()), single(input.size());
+        ChaCha20 c20_multi{key}, c20_single{key};
+        c20_multi.Seek(nonce, counter);
+        c20_single.Seek(nonce, counter);
+        c20_multi.Crypt(input, multi);
+        for (size_t pos = 0; pos < input.size(); pos += 64) {
+            const size_t len{std::min<size_t>(64, input.size() - pos)};
+            c20_single.Crypt(std::span{input}.subspan(pos, len), std::span{single}.subspan(pos, len));
+        }
+        BOOST_CHECK(multi == single);
+
+        // The stream continues at the same position.
+        std::byte next_multi[64], next_single[64];
+        c20_multi.Keystream(next_multi);
+        c20_single.Keystream(next_single);
+        BOOST_CHECK(std::ranges::equal(next_multi, next_single));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(poly1305_testvector)
 {
     // RFC 7539, section 2.5.2.
@@ -969,6 +999,25 @@ BOOST_AUTO_TEST_CASE(poly1305_testvector)
                  "0e410fa9d7a40ac582e77546be9a72bb");
 }
 
+BOOST_AUTO_TEST_CASE(poly1305_multiblock)
+{
+    // Long inputs go through the multi-block implementation, 16-byte updates
+    // through the single-block one.
+    for (int i = 0; i < 100; ++i) {
+        const auto key{m_rng.randbytes<std::byte>(Poly1305::KEYLEN)};
+        const auto msg{i % 2 ? m_rng.randbytes<std::byte>(m_rng.randrange(2048)) : std::vector<std::byte>(m_rng.randrange(2048), std::byte{0xff})};
+
+        std::vector<std::byte> tag_multi(Poly1305::TAGLEN), tag_single(Poly1305::TAGLEN);
+        Poly1305{key}.Update(msg).Finalize(tag_multi);
+        Poly1305 poly1305{key};
+        for (size_t pos = 0; pos < msg.size(); pos += 16) {
+            poly1305.Update(std::span{msg}.subspan(pos, std::min<size_t>(16, msg.size() - pos)));
+        }
+        poly1305.Finalize(tag_single);
+        BOOST_CHECK(tag_multi == tag_single);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(chacha20poly1305_testvectors)
 {
     // Note that in our implementation, the authentication is suffixed to the ciphertext.
@@ -1280,4 +1329,27 @@ BOOST_AUTO_TEST_CASE(muhash_tests)
     BOOST_CHECK_EQUAL(HexStr(out4), "3a31e6903aff0de9f62f9a9f7f8b861de76ce2cda09822b90014319ae5dc2271");
 }
 
+BOOST_AUTO_TEST_CASE(num3072_multiply)
+{
+    // Operands with all bits set in one or both halves, for which every
+    // intermediate sum of the multiplication carries.
+    unsigned char ones[Num3072::BYTE_SIZE], low_ones[Num3072::BYTE_SIZE], high_ones[Num3072::BYTE_SIZE];
+    std::fill(std::begin(ones), std::end(ones), 0xff);
+    std::fill(std::begin(low_ones), std::end(low_ones), 0);
+    std::fill(std::begin(low_ones), std::begin(low_ones) + Num3072::BYTE_SIZE / 2, 0xff);
+    std::fill(std::begin(high_ones), std::end(high_ones), 0);
+    std::fill(std::begin(high_ones) + Num3072::BYTE_SIZE / 2, std::end(high_ones), 0xff);
+    unsigned char out[Num3072::BYTE_SIZE];
+
+    Num3072 a{ones};
+    a.Multiply(Num3072{ones});
+    a.ToBytes(out);
+    BOOST_CHECK_EQUAL(HexStr(out), "101fb9a11b01000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
+
+    Num3072 b{low_ones};
+    b.Multiply(Num3072{high_ones});
+    b.ToBytes(out);
+    BOOST_CHECK_EQUAL(HexStr(out), "3651deffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff65d710000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
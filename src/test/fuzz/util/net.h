@@ -154,6 +154,8 @@ public:
 
     virtual bool SendMessages(CNode*) override { return m_fdp.ConsumeBool(); }
 
+    virtual bool ProcessLightMessages(CNode*, std::atomic<bool>&) override { return m_fdp.ConsumeBool(); }
+
 private:
     FuzzedDataProvider& m_fdp;
 };
@@ -11,6 +11,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <vector>
+
 BOOST_FIXTURE_TEST_SUITE(hash_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(murmurhash3)
@@ -148,4 +150,25 @@ BOOST_AUTO_TEST_CASE(siphash)
     }
 }
 
+BOOST_AUTO_TEST_CASE(siphash_batch)
+{
+    // Check consistency between SipHashUint256Batch and SipHashUint256, for
+    // lengths around and between the multiples of the number of lanes.
+    for (size_t len = 0; len <= 67; ++len) {
+        const uint64_t k0 = m_rng.rand64();
+        const uint64_t k1 = m_rng.rand64();
+        std::vector<uint256> vals(len);
+        std::vector<const uint256*> ptrs;
+        for (auto& val : vals) {
+            val = m_rng.rand256();
+            ptrs.push_back(&val);
+        }
+        std::vector<uint64_t> out(len);
+        SipHashUint256Batch(k0, k1, ptrs, out);
+        for (size_t i = 0; i < len; ++i) {
+            BOOST_CHECK_EQUAL(out[i], SipHashUint256(k0, k1, vals[i]));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+#include <univalue.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(jsonstream_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(matches_univalue)
+{
+    UniValue expected{UniValue::VOBJ};
+    expected.pushKV("hash", "00ff");
+    expected.pushKV("esc\"aped", "line\nbreak");
+    UniValue txs{UniValue::VARR};
+    for (int i{0}; i < 3; ++i) {
+        UniValue tx{UniValue::VOBJ};
+        tx.pushKV("n", i);
+        tx.pushKV("vin", UniValue{UniValue::VARR});
+        txs.push_back(std::move(tx));
+    }
+    expected.pushKV("tx", txs);
+    expected.pushKV("empty", UniValue{UniValue::VOBJ});
+    expected.pushKV("last", NullUniValue);
+
+    std::string out;
+    JSONStreamWriter stream{[&](std::string_view data) { out += data; }};
+    BOOST_CHECK(stream.Empty());
+    stream.BeginObject();
+    BOOST_CHECK(!stream.Empty());
+    stream.Key("hash");
+    stream.Value("00ff");
+    stream.KeyValues(UniValue{UniValue::VOBJ});
+    UniValue pairs{UniValue::VOBJ};
+    pairs.pushKV("esc\"aped", "line\nbreak");
+    stream.KeyValues(pairs);
+    stream.Key("tx");
+    stream.BeginArray();
+    for (const UniValue& tx : txs.getValues()) stream.Value(tx);
+    stream.EndArray();
+    stream.Key("empty");
+    stream.BeginObject();
+    stream.EndObject();
+    stream.Key("last");
+    stream.Value(NullUniValue);
+    stream.EndObject();
+    // Nothing is handed out before a flush.
+    BOOST_CHECK(out.empty());
+    stream.Flush();
+    BOOST_CHECK_EQUAL(out, expected.write());
+}
+
+BOOST_AUTO_TEST_CASE(flush_size)
+{
+    std::vector<std::string> chunks;
+    JSONStreamWriter stream{[&](std::string_view data) { chunks.emplace_back(data); }, /*flush_size=*/8};
+    stream.BeginArray();
+    stream.Value(1234);
+    stream.MaybeFlush();
+    BOOST_CHECK(chunks.empty());
+    stream.Value(5678);
+    stream.MaybeFlush();
+    BOOST_CHECK_EQUAL(chunks.size(), 1U);
+    stream.EndArray();
+    stream.Flush();
+    stream.Flush();
+    BOOST_CHECK_EQUAL(chunks.size(), 2U);
+
+    std::string out;
+    for (const std::string& chunk : chunks) out += chunk;
+    BOOST_CHECK_EQUAL(out, "[1234,5678]");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
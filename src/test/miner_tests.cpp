@@ -791,4 +791,59 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     TestPrioritisedMining(scriptPubKey, txFirst);
 }
 
+
+BOOST_AUTO_TEST_CASE(block_template_delta)
+{
+    const auto make_tx{[](uint32_t locktime) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vout.emplace_back(1 * COIN, CScript() << OP_TRUE);
+        tx.nLockTime = locktime;
+        return MakeTransactionRef(tx);
+    }};
+    const auto make_template{[&](const std::vector<CTransactionRef>& txs) {
+        node::CBlockTemplate tmpl;
+        CMutableTransaction coinbase;
+        coinbase.vin.resize(1);
+        coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+        tmpl.block.vtx.push_back(MakeTransactionRef(coinbase));
+        for (const auto& tx : txs) {
+            tmpl.block.vtx.push_back(tx);
+            tmpl.vTxFees.push_back(1000);
+            tmpl.vTxSigOpsCost.push_back(4);
+        }
+        return tmpl;
+    }};
+
+    std::vector<CTransactionRef> txs;
+    for (uint32_t i{0}; i < 6; ++i) txs.push_back(make_tx(i));
+
+    // Previous template: 0 1 2 3 4. New template drops 1, moves 0 to the end
+    // and adds 5 in the middle.
+    const std::vector<CTransactionRef> previous{txs[0], txs[1], txs[2], txs[3], txs[4]};
+    const std::vector<CTransactionRef> next{txs[2], txs[3], txs[5], txs[4], txs[0]};
+    const auto tmpl{make_template(next)};
+
+    const auto delta{node::GetBlockTemplateDelta(previous, tmpl)};
+    BOOST_CHECK(delta.removed_positions == (std::vector<uint32_t>{0, 1}));
+    BOOST_CHECK(delta.added_positions == (std::vector<uint32_t>{2, 4}));
+    BOOST_CHECK_EQUAL(delta.added_txs.size(), 2U);
+    BOOST_CHECK_EQUAL(delta.added_tx_fees.size(), 2U);
+    BOOST_CHECK_EQUAL(delta.added_tx_sigops.size(), 2U);
+    BOOST_CHECK_EQUAL(delta.coinbase_value, 50 * COIN);
+    BOOST_CHECK(delta.coinbase_merkle_path == TransactionMerklePath(tmpl.block, 0));
+
+    const auto applied{node::ApplyBlockTemplateDelta(previous, delta)};
+    BOOST_REQUIRE(applied);
+    BOOST_CHECK(*applied == next);
+
+    // A delta from an empty template adds every transaction.
+    const auto full_delta{node::GetBlockTemplateDelta({}, tmpl)};
+    BOOST_CHECK(full_delta.removed_positions.empty());
+    BOOST_CHECK(full_delta.added_txs == next);
+
+    // Deltas which don't fit the previous transactions are rejected.
+    BOOST_CHECK(!node::ApplyBlockTemplateDelta(std::span{previous}.first(1), delta));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
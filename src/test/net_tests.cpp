@@ -16,6 +16,7 @@
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <test/util/net.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <test/util/validation.h>
@@ -1555,4 +1556,194 @@ BOOST_AUTO_TEST_CASE(v2transport_test)
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(shared_payload_message)
+{
+    // Drain a message through a fresh v1 transport and return the bytes it sends.
+    auto wire_bytes{[](CSerializedNetMsg msg) {
+        V1Transport transport{/*node_id=*/0};
+        BOOST_REQUIRE(transport.SetMessageToSend(msg));
+        std::vector<uint8_t> bytes;
+        while (true) {
+            const auto& [to_send, _more, _msg_type] = transport.GetBytesToSend(/*have_next_message=*/false);
+            if (to_send.empty()) break;
+            bytes.insert(bytes.end(), to_send.begin(), to_send.end());
+            transport.MarkBytesSent(to_send.size());
+        }
+        return bytes;
+    }};
+
+    const std::vector<uint8_t> payload{m_rng.randbytes<uint8_t>(1000)};
+    CSerializedNetMsg msg{NetMsg::Make(NetMsgType::BLOCK, std::span{payload})};
+    const auto expected{wire_bytes(msg.Copy())};
+
+    msg.Share();
+    BOOST_CHECK(msg.data.empty());
+    const CSerializedNetMsg copy{msg.Copy()};
+    BOOST_CHECK(copy.m_shared_payload == msg.m_shared_payload);
+    BOOST_CHECK(std::ranges::equal(copy.Payload(), msg.Payload()));
+    BOOST_CHECK_EQUAL(copy.GetMemoryUsage(), msg.GetMemoryUsage());
+
+    // Every peer sends the same bytes, and sending does not disturb the shared payload.
+    BOOST_CHECK(wire_bytes(msg.Copy()) == expected);
+    BOOST_CHECK(wire_bytes(msg.Copy()) == expected);
+    BOOST_CHECK_EQUAL(msg.m_shared_payload.use_count(), 2);
+    BOOST_CHECK_EQUAL(msg.Payload().size(), expected.size() - CMessageHeader::HEADER_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(recv_buffer_pool)
+{
+    RecvBufferPool pool{/*max_bytes=*/1 << 20};
+    BOOST_CHECK_EQUAL(pool.Get(0).capacity(), 0U);
+
+    // Small buffers are rounded up to their size class, and serve requests of
+    // that class and the one below.
+    DataStream buffer{pool.Get(300)};
+    BOOST_CHECK_EQUAL(buffer.capacity(), 512U);
+    const std::byte* const data{buffer.data()};
+    buffer.resize(300);
+    pool.Put(std::move(buffer));
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), 512U);
+    BOOST_CHECK(pool.Get(600).data() != data);
+    DataStream reused{pool.Get(200)};
+    BOOST_CHECK(reused.data() == data);
+    BOOST_CHECK(reused.empty());
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), 0U);
+    pool.Put(std::move(reused));
+
+    // Large buffers are not rounded, and are only kept within the byte limit.
+    DataStream large{pool.Get((1 << 20) - 1)};
+    BOOST_CHECK_EQUAL(large.capacity(), (1U << 20) - 1);
+    pool.Put(std::move(large));
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), 512U);
+
+    // Received messages return their buffer to the pool of their transport,
+    // whose next message reuses it.
+    const auto shared_pool{std::make_shared<RecvBufferPool>()};
+    for (const bool v2 : {false, true}) {
+        std::unique_ptr<Transport> sender, receiver;
+        if (v2) {
+            sender = std::make_unique<V2Transport>(/*nodeid=*/0, /*initiating=*/true);
+            receiver = std::make_unique<V2Transport>(/*nodeid=*/1, /*initiating=*/false, shared_pool);
+        } else {
+            sender = std::make_unique<V1Transport>(/*node_id=*/0);
+            receiver = std::make_unique<V1Transport>(/*node_id=*/1, shared_pool);
+        }
+        std::vector<CNetMessage> received;
+        auto deliver{[&](Transport& from, Transport& to) {
+            while (true) {
+                const auto& [bytes, _more, _msg_type] = from.GetBytesToSend(/*have_next_message=*/false);
+                if (bytes.empty()) break;
+                std::vector<uint8_t> copy{bytes.begin(), bytes.end()};
+                from.MarkBytesSent(copy.size());
+                std::span<const uint8_t> remaining{copy};
+                while (!remaining.empty()) {
+                    BOOST_REQUIRE(to.ReceivedBytes(remaining));
+                    if (&to == receiver.get() && to.ReceivedMessageComplete()) {
+                        bool reject{false};
+                        received.push_back(to.GetReceivedMessage({}, reject));
+                        BOOST_CHECK(!reject);
+                    }
+                }
+            }
+        }};
+        // Complete the v2 handshake.
+        deliver(*sender, *receiver);
+        deliver(*receiver, *sender);
+        deliver(*sender, *receiver);
+
+        const std::vector<uint8_t> payload{m_rng.randbytes<uint8_t>(1000)};
+        const std::byte* first_data{nullptr};
+        for (int i{0}; i < 2; ++i) {
+            CSerializedNetMsg msg{NetMsg::Make(NetMsgType::BLOCK, std::span{payload})};
+            BOOST_REQUIRE(sender->SetMessageToSend(msg));
+            deliver(*sender, *receiver);
+            BOOST_REQUIRE_EQUAL(received.size(), 1U);
+            CNetMessage& got{received.back()};
+            BOOST_CHECK_EQUAL(got.m_type, NetMsgType::BLOCK);
+            BOOST_CHECK_EQUAL(got.m_message_size, payload.size());
+            BOOST_CHECK(std::ranges::equal(MakeUCharSpan(got.m_recv), payload));
+            // The second message reuses the buffer of the first.
+            if (i == 0) first_data = got.m_recv.data();
+            if (i == 1) BOOST_CHECK(got.m_recv.data() == first_data);
+            received.clear();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(light_message_processing)
+{
+    auto& connman{static_cast<ConnmanTestMsg&>(*m_node.connman)};
+    PeerManager& peerman{*m_node.peerman};
+
+    CNode node{/*id=*/0,
+               /*sock=*/nullptr,
+               CAddress{CService{LookupNumeric("1.2.3.4", 8333)}, NODE_NONE},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               CAddress{},
+               /*addrNameIn=*/"",
+               ConnectionType::INBOUND,
+               /*inbound_onion=*/false,
+               /*network_key=*/0};
+    peerman.InitializeNode(node, NODE_NETWORK);
+    WITH_LOCK(NetEventsInterface::g_msgproc_mutex,
+              connman.Handshake(node,
+                                /*successfully_connected=*/true,
+                                /*remote_services=*/ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+                                /*local_services=*/ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+                                /*version=*/PROTOCOL_VERSION,
+                                /*relay_txs=*/true));
+
+    // The test connman has no send buffer size, so every message sent pauses
+    // the node; drop what was sent and resume it, as Handshake() does.
+    auto flush{[&] {
+        connman.FlushSendBuffer(node);
+        node.fPauseSend = false;
+    }};
+    flush();
+
+    std::atomic<bool> interrupt{false};
+    auto process_light{[&] { return WITH_LOCK(node.m_msg_process_order_mutex, return peerman.ProcessLightMessages(&node, interrupt)); }};
+    auto process_all{[&] {
+        LOCK2(NetEventsInterface::g_msgproc_mutex, node.m_msg_process_order_mutex);
+        return connman.ProcessMessagesOnce(node);
+    }};
+    auto sent_type{[&] {
+        LOCK(node.cs_vSend);
+        const auto& [to_send, _more, msg_type] = node.m_transport->GetBytesToSend(/*have_next_message=*/false);
+        return to_send.empty() ? std::string{} : msg_type;
+    }};
+
+    // A ping is answered without the validation lane.
+    (void)connman.ReceiveMsgFrom(node, NetMsg::Make(NetMsgType::PING, uint64_t{1}));
+    BOOST_CHECK(!process_light());
+    BOOST_CHECK_EQUAL(sent_type(), NetMsgType::PONG);
+    flush();
+
+    // A message that needs the validation lane holds back the ones behind it.
+    (void)connman.ReceiveMsgFrom(node, NetMsg::Make(NetMsgType::SENDHEADERS));
+    (void)connman.ReceiveMsgFrom(node, NetMsg::Make(NetMsgType::PING, uint64_t{2}));
+    BOOST_CHECK(!process_light());
+    BOOST_CHECK_EQUAL(sent_type(), "");
+    BOOST_CHECK(process_all());
+    BOOST_CHECK_EQUAL(sent_type(), "");
+    BOOST_CHECK(!process_light());
+    BOOST_CHECK_EQUAL(sent_type(), NetMsgType::PONG);
+    flush();
+
+    // So does a block request, until the validation lane served it.
+    const std::vector<CInv> block_request{CInv{MSG_BLOCK, m_node.chainman->GetParams().GenesisBlock().GetHash()}};
+    (void)connman.ReceiveMsgFrom(node, NetMsg::Make(NetMsgType::GETDATA, block_request));
+    (void)connman.ReceiveMsgFrom(node, NetMsg::Make(NetMsgType::PING, uint64_t{3}));
+    BOOST_CHECK(process_light());
+    BOOST_CHECK(!process_light());
+    BOOST_CHECK_EQUAL(sent_type(), "");
+    process_all();
+    BOOST_CHECK_EQUAL(sent_type(), NetMsgType::BLOCK);
+    flush();
+
+    peerman.FinalizeNode(node);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
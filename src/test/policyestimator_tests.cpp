@@ -15,6 +15,19 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <future>
+#include <thread>
+
+/** Exposes the estimator lock, to check that estimates do not wait for it. */
+class BlockPolicyEstimatorTester
+{
+public:
+    static Mutex& GetLock(CBlockPolicyEstimator& estimator) LOCK_RETURNED(estimator.m_cs_fee_estimator)
+    {
+        return estimator.m_cs_fee_estimator;
+    }
+};
+
 BOOST_FIXTURE_TEST_SUITE(policyestimator_tests, ChainTestingSetup)
 
 BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
@@ -260,6 +273,29 @@ BOOST_AUTO_TEST_CASE(BlockPolicyEstimates)
     for (int i = 2; i < 9; i++) { // At 9, the original estimate was already at the bottom (b/c scale = 2)
         BOOST_CHECK(feeEst.estimateFee(i).GetFeePerK() < origFeeEst[i-1] - deltaFee);
     }
+
+    // Estimates are answered from the snapshot of the last block, without
+    // waiting for the estimator lock, e.g. while a block is being processed.
+    const CFeeRate fee_estimate{feeEst.estimateFee(2)};
+    const CFeeRate smart_fee_estimate{feeEst.estimateSmartFee(2, nullptr, /*conservative=*/false)};
+    std::promise<void> locked;
+    std::promise<void> release;
+    std::thread holder{[&] {
+        LOCK(BlockPolicyEstimatorTester::GetLock(feeEst));
+        locked.set_value();
+        release.get_future().wait();
+    }};
+    locked.get_future().wait();
+    auto estimates{std::async(std::launch::async, [&] {
+        return std::make_pair(feeEst.estimateFee(2), feeEst.estimateSmartFee(2, nullptr, /*conservative=*/false));
+    })};
+    const bool answered{estimates.wait_for(std::chrono::seconds{30}) == std::future_status::ready};
+    release.set_value();
+    holder.join();
+    BOOST_CHECK(answered);
+    const auto [fee, smart_fee]{estimates.get()};
+    BOOST_CHECK(fee == fee_estimate);
+    BOOST_CHECK(smart_fee == smart_fee_estimate);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
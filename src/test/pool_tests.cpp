@@ -2,6 +2,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <indirectmap.h>
 #include <memusage.h>
 #include <support/allocators/pool.h>
 #include <test/util/poolresourcetester.h>
@@ -191,4 +192,44 @@ BOOST_AUTO_TEST_CASE(memusage_test)
     PoolResourceTester::CheckAllDataAccountedFor(resource);
 }
 
+BOOST_AUTO_TEST_CASE(memusage_indirectmap_test)
+{
+    auto std_map = indirectmap<int64_t, int64_t>{};
+
+    using Map = indirectmap<int64_t,
+                            int64_t,
+                            PoolAllocator<std::pair<const int64_t* const, int64_t>,
+                                          sizeof(std::pair<const int64_t* const, int64_t>) + sizeof(void*) * 4>>;
+    auto resource = Map::allocator_type::ResourceType(1024);
+
+    PoolResourceTester::CheckAllDataAccountedFor(resource);
+
+    {
+        auto resource_map = Map{&resource};
+        // The chunk allocated ahead of use is not counted.
+        BOOST_CHECK_EQUAL(memusage::DynamicUsage(resource_map), 0U);
+
+        std::vector<int64_t> keys(10000);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            keys[i] = i;
+            std_map.insert({&keys[i], 0});
+            resource_map.insert({&keys[i], 0});
+        }
+
+        // The resource_map should have a lower memory usage because it has less malloc overhead
+        BOOST_TEST(memusage::DynamicUsage(resource_map) <= memusage::DynamicUsage(std_map) * 90 / 100);
+
+        // Make sure the pool is actually used by the nodes
+        BOOST_TEST(resource.NumAllocatedChunks() > 1);
+        BOOST_CHECK(resource_map.find(keys[1234]) != resource_map.end());
+
+        // The chunks the pool keeps are still counted once the map is empty.
+        resource_map.clear();
+        BOOST_CHECK_EQUAL(memusage::DynamicUsage(resource_map),
+                          (memusage::MallocUsage(sizeof(void*) * 3) + memusage::MallocUsage(resource.ChunkSizeBytes())) * (resource.NumAllocatedChunks() - 1));
+    }
+
+    PoolResourceTester::CheckAllDataAccountedFor(resource);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -169,6 +169,71 @@ BOOST_AUTO_TEST_CASE(recv_until_terminator_limit)
     receiver.join();
 }
 
+BOOST_AUTO_TEST_CASE(poller)
+{
+    for (const bool use_epoll : {false, true}) {
+        int s[2];
+        CreateSocketPair(s);
+        const auto local{std::make_shared<Sock>(s[0])};
+        const Sock remote(s[1]);
+        CreateSocketPair(s);
+        const auto idle{std::make_shared<Sock>(s[0])};
+        const Sock idle_remote(s[1]);
+
+        SockPoller poller{use_epoll};
+        Sock::EventsPerSock events_per_sock;
+        const auto occurred{[&](const std::shared_ptr<Sock>& sock) -> Sock::Event {
+            const auto it{events_per_sock.find(sock)};
+            return it == events_per_sock.end() ? 0 : it->second.occurred;
+        }};
+
+        // Nothing to receive yet.
+        poller.Watch(local, Sock::RECV);
+        poller.Watch(idle, Sock::RECV);
+        BOOST_REQUIRE(poller.Wait(10ms, events_per_sock));
+        BOOST_CHECK_EQUAL(occurred(local), 0);
+        BOOST_CHECK_EQUAL(occurred(idle), 0);
+
+        BOOST_REQUIRE_EQUAL(remote.Send("ab", 2, 0), 2);
+
+        // Readiness is reported while the caller doesn't want to receive, and again
+        // once it does.
+        poller.Watch(local, 0);
+        poller.Watch(idle, Sock::RECV);
+        BOOST_REQUIRE(poller.Wait(10ms, events_per_sock));
+        BOOST_CHECK_EQUAL(occurred(local), 0);
+        for (int i = 0; i < 2; ++i) {
+            poller.Watch(local, Sock::RECV | Sock::SEND);
+            poller.Watch(idle, Sock::RECV);
+            BOOST_REQUIRE(poller.Wait(24h, events_per_sock));
+            BOOST_CHECK_EQUAL(occurred(local), Sock::RECV | Sock::SEND);
+            BOOST_CHECK_EQUAL(occurred(idle), 0);
+        }
+
+        // Draining the socket stops the readiness from being reported, until more data arrives.
+        char buf[10];
+        BOOST_CHECK_EQUAL(local->Recv(buf, sizeof(buf), MSG_DONTWAIT), 2);
+        poller.Consumed(local, Sock::RECV);
+        poller.Watch(local, Sock::RECV);
+        poller.Watch(idle, Sock::RECV);
+        BOOST_REQUIRE(poller.Wait(10ms, events_per_sock));
+        BOOST_CHECK_EQUAL(occurred(local), 0);
+
+        BOOST_REQUIRE_EQUAL(idle_remote.Send("c", 1, 0), 1);
+        poller.Watch(local, Sock::RECV);
+        poller.Watch(idle, Sock::RECV);
+        BOOST_REQUIRE(poller.Wait(24h, events_per_sock));
+        BOOST_CHECK_EQUAL(occurred(local), 0);
+        BOOST_CHECK_EQUAL(occurred(idle), Sock::RECV);
+
+        // Sockets that are no longer watched are forgotten.
+        poller.Watch(local, Sock::RECV);
+        BOOST_REQUIRE(poller.Wait(10ms, events_per_sock));
+        BOOST_CHECK_EQUAL(occurred(idle), 0);
+        BOOST_REQUIRE(!poller.Wait(10ms, events_per_sock));
+    }
+}
+
 #endif /* WIN32 */
 
 BOOST_AUTO_TEST_SUITE_END()
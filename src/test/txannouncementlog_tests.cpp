@@ -0,0 +1,178 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txannouncementlog.h>
+#include <uint256.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <optional>
+#include <vector>
+
+using node::TxAnnouncementLog;
+using node::TxInventoryQueue;
+
+static Wtxid MakeWtxid(uint64_t n)
+{
+    uint256 hash;
+    hash.data()[0] = n & 0xff;
+    hash.data()[1] = n >> 8;
+    return Wtxid::FromUint256(hash);
+}
+
+static std::vector<Wtxid> PopAll(TxInventoryQueue& queue, size_t max = SIZE_MAX)
+{
+    std::vector<Wtxid> ret;
+    queue.Pop(max, [&](const Wtxid& wtxid) { ret.push_back(wtxid); return true; });
+    return ret;
+}
+
+BOOST_FIXTURE_TEST_SUITE(txannouncementlog_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(log_order)
+{
+    TxAnnouncementLog log;
+    TxInventoryQueue a{log}, b{log};
+
+    // Each queue gets its own subset of the log, in log order, once.
+    std::vector<Wtxid> expected_a, expected_b;
+    for (uint64_t i = 0; i < 300; ++i) {
+        const Wtxid wtxid{MakeWtxid(i)};
+        const auto seq{log.Append(wtxid)};
+        if (i % 3 != 0) {
+            a.Push(seq, wtxid);
+            a.Push(seq, wtxid);
+            expected_a.push_back(wtxid);
+        }
+        if (i % 2 == 0) {
+            b.Push(seq, wtxid);
+            expected_b.push_back(wtxid);
+        }
+    }
+    BOOST_CHECK_EQUAL(a.size(), expected_a.size());
+    BOOST_CHECK_EQUAL(b.size(), expected_b.size());
+    BOOST_CHECK_EQUAL(log.Size(), 300U);
+
+    // Read a in two steps, past a batch boundary.
+    std::vector<Wtxid> read{PopAll(a, 150)};
+    BOOST_CHECK_EQUAL(read.size(), 150U);
+    BOOST_CHECK_EQUAL(a.size(), expected_a.size() - 150);
+    for (const Wtxid& wtxid : PopAll(a)) read.push_back(wtxid);
+    BOOST_CHECK(read == expected_a);
+    BOOST_CHECK(a.empty());
+    // b has not read anything, so the log keeps everything.
+    BOOST_CHECK_EQUAL(log.Size(), 300U);
+
+    BOOST_CHECK(PopAll(b) == expected_b);
+    BOOST_CHECK_EQUAL(log.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(rejected_are_dropped)
+{
+    TxAnnouncementLog log;
+    TxInventoryQueue queue{log};
+    for (uint64_t i = 0; i < 10; ++i) {
+        const Wtxid wtxid{MakeWtxid(i)};
+        queue.Push(log.Append(wtxid), wtxid);
+    }
+
+    // Accept odd entries only: max counts accepted ones, and rejected ones
+    // are dequeued as they are passed over.
+    std::vector<Wtxid> accepted;
+    queue.Pop(3, [&](const Wtxid& wtxid) {
+        if ((wtxid.ToUint256().data()[0] & 1) == 0) return false;
+        accepted.push_back(wtxid);
+        return true;
+    });
+    BOOST_CHECK(accepted == std::vector<Wtxid>({MakeWtxid(1), MakeWtxid(3), MakeWtxid(5)}));
+    BOOST_CHECK(PopAll(queue) == std::vector<Wtxid>({MakeWtxid(6), MakeWtxid(7), MakeWtxid(8), MakeWtxid(9)}));
+}
+
+BOOST_AUTO_TEST_CASE(unlogged)
+{
+    TxAnnouncementLog log;
+    TxInventoryQueue queue{log};
+    const Wtxid first{MakeWtxid(1)}, second{MakeWtxid(2)}, third{MakeWtxid(3)};
+
+    const auto seq_first{log.Append(first)};
+    const auto seq_second{log.Append(second)};
+    queue.Push(seq_second, second);
+    BOOST_CHECK(PopAll(queue) == std::vector<Wtxid>({second}));
+
+    // An entry behind the cursor, and one without entry, go ahead of the log.
+    queue.Push(seq_first, first);
+    const Wtxid wtxid{third};
+    queue.Push(log.Append(wtxid), wtxid);
+    queue.Push(MakeWtxid(4));
+    BOOST_CHECK_EQUAL(queue.size(), 3U);
+    BOOST_CHECK(PopAll(queue) == std::vector<Wtxid>({first, MakeWtxid(4), third}));
+
+    queue.Push(MakeWtxid(5));
+    queue.Push(log.Append(MakeWtxid(6)), MakeWtxid(6));
+    queue.clear();
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK(PopAll(queue).empty());
+}
+
+BOOST_AUTO_TEST_CASE(backlog_order)
+{
+    TxAnnouncementLog log;
+    TxInventoryQueue queue{log};
+    // Entries with a higher first byte are preferred.
+    const auto compare{[](const Wtxid& a, const Wtxid& b) { return a.ToUint256().data()[0] < b.ToUint256().data()[0]; }};
+    for (uint64_t i : {3, 9, 1, 7, 5}) {
+        const Wtxid wtxid{MakeWtxid(i)};
+        queue.Push(log.Append(wtxid), wtxid);
+    }
+    queue.Push(MakeWtxid(8));
+
+    // A backlogged queue hands out the best entries, with rejected ones
+    // dequeued as they are passed over.
+    std::vector<Wtxid> accepted;
+    queue.Pop(2, compare, [&](const Wtxid& wtxid) {
+        if (wtxid == MakeWtxid(8)) return false;
+        accepted.push_back(wtxid);
+        return true;
+    });
+    BOOST_CHECK(accepted == std::vector<Wtxid>({MakeWtxid(9), MakeWtxid(7)}));
+    BOOST_CHECK_EQUAL(queue.size(), 3U);
+
+    // What fits is taken in queue order.
+    accepted.clear();
+    queue.Pop(3, compare, [&](const Wtxid& wtxid) { accepted.push_back(wtxid); return true; });
+    BOOST_CHECK(accepted == std::vector<Wtxid>({MakeWtxid(3), MakeWtxid(1), MakeWtxid(5)}));
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK_EQUAL(log.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(trim)
+{
+    TxAnnouncementLog log;
+    // Without queues, nothing is kept.
+    log.Append(MakeWtxid(0));
+    BOOST_CHECK_EQUAL(log.Size(), 0U);
+
+    std::optional<TxInventoryQueue> idle{log};
+    TxInventoryQueue busy{log};
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        const Wtxid wtxid{MakeWtxid(i)};
+        busy.Push(log.Append(wtxid), wtxid);
+        if (i % 100 == 0) BOOST_CHECK_EQUAL(PopAll(busy).size(), 100U);
+    }
+    // A queue with nothing queued skips the log on its next read.
+    BOOST_CHECK_EQUAL(log.Size(), 1000U);
+    BOOST_CHECK(PopAll(*idle).empty());
+    BOOST_CHECK_EQUAL(log.Size(), 0U);
+
+    log.Append(MakeWtxid(1001));
+    BOOST_CHECK_EQUAL(log.Size(), 1U);
+    idle.reset();
+    BOOST_CHECK_EQUAL(log.Size(), 1U);
+    busy.clear();
+    BOOST_CHECK_EQUAL(log.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
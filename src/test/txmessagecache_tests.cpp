@@ -0,0 +1,113 @@
+// Copyright (c) The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <netmessagemaker.h>
+#include <node/txmessagecache.h>
+#include <primitives/transaction.h>
+#include <protocol.h>
+#include <script/script.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using node::TxMessageCache;
+
+static CTransactionRef MakeTx(uint32_t n, bool with_witness)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.n = n;
+    if (with_witness) mtx.vin[0].scriptWitness.stack.push_back({1, 2, 3});
+    mtx.vout.resize(1);
+    mtx.vout[0].nValue = n;
+    mtx.vout[0].scriptPubKey = CScript{} << OP_TRUE;
+    return MakeTransactionRef(mtx);
+}
+
+BOOST_FIXTURE_TEST_SUITE(txmessagecache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(serve_from_cache)
+{
+    TxMessageCache cache;
+    const auto tx{MakeTx(1, /*with_witness=*/true)};
+    const auto expected_witness{NetMsg::Make(NetMsgType::TX, TX_WITH_WITNESS(*tx))};
+    const auto expected_no_witness{NetMsg::Make(NetMsgType::TX, TX_NO_WITNESS(*tx))};
+
+    // Requests without witness are not answered with the witness serialization,
+    // and do not fill the cache.
+    const auto msg_no_witness{cache.GetMessage(*tx, /*with_witness=*/false)};
+    BOOST_CHECK(!msg_no_witness.m_shared_payload);
+    BOOST_CHECK(std::ranges::equal(msg_no_witness.Payload(), expected_no_witness.data));
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+
+    // The first request serializes the transaction and caches it, and every
+    // request shares the same payload.
+    const auto msg1{cache.GetMessage(*tx, /*with_witness=*/true)};
+    const auto msg2{cache.GetMessage(*tx, /*with_witness=*/true)};
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+    BOOST_CHECK_EQUAL(msg1.m_type, NetMsgType::TX);
+    BOOST_CHECK(msg1.m_shared_payload);
+    BOOST_CHECK(msg1.m_shared_payload == msg2.m_shared_payload);
+    BOOST_CHECK(std::ranges::equal(msg1.Payload(), expected_witness.data));
+
+    // Requests without witness share it when both serializations are the same.
+    const auto legacy_tx{MakeTx(2, /*with_witness=*/false)};
+    const auto legacy_msg1{cache.GetMessage(*legacy_tx, /*with_witness=*/false)};
+    const auto legacy_msg2{cache.GetMessage(*legacy_tx, /*with_witness=*/true)};
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+    BOOST_CHECK(legacy_msg1.m_shared_payload == legacy_msg2.m_shared_payload);
+    BOOST_CHECK(std::ranges::equal(legacy_msg1.Payload(), NetMsg::Make(NetMsgType::TX, TX_NO_WITNESS(*legacy_tx)).data));
+
+    cache.Remove(tx->GetWitnessHash());
+    cache.Remove(tx->GetWitnessHash());
+    BOOST_CHECK_EQUAL(cache.Size(), 1U);
+    // A removed entry stays valid for the messages still referring to it.
+    BOOST_CHECK(std::ranges::equal(msg1.Payload(), expected_witness.data));
+    // The next request caches it again.
+    BOOST_CHECK(cache.GetMessage(*tx, /*with_witness=*/true).m_shared_payload != msg1.m_shared_payload);
+    BOOST_CHECK_EQUAL(cache.Size(), 2U);
+    cache.Remove(tx->GetWitnessHash());
+
+    cache.Remove(legacy_tx->GetWitnessHash());
+    BOOST_CHECK_EQUAL(cache.Size(), 0U);
+    BOOST_CHECK_EQUAL(cache.Bytes(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(evict_oldest)
+{
+    std::vector<CTransactionRef> txs;
+    for (uint32_t i{0}; i < 10; ++i) txs.push_back(MakeTx(i, /*with_witness=*/true));
+    const size_t entry_bytes{[&] {
+        auto msg{NetMsg::Make(NetMsgType::TX, TX_WITH_WITNESS(*txs[0]))};
+        msg.Share();
+        return msg.GetMemoryUsage();
+    }()};
+
+    TxMessageCache cache{/*max_bytes=*/entry_bytes * 4};
+    std::vector<CSerializedNetMsg> msgs;
+    for (const auto& tx : txs) {
+        msgs.push_back(cache.GetMessage(*tx, /*with_witness=*/true));
+        BOOST_CHECK_LE(cache.Bytes(), entry_bytes * 4);
+    }
+    BOOST_CHECK_EQUAL(cache.Size(), 4U);
+    // Newest first, as asking for an evicted transaction caches it again and
+    // evicts the oldest entry.
+    for (size_t i{txs.size()}; i-- > 0;) {
+        const bool cached{cache.GetMessage(*txs[i], /*with_witness=*/true).m_shared_payload == msgs[i].m_shared_payload};
+        BOOST_CHECK_EQUAL(cached, i >= 6);
+    }
+    BOOST_CHECK_EQUAL(cache.Size(), 4U);
+
+    // A transaction that does not fit at all is not cached.
+    TxMessageCache tiny_cache{/*max_bytes=*/1};
+    const auto tiny_msg{tiny_cache.GetMessage(*txs[0], /*with_witness=*/true)};
+    BOOST_CHECK(std::ranges::equal(tiny_msg.Payload(), NetMsg::Make(NetMsgType::TX, TX_WITH_WITNESS(*txs[0])).data));
+    BOOST_CHECK_EQUAL(tiny_cache.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,10 +4,65 @@
 
 #include <node/txreconciliation.h>
 
+#include <random.h>
 #include <test/util/setup_common.h>
 
+#include <algorithm>
+#include <set>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 
+namespace {
+Wtxid RandomWtxid(FastRandomContext& rng) { return Wtxid::FromUint256(rng.rand256()); }
+
+/** Two trackers registered with each other as peer 0, the first one as the initiator. */
+struct ReconcilingPair {
+    TxReconciliationTracker initiator{TXRECONCILIATION_VERSION};
+    TxReconciliationTracker responder{TXRECONCILIATION_VERSION};
+
+    ReconcilingPair()
+    {
+        const uint64_t initiator_salt{initiator.PreRegisterPeer(0)};
+        const uint64_t responder_salt{responder.PreRegisterPeer(0)};
+        BOOST_REQUIRE_EQUAL(initiator.RegisterPeer(0, /*is_peer_inbound=*/false, 1, responder_salt), ReconciliationRegisterResult::SUCCESS);
+        BOOST_REQUIRE_EQUAL(responder.RegisterPeer(0, /*is_peer_inbound=*/true, 1, initiator_salt), ReconciliationRegisterResult::SUCCESS);
+    }
+
+    /** Fill the sets with shared transactions and ones only either side has. */
+    void AddTxs(FastRandomContext& rng, size_t shared, size_t initiator_only, size_t responder_only,
+                std::set<Wtxid>& initiator_txs, std::set<Wtxid>& responder_txs)
+    {
+        for (size_t i = 0; i < shared; ++i) {
+            const Wtxid wtxid{RandomWtxid(rng)};
+            BOOST_REQUIRE(initiator.AddToSet(0, wtxid));
+            BOOST_REQUIRE(responder.AddToSet(0, wtxid));
+        }
+        for (size_t i = 0; i < initiator_only; ++i) {
+            const Wtxid wtxid{*initiator_txs.insert(RandomWtxid(rng)).first};
+            BOOST_REQUIRE(initiator.AddToSet(0, wtxid));
+        }
+        for (size_t i = 0; i < responder_only; ++i) {
+            const Wtxid wtxid{*responder_txs.insert(RandomWtxid(rng)).first};
+            BOOST_REQUIRE(responder.AddToSet(0, wtxid));
+        }
+    }
+
+    /** Run the exchange up to the initiator handling the initial sketch. */
+    ReconciliationSketchResult StartRound()
+    {
+        const auto request{initiator.InitiateReconciliationRequest(0, /*now=*/1s)};
+        BOOST_REQUIRE(request);
+        BOOST_REQUIRE(responder.HandleReconciliationRequest(0, request->first, request->second));
+        const auto sketch{responder.RespondToReconciliationRequest(0)};
+        BOOST_REQUIRE(sketch);
+        return initiator.HandleSketch(0, *sketch);
+    }
+};
+
+std::set<Wtxid> ToSet(const std::vector<Wtxid>& wtxids) { return {wtxids.begin(), wtxids.end()}; }
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(RegisterPeerTest)
@@ -81,4 +136,240 @@ BOOST_AUTO_TEST_CASE(IsPeerRegisteredTest)
     BOOST_CHECK(!tracker.IsPeerRegistered(peer_id0));
 }
 
+BOOST_AUTO_TEST_CASE(AddToSetTest)
+{
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+    const Wtxid wtxid{RandomWtxid(m_rng)};
+
+    // Not registered peers are flooded to.
+    BOOST_CHECK(!tracker.AddToSet(0, wtxid));
+    tracker.PreRegisterPeer(0);
+    BOOST_CHECK(!tracker.AddToSet(0, wtxid));
+
+    BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(0, true, 1, 1), ReconciliationRegisterResult::SUCCESS);
+    BOOST_CHECK(tracker.AddToSet(0, wtxid));
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(0), 1U);
+    BOOST_CHECK(tracker.TryRemovingFromSet(0, wtxid));
+    BOOST_CHECK(!tracker.TryRemovingFromSet(0, wtxid));
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(0), 0U);
+
+    // Beyond the limit, transactions are flooded.
+    for (size_t i = 0; i < MAX_RECONSET_SIZE; ++i) {
+        BOOST_REQUIRE(tracker.AddToSet(0, RandomWtxid(m_rng)));
+    }
+    BOOST_CHECK(!tracker.AddToSet(0, wtxid));
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(0), MAX_RECONSET_SIZE);
+
+    tracker.ForgetPeer(0);
+    BOOST_CHECK_EQUAL(tracker.GetSetSize(0), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(FanoutTargetsTest)
+{
+    TxReconciliationTracker tracker(TXRECONCILIATION_VERSION);
+    // Peers 0..9 are outbound, 10..59 inbound.
+    for (NodeId peer_id = 0; peer_id < 60; ++peer_id) {
+        tracker.PreRegisterPeer(peer_id);
+        BOOST_REQUIRE_EQUAL(tracker.RegisterPeer(peer_id, /*is_peer_inbound=*/peer_id >= 10, 1, 1), ReconciliationRegisterResult::SUCCESS);
+    }
+
+    size_t inbound_targets{0};
+    std::set<NodeId> all_targets;
+    for (int i = 0; i < 100; ++i) {
+        const Wtxid wtxid{RandomWtxid(m_rng)};
+        const auto targets{tracker.GetFanoutTargets(wtxid, /*inbounds_nonrcncl_tx_relay=*/0, /*outbounds_nonrcncl_tx_relay=*/0)};
+        // The choice is the same for every caller.
+        BOOST_CHECK(targets == tracker.GetFanoutTargets(wtxid, 0, 0));
+        BOOST_CHECK(std::is_sorted(targets.begin(), targets.end()));
+        BOOST_CHECK_EQUAL(std::count_if(targets.begin(), targets.end(), [](NodeId id) { return id < 10; }), OUTBOUND_FANOUT_DESTINATIONS);
+        inbound_targets += std::count_if(targets.begin(), targets.end(), [](NodeId id) { return id >= 10; });
+        all_targets.insert(targets.begin(), targets.end());
+
+        // Non-reconciling peers take the place of reconciling ones.
+        const auto fewer_targets{tracker.GetFanoutTargets(wtxid, /*inbounds_nonrcncl_tx_relay=*/50, OUTBOUND_FANOUT_DESTINATIONS)};
+        BOOST_CHECK(fewer_targets.empty());
+    }
+    // 10% of the 50 inbound peers.
+    BOOST_CHECK_EQUAL(inbound_targets, 100 * 5);
+    // Different transactions go to different peers.
+    BOOST_CHECK_GT(all_targets.size(), 30U);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationSuccessTest)
+{
+    ReconcilingPair pair;
+    std::set<Wtxid> initiator_txs, responder_txs;
+    pair.AddTxs(m_rng, /*shared=*/100, /*initiator_only=*/5, /*responder_only=*/7, initiator_txs, responder_txs);
+
+    const auto result{pair.StartRound()};
+    BOOST_REQUIRE(result.valid);
+    BOOST_REQUIRE(!result.request_extension);
+    BOOST_CHECK(result.success);
+    BOOST_CHECK(ToSet(result.announce) == initiator_txs);
+    BOOST_CHECK_EQUAL(result.ask_shortids.size(), responder_txs.size());
+
+    const auto announce{pair.responder.HandleReconciliationDifference(0, /*success=*/true, result.ask_shortids)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(ToSet(*announce) == responder_txs);
+
+    // Both sets were emptied for the round, and the next round waits for the interval.
+    BOOST_CHECK_EQUAL(pair.initiator.GetSetSize(0), 0U);
+    BOOST_CHECK_EQUAL(pair.responder.GetSetSize(0), 0U);
+    BOOST_CHECK(!pair.initiator.InitiateReconciliationRequest(0, 2s));
+    BOOST_CHECK(pair.initiator.InitiateReconciliationRequest(0, 1s + RECON_REQUEST_INTERVAL));
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationExtensionTest)
+{
+    ReconcilingPair pair;
+    std::set<Wtxid> initiator_txs, responder_txs;
+    // Equal set sizes make the difference estimate q * 48 + 1 = 13, too low for the actual 16.
+    pair.AddTxs(m_rng, /*shared=*/40, /*initiator_only=*/8, /*responder_only=*/8, initiator_txs, responder_txs);
+
+    const auto first{pair.StartRound()};
+    BOOST_REQUIRE(first.valid);
+    BOOST_REQUIRE(first.request_extension);
+
+    // Transactions arriving meanwhile are left for the next round.
+    BOOST_REQUIRE(pair.responder.AddToSet(0, RandomWtxid(m_rng)));
+    const auto extension{pair.responder.HandleExtensionRequest(0)};
+    BOOST_REQUIRE(extension);
+    // Only one extension per round.
+    BOOST_CHECK(!pair.responder.HandleExtensionRequest(0));
+
+    const auto result{pair.initiator.HandleSketch(0, *extension)};
+    BOOST_REQUIRE(result.valid);
+    BOOST_CHECK(!result.request_extension);
+    BOOST_CHECK(result.success);
+    BOOST_CHECK(ToSet(result.announce) == initiator_txs);
+
+    const auto announce{pair.responder.HandleReconciliationDifference(0, /*success=*/true, result.ask_shortids)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(ToSet(*announce) == responder_txs);
+    BOOST_CHECK_EQUAL(pair.responder.GetSetSize(0), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationFailureTest)
+{
+    ReconcilingPair pair;
+    std::set<Wtxid> initiator_txs, responder_txs;
+    // Disjoint sets of equal size, far beyond what even the extended sketch can decode.
+    pair.AddTxs(m_rng, /*shared=*/0, /*initiator_only=*/40, /*responder_only=*/40, initiator_txs, responder_txs);
+
+    const auto first{pair.StartRound()};
+    BOOST_REQUIRE(first.request_extension);
+    const auto extension{pair.responder.HandleExtensionRequest(0)};
+    BOOST_REQUIRE(extension);
+
+    // Both sides fall back to announcing their whole set.
+    const auto result{pair.initiator.HandleSketch(0, *extension)};
+    BOOST_REQUIRE(result.valid);
+    BOOST_CHECK(!result.success);
+    BOOST_CHECK(result.ask_shortids.empty());
+    BOOST_CHECK(ToSet(result.announce) == initiator_txs);
+    const auto announce{pair.responder.HandleReconciliationDifference(0, /*success=*/false, result.ask_shortids)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(ToSet(*announce) == responder_txs);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationTimeoutTest)
+{
+    ReconcilingPair pair;
+    std::set<Wtxid> initiator_txs, responder_txs;
+    pair.AddTxs(m_rng, /*shared=*/0, /*initiator_only=*/5, /*responder_only=*/0, initiator_txs, responder_txs);
+
+    const auto request{pair.initiator.InitiateReconciliationRequest(0, 1s)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK_EQUAL(request->first, 5U);
+    BOOST_REQUIRE(pair.initiator.AddToSet(0, RandomWtxid(m_rng)));
+
+    // The round stays open until it expires, even past the request interval.
+    BOOST_CHECK(!pair.initiator.InitiateReconciliationRequest(0, 1s + RECON_REQUEST_INTERVAL));
+    BOOST_CHECK(!pair.initiator.InitiateReconciliationRequest(0, 1s + RECON_RESPONSE_TIMEOUT - 1us));
+
+    // Once it expired, the next round includes the transactions of the abandoned one.
+    const auto next_request{pair.initiator.InitiateReconciliationRequest(0, 1s + RECON_RESPONSE_TIMEOUT)};
+    BOOST_REQUIRE(next_request);
+    BOOST_CHECK_EQUAL(next_request->first, 6U);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationAbandonedTest)
+{
+    ReconcilingPair pair;
+    std::set<Wtxid> initiator_txs, responder_txs;
+    pair.AddTxs(m_rng, /*shared=*/100, /*initiator_only=*/5, /*responder_only=*/7, initiator_txs, responder_txs);
+
+    // The responder answers a request only after the initiator gave up on it.
+    const auto request{pair.initiator.InitiateReconciliationRequest(0, 1s)};
+    BOOST_REQUIRE(request);
+    BOOST_REQUIRE(pair.responder.HandleReconciliationRequest(0, request->first, request->second));
+    const auto late_sketch{pair.responder.RespondToReconciliationRequest(0)};
+    BOOST_REQUIRE(late_sketch);
+    const auto next_request{pair.initiator.InitiateReconciliationRequest(0, 1s + RECON_RESPONSE_TIMEOUT)};
+    BOOST_REQUIRE(next_request);
+
+    // The late sketch is ignored, and the next request ends the abandoned round on the responder.
+    const auto stale{pair.initiator.HandleSketch(0, *late_sketch)};
+    BOOST_CHECK(stale.valid && stale.stale);
+    BOOST_REQUIRE(pair.responder.HandleReconciliationRequest(0, next_request->first, next_request->second));
+    BOOST_CHECK_EQUAL(pair.responder.GetSetSize(0), 107U);
+
+    const auto sketch{pair.responder.RespondToReconciliationRequest(0)};
+    BOOST_REQUIRE(sketch);
+    const auto result{pair.initiator.HandleSketch(0, *sketch)};
+    BOOST_REQUIRE(result.valid && !result.stale && !result.request_extension);
+    BOOST_CHECK(result.success);
+    BOOST_CHECK(ToSet(result.announce) == initiator_txs);
+    const auto announce{pair.responder.HandleReconciliationDifference(0, /*success=*/true, result.ask_shortids)};
+    BOOST_REQUIRE(announce);
+    BOOST_CHECK(ToSet(*announce) == responder_txs);
+
+    // The responder had not answered the abandoned request yet: both requests are answered, the
+    // first one with an empty sketch.
+    const auto third_request{pair.initiator.InitiateReconciliationRequest(0, 1s + RECON_RESPONSE_TIMEOUT + RECON_REQUEST_INTERVAL)};
+    BOOST_REQUIRE(third_request);
+    BOOST_REQUIRE(pair.responder.HandleReconciliationRequest(0, third_request->first, third_request->second));
+    const auto fourth_request{pair.initiator.InitiateReconciliationRequest(0, 1s + 2 * RECON_RESPONSE_TIMEOUT + RECON_REQUEST_INTERVAL)};
+    BOOST_REQUIRE(fourth_request);
+    BOOST_REQUIRE(pair.responder.HandleReconciliationRequest(0, fourth_request->first, fourth_request->second));
+    const auto empty_sketch{pair.responder.RespondToReconciliationRequest(0)};
+    BOOST_REQUIRE(empty_sketch);
+    BOOST_CHECK(empty_sketch->empty());
+    const auto last_sketch{pair.responder.RespondToReconciliationRequest(0)};
+    BOOST_REQUIRE(last_sketch);
+    BOOST_CHECK(!pair.responder.RespondToReconciliationRequest(0));
+    BOOST_CHECK(pair.initiator.HandleSketch(0, *empty_sketch).stale);
+    const auto last_result{pair.initiator.HandleSketch(0, *last_sketch)};
+    BOOST_CHECK(last_result.valid && !last_result.stale && last_result.success);
+}
+
+BOOST_AUTO_TEST_CASE(ReconciliationProtocolViolationTest)
+{
+    ReconcilingPair pair;
+
+    // Messages out of turn or for the wrong role.
+    BOOST_CHECK(!pair.initiator.HandleSketch(0, std::vector<uint8_t>(4)).valid);
+    BOOST_CHECK(!pair.responder.HandleSketch(0, std::vector<uint8_t>(4)).valid);
+    BOOST_CHECK(!pair.responder.HandleExtensionRequest(0));
+    BOOST_CHECK(!pair.responder.HandleReconciliationDifference(0, true, {}));
+    BOOST_CHECK(!pair.initiator.HandleReconciliationRequest(0, 0, 0));
+    BOOST_CHECK(!pair.responder.InitiateReconciliationRequest(0, 1s));
+
+    const auto request{pair.initiator.InitiateReconciliationRequest(0, 1s)};
+    BOOST_REQUIRE(request);
+    BOOST_CHECK(pair.responder.HandleReconciliationRequest(0, request->first, request->second));
+
+    // Sketches must consist of whole elements and stay within the capacity limit.
+    BOOST_CHECK(!pair.initiator.HandleSketch(0, std::vector<uint8_t>(3)).valid);
+    BOOST_CHECK(!pair.initiator.HandleSketch(0, std::vector<uint8_t>((MAX_SKETCH_CAPACITY + 1) * 4)).valid);
+
+    // With nothing on either side, an empty sketch concludes the round successfully.
+    const auto sketch{pair.responder.RespondToReconciliationRequest(0)};
+    BOOST_REQUIRE(sketch);
+    BOOST_CHECK(sketch->empty());
+    const auto result{pair.initiator.HandleSketch(0, *sketch)};
+    BOOST_CHECK(result.valid && result.success && result.announce.empty() && result.ask_shortids.empty());
+    BOOST_CHECK(!pair.responder.HandleExtensionRequest(0));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
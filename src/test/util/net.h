@@ -86,7 +86,8 @@ struct ConnmanTestMsg : public CConnman {
 
     void SocketHandlerPublic()
     {
-        SocketHandler();
+        SockPoller poller{/*use_epoll=*/false};
+        SocketHandler(/*shard=*/0, poller);
     }
 
     void Handshake(CNode& node,
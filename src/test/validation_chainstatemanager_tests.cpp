@@ -414,6 +414,54 @@ BOOST_FIXTURE_TEST_CASE(chainstatemanager_activate_snapshot, SnapshotTestSetup)
     this->SetupSnapshot();
 }
 
+//! Test loading a snapshot whose coins are not in database order, which is
+//! hashed from the database after the coins are loaded.
+BOOST_FIXTURE_TEST_CASE(chainstatemanager_snapshot_out_of_order, SnapshotTestSetup)
+{
+    ChainstateManager& chainman = *Assert(m_node.chainman);
+    mineBlocks(10);
+    const fs::path snapshot_path{m_path_root / "test_snapshot.110.dat"};
+
+    {
+        ASSERT_DEBUG_LOG("coins are not in database order");
+        BOOST_REQUIRE(CreateAndActivateUTXOSnapshot(
+            this, [&](AutoFile& auto_infile, SnapshotMetadata& metadata) {
+                // Rewrite the coins with their transactions in reverse order.
+                const int64_t coins_begin{auto_infile.tell()};
+                std::vector<DataStream> txs;
+                for (uint64_t coins_left{metadata.m_coins_count}; coins_left > 0;) {
+                    DataStream& tx{txs.emplace_back()};
+                    Txid txid;
+                    auto_infile >> txid;
+                    const uint64_t coins_per_txid{ReadCompactSize(auto_infile)};
+                    tx << txid;
+                    WriteCompactSize(tx, coins_per_txid);
+                    for (uint64_t i{0}; i < coins_per_txid; ++i) {
+                        WriteCompactSize(tx, ReadCompactSize(auto_infile));
+                        Coin coin;
+                        auto_infile >> coin;
+                        tx << coin;
+                    }
+                    coins_left -= coins_per_txid;
+                }
+                BOOST_REQUIRE_GT(txs.size(), 1U);
+                AutoFile outfile{fsbridge::fopen(snapshot_path, "r+b")};
+                outfile.seek(coins_begin, SEEK_SET);
+                for (auto tx{txs.rbegin()}; tx != txs.rend(); ++tx) outfile.write(*tx);
+                BOOST_REQUIRE_EQUAL(outfile.fclose(), 0);
+                // Drop what was buffered of the old file contents.
+                auto_infile.seek(coins_begin, SEEK_SET);
+        }));
+    }
+    BOOST_CHECK(chainman.IsSnapshotActive());
+
+    LOCK(::cs_main);
+    CCoinsViewCache& coinscache{chainman.ActiveChainstate().CoinsTip()};
+    for (const CTransactionRef& txn : m_coinbase_txns) {
+        BOOST_CHECK(coinscache.HaveCoin(COutPoint{txn->GetHash(), 0}));
+    }
+}
+
 //! Test LoadBlockIndex behavior when multiple chainstates are in use.
 //!
 //! - First, verify that setBlockIndexCandidates is as expected when using a single,
@@ -14,10 +14,13 @@
 #include <uint256.h>
 #include <util/vector.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <iterator>
+#include <memory>
 #include <utility>
+#include <vector>
 
 static constexpr uint8_t DB_COIN{'C'};
 static constexpr uint8_t DB_BEST_BLOCK{'B'};
@@ -154,6 +157,19 @@ bool CCoinsViewDB::BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashB
     return ret;
 }
 
+bool CCoinsViewDB::WriteCoins(std::span<const std::pair<COutPoint, Coin>> coins)
+{
+    CDBBatch batch(*m_db);
+    for (const auto& [outpoint, coin] : coins) {
+        batch.Write(CoinEntry(&outpoint), coin);
+        if (batch.ApproximateSize() > m_options.batch_write_bytes) {
+            if (!m_db->WriteBatch(batch)) return false;
+            batch.Clear();
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
 size_t CCoinsViewDB::EstimateSize() const
 {
     return m_db->EstimateSize(DB_COIN, uint8_t(DB_COIN + 1));
@@ -165,8 +181,8 @@ class CCoinsViewDBCursor: public CCoinsViewCursor
 public:
     // Prefer using CCoinsViewDB::Cursor() since we want to perform some
     // cache warmup on instantiation.
-    CCoinsViewDBCursor(CDBIterator* pcursorIn, const uint256&hashBlockIn):
-        CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
+    CCoinsViewDBCursor(CDBIterator* pcursorIn, const uint256&hashBlockIn, uint32_t end = COINS_CURSOR_PREFIXES):
+        CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn), m_end(end) {}
     ~CCoinsViewDBCursor() = default;
 
     bool GetKey(COutPoint &key) const override;
@@ -176,8 +192,13 @@ public:
     void Next() override;
 
 private:
+    //! Cache the key at the iterator position, if it is in range
+    void LoadKey();
+
     std::unique_ptr<CDBIterator> pcursor;
     std::pair<char, COutPoint> keyTmp;
+    //! Txid prefix at which the cursor's range ends, see CoinsCursorRangeBegin()
+    const uint32_t m_end;
 
     friend class CCoinsViewDB;
 };
@@ -191,14 +212,38 @@ std::unique_ptr<CCoinsViewCursor> CCoinsViewDB::Cursor() const
        that restriction.  */
     i->pcursor->Seek(DB_COIN);
     // Cache key of first record
-    if (i->pcursor->Valid()) {
-        CoinEntry entry(&i->keyTmp.second);
-        i->pcursor->GetKey(entry);
-        i->keyTmp.first = entry.key;
+    i->LoadKey();
+    return i;
+}
+
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsViewDB::Cursors(size_t count) const
+{
+    count = std::clamp<size_t>(count, 1, COINS_CURSOR_PREFIXES);
+    const uint256 best_block{GetBestBlock()};
+    std::vector<std::unique_ptr<CDBIterator>> iterators{const_cast<CDBWrapper&>(*m_db).NewIterators(count)};
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    for (size_t n{0}; n < count; ++n) {
+        auto i = std::make_unique<CCoinsViewDBCursor>(iterators[n].release(), best_block, CoinsCursorRangeBegin(n + 1, count));
+        uint256 begin;
+        const uint32_t prefix{CoinsCursorRangeBegin(n, count)};
+        begin.data()[0] = prefix >> 8;
+        begin.data()[1] = prefix & 0xff;
+        const COutPoint start{Txid::FromUint256(begin), 0};
+        i->pcursor->Seek(CoinEntry{&start});
+        i->LoadKey();
+        cursors.push_back(std::move(i));
+    }
+    return cursors;
+}
+
+void CCoinsViewDBCursor::LoadKey()
+{
+    CoinEntry entry(&keyTmp.second);
+    if (!pcursor->Valid() || !pcursor->GetKey(entry) || CoinsCursorPrefix(keyTmp.second) >= m_end) {
+        keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
     } else {
-        i->keyTmp.first = 0; // Make sure Valid() and GetKey() return false
+        keyTmp.first = entry.key;
     }
-    return i;
 }
 
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const
@@ -224,10 +269,5 @@ bool CCoinsViewDBCursor::Valid() const
 void CCoinsViewDBCursor::Next()
 {
     pcursor->Next();
-    CoinEntry entry(&keyTmp.second);
-    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
-        keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
-    } else {
-        keyTmp.first = entry.key;
-    }
+    LoadKey();
 }
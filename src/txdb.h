@@ -16,6 +16,8 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
 class COutPoint;
@@ -49,6 +51,12 @@ public:
     std::vector<uint256> GetHeadBlocks() const override;
     bool BatchWrite(CoinsViewCacheCursor& cursor, const uint256 &hashBlock) override;
     std::unique_ptr<CCoinsViewCursor> Cursor() const override;
+    std::vector<std::unique_ptr<CCoinsViewCursor>> Cursors(size_t count) const override;
+
+    //! Write coins straight to the database in batches, bypassing any cache
+    //! on top of it. For bulk loading a database that nothing else uses yet;
+    //! the caller sets the best block afterwards.
+    bool WriteCoins(std::span<const std::pair<COutPoint, Coin>> coins);
 
     //! Whether an unsupported database format is used.
     bool NeedsUpgrade();
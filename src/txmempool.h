@@ -18,6 +18,7 @@
 #include <policy/packages.h>
 #include <primitives/transaction.h>
 #include <primitives/transaction_identifier.h>
+#include <support/allocators/pool.h>
 #include <sync.h>
 #include <util/epochguard.h>
 #include <util/feefrac.h>
@@ -413,7 +414,27 @@ private:
     }
 
 public:
-    indirectmap<COutPoint, const CTransaction*> mapNextTx GUARDED_BY(cs);
+    /**
+     * mapNextTx holds one node for every input of every mempool transaction.
+     * Like CCoinsMap, allocate the nodes from a pool to avoid the per-node
+     * malloc overhead and heap fragmentation. The size of 4 pointers added to
+     * the data covers the red-black tree node header.
+     *
+     * The transactions themselves are not pooled: they are shared with relay,
+     * blocks and wallets through CTransactionRef, and standard scriptPubKeys
+     * fit inline in CScript, so outputs have no script allocations to share.
+     */
+    using NextTxMap = indirectmap<COutPoint,
+                                  const CTransaction*,
+                                  PoolAllocator<std::pair<const COutPoint* const, const CTransaction*>,
+                                                sizeof(std::pair<const COutPoint* const, const CTransaction*>) + sizeof(void*) * 4>>;
+
+private:
+    //! Must outlive mapNextTx, which allocates from it.
+    NextTxMap::allocator_type::ResourceType m_next_tx_resource{};
+
+public:
+    NextTxMap mapNextTx GUARDED_BY(cs){&m_next_tx_resource};
     std::map<Txid, CAmount> mapDeltas GUARDED_BY(cs);
 
     using Options = kernel::MemPoolOptions;
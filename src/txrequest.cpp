@@ -10,25 +10,25 @@
 #include <random.h>
 #include <uint256.h>
 
-#include <boost/multi_index/indexed_by.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/tag.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/tuple/tuple.hpp>
+#include <util/hasher.h>
 
+#include <algorithm>
+#include <cassert>
 #include <chrono>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
-
-#include <cassert>
+#include <vector>
 
 namespace {
 
 /** The various states a (txhash,peer) pair can be in.
  *
  * Note that CANDIDATE is split up into 3 substates (DELAYED, BEST, READY), allowing more efficient implementation.
- * Also note that the sorting order of ByTxHashView relies on the specific order of values in this enum.
  *
  * Expected behaviour is:
  *   - When first announced by a peer, the state is CANDIDATE_DELAYED until reqtime is reached.
@@ -60,17 +60,27 @@ using SequenceNumber = uint64_t;
 /** An announcement. This is the data we track for each txid or wtxid that is announced to us by each peer. */
 struct Announcement {
     /** Txid or wtxid that was announced. */
-    const GenTxid m_gtxid;
+    GenTxid m_gtxid;
     /** For CANDIDATE_{DELAYED,BEST,READY} the reqtime; for REQUESTED the expiry. */
     std::chrono::microseconds m_time;
     /** What peer the request was from. */
-    const NodeId m_peer;
+    NodeId m_peer;
+    /** Cached priority of this announcement, see PriorityComputer. */
+    uint64_t m_priority{0};
     /** What sequence number this announcement has. */
-    const SequenceNumber m_sequence : 59;
+    SequenceNumber m_sequence : 59;
     /** Whether the request is preferred. */
-    const bool m_preferred : 1;
+    bool m_preferred : 1;
     /** What state this announcement is in. */
     State m_state : 3 {State::CANDIDATE_DELAYED};
+    /** Whether this storage slot holds an announcement. */
+    bool m_in_use : 1 {true};
+    /** Incremented whenever the state or time changes, to invalidate queued time events. */
+    uint32_t m_version{0};
+    /** Position in the announcing peer's list of announcements. */
+    uint32_t m_peer_pos{0};
+    /** Position in the announcing peer's list of CANDIDATE_BEST announcements, if CANDIDATE_BEST. */
+    uint32_t m_best_pos{0};
     State GetState() const { return m_state; }
     void SetState(State state) { m_state = state; }
 
@@ -124,107 +134,65 @@ public:
     }
 };
 
-// Definitions for the 3 indexes used in the main data structure.
-//
-// Each index has a By* type to identify it, a By*View data type to represent the view of announcement it is sorted
-// by, and an By*ViewExtractor type to convert an announcement into the By*View type.
-// See https://www.boost.org/doc/libs/1_58_0/libs/multi_index/doc/reference/key_extraction.html#key_extractors
-// for more information about the key extraction concept.
-
-// The ByPeer index is sorted by (peer, state == CANDIDATE_BEST, txhash)
-//
-// Uses:
-// * Looking up existing announcements by peer/txhash, by checking both (peer, false, txhash) and
-//   (peer, true, txhash).
-// * Finding all CANDIDATE_BEST announcements for a given peer in GetRequestable.
-struct ByPeer {};
-using ByPeerView = std::tuple<NodeId, bool, const uint256&>;
-struct ByPeerViewExtractor
-{
-    using result_type = ByPeerView;
-    result_type operator()(const Announcement& ann) const
-    {
-        return ByPeerView{ann.m_peer, ann.GetState() == State::CANDIDATE_BEST, ann.m_gtxid.ToUint256()};
-    }
-};
+//! Index of an announcement in the flat announcement storage.
+using AnnIdx = uint32_t;
 
-// The ByTxHash index is sorted by (txhash, state, priority).
-//
-// Note: priority == 0 whenever state != CANDIDATE_READY.
-//
-// Uses:
-// * Deleting all announcements with a given txhash in ForgetTxHash.
-// * Finding the best CANDIDATE_READY to convert to CANDIDATE_BEST, when no other CANDIDATE_READY or REQUESTED
-//   announcement exists for that txhash.
-// * Determining when no more non-COMPLETED announcements for a given txhash exist, so the COMPLETED ones can be
-//   deleted.
-struct ByTxHash {};
-using ByTxHashView = std::tuple<const uint256&, State, Priority>;
-class ByTxHashViewExtractor {
-    const PriorityComputer& m_computer;
+//! Key identifying an announcement: the announcing peer and the txhash.
+using PeerTxHash = std::pair<NodeId, uint256>;
+
+/** Salted hasher for PeerTxHash keys. */
+class PeerTxHashHasher {
+    const uint64_t m_k0, m_k1;
 public:
-    explicit ByTxHashViewExtractor(const PriorityComputer& computer) : m_computer(computer) {}
-    using result_type = ByTxHashView;
-    result_type operator()(const Announcement& ann) const
+    PeerTxHashHasher() : m_k0{FastRandomContext().rand64()}, m_k1{FastRandomContext().rand64()} {}
+
+    size_t operator()(const PeerTxHash& key) const
     {
-        const Priority prio = (ann.GetState() == State::CANDIDATE_READY) ? m_computer(ann) : 0;
-        return ByTxHashView{ann.m_gtxid.ToUint256(), ann.GetState(), prio};
+        return SipHashUint256Extra(m_k0, m_k1, key.second, static_cast<uint32_t>(key.first));
     }
 };
 
-enum class WaitState {
-    //! Used for announcements that need efficient testing of "is their timestamp in the future?".
-    FUTURE_EVENT,
-    //! Used for announcements whose timestamp is not relevant.
-    NO_EVENT,
-    //! Used for announcements that need efficient testing of "is their timestamp in the past?".
-    PAST_EVENT,
-};
+/** An entry in one of the time queues. It refers to an announcement together with the version it had when the
+ *  entry was pushed; entries whose version no longer matches are stale and skipped when popped. */
+struct TimeEntry {
+    std::chrono::microseconds m_time;
+    AnnIdx m_idx;
+    uint32_t m_version;
 
-WaitState GetWaitState(const Announcement& ann)
-{
-    if (ann.IsWaiting()) return WaitState::FUTURE_EVENT;
-    if (ann.IsSelectable()) return WaitState::PAST_EVENT;
-    return WaitState::NO_EVENT;
-}
+    friend bool operator<(const TimeEntry& a, const TimeEntry& b) { return a.m_time < b.m_time; }
+    friend bool operator>(const TimeEntry& a, const TimeEntry& b) { return a.m_time > b.m_time; }
+};
 
-// The ByTime index is sorted by (wait_state, time).
-//
-// All announcements with a timestamp in the future can be found by iterating the index forward from the beginning.
-// All announcements with a timestamp in the past can be found by iterating the index backwards from the end.
-//
-// Uses:
-// * Finding CANDIDATE_DELAYED announcements whose reqtime has passed, and REQUESTED announcements whose expiry has
-//   passed.
-// * Finding CANDIDATE_READY/BEST announcements whose reqtime is in the future (when the clock time went backwards).
-struct ByTime {};
-using ByTimeView = std::pair<WaitState, std::chrono::microseconds>;
-struct ByTimeViewExtractor
-{
-    using result_type = ByTimeView;
-    result_type operator()(const Announcement& ann) const
+/** A priority queue of TimeEntry objects with lazy deletion.
+ *
+ * Compare is std::greater for a queue that pops the earliest time first, and std::less for one that pops the latest
+ * time first. Stale entries are only removed when they reach the top, or when they make up more than half of the
+ * queue, at which point the queue is rebuilt from the live announcements (amortized O(1) per push). */
+template<typename Compare>
+class TimeQueue {
+    std::vector<TimeEntry> m_heap;
+public:
+    void Push(const TimeEntry& entry)
+    {
+        m_heap.push_back(entry);
+        std::push_heap(m_heap.begin(), m_heap.end(), Compare{});
+    }
+    bool Empty() const { return m_heap.empty(); }
+    size_t Size() const { return m_heap.size(); }
+    const TimeEntry& Top() const { return m_heap.front(); }
+    void Pop()
+    {
+        std::pop_heap(m_heap.begin(), m_heap.end(), Compare{});
+        m_heap.pop_back();
+    }
+    //! Replace the contents with the given entries.
+    void Rebuild(std::vector<TimeEntry>&& entries)
     {
-        return ByTimeView{GetWaitState(ann), ann.m_time};
+        m_heap = std::move(entries);
+        std::make_heap(m_heap.begin(), m_heap.end(), Compare{});
     }
 };
 
-struct Announcement_Indices final : boost::multi_index::indexed_by<
-    boost::multi_index::ordered_unique<boost::multi_index::tag<ByPeer>, ByPeerViewExtractor>,
-    boost::multi_index::ordered_non_unique<boost::multi_index::tag<ByTxHash>, ByTxHashViewExtractor>,
-    boost::multi_index::ordered_non_unique<boost::multi_index::tag<ByTime>, ByTimeViewExtractor>
->
-{};
-
-/** Data type for the main data structure (Announcement objects with ByPeer/ByTxHash/ByTime indexes). */
-using Index = boost::multi_index_container<
-    Announcement,
-    Announcement_Indices
->;
-
-/** Helper type to simplify syntax of iterator types. */
-template<typename Tag>
-using Iter = typename Index::index<Tag>::type::iterator;
-
 /** Per-peer statistics object. */
 struct PeerInfo {
     size_t m_total = 0; //!< Total number of announcements for this peer.
@@ -232,6 +200,15 @@ struct PeerInfo {
     size_t m_requested = 0; //!< Number of REQUESTED announcements for this peer.
 };
 
+/** Per-peer data: statistics plus the announcements of this peer. */
+struct PeerData {
+    PeerInfo m_info;
+    //! All announcements of this peer (unordered). Announcement::m_peer_pos is the position in this vector.
+    std::vector<AnnIdx> m_announcements;
+    //! CANDIDATE_BEST announcements of this peer (unordered). Announcement::m_best_pos is the position in this vector.
+    std::vector<AnnIdx> m_best;
+};
+
 /** Per-txhash statistics object. Only used for sanity checking. */
 struct TxHashInfo
 {
@@ -258,46 +235,20 @@ bool operator==(const PeerInfo& a, const PeerInfo& b)
            std::tie(b.m_total, b.m_completed, b.m_requested);
 };
 
-/** (Re)compute the PeerInfo map from the index. Only used for sanity checking. */
-std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index& index)
-{
-    std::unordered_map<NodeId, PeerInfo> ret;
-    for (const Announcement& ann : index) {
-        PeerInfo& info = ret[ann.m_peer];
-        ++info.m_total;
-        info.m_requested += (ann.GetState() == State::REQUESTED);
-        info.m_completed += (ann.GetState() == State::COMPLETED);
-    }
-    return ret;
-}
-
-/** Compute the TxHashInfo map. Only used for sanity checking. */
-std::map<uint256, TxHashInfo> ComputeTxHashInfo(const Index& index, const PriorityComputer& computer)
-{
-    std::map<uint256, TxHashInfo> ret;
-    for (const Announcement& ann : index) {
-        TxHashInfo& info = ret[ann.m_gtxid.ToUint256()];
-        // Classify how many announcements of each state we have for this txhash.
-        info.m_candidate_delayed += (ann.GetState() == State::CANDIDATE_DELAYED);
-        info.m_candidate_ready += (ann.GetState() == State::CANDIDATE_READY);
-        info.m_candidate_best += (ann.GetState() == State::CANDIDATE_BEST);
-        info.m_requested += (ann.GetState() == State::REQUESTED);
-        // And track the priority of the best CANDIDATE_READY/CANDIDATE_BEST announcements.
-        if (ann.GetState() == State::CANDIDATE_BEST) {
-            info.m_priority_candidate_best = computer(ann);
-        }
-        if (ann.GetState() == State::CANDIDATE_READY) {
-            info.m_priority_best_candidate_ready = std::max(info.m_priority_best_candidate_ready, computer(ann));
-        }
-        // Also keep track of which peers this txhash has an announcement for (so we can detect duplicates).
-        info.m_peers.push_back(ann.m_peer);
-    }
-    return ret;
-}
-
 }  // namespace
 
-/** Actual implementation for TxRequestTracker's data structure. */
+/** Actual implementation for TxRequestTracker's data structure.
+ *
+ * Announcements are stored in a flat vector, with freed slots reused, and compacted once most slots are unused.
+ * They are indexed by:
+ * - m_by_peer_txhash: a hash map from (peer, txhash) to the announcement, enforcing uniqueness.
+ * - m_by_txhash: a hash map from txhash to all announcements for it. The number of announcements per txhash is
+ *   bounded by the number of peers, so operations on a txhash scan this list.
+ * - m_peers: per peer, the list of all its announcements and of its CANDIDATE_BEST announcements.
+ * - m_future: announcements waiting for their time to pass (CANDIDATE_DELAYED and REQUESTED), earliest first.
+ * - m_past: selectable announcements (CANDIDATE_READY and CANDIDATE_BEST), latest first, to detect time going
+ *   backwards.
+ */
 class TxRequestTracker::Impl {
     //! The current sequence number. Increases for every announcement. This is used to sort txhashes returned by
     //! GetRequestable in announcement order.
@@ -306,21 +257,89 @@ class TxRequestTracker::Impl {
     //! This tracker's priority computer.
     const PriorityComputer m_computer;
 
-    //! This tracker's main data structure. See SanityCheck() for the invariants that apply to it.
-    Index m_index;
-
-    //! Map with this tracker's per-peer statistics.
-    std::unordered_map<NodeId, PeerInfo> m_peerinfo;
+    //! Announcement storage. Slots in m_free are unused.
+    std::vector<Announcement> m_announcements;
+    //! Unused slots in m_announcements.
+    std::vector<AnnIdx> m_free;
+
+    //! Index by (peer, txhash).
+    std::unordered_map<PeerTxHash, AnnIdx, PeerTxHashHasher> m_by_peer_txhash;
+    //! Index by txhash.
+    std::unordered_map<uint256, std::vector<AnnIdx>, SaltedUint256Hasher> m_by_txhash;
+    //! Per-peer data. Peers without announcements have no entry.
+    std::unordered_map<NodeId, PeerData> m_peers;
+
+    //! CANDIDATE_DELAYED and REQUESTED announcements, earliest time first.
+    TimeQueue<std::greater<TimeEntry>> m_future;
+    //! CANDIDATE_READY and CANDIDATE_BEST announcements, latest time first.
+    TimeQueue<std::less<TimeEntry>> m_past;
+
+    //! Apply fn to every announcement in use.
+    template<typename Fn>
+    void ForEachAnnouncement(Fn&& fn) const
+    {
+        for (const Announcement& ann : m_announcements) {
+            if (ann.m_in_use) fn(ann);
+        }
+    }
 
 public:
     void SanityCheck() const
     {
-        // Recompute m_peerdata from m_index. This verifies the data in it as it should just be caching statistics
-        // on m_index. It also verifies the invariant that no PeerInfo announcements with m_total==0 exist.
-        assert(m_peerinfo == RecomputePeerInfo(m_index));
+        // Recompute the per-peer statistics and the peer indexes from the announcements. This verifies the data in
+        // m_peers as it should just be caching information on the announcements. It also verifies the invariant
+        // that no peer entries without announcements exist.
+        std::unordered_map<NodeId, PeerInfo> peerinfo;
+        std::map<uint256, TxHashInfo> txhashinfo;
+        size_t size{0};
+        for (AnnIdx idx{0}; idx < m_announcements.size(); ++idx) {
+            const Announcement& ann{m_announcements[idx]};
+            if (!ann.m_in_use) continue;
+            ++size;
+            PeerInfo& info = peerinfo[ann.m_peer];
+            ++info.m_total;
+            info.m_requested += (ann.GetState() == State::REQUESTED);
+            info.m_completed += (ann.GetState() == State::COMPLETED);
+
+            // Verify that the announcement is indexed correctly.
+            const uint256& txhash{ann.m_gtxid.ToUint256()};
+            assert(m_by_peer_txhash.at(PeerTxHash{ann.m_peer, txhash}) == idx);
+            const auto& txhash_anns{m_by_txhash.at(txhash)};
+            assert(std::count(txhash_anns.begin(), txhash_anns.end(), idx) == 1);
+            const PeerData& peer{m_peers.at(ann.m_peer)};
+            assert(peer.m_announcements.at(ann.m_peer_pos) == idx);
+            if (ann.GetState() == State::CANDIDATE_BEST) assert(peer.m_best.at(ann.m_best_pos) == idx);
+            assert(ann.m_priority == m_computer(ann));
+
+            TxHashInfo& tinfo = txhashinfo[txhash];
+            // Classify how many announcements of each state we have for this txhash.
+            tinfo.m_candidate_delayed += (ann.GetState() == State::CANDIDATE_DELAYED);
+            tinfo.m_candidate_ready += (ann.GetState() == State::CANDIDATE_READY);
+            tinfo.m_candidate_best += (ann.GetState() == State::CANDIDATE_BEST);
+            tinfo.m_requested += (ann.GetState() == State::REQUESTED);
+            // And track the priority of the best CANDIDATE_READY/CANDIDATE_BEST announcements.
+            if (ann.GetState() == State::CANDIDATE_BEST) {
+                tinfo.m_priority_candidate_best = ann.m_priority;
+            }
+            if (ann.GetState() == State::CANDIDATE_READY) {
+                tinfo.m_priority_best_candidate_ready = std::max(tinfo.m_priority_best_candidate_ready, ann.m_priority);
+            }
+            // Also keep track of which peers this txhash has an announcement for (so we can detect duplicates).
+            tinfo.m_peers.push_back(ann.m_peer);
+        }
+        assert(size == Size());
+        assert(m_by_peer_txhash.size() == size);
+        assert(m_by_txhash.size() == txhashinfo.size());
+        assert(m_peers.size() == peerinfo.size());
+        for (const auto& [peer, info] : peerinfo) {
+            const PeerData& data{m_peers.at(peer)};
+            assert(data.m_info == info);
+            assert(data.m_announcements.size() == info.m_total);
+            for (AnnIdx idx : data.m_best) assert(m_announcements[idx].GetState() == State::CANDIDATE_BEST);
+        }
 
-        // Calculate per-txhash statistics from m_index, and validate invariants.
-        for (auto& item : ComputeTxHashInfo(m_index, m_computer)) {
+        // Validate per-txhash invariants.
+        for (auto& item : txhashinfo) {
             TxHashInfo& info = item.second;
 
             // Cannot have only COMPLETED peer (txhash should have been forgotten already)
@@ -349,7 +368,7 @@ public:
 
     void PostGetRequestableSanityCheck(std::chrono::microseconds now) const
     {
-        for (const Announcement& ann : m_index) {
+        ForEachAnnouncement([&](const Announcement& ann) {
             if (ann.IsWaiting()) {
                 // REQUESTED and CANDIDATE_DELAYED must have a time in the future (they should have been converted
                 // to COMPLETED/CANDIDATE_READY respectively).
@@ -359,120 +378,227 @@ public:
                 // CANDIDATE_DELAYED, or should have been converted back to it if time went backwards).
                 assert(ann.m_time <= now);
             }
-        }
+        });
     }
 
 private:
-    //! Wrapper around Index::...::erase that keeps m_peerinfo up to date.
-    template<typename Tag>
-    Iter<Tag> Erase(Iter<Tag> it)
+    //! Push an entry for the announcement on the time queue matching its state, if any.
+    void PushTimeEntry(AnnIdx idx)
     {
-        auto peerit = m_peerinfo.find(it->m_peer);
-        peerit->second.m_completed -= it->GetState() == State::COMPLETED;
-        peerit->second.m_requested -= it->GetState() == State::REQUESTED;
-        if (--peerit->second.m_total == 0) m_peerinfo.erase(peerit);
-        return m_index.get<Tag>().erase(it);
+        const Announcement& ann{m_announcements[idx]};
+        const TimeEntry entry{ann.m_time, idx, ann.m_version};
+        if (ann.IsWaiting()) {
+            m_future.Push(entry);
+            if (m_future.Size() > 2 * Size() + 64) RebuildTimeQueues();
+        } else if (ann.IsSelectable()) {
+            m_past.Push(entry);
+            if (m_past.Size() > 2 * Size() + 64) RebuildTimeQueues();
+        }
     }
 
-    //! Wrapper around Index::...::modify that keeps m_peerinfo up to date.
-    template<typename Tag, typename Modifier>
-    void Modify(Iter<Tag> it, Modifier modifier)
+    //! Drop all stale entries from the time queues. As MaybeCompact() keeps the number of unused slots below the
+    //! number of announcements plus a constant, this is linear in Size().
+    void RebuildTimeQueues()
     {
-        auto peerit = m_peerinfo.find(it->m_peer);
-        peerit->second.m_completed -= it->GetState() == State::COMPLETED;
-        peerit->second.m_requested -= it->GetState() == State::REQUESTED;
-        m_index.get<Tag>().modify(it, std::move(modifier));
-        peerit->second.m_completed += it->GetState() == State::COMPLETED;
-        peerit->second.m_requested += it->GetState() == State::REQUESTED;
+        std::vector<TimeEntry> future, past;
+        for (AnnIdx idx{0}; idx < m_announcements.size(); ++idx) {
+            const Announcement& ann{m_announcements[idx]};
+            if (!ann.m_in_use) continue;
+            if (ann.IsWaiting()) future.push_back({ann.m_time, idx, ann.m_version});
+            if (ann.IsSelectable()) past.push_back({ann.m_time, idx, ann.m_version});
+        }
+        m_future.Rebuild(std::move(future));
+        m_past.Rebuild(std::move(past));
+    }
+
+    //! Move the announcements to the front of the storage and release the unused slots, once these outnumber the
+    //! announcements. As the next compaction needs about Size() / 2 erasures, this is amortized O(1) per erasure.
+    //! All announcement indexes change, so this may only be called once an operation is done with them.
+    void MaybeCompact()
+    {
+        if (m_free.size() <= Size() + 64) return;
+        std::vector<AnnIdx> new_idx(m_announcements.size());
+        std::vector<Announcement> announcements;
+        announcements.reserve(Size());
+        for (AnnIdx idx{0}; idx < m_announcements.size(); ++idx) {
+            if (!m_announcements[idx].m_in_use) continue;
+            new_idx[idx] = announcements.size();
+            announcements.push_back(std::move(m_announcements[idx]));
+        }
+        m_announcements = std::move(announcements);
+        m_free = {};
+        // The positions within the per-peer vectors do not change.
+        for (auto& [key, idx] : m_by_peer_txhash) idx = new_idx[idx];
+        for (auto& [txhash, anns] : m_by_txhash) {
+            for (AnnIdx& idx : anns) idx = new_idx[idx];
+        }
+        for (auto& [peer, data] : m_peers) {
+            for (AnnIdx& idx : data.m_announcements) idx = new_idx[idx];
+            for (AnnIdx& idx : data.m_best) idx = new_idx[idx];
+        }
+        RebuildTimeQueues();
+    }
+
+    //! Delete all announcements for a txhash.
+    void EraseTxHash(const uint256& txhash)
+    {
+        auto it = m_by_txhash.find(txhash);
+        if (it == m_by_txhash.end()) return;
+        // Copy, as erasing the last announcement removes the map entry.
+        const std::vector<AnnIdx> anns{it->second};
+        for (AnnIdx idx : anns) Erase(idx);
+    }
+
+    //! Return the announcement referred to by the top of a time queue, after popping stale entries.
+    template<typename Queue>
+    std::optional<AnnIdx> Top(Queue& queue)
+    {
+        while (!queue.Empty()) {
+            const TimeEntry& entry{queue.Top()};
+            const Announcement& ann{m_announcements[entry.m_idx]};
+            if (ann.m_in_use && ann.m_version == entry.m_version) return entry.m_idx;
+            queue.Pop();
+        }
+        return std::nullopt;
+    }
+
+    //! Change the state (and optionally the time) of an announcement, keeping the per-peer data and the time queues
+    //! up to date.
+    void SetState(AnnIdx idx, State state, std::optional<std::chrono::microseconds> time = std::nullopt)
+    {
+        Announcement& ann{m_announcements[idx]};
+        PeerData& peer{m_peers.find(ann.m_peer)->second};
+        peer.m_info.m_completed -= ann.GetState() == State::COMPLETED;
+        peer.m_info.m_requested -= ann.GetState() == State::REQUESTED;
+        if (ann.GetState() == State::CANDIDATE_BEST && state != State::CANDIDATE_BEST) {
+            RemoveAt(peer.m_best, ann.m_best_pos, &Announcement::m_best_pos);
+        } else if (ann.GetState() != State::CANDIDATE_BEST && state == State::CANDIDATE_BEST) {
+            ann.m_best_pos = peer.m_best.size();
+            peer.m_best.push_back(idx);
+        }
+        ann.SetState(state);
+        if (time) ann.m_time = *time;
+        ++ann.m_version;
+        peer.m_info.m_completed += ann.GetState() == State::COMPLETED;
+        peer.m_info.m_requested += ann.GetState() == State::REQUESTED;
+        PushTimeEntry(idx);
+    }
+
+    //! Remove the element at pos from a vector of announcement indexes, moving the last element into its place and
+    //! updating that announcement's position field.
+    void RemoveAt(std::vector<AnnIdx>& vec, uint32_t pos, uint32_t Announcement::*pos_field)
+    {
+        if (pos + 1 != vec.size()) {
+            vec[pos] = vec.back();
+            m_announcements[vec[pos]].*pos_field = pos;
+        }
+        vec.pop_back();
+    }
+
+    //! Delete an announcement, removing it from all indexes.
+    void Erase(AnnIdx idx)
+    {
+        Announcement& ann{m_announcements[idx]};
+        const uint256& txhash{ann.m_gtxid.ToUint256()};
+
+        auto peerit = m_peers.find(ann.m_peer);
+        PeerData& peer{peerit->second};
+        peer.m_info.m_completed -= ann.GetState() == State::COMPLETED;
+        peer.m_info.m_requested -= ann.GetState() == State::REQUESTED;
+        if (ann.GetState() == State::CANDIDATE_BEST) RemoveAt(peer.m_best, ann.m_best_pos, &Announcement::m_best_pos);
+        RemoveAt(peer.m_announcements, ann.m_peer_pos, &Announcement::m_peer_pos);
+        if (--peer.m_info.m_total == 0) m_peers.erase(peerit);
+
+        auto txhashit = m_by_txhash.find(txhash);
+        auto& txhash_anns{txhashit->second};
+        txhash_anns.erase(std::find(txhash_anns.begin(), txhash_anns.end(), idx));
+        if (txhash_anns.empty()) m_by_txhash.erase(txhashit);
+
+        m_by_peer_txhash.erase(PeerTxHash{ann.m_peer, txhash});
+
+        ann.m_in_use = false;
+        ++ann.m_version;
+        m_free.push_back(idx);
+    }
+
+    //! Find the announcement for a txhash which IsSelected(), if any.
+    std::optional<AnnIdx> FindSelected(const std::vector<AnnIdx>& txhash_anns) const
+    {
+        for (AnnIdx idx : txhash_anns) {
+            if (m_announcements[idx].IsSelected()) return idx;
+        }
+        return std::nullopt;
     }
 
     //! Convert a CANDIDATE_DELAYED announcement into a CANDIDATE_READY. If this makes it the new best
     //! CANDIDATE_READY (and no REQUESTED exists) and better than the CANDIDATE_BEST (if any), it becomes the new
     //! CANDIDATE_BEST.
-    void PromoteCandidateReady(Iter<ByTxHash> it)
+    void PromoteCandidateReady(AnnIdx idx)
     {
-        assert(it != m_index.get<ByTxHash>().end());
-        assert(it->GetState() == State::CANDIDATE_DELAYED);
+        assert(m_announcements[idx].GetState() == State::CANDIDATE_DELAYED);
         // Convert CANDIDATE_DELAYED to CANDIDATE_READY first.
-        Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_READY); });
-        // The following code relies on the fact that the ByTxHash is sorted by txhash, and then by state (first
-        // _DELAYED, then _READY, then _BEST/REQUESTED). Within the _READY announcements, the best one (highest
-        // priority) comes last. Thus, if an existing _BEST exists for the same txhash that this announcement may
-        // be preferred over, it must immediately follow the newly created _READY.
-        auto it_next = std::next(it);
-        if (it_next == m_index.get<ByTxHash>().end() || it_next->m_gtxid.ToUint256() != it->m_gtxid.ToUint256() ||
-            it_next->GetState() == State::COMPLETED) {
-            // This is the new best CANDIDATE_READY, and there is no IsSelected() announcement for this txhash
-            // already.
-            Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
-        } else if (it_next->GetState() == State::CANDIDATE_BEST) {
-            Priority priority_old = m_computer(*it_next);
-            Priority priority_new = m_computer(*it);
-            if (priority_new > priority_old) {
-                // There is a CANDIDATE_BEST announcement already, but this one is better.
-                Modify<ByTxHash>(it_next, [](Announcement& ann){ ann.SetState(State::CANDIDATE_READY); });
-                Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
-            }
+        SetState(idx, State::CANDIDATE_READY);
+        const auto selected{FindSelected(m_by_txhash.find(m_announcements[idx].m_gtxid.ToUint256())->second)};
+        if (!selected) {
+            // There is no IsSelected() announcement for this txhash already. Invariants guarantee that no other
+            // CANDIDATE_READY exists either, so this is the new best.
+            SetState(idx, State::CANDIDATE_BEST);
+        } else if (m_announcements[*selected].GetState() == State::CANDIDATE_BEST &&
+                   m_announcements[idx].m_priority > m_announcements[*selected].m_priority) {
+            // There is a CANDIDATE_BEST announcement already, but this one is better.
+            SetState(*selected, State::CANDIDATE_READY);
+            SetState(idx, State::CANDIDATE_BEST);
         }
     }
 
     //! Change the state of an announcement to something non-IsSelected(). If it was IsSelected(), the next best
     //! announcement will be marked CANDIDATE_BEST.
-    void ChangeAndReselect(Iter<ByTxHash> it, State new_state)
+    void ChangeAndReselect(AnnIdx idx, State new_state)
     {
         assert(new_state == State::COMPLETED || new_state == State::CANDIDATE_DELAYED);
-        assert(it != m_index.get<ByTxHash>().end());
-        if (it->IsSelected() && it != m_index.get<ByTxHash>().begin()) {
-            auto it_prev = std::prev(it);
-            // The next best CANDIDATE_READY, if any, immediately precedes the REQUESTED or CANDIDATE_BEST
-            // announcement in the ByTxHash index.
-            if (it_prev->m_gtxid.ToUint256() == it->m_gtxid.ToUint256() && it_prev->GetState() == State::CANDIDATE_READY) {
-                // If one such CANDIDATE_READY exists (for this txhash), convert it to CANDIDATE_BEST.
-                Modify<ByTxHash>(it_prev, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
+        if (m_announcements[idx].IsSelected()) {
+            // If any CANDIDATE_READY exists for this txhash, convert the one with the highest priority to
+            // CANDIDATE_BEST.
+            std::optional<AnnIdx> best_ready;
+            for (AnnIdx other : m_by_txhash.find(m_announcements[idx].m_gtxid.ToUint256())->second) {
+                const Announcement& ann{m_announcements[other]};
+                if (ann.GetState() == State::CANDIDATE_READY &&
+                    (!best_ready || ann.m_priority > m_announcements[*best_ready].m_priority)) {
+                    best_ready = other;
+                }
             }
+            if (best_ready) SetState(*best_ready, State::CANDIDATE_BEST);
         }
-        Modify<ByTxHash>(it, [new_state](Announcement& ann){ ann.SetState(new_state); });
+        SetState(idx, new_state);
     }
 
-    //! Check if 'it' is the only announcement for a given txhash that isn't COMPLETED.
-    bool IsOnlyNonCompleted(Iter<ByTxHash> it)
+    //! Check if idx is the only announcement for a given txhash that isn't COMPLETED.
+    bool IsOnlyNonCompleted(AnnIdx idx) const
     {
-        assert(it != m_index.get<ByTxHash>().end());
-        assert(it->GetState() != State::COMPLETED); // Not allowed to call this on COMPLETED announcements.
-
-        // This announcement has a predecessor that belongs to the same txhash. Due to ordering, and the
-        // fact that 'it' is not COMPLETED, its predecessor cannot be COMPLETED here.
-        if (it != m_index.get<ByTxHash>().begin() && std::prev(it)->m_gtxid.ToUint256() == it->m_gtxid.ToUint256()) return false;
-
-        // This announcement has a successor that belongs to the same txhash, and is not COMPLETED.
-        if (std::next(it) != m_index.get<ByTxHash>().end() && std::next(it)->m_gtxid.ToUint256() == it->m_gtxid.ToUint256() &&
-            std::next(it)->GetState() != State::COMPLETED) return false;
-
+        assert(m_announcements[idx].GetState() != State::COMPLETED); // Not allowed to call this on COMPLETED announcements.
+        for (AnnIdx other : m_by_txhash.find(m_announcements[idx].m_gtxid.ToUint256())->second) {
+            if (other != idx && m_announcements[other].GetState() != State::COMPLETED) return false;
+        }
         return true;
     }
 
     /** Convert any announcement to a COMPLETED one. If there are no non-COMPLETED announcements left for this
      *  txhash, they are deleted. If this was a REQUESTED announcement, and there are other CANDIDATEs left, the
      *  best one is made CANDIDATE_BEST. Returns whether the announcement still exists. */
-    bool MakeCompleted(Iter<ByTxHash> it)
+    bool MakeCompleted(AnnIdx idx)
     {
-        assert(it != m_index.get<ByTxHash>().end());
-
         // Nothing to be done if it's already COMPLETED.
-        if (it->GetState() == State::COMPLETED) return true;
+        if (m_announcements[idx].GetState() == State::COMPLETED) return true;
 
-        if (IsOnlyNonCompleted(it)) {
+        if (IsOnlyNonCompleted(idx)) {
             // This is the last non-COMPLETED announcement for this txhash. Delete all.
-            uint256 txhash = it->m_gtxid.ToUint256();
-            do {
-                it = Erase<ByTxHash>(it);
-            } while (it != m_index.get<ByTxHash>().end() && it->m_gtxid.ToUint256() == txhash);
+            EraseTxHash(m_announcements[idx].m_gtxid.ToUint256());
             return false;
         }
 
         // Mark the announcement COMPLETED, and select the next best announcement (the first CANDIDATE_READY) if
         // needed.
-        ChangeAndReselect(it, State::COMPLETED);
+        ChangeAndReselect(idx, State::COMPLETED);
 
         return true;
     }
@@ -487,110 +613,110 @@ private:
 
         // Iterate over all CANDIDATE_DELAYED and REQUESTED from old to new, as long as they're in the past,
         // and convert them to CANDIDATE_READY and COMPLETED respectively.
-        while (!m_index.empty()) {
-            auto it = m_index.get<ByTime>().begin();
-            if (it->GetState() == State::CANDIDATE_DELAYED && it->m_time <= now) {
-                PromoteCandidateReady(m_index.project<ByTxHash>(it));
-            } else if (it->GetState() == State::REQUESTED && it->m_time <= now) {
-                if (expired) expired->emplace_back(it->m_peer, it->m_gtxid);
-                MakeCompleted(m_index.project<ByTxHash>(it));
+        while (const auto idx{Top(m_future)}) {
+            const Announcement& ann{m_announcements[*idx]};
+            if (ann.m_time > now) break;
+            m_future.Pop();
+            if (ann.GetState() == State::CANDIDATE_DELAYED) {
+                PromoteCandidateReady(*idx);
             } else {
-                break;
+                if (expired) expired->emplace_back(ann.m_peer, ann.m_gtxid);
+                MakeCompleted(*idx);
             }
         }
 
-        while (!m_index.empty()) {
-            // If time went backwards, we may need to demote CANDIDATE_BEST and CANDIDATE_READY announcements back
-            // to CANDIDATE_DELAYED. This is an unusual edge case, and unlikely to matter in production. However,
-            // it makes it much easier to specify and test TxRequestTracker::Impl's behaviour.
-            auto it = std::prev(m_index.get<ByTime>().end());
-            if (it->IsSelectable() && it->m_time > now) {
-                ChangeAndReselect(m_index.project<ByTxHash>(it), State::CANDIDATE_DELAYED);
-            } else {
-                break;
-            }
+        // If time went backwards, we may need to demote CANDIDATE_BEST and CANDIDATE_READY announcements back
+        // to CANDIDATE_DELAYED. This is an unusual edge case, and unlikely to matter in production. However,
+        // it makes it much easier to specify and test TxRequestTracker::Impl's behaviour.
+        while (const auto idx{Top(m_past)}) {
+            if (m_announcements[*idx].m_time <= now) break;
+            m_past.Pop();
+            ChangeAndReselect(*idx, State::CANDIDATE_DELAYED);
         }
     }
 
 public:
     explicit Impl(bool deterministic) :
-        m_computer(deterministic),
-        // Explicitly initialize m_index as we need to pass a reference to m_computer to ByTxHashViewExtractor.
-        m_index(boost::make_tuple(
-            boost::make_tuple(ByPeerViewExtractor(), std::less<ByPeerView>()),
-            boost::make_tuple(ByTxHashViewExtractor(m_computer), std::less<ByTxHashView>()),
-            boost::make_tuple(ByTimeViewExtractor(), std::less<ByTimeView>())
-        )) {}
-
-    // Disable copying and assigning (a default copy won't work due the stateful ByTxHashViewExtractor).
+        m_computer(deterministic) {}
+
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
 
     void DisconnectedPeer(NodeId peer)
     {
-        auto& index = m_index.get<ByPeer>();
-        auto it = index.lower_bound(ByPeerView{peer, false, uint256::ZERO});
-        while (it != index.end() && it->m_peer == peer) {
-            // Check what to continue with after this iteration. 'it' will be deleted in what follows, so we need to
-            // decide what to continue with afterwards. There are a number of cases to consider:
-            // - std::next(it) is end() or belongs to a different peer. In that case, this is the last iteration
-            //   of the loop (denote this by setting it_next to end()).
-            // - 'it' is not the only non-COMPLETED announcement for its txhash. This means it will be deleted, but
-            //   no other Announcement objects will be modified. Continue with std::next(it) if it belongs to the
-            //   same peer, but decide this ahead of time (as 'it' may change position in what follows).
-            // - 'it' is the only non-COMPLETED announcement for its txhash. This means it will be deleted along
-            //   with all other announcements for the same txhash - which may include std::next(it). However, other
-            //   than 'it', no announcements for the same peer can be affected (due to (peer, txhash) uniqueness).
-            //   In other words, the situation where std::next(it) is deleted can only occur if std::next(it)
-            //   belongs to a different peer but the same txhash as 'it'. This is covered by the first bulletpoint
-            //   already, and we'll have set it_next to end().
-            auto it_next = (std::next(it) == index.end() || std::next(it)->m_peer != peer) ? index.end() :
-                std::next(it);
+        auto peerit = m_peers.find(peer);
+        if (peerit == m_peers.end()) return;
+        // Completing one announcement of this peer can only delete announcements of the same txhash, which belong
+        // to other peers due to (peer, txhash) uniqueness. Thus all of the copied indexes remain valid until they
+        // are processed themselves.
+        const std::vector<AnnIdx> anns{peerit->second.m_announcements};
+        for (AnnIdx idx : anns) {
             // If the announcement isn't already COMPLETED, first make it COMPLETED (which will mark other
             // CANDIDATEs as CANDIDATE_BEST, or delete all of a txhash's announcements if no non-COMPLETED ones are
             // left).
-            if (MakeCompleted(m_index.project<ByTxHash>(it))) {
+            if (MakeCompleted(idx)) {
                 // Then actually delete the announcement (unless it was already deleted by MakeCompleted).
-                Erase<ByPeer>(it);
+                Erase(idx);
             }
-            it = it_next;
         }
+        MaybeCompact();
     }
 
     void ForgetTxHash(const uint256& txhash)
     {
-        auto it = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_DELAYED, 0});
-        while (it != m_index.get<ByTxHash>().end() && it->m_gtxid.ToUint256() == txhash) {
-            it = Erase<ByTxHash>(it);
-        }
+        EraseTxHash(txhash);
+        MaybeCompact();
     }
 
     void GetCandidatePeers(const uint256& txhash, std::vector<NodeId>& result_peers) const
     {
-        auto it = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_DELAYED, 0});
-        while (it != m_index.get<ByTxHash>().end() && it->m_gtxid.ToUint256() == txhash && it->GetState() != State::COMPLETED) {
-            result_peers.push_back(it->m_peer);
-            ++it;
+        auto it = m_by_txhash.find(txhash);
+        if (it == m_by_txhash.end()) return;
+        std::vector<const Announcement*> candidates;
+        for (AnnIdx idx : it->second) {
+            if (m_announcements[idx].GetState() != State::COMPLETED) candidates.push_back(&m_announcements[idx]);
         }
+        // Sort by state, then by priority for CANDIDATE_READY ones, then by announcement order.
+        std::sort(candidates.begin(), candidates.end(), [](const Announcement* a, const Announcement* b) {
+            const Priority prio_a{a->GetState() == State::CANDIDATE_READY ? a->m_priority : 0};
+            const Priority prio_b{b->GetState() == State::CANDIDATE_READY ? b->m_priority : 0};
+            return std::tuple{a->GetState(), prio_a, a->m_sequence} < std::tuple{b->GetState(), prio_b, b->m_sequence};
+        });
+        for (const Announcement* ann : candidates) result_peers.push_back(ann->m_peer);
     }
 
     void ReceivedInv(NodeId peer, const GenTxid& gtxid, bool preferred,
                      std::chrono::microseconds reqtime)
     {
-        // Bail out if we already have a CANDIDATE_BEST announcement for this (txhash, peer) combination. The case
-        // where there is a non-CANDIDATE_BEST announcement already will be caught by the uniqueness property of the
-        // ByPeer index when we try to emplace the new object below.
-        if (m_index.get<ByPeer>().count(ByPeerView{peer, true, gtxid.ToUint256()})) return;
-
-        // Try creating the announcement with CANDIDATE_DELAYED state (which will fail due to the uniqueness
-        // of the ByPeer index if a non-CANDIDATE_BEST announcement already exists with the same txhash and peer).
-        // Bail out in that case.
-        auto ret = m_index.get<ByPeer>().emplace(gtxid, peer, preferred, reqtime, m_current_sequence);
-        if (!ret.second) return;
+        // Bail out if we already have an announcement for this (txhash, peer) combination.
+        const auto [it, inserted] = m_by_peer_txhash.try_emplace(PeerTxHash{peer, gtxid.ToUint256()});
+        if (!inserted) return;
+
+        AnnIdx idx;
+        if (m_free.empty()) {
+            idx = m_announcements.size();
+            m_announcements.emplace_back(gtxid, peer, preferred, reqtime, m_current_sequence);
+        } else {
+            idx = m_free.back();
+            m_free.pop_back();
+            // Keep the version increasing across reuse of the slot, so stale time queue entries stay stale.
+            const uint32_t version{m_announcements[idx].m_version};
+            m_announcements[idx] = Announcement(gtxid, peer, preferred, reqtime, m_current_sequence);
+            m_announcements[idx].m_version = version + 1;
+        }
+        Announcement& ann{m_announcements[idx]};
+        ann.m_priority = m_computer(ann);
+        it->second = idx;
+        m_by_txhash[gtxid.ToUint256()].push_back(idx);
 
         // Update accounting metadata.
-        ++m_peerinfo[peer].m_total;
+        PeerData& data{m_peers[peer]};
+        ++data.m_info.m_total;
+        ann.m_peer_pos = data.m_announcements.size();
+        data.m_announcements.push_back(idx);
         ++m_current_sequence;
+
+        PushTimeEntry(idx);
     }
 
     //! Find the GenTxids to request now from peer.
@@ -599,14 +725,14 @@ public:
     {
         // Move time.
         SetTimePoint(now, expired);
+        MaybeCompact();
 
         // Find all CANDIDATE_BEST announcements for this peer.
         std::vector<const Announcement*> selected;
-        auto it_peer = m_index.get<ByPeer>().lower_bound(ByPeerView{peer, true, uint256::ZERO});
-        while (it_peer != m_index.get<ByPeer>().end() && it_peer->m_peer == peer &&
-            it_peer->GetState() == State::CANDIDATE_BEST) {
-            selected.emplace_back(&*it_peer);
-            ++it_peer;
+        auto peerit = m_peers.find(peer);
+        if (peerit != m_peers.end()) {
+            selected.reserve(peerit->second.m_best.size());
+            for (AnnIdx idx : peerit->second.m_best) selected.push_back(&m_announcements[idx]);
         }
 
         // Sort by sequence number.
@@ -625,18 +751,20 @@ public:
 
     void RequestedTx(NodeId peer, const uint256& txhash, std::chrono::microseconds expiry)
     {
-        auto it = m_index.get<ByPeer>().find(ByPeerView{peer, true, txhash});
-        if (it == m_index.get<ByPeer>().end()) {
+        auto it = m_by_peer_txhash.find(PeerTxHash{peer, txhash});
+        if (it == m_by_peer_txhash.end()) {
+            // This txhash wasn't tracked for this peer at all (and the caller should have called ReceivedInv).
+            return;
+        }
+        const AnnIdx idx{it->second};
+        const State state{m_announcements[idx].GetState()};
+        if (state != State::CANDIDATE_BEST) {
             // There is no CANDIDATE_BEST announcement, look for a _READY or _DELAYED instead. If the caller only
             // ever invokes RequestedTx with the values returned by GetRequestable, and no other non-const functions
             // other than ForgetTxHash and GetRequestable in between, this branch will never execute (as txhashes
             // returned by GetRequestable always correspond to CANDIDATE_BEST announcements).
-
-            it = m_index.get<ByPeer>().find(ByPeerView{peer, false, txhash});
-            if (it == m_index.get<ByPeer>().end() || (it->GetState() != State::CANDIDATE_DELAYED &&
-                                                      it->GetState() != State::CANDIDATE_READY)) {
-                // There is no CANDIDATE announcement tracked for this peer, so we have nothing to do. Either this
-                // txhash wasn't tracked at all (and the caller should have called ReceivedInv), or it was already
+            if (state != State::CANDIDATE_DELAYED && state != State::CANDIDATE_READY) {
+                // There is no CANDIDATE announcement tracked for this peer, so we have nothing to do. It was already
                 // requested and/or completed for other reasons and this is just a superfluous RequestedTx call.
                 return;
             }
@@ -644,63 +772,56 @@ public:
             // Look for an existing CANDIDATE_BEST or REQUESTED with the same txhash. We only need to do this if the
             // found announcement had a different state than CANDIDATE_BEST. If it did, invariants guarantee that no
             // other CANDIDATE_BEST or REQUESTED can exist.
-            auto it_old = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_BEST, 0});
-            if (it_old != m_index.get<ByTxHash>().end() && it_old->m_gtxid.ToUint256() == txhash) {
-                if (it_old->GetState() == State::CANDIDATE_BEST) {
+            if (const auto old{FindSelected(m_by_txhash.find(txhash)->second)}) {
+                if (m_announcements[*old].GetState() == State::CANDIDATE_BEST) {
                     // The data structure's invariants require that there can be at most one CANDIDATE_BEST or one
                     // REQUESTED announcement per txhash (but not both simultaneously), so we have to convert any
                     // existing CANDIDATE_BEST to another CANDIDATE_* when constructing another REQUESTED.
                     // It doesn't matter whether we pick CANDIDATE_READY or _DELAYED here, as SetTimePoint()
                     // will correct it at GetRequestable() time. If time only goes forward, it will always be
                     // _READY, so pick that to avoid extra work in SetTimePoint().
-                    Modify<ByTxHash>(it_old, [](Announcement& ann) { ann.SetState(State::CANDIDATE_READY); });
-                } else if (it_old->GetState() == State::REQUESTED) {
+                    SetState(*old, State::CANDIDATE_READY);
+                } else {
                     // As we're no longer waiting for a response to the previous REQUESTED announcement, convert it
                     // to COMPLETED. This also helps guaranteeing progress.
-                    Modify<ByTxHash>(it_old, [](Announcement& ann) { ann.SetState(State::COMPLETED); });
+                    SetState(*old, State::COMPLETED);
                 }
             }
         }
 
-        Modify<ByPeer>(it, [expiry](Announcement& ann) {
-            ann.SetState(State::REQUESTED);
-            ann.m_time = expiry;
-        });
+        SetState(idx, State::REQUESTED, expiry);
     }
 
     void ReceivedResponse(NodeId peer, const uint256& txhash)
     {
-        // We need to search the ByPeer index for both (peer, false, txhash) and (peer, true, txhash).
-        auto it = m_index.get<ByPeer>().find(ByPeerView{peer, false, txhash});
-        if (it == m_index.get<ByPeer>().end()) {
-            it = m_index.get<ByPeer>().find(ByPeerView{peer, true, txhash});
-        }
-        if (it != m_index.get<ByPeer>().end()) MakeCompleted(m_index.project<ByTxHash>(it));
+        auto it = m_by_peer_txhash.find(PeerTxHash{peer, txhash});
+        if (it != m_by_peer_txhash.end()) MakeCompleted(it->second);
+        MaybeCompact();
     }
 
     size_t CountInFlight(NodeId peer) const
     {
-        auto it = m_peerinfo.find(peer);
-        if (it != m_peerinfo.end()) return it->second.m_requested;
+        auto it = m_peers.find(peer);
+        if (it != m_peers.end()) return it->second.m_info.m_requested;
         return 0;
     }
 
     size_t CountCandidates(NodeId peer) const
     {
-        auto it = m_peerinfo.find(peer);
-        if (it != m_peerinfo.end()) return it->second.m_total - it->second.m_requested - it->second.m_completed;
+        auto it = m_peers.find(peer);
+        if (it != m_peers.end()) return it->second.m_info.m_total - it->second.m_info.m_requested - it->second.m_info.m_completed;
         return 0;
     }
 
     size_t Count(NodeId peer) const
     {
-        auto it = m_peerinfo.find(peer);
-        if (it != m_peerinfo.end()) return it->second.m_total;
+        auto it = m_peers.find(peer);
+        if (it != m_peers.end()) return it->second.m_info.m_total;
         return 0;
     }
 
     //! Count how many announcements are being tracked in total across all peers and transactions.
-    size_t Size() const { return m_index.size(); }
+    size_t Size() const { return m_announcements.size() - m_free.size(); }
 
     uint64_t ComputePriority(const uint256& txhash, NodeId peer, bool preferred) const
     {
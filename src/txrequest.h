@@ -90,8 +90,9 @@
  * Complexity:
  * - Memory usage is proportional to the total number of tracked announcements (Size()) plus the number of
  *   peers with a nonzero number of tracked announcements.
- * - CPU usage is generally logarithmic in the total number of tracked announcements, plus the number of
- *   announcements affected by an operation (amortized O(1) per announcement).
+ * - CPU usage is generally constant per operation (hash table lookups), plus the number of announcements for the
+ *   affected txhash (bounded by the number of peers), plus logarithmic in the total number of tracked announcements
+ *   for operations that change an announcement's timing (amortized O(1) per announcement).
  *
  * Context:
  * - In an earlier version of the transaction request logic it was possible for a peer to prevent us from seeing a
@@ -5,13 +5,19 @@
 #include <univalue.h>
 #include <univalue_utffilter.h>
 
+#include <bit>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /*
  * According to stackexchange, the original json test suite wanted
  * to limit depth to 22.  Widely-deployed PHP bails at depth 512,
@@ -25,6 +31,79 @@ static bool json_isdigit(int ch)
     return ((ch >= '0') && (ch <= '9'));
 }
 
+/*
+ * Large documents are mostly long strings, like the hex of transactions and
+ * PSBTs, and the indentation of pretty-printed output. The scans below find
+ * the end of such runs 16 bytes at a time with SSE2, or 8 bytes at a time
+ * otherwise, instead of going through the tokenizer byte by byte.
+ */
+
+static constexpr uint64_t BYTES_01{0x0101010101010101};
+static constexpr uint64_t BYTES_80{0x8080808080808080};
+
+// nonzero if any byte of x is zero
+static inline uint64_t swar_haszero(uint64_t x)
+{
+    return (x - BYTES_01) & ~x & BYTES_80;
+}
+
+// return the first char in [raw, end) that is not plain string content:
+// a quote, a backslash, a control char or a non-ASCII byte
+static const char* find_string_special(const char* raw, const char* end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    // as signed bytes, both control chars and non-ASCII bytes are below 0x20
+    const __m128i space = _mm_set1_epi8(0x20);
+    for (; end - raw >= 16; raw += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw));
+        const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                             _mm_cmplt_epi8(chunk, space));
+        const unsigned mask = _mm_movemask_epi8(special);
+        if (mask) return raw + std::countr_zero(mask);
+    }
+#else
+    for (; end - raw >= 8; raw += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, raw, 8);
+        const uint64_t special = swar_haszero(chunk ^ (BYTES_01 * '"')) | swar_haszero(chunk ^ (BYTES_01 * '\\')) |
+                                 swar_haszero(chunk & (BYTES_01 * 0xe0)) | (chunk & BYTES_80);
+        if (special) break;
+    }
+#endif
+    while (raw < end && *raw != '"' && *raw != '\\' && (unsigned char)*raw >= 0x20 && (unsigned char)*raw < 0x80)
+        raw++;
+    return raw;
+}
+
+// return the first char in [raw, end) that is not whitespace
+static const char* skip_whitespace(const char* raw, const char* end)
+{
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (; end - raw >= 16; raw += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw));
+        const __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, newline)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(chunk, tab), _mm_cmpeq_epi8(chunk, cr)));
+        const unsigned mask = ~_mm_movemask_epi8(ws) & 0xffff;
+        if (mask) return raw + std::countr_zero(mask);
+    }
+#else
+    for (; end - raw >= 8; raw += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, raw, 8);
+        if (chunk != BYTES_01 * ' ') break;
+    }
+#endif
+    while (raw < end && json_isspace(*raw))
+        raw++;
+    return raw;
+}
+
 // convert hexadecimal string to unsigned integer
 static const char *hatoui(const char *first, const char *last,
                           unsigned int& out)
@@ -60,8 +139,7 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
 
     const char *rawStart = raw;
 
-    while (raw < end && (json_isspace(*raw)))          // skip whitespace
-        raw++;
+    raw = skip_whitespace(raw, end);
 
     if (raw >= end)
         return JTOK_NONE;
@@ -124,8 +202,6 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
     case '8':
     case '9': {
         // part 1: int
-        std::string numStr;
-
         const char *first = raw;
 
         const char *firstDigit = first;
@@ -134,49 +210,38 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
         if ((*firstDigit == '0') && json_isdigit(firstDigit[1]))
             return JTOK_ERR;
 
-        numStr += *raw;                       // copy first char
-        raw++;
+        raw++;                                // skip first char
 
         if ((*first == '-') && (raw < end) && (!json_isdigit(*raw)))
             return JTOK_ERR;
 
-        while (raw < end && json_isdigit(*raw)) {  // copy digits
-            numStr += *raw;
+        while (raw < end && json_isdigit(*raw))  // skip digits
             raw++;
-        }
 
         // part 2: frac
         if (raw < end && *raw == '.') {
-            numStr += *raw;                   // copy .
-            raw++;
+            raw++;                            // skip .
 
             if (raw >= end || !json_isdigit(*raw))
                 return JTOK_ERR;
-            while (raw < end && json_isdigit(*raw)) { // copy digits
-                numStr += *raw;
+            while (raw < end && json_isdigit(*raw)) // skip digits
                 raw++;
-            }
         }
 
         // part 3: exp
         if (raw < end && (*raw == 'e' || *raw == 'E')) {
-            numStr += *raw;                   // copy E
-            raw++;
+            raw++;                            // skip E
 
-            if (raw < end && (*raw == '-' || *raw == '+')) { // copy +/-
-                numStr += *raw;
+            if (raw < end && (*raw == '-' || *raw == '+')) // skip +/-
                 raw++;
-            }
 
             if (raw >= end || !json_isdigit(*raw))
                 return JTOK_ERR;
-            while (raw < end && json_isdigit(*raw)) { // copy digits
-                numStr += *raw;
+            while (raw < end && json_isdigit(*raw)) // skip digits
                 raw++;
-            }
         }
 
-        tokenVal = numStr;
+        tokenVal.assign(first, raw);
         consumed = (raw - rawStart);
         return JTOK_NUMBER;
         }
@@ -184,10 +249,13 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
     case '"': {
         raw++;                                // skip "
 
-        std::string valStr;
-        JSONUTF8StringFilter writer(valStr);
+        JSONUTF8StringFilter writer(tokenVal);
 
         while (true) {
+            const char* run_end = find_string_special(raw, end);
+            writer.push_back_ascii(raw, run_end);
+            raw = run_end;
+
             if (raw >= end || (unsigned char)*raw < 0x20)
                 return JTOK_ERR;
 
@@ -238,7 +306,6 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
 
         if (!writer.finalize())
             return JTOK_ERR;
-        tokenVal = valStr;
         consumed = (raw - rawStart);
         return JTOK_STRING;
         }
@@ -328,9 +395,8 @@ bool UniValue::read(std::string_view str_in)
                     setArray();
                 stack.push_back(this);
             } else {
-                UniValue tmpVal(utyp);
                 UniValue *top = stack.back();
-                top->values.push_back(tmpVal);
+                top->values.emplace_back(utyp);
 
                 UniValue *newTop = &(top->values.back());
                 stack.push_back(newTop);
@@ -417,14 +483,14 @@ bool UniValue::read(std::string_view str_in)
             }
 
         case JTOK_NUMBER: {
-            UniValue tmpVal(VNUM, tokenVal);
+            UniValue tmpVal(VNUM, std::move(tokenVal));
             if (!stack.size()) {
-                *this = tmpVal;
+                *this = std::move(tmpVal);
                 break;
             }
 
             UniValue *top = stack.back();
-            top->values.push_back(tmpVal);
+            top->values.push_back(std::move(tmpVal));
 
             setExpect(NOT_VALUE);
             break;
@@ -433,17 +499,17 @@ bool UniValue::read(std::string_view str_in)
         case JTOK_STRING: {
             if (expect(OBJ_NAME)) {
                 UniValue *top = stack.back();
-                top->keys.push_back(tokenVal);
+                top->keys.push_back(std::move(tokenVal));
                 clearExpect(OBJ_NAME);
                 setExpect(COLON);
             } else {
-                UniValue tmpVal(VSTR, tokenVal);
+                UniValue tmpVal(VSTR, std::move(tokenVal));
                 if (!stack.size()) {
-                    *this = tmpVal;
+                    *this = std::move(tmpVal);
                     break;
                 }
                 UniValue *top = stack.back();
-                top->values.push_back(tmpVal);
+                top->values.push_back(std::move(tmpVal));
             }
 
             setExpect(NOT_VALUE);
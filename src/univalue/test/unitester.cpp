@@ -185,6 +185,34 @@ void no_nul_test()
     assert(val.read({buf + 3, 7}));
 }
 
+// Test strings with special chars at every position of the chunks they are scanned in
+void long_string_test()
+{
+    const std::string plain(40, 'a');
+    for (size_t pos = 0; pos < plain.size(); ++pos) {
+        for (size_t len = pos + 1; len <= plain.size(); len += 7) {
+            const std::string head = plain.substr(0, pos);
+            const std::string tail = plain.substr(pos, len - pos);
+            UniValue val;
+            // escapes
+            assert(val.read("\"" + head + "\\n" + tail + "\""));
+            assert(val.get_str() == head + "\n" + tail);
+            // UTF-8
+            assert(val.read("\"" + head + "\xc6\x91" + tail + "\""));
+            assert(val.get_str() == head + "\xc6\x91" + tail);
+            // broken UTF-8
+            assert(!val.read("\"" + head + "\xc6" + tail + "\""));
+            // control chars
+            assert(!val.read("\"" + head + "\x1f" + tail + "\""));
+            // unterminated
+            assert(!val.read("\"" + head + tail));
+            // indentation
+            assert(val.read(std::string(pos, ' ') + "[\n" + std::string(len, ' ') + "1\t]" + std::string(len, '\n')));
+            assert(val[0].getInt<int>() == 1);
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
     for (const auto& [file, json] : tests) {
@@ -193,6 +221,7 @@ int main(int argc, char* argv[])
 
     unescape_unicode_test();
     no_nul_test();
+    long_string_test();
 
     return 0;
 }
@@ -19,6 +19,13 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <array>
+#endif
+
 static inline bool IOErrorIsPermanent(int err)
 {
     return err != WSAEAGAIN && err != WSAEINTR && err != WSAEWOULDBLOCK && err != WSAEINPROGRESS;
@@ -419,6 +426,124 @@ bool Sock::operator==(SOCKET s) const
     return m_socket == s;
 };
 
+SockPoller::SockPoller(bool use_epoll)
+{
+#ifdef USE_EPOLL
+    if (use_epoll) {
+        m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (m_epoll_fd == -1) {
+            LogPrintf("Unable to create epoll instance, falling back to poll: %s\n", NetworkErrorString(WSAGetLastError()));
+        }
+    }
+#endif
+}
+
+SockPoller::~SockPoller()
+{
+    DisableEpoll();
+}
+
+void SockPoller::DisableEpoll()
+{
+#ifdef USE_EPOLL
+    if (m_epoll_fd != -1) {
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+#endif
+}
+
+void SockPoller::Watch(const std::shared_ptr<const Sock>& sock, Sock::Event requested, bool edge_triggered)
+{
+    const auto [it, inserted]{m_entries.try_emplace(sock->m_socket)};
+    Entry& entry{it->second};
+    if (inserted) {
+        entry.sock = sock;
+        entry.edge_triggered = edge_triggered;
+#ifdef USE_EPOLL
+        if (m_epoll_fd != -1) {
+            // Edge-triggered registrations are for both directions for as long as the socket is
+            // watched, what the caller currently wants only filters what Wait() reports.
+            epoll_event ev{};
+            ev.events = edge_triggered ? (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET) : EPOLLIN;
+            ev.data.fd = sock->m_socket;
+            if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, sock->m_socket, &ev) == -1) {
+                LogPrintf("Unable to add socket %d to epoll instance, falling back to poll: %s\n",
+                          sock->m_socket, NetworkErrorString(WSAGetLastError()));
+                DisableEpoll();
+            }
+        }
+#endif
+    }
+    entry.requested = requested;
+    entry.watched = true;
+}
+
+bool SockPoller::Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock)
+{
+    events_per_sock.clear();
+
+    bool known_ready{false};
+    for (auto it{m_entries.begin()}; it != m_entries.end();) {
+        Entry& entry{it->second};
+        if (!entry.watched) {
+#ifdef USE_EPOLL
+            // The socket is still open because entry.sock owns it, so this can't hit another
+            // socket that reuses the file descriptor.
+            if (m_epoll_fd != -1) epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, it->first, nullptr);
+#endif
+            it = m_entries.erase(it);
+            continue;
+        }
+        entry.watched = false;
+        if (!entry.edge_triggered) entry.ready = 0;
+        if (entry.requested != 0 && (entry.ready & (entry.requested | Sock::ERR))) known_ready = true;
+        ++it;
+    }
+
+    if (m_epoll_fd == -1) {
+        for (const auto& [_, entry] : m_entries) {
+            if (entry.requested != 0) events_per_sock.emplace(entry.sock, Sock::Events{entry.requested});
+        }
+        return !events_per_sock.empty() && events_per_sock.begin()->first->WaitMany(timeout, events_per_sock);
+    }
+
+#ifdef USE_EPOLL
+    if (m_entries.empty()) return false;
+
+    std::array<epoll_event, 256> events;
+    const int num_events{epoll_wait(m_epoll_fd, events.data(), events.size(), known_ready ? 0 : count_milliseconds(timeout))};
+    if (num_events == -1) {
+        return false;
+    }
+    // Events that did not fit are reported by the next epoll_wait(2).
+    for (int i{0}; i < num_events; ++i) {
+        const auto it{m_entries.find(events[i].data.fd)};
+        if (it == m_entries.end()) continue;
+        Entry& entry{it->second};
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP)) entry.ready |= Sock::RECV;
+        if (events[i].events & EPOLLOUT) entry.ready |= Sock::SEND;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) entry.ready |= Sock::ERR;
+    }
+
+    for (const auto& [_, entry] : m_entries) {
+        const Sock::Event occurred = entry.ready & (entry.requested | Sock::ERR);
+        if (entry.requested != 0 && occurred != 0) {
+            events_per_sock.emplace(entry.sock, Sock::Events{entry.requested}).first->second.occurred = occurred;
+        }
+    }
+#endif
+    return true;
+}
+
+void SockPoller::Consumed(const std::shared_ptr<const Sock>& sock, Sock::Event event)
+{
+    const auto it{m_entries.find(sock->m_socket)};
+    if (it != m_entries.end() && it->second.edge_triggered) {
+        it->second.ready &= ~event;
+    }
+}
+
 std::string NetworkErrorString(int err)
 {
 #if defined(WIN32)
@@ -269,6 +269,8 @@ public:
     bool operator==(SOCKET s) const;
 
 protected:
+    friend class SockPoller;
+
     /**
      * Contained socket. `INVALID_SOCKET` designates the object is empty.
      */
@@ -281,6 +283,78 @@ private:
     void Close();
 };
 
+/**
+ * Wait for IO readiness on a set of sockets that changes little between waits,
+ * like the connections serviced by a socket handler thread.
+ *
+ * If `use_epoll` is set and epoll(7) is available, sockets are registered with
+ * the kernel once, edge-triggered, and a wait only costs in proportion to the
+ * sockets whose state changed, not to all registered ones. The readiness
+ * reported by the kernel is remembered until `Consumed()` says that an
+ * operation on the socket would block. Otherwise every `Wait()` is a
+ * `Sock::WaitMany()` on all watched sockets, which also works for the mocked
+ * sockets used in tests.
+ *
+ * Not thread safe, each thread should use its own instance.
+ */
+class SockPoller
+{
+public:
+    explicit SockPoller(bool use_epoll);
+    ~SockPoller();
+
+    SockPoller(const SockPoller&) = delete;
+    SockPoller& operator=(const SockPoller&) = delete;
+
+    /**
+     * Wait for `requested` events on `sock` in the next `Wait()`. Sockets that have not been
+     * passed to this since the previous `Wait()` are forgotten by the next one.
+     * @param[in] sock Socket to watch. Kept alive for as long as it is watched.
+     * @param[in] requested Bitwise-or of `Sock::RECV` and `Sock::SEND`, may be 0.
+     * @param[in] edge_triggered Whether readiness is remembered until `Consumed()`. Use false
+     * when the caller can't tell that an operation would block, e.g. for listening sockets.
+     */
+    void Watch(const std::shared_ptr<const Sock>& sock, Sock::Event requested, bool edge_triggered = true);
+
+    /**
+     * Wait for readiness of the watched sockets.
+     * @param[in] timeout Wait at most this long, don't wait if some socket is known to be ready.
+     * @param[out] events_per_sock Watched sockets and the requested events that occurred
+     * (`Sock::ERR` is added if an exceptional condition occurred).
+     * @return true on success (or timeout), false if there is nothing to wait for or waiting failed
+     */
+    [[nodiscard]] bool Wait(std::chrono::milliseconds timeout, Sock::EventsPerSock& events_per_sock);
+
+    /**
+     * Report that `event` is no longer possible on `sock` without blocking, because recv(2)
+     * drained the receive buffer or send(2) filled up the send buffer. It will be reported
+     * by `Wait()` again once the kernel signals that this changed.
+     */
+    void Consumed(const std::shared_ptr<const Sock>& sock, Sock::Event event);
+
+    /** Whether the epoll(7) backend is in use. */
+    bool UsesEpoll() const { return m_epoll_fd != -1; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Sock> sock;
+        Sock::Event requested{0};
+        /** Events known to be possible, only maintained for epoll registrations. */
+        Sock::Event ready{0};
+        bool edge_triggered{true};
+        /** Whether Watch() was called since the last Wait(). */
+        bool watched{false};
+    };
+
+    /** Switch to Sock::WaitMany() for good, e.g. if a socket can't be registered. */
+    void DisableEpoll();
+
+    std::unordered_map<SOCKET, Entry> m_entries;
+
+    /** The epoll(7) instance, or -1 if not in use. */
+    int m_epoll_fd{-1};
+};
+
 /** Return readable error string for a network error code */
 std::string NetworkErrorString(int err);
 
@@ -17,6 +17,7 @@
 #include <consensus/tx_check.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/muhash.h>
 #include <cuckoocache.h>
 #include <flatfile.h>
 #include <hash.h>
@@ -59,6 +60,7 @@
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/threadnames.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <util/translation.h>
@@ -67,14 +69,18 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 using kernel::CCoinsStats;
 using kernel::CoinStatsHashType;
@@ -5833,6 +5839,292 @@ static void FlushSnapshotToDisk(CCoinsViewCache& coins_cache, bool snapshot_load
     coins_cache.Flush();
 }
 
+namespace {
+//! Coins of a snapshot, in file order
+using SnapshotCoins = std::vector<std::pair<COutPoint, Coin>>;
+
+//! Number of coins handed from one stage of snapshot loading to the next at once
+constexpr size_t SNAPSHOT_BATCH_COINS{1 << 16};
+
+/** A bounded queue of coin batches between two stages of snapshot loading */
+class SnapshotCoinsQueue
+{
+public:
+    using Batch = std::shared_ptr<const SnapshotCoins>;
+
+    //! Add a batch, waiting while the queue is full. Returns false if the queue was closed.
+    bool Push(Batch batch) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_closed || m_batches.size() < MAX_BATCHES; });
+            if (m_closed) return false;
+            m_batches.push_back(std::move(batch));
+        }
+        m_cv.notify_all();
+        return true;
+    }
+
+    //! Take the next batch, waiting for one. Returns nullptr once the queue is closed and empty.
+    Batch Pop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        Batch batch;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_closed || !m_batches.empty(); });
+            if (m_batches.empty()) return nullptr;
+            batch = std::move(m_batches.front());
+            m_batches.pop_front();
+        }
+        m_cv.notify_all();
+        return batch;
+    }
+
+    //! Stop accepting batches. Those already queued can still be taken.
+    void Close() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_closed = true);
+        m_cv.notify_all();
+    }
+
+private:
+    static constexpr size_t MAX_BATCHES{4};
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Batch> m_batches GUARDED_BY(m_mutex);
+    bool m_closed GUARDED_BY(m_mutex){false};
+};
+
+/**
+ * Read and check coins_count coins in the serialization of snapshot coins,
+ * passing each to fn, which returns false to stop reading. coins_before is the
+ * number of coins before them in the snapshot, for error messages. Returns an
+ * error message if the coins are bad.
+ */
+template <typename Stream, typename Fn>
+std::optional<std::string> ReadSnapshotCoins(Stream& s, uint64_t coins_count, uint64_t coins_before, int base_height, Fn&& fn)
+{
+    uint64_t coins_left = coins_count;
+    int64_t coins_processed{0};
+
+    while (coins_left > 0) {
+        try {
+            Txid txid;
+            s >> txid;
+            size_t coins_per_txid{0};
+            coins_per_txid = ReadCompactSize(s);
+
+            if (coins_per_txid > coins_left) {
+                return "Mismatch in coins count in snapshot metadata and actual snapshot data";
+            }
+
+            for (size_t i = 0; i < coins_per_txid; i++) {
+                COutPoint outpoint;
+                Coin coin;
+                outpoint.n = static_cast<uint32_t>(ReadCompactSize(s));
+                outpoint.hash = txid;
+                s >> coin;
+                if (coin.nHeight > base_height ||
+                    outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
+                ) {
+                    return strprintf("Bad snapshot data after deserializing %d coins",
+                                     coins_before + coins_count - coins_left);
+                }
+                if (!MoneyRange(coin.out.nValue)) {
+                    return strprintf("Bad snapshot data after deserializing %d coins - bad tx out value",
+                                     coins_before + coins_count - coins_left);
+                }
+
+                --coins_left;
+                ++coins_processed;
+
+                if (!fn(std::move(outpoint), std::move(coin))) return std::nullopt;
+            }
+        } catch (const std::ios_base::failure&) {
+            return strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins",
+                             coins_before + coins_processed);
+        }
+    }
+    return std::nullopt;
+}
+
+//! Read the coins of a snapshot with its coins in a single stream, handing them on in batches.
+std::optional<std::string> ReadSnapshotStream(AutoFile& coins_file, uint64_t coins_count, int base_height, SnapshotCoinsQueue& out)
+{
+    auto batch{std::make_shared<SnapshotCoins>()};
+    batch->reserve(SNAPSHOT_BATCH_COINS);
+    bool closed{false};
+    const auto error{ReadSnapshotCoins(coins_file, coins_count, /*coins_before=*/0, base_height, [&](COutPoint&& outpoint, Coin&& coin) {
+        batch->emplace_back(std::move(outpoint), std::move(coin));
+        if (batch->size() == SNAPSHOT_BATCH_COINS) {
+            if (!out.Push(std::move(batch))) {
+                closed = true;
+                return false;
+            }
+            batch = std::make_shared<SnapshotCoins>();
+            batch->reserve(SNAPSHOT_BATCH_COINS);
+        }
+        return true;
+    })};
+    if (error || closed) return error;
+
+    bool out_of_coins{false};
+    try {
+        std::byte left_over_byte;
+        coins_file >> left_over_byte;
+    } catch (const std::ios_base::failure&) {
+        // We expect an exception since we should be out of coins.
+        out_of_coins = true;
+    }
+    if (!out_of_coins) {
+        return strprintf("Bad snapshot - coins left over after deserializing %d coins",
+                         coins_count);
+    }
+
+    if (!batch->empty()) out.Push(std::move(batch));
+    return std::nullopt;
+}
+
+//! Maximum number of threads that decode the chunks of a chunked snapshot
+constexpr size_t MAX_SNAPSHOT_CHUNK_THREADS{16};
+
+//! Read and check the directory of a chunked snapshot, leaving the file at the first chunk.
+std::optional<std::string> ReadSnapshotDirectory(AutoFile& coins_file, uint64_t coins_count, std::vector<node::SnapshotChunkInfo>& directory)
+{
+    try {
+        const int64_t chunks_begin{coins_file.tell()};
+        coins_file.seek(-int64_t{sizeof(uint64_t)}, SEEK_END);
+        const int64_t directory_end{coins_file.tell()};
+        uint64_t directory_offset;
+        coins_file >> directory_offset;
+        if (directory_offset < uint64_t(chunks_begin) || directory_offset > uint64_t(directory_end)) {
+            return "Bad snapshot - chunk directory out of bounds";
+        }
+        coins_file.seek(directory_offset, SEEK_SET);
+        coins_file >> directory;
+        if (coins_file.tell() != directory_end) {
+            return "Bad snapshot - data left over after the chunk directory";
+        }
+
+        uint64_t chunks_size{0}, chunks_coins{0};
+        for (size_t i{0}; i < directory.size(); ++i) {
+            const auto& info{directory[i]};
+            if (info.m_coins_count == 0 || info.m_coins_count > node::SNAPSHOT_CHUNK_MAX_COINS || info.m_size > node::SNAPSHOT_CHUNK_MAX_SIZE) {
+                return strprintf("Bad snapshot - chunk %d exceeds the chunk limits", i);
+            }
+            chunks_size += info.m_size;
+            chunks_coins += info.m_coins_count;
+        }
+        if (chunks_coins != coins_count) {
+            return "Mismatch in coins count in snapshot metadata and actual snapshot data";
+        }
+        if (chunks_size != directory_offset - chunks_begin) {
+            return "Bad snapshot - chunk sizes do not match the chunk directory offset";
+        }
+        coins_file.seek(chunks_begin, SEEK_SET);
+    } catch (const std::ios_base::failure&) {
+        return "Bad snapshot format or truncated snapshot - unable to read the chunk directory";
+    }
+    return std::nullopt;
+}
+
+/**
+ * Read the coins of a chunked snapshot, handing them on in batches of a
+ * chunk. A round of chunks is read at a time, and the chunks of a round are
+ * decoded, checked and hashed on several threads. A chunk whose coins do not
+ * match the hash in the directory is reported before any coin of it is handed
+ * on.
+ */
+std::optional<std::string> ReadSnapshotChunks(AutoFile& coins_file, uint64_t coins_count, int base_height, SnapshotCoinsQueue& out)
+{
+    std::vector<node::SnapshotChunkInfo> directory;
+    if (auto error{ReadSnapshotDirectory(coins_file, coins_count, directory)}) return error;
+
+    const size_t threads{std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_SNAPSHOT_CHUNK_THREADS)};
+    uint64_t coins_before{0};
+    for (size_t first{0}; first < directory.size(); first += threads) {
+        const size_t count{std::min(threads, directory.size() - first)};
+        std::vector<std::vector<std::byte>> chunks(count);
+        std::vector<uint64_t> chunk_coins_before(count);
+        for (size_t i{0}; i < count; ++i) {
+            chunk_coins_before[i] = coins_before;
+            try {
+                chunks[i].resize(directory[first + i].m_size);
+                coins_file.read(chunks[i]);
+            } catch (const std::ios_base::failure&) {
+                return strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins",
+                                 coins_before);
+            }
+            coins_before += directory[first + i].m_coins_count;
+        }
+
+        std::vector<std::shared_ptr<SnapshotCoins>> batches(count);
+        std::vector<std::optional<std::string>> errors(count);
+        const auto decode{[&](size_t i) {
+            auto& info{directory[first + i]};
+            auto batch{std::make_shared<SnapshotCoins>()};
+            batch->reserve(info.m_coins_count);
+            SpanReader chunk{chunks[i]};
+            MuHash3072 muhash;
+            errors[i] = ReadSnapshotCoins(chunk, info.m_coins_count, chunk_coins_before[i], base_height, [&](COutPoint&& outpoint, Coin&& coin) {
+                kernel::ApplyCoinHash(muhash, outpoint, coin);
+                batch->emplace_back(std::move(outpoint), std::move(coin));
+                return true;
+            });
+            if (errors[i]) return;
+            if (!chunk.empty()) {
+                errors[i] = strprintf("Bad snapshot - data left over in chunk %d", first + i);
+                return;
+            }
+            uint256 hash, expected_hash;
+            muhash.Finalize(hash);
+            info.m_muhash.Finalize(expected_hash);
+            if (hash != expected_hash) {
+                errors[i] = strprintf("Bad snapshot chunk %d content hash: expected %s, got %s",
+                                      first + i, expected_hash.ToString(), hash.ToString());
+                return;
+            }
+            batches[i] = std::move(batch);
+        }};
+        // An exception must not escape a worker, or the others would not be
+        // joined.
+        const auto try_decode{[&](size_t i) {
+            try {
+                decode(i);
+            } catch (const std::exception& e) {
+                errors[i] = strprintf("Failed to decode snapshot chunk %d: %s", first + i, e.what());
+            }
+        }};
+        std::vector<std::thread> workers;
+        for (size_t i{1}; i < count; ++i) {
+            workers.emplace_back([&, i] {
+                util::ThreadRename(strprintf("snapshot.chunk.%i", i));
+                try_decode(i);
+            });
+        }
+        try_decode(0);
+        for (auto& worker : workers) worker.join();
+
+        for (size_t i{0}; i < count; ++i) {
+            if (errors[i]) return errors[i];
+            if (!out.Push(std::move(batches[i]))) return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+//! Whether coins continue the strictly increasing outpoint order of the coins before them, ending at prev.
+bool CoinsInOrder(const SnapshotCoins& coins, std::optional<COutPoint>& prev)
+{
+    for (const auto& [outpoint, coin] : coins) {
+        if (prev && !(*prev < outpoint)) return false;
+        prev = outpoint;
+    }
+    return true;
+}
+} // namespace
+
 struct StopHashingException : public std::exception
 {
     const char* what() const noexcept override
@@ -5884,78 +6176,80 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     }
 
     const uint64_t coins_count = metadata.m_coins_count;
-    uint64_t coins_left = metadata.m_coins_count;
 
-    LogInfo("[snapshot] loading %d coins from snapshot %s", coins_left, base_blockhash.ToString());
-    int64_t coins_processed{0};
+    LogInfo("[snapshot] loading %d coins from snapshot %s", coins_count, base_blockhash.ToString());
 
-    while (coins_left > 0) {
-        try {
-            Txid txid;
-            coins_file >> txid;
-            size_t coins_per_txid{0};
-            coins_per_txid = ReadCompactSize(coins_file);
+    // As above, okay to immediately release cs_main here since no other context knows
+    // about the snapshot_chainstate.
+    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
 
-            if (coins_per_txid > coins_left) {
-                return util::Error{Untranslated("Mismatch in coins count in snapshot metadata and actual snapshot data")};
+    // Load the coins in a pipeline: one thread reads and checks them, this
+    // thread writes them to the database in batches, bypassing the coins
+    // cache, and another thread hashes them. The coins of a snapshot are
+    // dumped in database order, which the content hash is computed in, so
+    // unless the file is in a different order, the hash is done when the last
+    // coin is written and does not need another pass over the database.
+    // Chunked snapshots are moreover decoded and checked on several threads.
+    SnapshotCoinsQueue read_queue, hash_queue;
+    std::optional<std::string> read_error;
+    bool in_order{true};
+    std::optional<COutPoint> last_outpoint;
+    HashWriter hasher{};
+    std::thread reader{[&] {
+        util::ThreadRename("snapshot.read");
+        // Report any exception as an error, as one escaping the thread would
+        // terminate the program.
+        try {
+            if (metadata.m_version == SnapshotMetadata::CHUNKED_VERSION) {
+                read_error = ReadSnapshotChunks(coins_file, coins_count, base_height, read_queue);
+            } else {
+                read_error = ReadSnapshotStream(coins_file, coins_count, base_height, read_queue);
             }
+        } catch (const std::exception& e) {
+            read_error = strprintf("Failed to read snapshot: %s", e.what());
+        }
+        read_queue.Close();
+    }};
+    std::thread hash_thread{[&] {
+        util::ThreadRename("snapshot.hash");
+        while (auto batch{hash_queue.Pop()}) {
+            for (const auto& [outpoint, coin] : *batch) kernel::ApplyCoinHash(hasher, outpoint, coin);
+        }
+    }};
+    const auto stop_pipeline{[&] {
+        read_queue.Close();
+        hash_queue.Close();
+        if (reader.joinable()) reader.join();
+        if (hash_thread.joinable()) hash_thread.join();
+    }};
 
-            for (size_t i = 0; i < coins_per_txid; i++) {
-                COutPoint outpoint;
-                Coin coin;
-                outpoint.n = static_cast<uint32_t>(ReadCompactSize(coins_file));
-                outpoint.hash = txid;
-                coins_file >> coin;
-                if (coin.nHeight > base_height ||
-                    outpoint.n >= std::numeric_limits<decltype(outpoint.n)>::max() // Avoid integer wrap-around in coinstats.cpp:ApplyHash
-                ) {
-                    return util::Error{Untranslated(strprintf("Bad snapshot data after deserializing %d coins",
-                              coins_count - coins_left))};
-                }
-                if (!MoneyRange(coin.out.nValue)) {
-                    return util::Error{Untranslated(strprintf("Bad snapshot data after deserializing %d coins - bad tx out value",
-                              coins_count - coins_left))};
-                }
-                coins_cache.EmplaceCoinInternalDANGER(std::move(outpoint), std::move(coin));
-
-                --coins_left;
-                ++coins_processed;
-
-                if (coins_processed % 1000000 == 0) {
-                    LogInfo("[snapshot] %d coins loaded (%.2f%%, %.2f MB)",
-                        coins_processed,
-                        static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count),
-                        coins_cache.DynamicMemoryUsage() / (1000 * 1000));
-                }
-
-                // Batch write and flush (if we need to) every so often.
-                //
-                // If our average Coin size is roughly 41 bytes, checking every 120,000 coins
-                // means <5MB of memory imprecision.
-                if (coins_processed % 120000 == 0) {
-                    if (m_interrupt) {
-                        return util::Error{Untranslated("Aborting after an interrupt was requested")};
-                    }
-
-                    const auto snapshot_cache_state = WITH_LOCK(::cs_main,
-                        return snapshot_chainstate.GetCoinsCacheSizeState());
-
-                    if (snapshot_cache_state >= CoinsCacheSizeState::CRITICAL) {
-                        // This is a hack - we don't know what the actual best block is, but that
-                        // doesn't matter for the purposes of flushing the cache here. We'll set this
-                        // to its correct value (`base_blockhash`) below after the coins are loaded.
-                        coins_cache.SetBestBlock(GetRandHash());
-
-                        // No need to acquire cs_main since this chainstate isn't being used yet.
-                        FlushSnapshotToDisk(coins_cache, /*snapshot_loaded=*/false);
-                    }
-                }
+    int64_t coins_processed{0};
+    try {
+        while (auto batch{read_queue.Pop()}) {
+            if (m_interrupt) {
+                stop_pipeline();
+                return util::Error{Untranslated("Aborting after an interrupt was requested")};
             }
-        } catch (const std::ios_base::failure&) {
-            return util::Error{Untranslated(strprintf("Bad snapshot format or truncated snapshot after deserializing %d coins",
-                      coins_processed))};
+            if (!snapshot_coinsdb->WriteCoins(*batch)) {
+                stop_pipeline();
+                return util::Error{Untranslated("Failed to write snapshot coins to the database")};
+            }
+            if (in_order) in_order = CoinsInOrder(*batch, last_outpoint);
+            const int64_t logged{coins_processed / 1000000};
+            coins_processed += batch->size();
+            if (coins_processed / 1000000 > logged) {
+                LogInfo("[snapshot] %d coins loaded (%.2f%%)",
+                    coins_processed,
+                    static_cast<float>(coins_processed) * 100 / static_cast<float>(coins_count));
+            }
+            hash_queue.Push(std::move(batch));
         }
+    } catch (...) {
+        stop_pipeline();
+        throw;
     }
+    stop_pipeline();
+    if (read_error) return util::Error{Untranslated(*read_error)};
 
     // Important that we set this. This and the coins_cache accesses above are
     // sort of a layer violation, but either we reach into the innards of
@@ -5964,22 +6258,8 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
     // method.
     coins_cache.SetBestBlock(base_blockhash);
 
-    bool out_of_coins{false};
-    try {
-        std::byte left_over_byte;
-        coins_file >> left_over_byte;
-    } catch (const std::ios_base::failure&) {
-        // We expect an exception since we should be out of coins.
-        out_of_coins = true;
-    }
-    if (!out_of_coins) {
-        return util::Error{Untranslated(strprintf("Bad snapshot - coins left over after deserializing %d coins",
-            coins_count))};
-    }
-
-    LogInfo("[snapshot] loaded %d (%.2f MB) coins from snapshot %s",
+    LogInfo("[snapshot] loaded %d coins from snapshot %s",
         coins_count,
-        coins_cache.DynamicMemoryUsage() / (1000 * 1000),
         base_blockhash.ToString());
 
     // No need to acquire cs_main since this chainstate isn't being used yet.
@@ -5987,26 +6267,28 @@ util::Result<void> ChainstateManager::PopulateAndValidateSnapshot(
 
     assert(coins_cache.GetBestBlock() == base_blockhash);
 
-    // As above, okay to immediately release cs_main here since no other context knows
-    // about the snapshot_chainstate.
-    CCoinsViewDB* snapshot_coinsdb = WITH_LOCK(::cs_main, return &snapshot_chainstate.CoinsDB());
-
-    std::optional<CCoinsStats> maybe_stats;
-
-    try {
-        maybe_stats = ComputeUTXOStats(
-            CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
-    } catch (StopHashingException const&) {
-        return util::Error{Untranslated("Aborting after an interrupt was requested")};
-    }
-    if (!maybe_stats.has_value()) {
-        return util::Error{Untranslated("Failed to generate coins stats")};
+    uint256 hash_serialized;
+    if (in_order) {
+        hash_serialized = hasher.GetHash();
+    } else {
+        LogInfo("[snapshot] coins are not in database order, hashing the loaded coins");
+        std::optional<CCoinsStats> maybe_stats;
+        try {
+            maybe_stats = ComputeUTXOStats(
+                CoinStatsHashType::HASH_SERIALIZED, snapshot_coinsdb, m_blockman, [&interrupt = m_interrupt] { SnapshotUTXOHashBreakpoint(interrupt); });
+        } catch (StopHashingException const&) {
+            return util::Error{Untranslated("Aborting after an interrupt was requested")};
+        }
+        if (!maybe_stats.has_value()) {
+            return util::Error{Untranslated("Failed to generate coins stats")};
+        }
+        hash_serialized = maybe_stats->hashSerialized;
     }
 
     // Assert that the deserialized chainstate contents match the expected assumeutxo value.
-    if (AssumeutxoHash{maybe_stats->hashSerialized} != au_data.hash_serialized) {
+    if (AssumeutxoHash{hash_serialized} != au_data.hash_serialized) {
         return util::Error{Untranslated(strprintf("Bad snapshot content hash: expected %s, got %s",
-            au_data.hash_serialized.ToString(), maybe_stats->hashSerialized.ToString()))};
+            au_data.hash_serialized.ToString(), hash_serialized.ToString()))};
     }
 
     snapshot_chainstate.m_chain.SetTip(*snapshot_start_block);
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the address index.
+
+Test that getaddresshistory and the /rest/addresshistory endpoint return the
+outputs paying to a script and the inputs spending them, and that the history
+follows reorgs.
+"""
+
+from decimal import Decimal
+import http.client
+import json
+import urllib.parse
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+from test_framework.wallet import (
+    MiniWallet,
+    getnewdestination,
+)
+
+
+class AddressIndexTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [
+            [],
+            ["-addressindex", "-rest"],
+        ]
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[1])
+        self._test_index_disabled()
+        self._test_history()
+        self._test_rest()
+        self._test_reorg()
+
+    def _test_index_disabled(self):
+        self.log.info("Test that getaddresshistory requires -addressindex")
+        assert_raises_rpc_error(-1, "Address index not enabled", self.nodes[0].getaddresshistory, self.wallet.get_address())
+
+    def _test_history(self):
+        node = self.nodes[1]
+        self.generate(self.wallet, 110)
+        self.sync_index_node()
+
+        self.log.info("Test the history of the outputs of the coinbase transactions")
+        res = node.getaddresshistory(self.wallet.get_address())
+        assert_equal(res["height"], 110)
+        assert_equal(len(res["history"]), 110)
+        assert_equal([e["height"] for e in res["history"]], list(range(1, 111)))
+        assert all(e["type"] == "funding" for e in res["history"])
+        assert_equal(res["history"][0]["amount"], Decimal("50"))
+
+        self.log.info("Test a range of heights")
+        res = node.getaddresshistory(self.wallet.get_address(), 10, 19)
+        assert_equal([e["height"] for e in res["history"]], list(range(10, 20)))
+        assert_raises_rpc_error(-8, "Invalid height range", node.getaddresshistory, self.wallet.get_address(), 20, 19)
+
+        self.log.info("Test pages of the history")
+        full = node.getaddresshistory(self.wallet.get_address())["history"]
+        pages = [node.getaddresshistory(self.wallet.get_address(), 0, 110, 25, skip)["history"] for skip in range(0, 110, 25)]
+        assert_equal([len(page) for page in pages], [25, 25, 25, 25, 10])
+        assert_equal(sum(pages, []), full)
+        assert_equal(node.getaddresshistory(self.wallet.get_address(), 0, None, 0)["history"], [])
+        assert_equal(len(node.getaddresshistory(address=self.wallet.get_address(), count=5)["history"]), 5)
+        assert_raises_rpc_error(-8, "Negative count", node.getaddresshistory, self.wallet.get_address(), 0, None, -1)
+        assert_raises_rpc_error(-8, "Negative skip", node.getaddresshistory, self.wallet.get_address(), 0, None, 1, -1)
+
+        self.log.info("Test a spend and the output it creates")
+        _, dest_spk, dest_address = getnewdestination()
+        self.sent = self.wallet.send_to(from_node=node, scriptPubKey=dest_spk, amount=100000)
+        self.generate(self.wallet, 1)
+        self.dest_address = dest_address
+
+        res = node.getaddresshistory(dest_address)
+        assert_equal(res["history"], [{
+            "height": 111,
+            "type": "funding",
+            "txid": self.sent["txid"],
+            "vout": self.sent["sent_vout"],
+            "amount": Decimal("0.001"),
+        }])
+        # The history of a hex-encoded scriptPubKey is the same as of its address.
+        assert_equal(node.getaddresshistory(dest_spk.hex()), res)
+
+        spends = [e for e in node.getaddresshistory(self.wallet.get_address(), 111)["history"] if e["type"] == "spending"]
+        assert_equal(len(spends), 1)
+        assert_equal(spends[0]["txid"], self.sent["txid"])
+        assert_equal(spends[0]["vin"], 0)
+
+        self.log.info("Test an invalid address")
+        assert_raises_rpc_error(-5, "Invalid address or scriptPubKey", node.getaddresshistory, "invalid")
+
+        self.log.info("Test that getindexinfo lists the index")
+        assert_equal(node.getindexinfo("addressindex"), {"addressindex": {"synced": True, "best_block_height": 111}})
+
+    def _test_rest(self):
+        self.log.info("Test the /rest/addresshistory endpoint")
+        node = self.nodes[1]
+        url = urllib.parse.urlparse(node.url)
+
+        def rest_request(uri, status=200):
+            conn = http.client.HTTPConnection(url.hostname, url.port)
+            conn.request("GET", "/rest/addresshistory/" + uri)
+            resp = conn.getresponse()
+            assert_equal(resp.status, status)
+            return resp.read().decode("utf-8")
+
+        assert_equal(json.loads(rest_request(f"{self.dest_address}.json"), parse_float=Decimal), node.getaddresshistory(self.dest_address))
+        assert_equal(json.loads(rest_request(f"{self.wallet.get_address()}.json?from_height=10&to_height=19"), parse_float=Decimal),
+                     node.getaddresshistory(self.wallet.get_address(), 10, 19))
+        assert_equal(json.loads(rest_request(f"{self.wallet.get_address()}.json?count=5&skip=20"), parse_float=Decimal),
+                     node.getaddresshistory(self.wallet.get_address(), 0, None, 5, 20))
+        rest_request(f"{self.dest_address}.json?count=-1", status=400)
+        assert_equal(len(json.loads(rest_request(f"{self.wallet.get_address()}.json?count=10000"))["history"]),
+                     len(node.getaddresshistory(self.wallet.get_address())["history"]))
+        rest_request(f"{self.dest_address}.json?count=10001", status=400)
+        rest_request("invalid.json", status=400)
+        rest_request(f"{self.dest_address}.json?from_height=-1", status=400)
+        rest_request(f"{self.dest_address}.bin", status=404)
+
+    def _test_reorg(self):
+        self.log.info("Test that the history follows a reorg")
+        node = self.nodes[1]
+        node.invalidateblock(node.getbestblockhash())
+        # Mine the replacement blocks without the spend, which is back in the mempool.
+        for _ in range(2):
+            self.generateblock(node, output=getnewdestination()[2], transactions=[], sync_fun=self.no_op)
+        assert_equal(node.getaddresshistory(self.dest_address)["history"], [])
+        assert_equal(node.getaddresshistory(self.wallet.get_address(), 111)["history"], [])
+
+    def sync_index_node(self):
+        self.wait_until(lambda: self.nodes[1].getindexinfo()["addressindex"]["synced"] is True)
+
+
+if __name__ == '__main__':
+    AddressIndexTest(__file__).main()
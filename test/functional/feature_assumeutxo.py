@@ -96,7 +96,7 @@ class AssumeutxoTest(BitcoinTestFramework):
         assert_raises_rpc_error(parsing_error_code, "Unable to parse metadata: Invalid UTXO set snapshot magic bytes. Please check if this is indeed a snapshot file or if you are using an outdated snapshot format.", node.loadtxoutset, bad_snapshot_path)
 
         self.log.info("  - snapshot file with unsupported version")
-        for version in [0, 1, 3]:
+        for version in [0, 1, 4]:
             with open(bad_snapshot_path, 'wb') as f:
                 f.write(valid_snapshot_contents[:5] + version.to_bytes(2, "little") + valid_snapshot_contents[7:])
             assert_raises_rpc_error(parsing_error_code, f"Unable to parse metadata: Version of snapshot {version} does not match any of the supported versions.", node.loadtxoutset, bad_snapshot_path)
@@ -167,6 +167,30 @@ class AssumeutxoTest(BitcoinTestFramework):
             msg = custom_message if custom_message is not None else f"Bad snapshot content hash: expected d2b051ff5e8eef46520350776f4100dd710a63447a8e01d917e92e79751a63e2, got {wrong_hash}."
             expected_error(msg)
 
+    def test_invalid_chunked_snapshot_scenarios(self, valid_snapshot_path):
+        self.log.info("Test loading invalid chunked snapshot files")
+        with open(valid_snapshot_path, 'rb') as f:
+            valid_snapshot_contents = f.read()
+        bad_snapshot_path = valid_snapshot_path + '.mod'
+        node = self.nodes[1]
+        # Snapshot magic, snapshot version, network magic, hash, coins count
+        chunks_offset = 5 + 2 + 4 + 32 + 8
+
+        self.log.info("  - chunk with content that does not match its hash")
+        with open(bad_snapshot_path, 'wb') as f:
+            f.write(valid_snapshot_contents[:chunks_offset] + b"\xff" * 32 + valid_snapshot_contents[chunks_offset + 32:])
+        assert_raises_rpc_error(-32603, "Unable to load UTXO snapshot: Population failed: Bad snapshot chunk 0 content hash", node.loadtxoutset, bad_snapshot_path)
+
+        self.log.info("  - chunk directory offset out of bounds")
+        with open(bad_snapshot_path, 'wb') as f:
+            f.write(valid_snapshot_contents[:-8] + (0).to_bytes(8, "little"))
+        assert_raises_rpc_error(-32603, "Unable to load UTXO snapshot: Population failed: Bad snapshot - chunk directory out of bounds", node.loadtxoutset, bad_snapshot_path)
+
+        self.log.info("  - truncated chunked snapshot")
+        with open(bad_snapshot_path, 'wb') as f:
+            f.write(valid_snapshot_contents[:-9])
+        assert_raises_rpc_error(-32603, "Unable to load UTXO snapshot: Population failed: Bad snapshot", node.loadtxoutset, bad_snapshot_path)
+
     def test_headers_not_synced(self, valid_snapshot_path):
         for node in self.nodes[1:]:
             msg = "Unable to load UTXO snapshot: The base block header (7cc695046fec709f8c9394b6f928f81e81fd3ac20977bb68760fa1faa7916ea2) must appear in the headers chain. Make sure all headers are syncing, and call loadtxoutset again."
@@ -484,12 +508,19 @@ class AssumeutxoTest(BitcoinTestFramework):
         dump_output5 = n0.dumptxoutset('utxos5.dat', rollback=prev_snap_hash)
         assert_equal(sha256sum_file(dump_output4['path']), sha256sum_file(dump_output5['path']))
 
+        self.log.info("Check that dumptxoutset writes chunked snapshots")
+        dump_output6 = n0.dumptxoutset('utxos6.dat', rollback=SNAPSHOT_BASE_HEIGHT, version=3)
+        check_dump_output(dump_output6)
+        assert_equal(dump_output6['coins_written'], dump_output['coins_written'])
+        assert_raises_rpc_error(-8, "Invalid snapshot version 4. Please specify 2 or 3", n0.dumptxoutset, 'utxos7.dat', "latest", version=4)
+
         # Ensure n0 is back at the tip
         assert_equal(n0.getblockchaininfo()["blocks"], FINAL_HEIGHT)
 
         self.test_snapshot_with_less_work(dump_output['path'])
         self.test_invalid_mempool_state(dump_output['path'])
         self.test_invalid_snapshot_scenarios(dump_output['path'])
+        self.test_invalid_chunked_snapshot_scenarios(dump_output6['path'])
         self.test_invalid_chainstate_scenarios()
         self.test_invalid_file_path()
         self.test_snapshot_block_invalidated(dump_output['path'])
@@ -706,7 +737,8 @@ class AssumeutxoTest(BitcoinTestFramework):
             for i in range(1, 300):
                 block = n0.getblock(n0.getblockhash(i), 0)
                 n2.submitheader(block)
-            loaded = n2.loadtxoutset(dump_output['path'])
+            # Load the chunked snapshot this time, which has the same contents.
+            loaded = n2.loadtxoutset(dump_output6['path'])
             assert_equal(loaded['coins_loaded'], SNAPSHOT_BASE_HEIGHT)
             assert_equal(loaded['base_height'], SNAPSHOT_BASE_HEIGHT)
 
@@ -8,6 +8,7 @@ from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import assert_equal, str_to_b64str
 
 import http.client
+import json
 import time
 import urllib.parse
 
@@ -237,5 +238,37 @@ class HTTPBasicsTest (BitcoinTestFramework):
         conn.request('GET', '/')
         conn.getresponse()
 
+        self.log.info("Check pipelined requests with several event loops")
+        self.restart_node(1, extra_args=["-rpceventthreads=4"])
+        url = urllib.parse.urlparse(self.nodes[1].url)
+        authpair = f'{url.username}:{url.password}'
+        conns = []
+        for _ in range(8):
+            conn = http.client.HTTPConnection(url.hostname, url.port)
+            conn.connect()
+            conns.append(conn)
+        for i, conn in enumerate(conns):
+            # Both requests in one write: the replies come back in order.
+            requests = b""
+            for method in ["getblockcount", "getbestblockhash"]:
+                body = f'{{"method": "{method}", "id": {i}}}'
+                requests += (f"POST / HTTP/1.1\r\nHost: {url.hostname}\r\n"
+                             f"Authorization: Basic {str_to_b64str(authpair)}\r\n"
+                             f"Content-Length: {len(body)}\r\n\r\n{body}").encode()
+            conn.sock.sendall(requests)
+            replies = conn.sock.makefile('rb')
+            for expected in [self.nodes[1].getblockcount(), self.nodes[1].getbestblockhash()]:
+                assert replies.readline().startswith(b"HTTP/1.1 200 OK")
+                length = None
+                while (line := replies.readline()) != b"\r\n":
+                    name, value = line.decode().split(":", 1)
+                    if name.lower() == "content-length":
+                        length = int(value)
+                reply = json.loads(replies.read(length))
+                assert_equal(reply["result"], expected)
+                assert_equal(reply["id"], i)
+        for conn in conns:
+            conn.close()
+
 if __name__ == '__main__':
     HTTPBasicsTest(__file__).main()
@@ -178,6 +178,13 @@ class IPCInterfaceTest(BitcoinTestFramework):
             template6 = await waitnext
             block4 = await self.parse_and_deserialize_block(template6, ctx)
             assert_equal(len(block4.vtx), 3)
+            self.log.debug("Check the delta against the previous template")
+            delta = (await template6.result.getDelta(ctx)).result
+            assert_equal(len(delta.addedTxs), len(block4.vtx) - len(block3.vtx) + len(delta.removedPositions))
+            for pos, tx in zip(delta.addedPositions, delta.addedTxs):
+                assert_equal(tx, block4.vtx[pos + 1].serialize())
+            assert_equal(delta.coinbaseValue, block4.vtx[0].vout[0].nValue)
+            assert_equal(len(delta.header), block_header_size)
             self.log.debug("Wait for another, but time out, since the fee threshold is set now")
             template7 = await template6.result.waitNext(ctx, waitoptions)
             assert_equal(template7.to_dict(), {})
@@ -4,9 +4,13 @@
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 """Tests some generic aspects of the RPC interface."""
 
+import base64
+import http.client
 import json
 import os
+import urllib.parse
 from dataclasses import dataclass
+from decimal import Decimal
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import assert_equal, assert_greater_than_or_equal
 from threading import Thread
@@ -177,6 +181,34 @@ class RPCInterfaceTest(BitcoinTestFramework):
             request_fields={"jsonrpc": "2.1"},
             response_fields={"result": None, "error": {"code": RPC_INVALID_REQUEST, "message": "JSON-RPC version not supported"}}))
 
+    def test_dependent_batch(self):
+        self.log.info("Testing the requests of a batch see the effects of the ones before them...")
+        calls = []
+        for idx in range(50):
+            calls.append({"method": "setnetworkactive", "params": [idx % 2 == 1]})
+            calls.append({"method": "getnetworkinfo"})
+        request = [format_request(BatchOptions(version=2), idx, call) for idx, call in enumerate(calls)]
+        rpc_response, http_status = send_json_rpc(self.nodes[0], request)
+        assert_equal(http_status, 200)
+        assert_equal([r["result"]["networkactive"] for r in rpc_response[1::2]], [idx % 2 == 1 for idx in range(50)])
+        assert_equal(self.nodes[0].getnetworkinfo()["networkactive"], True)
+
+    def test_parallel_batch(self):
+        self.log.info("Testing a batch executed in parallel keeps the order of its requests...")
+        self.restart_node(0, ['-rpcbatchparallelism=8'])
+        calls = [{"method": "echo", "params": [idx]} if idx % 5 else {"method": "invalidmethod"} for idx in range(500)]
+        options = [BatchOptions(version=2, notification=idx % 7 == 0) for idx in range(len(calls))]
+        request = [format_request(opts, idx, call) for idx, (opts, call) in enumerate(zip(options, calls))]
+        response = []
+        for idx, opts in enumerate(options):
+            result = {"result": [idx]} if idx % 5 else {"error": {"code": RPC_METHOD_NOT_FOUND, "message": "Method not found"}}
+            r = format_response(opts, idx, result)
+            if r is not None:
+                response.append(r)
+        rpc_response, http_status = send_json_rpc(self.nodes[0], request)
+        assert_equal(http_status, 200)
+        assert_equal(rpc_response, response)
+
     def test_http_status_codes(self):
         self.log.info("Testing HTTP status codes for JSON-RPC 1.1 requests...")
         # OK
@@ -226,6 +258,37 @@ class RPCInterfaceTest(BitcoinTestFramework):
         # Sanity check: command was not executed
         assert_equal(block_count + 1, self.nodes[0].getblockcount())
 
+    def test_streamed_result(self):
+        self.log.info("Testing large results are sent as chunked replies...")
+        node = self.nodes[0]
+        blockhash = node.getbestblockhash()
+        url = urllib.parse.urlparse(node.url)
+        auth = base64.b64encode(f"{url.username}:{url.password}".encode()).decode()
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        for method, params, streamed in [
+            ("getblock", [blockhash, 1], False),
+            ("getblock", [blockhash, 2], True),
+            ("getblock", [blockhash, 3], True),
+            ("getrawmempool", [True], True),
+            ("getrawmempool", [False], False),
+        ]:
+            for version_fields in [{"version": "1.1"}, {"jsonrpc": "2.0"}]:
+                request = {**version_fields, "id": 1, "method": method, "params": params}
+                # Reuse the connection, which must stay usable after a chunked reply.
+                conn.request("POST", "/", json.dumps(request), {"Authorization": f"Basic {auth}"})
+                response = conn.getresponse()
+                assert_equal(response.status, 200)
+                assert_equal(response.getheader("Transfer-Encoding") == "chunked", streamed)
+                reply = json.loads(response.read(), parse_float=Decimal)
+                # Requests in a batch are never streamed.
+                batch_reply, _ = send_json_rpc(node, [request])
+                assert_equal([reply], batch_reply)
+        conn.close()
+
+        self.log.info("Testing an error before the result is sent is replied normally...")
+        expect_http_rpc_status(500, RPC_INVALID_PARAMETER, node, "getrawmempool", [True, True])
+        expect_http_rpc_status(200, RPC_INVALID_PARAMETER, node, "getrawmempool", [True, True], version=2)
+
     def test_work_queue_exceeded(self):
         self.log.info("Testing work queue exceeded...")
         self.restart_node(0, ['-rpcworkqueue=1', '-rpcthreads=1'])
@@ -242,6 +305,9 @@ class RPCInterfaceTest(BitcoinTestFramework):
         self.test_getrpcinfo()
         self.test_batch_requests()
         self.test_http_status_codes()
+        self.test_dependent_batch()
+        self.test_parallel_batch()
+        self.test_streamed_result()
         self.test_work_queue_exceeded()
 
 
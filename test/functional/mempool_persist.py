@@ -195,6 +195,7 @@ class MempoolPersistTest(BitcoinTestFramework):
 
         self.test_importmempool_union()
         self.test_persist_unbroadcast()
+        self.test_import_truncated()
 
     def test_persist_unbroadcast(self):
         node0 = self.nodes[0]
@@ -258,6 +259,27 @@ class MempoolPersistTest(BitcoinTestFramework):
         assert_equal(entry_node01_secret["fees"]["base"] + 5, entry_node01_secret["fees"]["modified"])
         self.stop_nodes()
 
+    def test_import_truncated(self):
+        self.log.debug("Import a truncated mempool.dat. Verify that the transactions before the truncated one are loaded")
+        node0 = self.nodes[0]
+        self.generate(node0, 1, sync_fun=self.no_op)
+        txs = [self.mini_wallet.send_self_transfer(from_node=node0, confirmed_only=True) for _ in range(5)]
+        with open(node0.savemempool()["filename"], "rb") as f:
+            mempool_data = f.read()
+        self.restart_node(0, extra_args=["-persistmempool=0"])
+        assert_equal(len(node0.getrawmempool()), 0)
+
+        # The file starts with the version, the obfuscation key and the number
+        # of transactions. Each transaction is followed by its time and fee
+        # delta. Cut the file in the middle of the time of the last one.
+        header_size = 8 + 9 + 8
+        txs_size = sum(len(tx["hex"]) // 2 + 8 + 8 for tx in txs)
+        truncated = node0.datadir_path / "mempool_truncated.dat"
+        truncated.write_bytes(mempool_data[:header_size + txs_size - 10])
+        assert_raises_rpc_error(-1, "Unable to import mempool file", node0.importmempool, truncated)
+        assert_equal(len(node0.getrawmempool()), len(txs) - 1)
+        self.stop_nodes()
+
 
 if __name__ == "__main__":
     MempoolPersistTest(__file__).main()
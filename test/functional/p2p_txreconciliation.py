@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# Copyright (c) The Bitcoin Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test transaction relay with reconciliation (BIP 330).
+
+Relay the same transactions through a fully connected network of nodes, once
+by flooding only and once with -txreconciliation, and check that all of them
+arrive everywhere and that reconciliation announces them with fewer inv bytes.
+"""
+import time
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_greater_than
+from test_framework.wallet import MiniWallet
+
+NUM_TXS = 40
+
+
+class TxReconciliationTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 8
+
+    def setup_network(self):
+        self.setup_nodes()
+
+    def connect_mesh(self):
+        # Every node makes an outbound connection to every other node, so that
+        # each has 7 outbound and 7 inbound peers. With flooding, every
+        # transaction is announced at least once between each pair of nodes.
+        # With reconciliation, nodes flood to 4 outbound peers and rarely to
+        # inbound ones, and only announce what a peer lacks after a
+        # reconciliation round.
+        for i in range(self.num_nodes):
+            for j in range(self.num_nodes):
+                if i != j:
+                    self.connect_nodes(i, j)
+
+    def bytes_sent_per_msg(self):
+        bytes_per_msg = {}
+        for node in self.nodes:
+            for peer in node.getpeerinfo():
+                for msg_type, sent in peer["bytessent_per_msg"].items():
+                    bytes_per_msg[msg_type] = bytes_per_msg.get(msg_type, 0) + sent
+        return bytes_per_msg
+
+    def relay_txs(self, txs):
+        """Relay the transactions from node 0 and return the bytes sent per message type once relay is over."""
+        self.connect_mesh()
+        mocktime = int(time.time())
+        for node in self.nodes:
+            node.setmocktime(mocktime)
+
+        # Submit all transactions before the clock moves, so that they are
+        # announced together.
+        for tx in txs:
+            self.nodes[0].sendrawtransaction(tx["hex"])
+
+        def advance_clock():
+            nonlocal mocktime
+            # Advance the clock by the average outbound trickle interval, so
+            # that transactions spread a hop at a time and reconciliation
+            # rounds, which are further apart, find most of them on both
+            # sides. Larger steps let rounds run between every hop and
+            # announce what the peer is about to get anyway.
+            mocktime += 2
+            for node in self.nodes:
+                node.setmocktime(mocktime)
+            # Let the nodes answer each other before the next step.
+            time.sleep(0.5)
+
+        txids = [tx["txid"] for tx in txs]
+
+        def relayed():
+            advance_clock()
+            return all(set(txids).issubset(node.getrawmempool()) for node in self.nodes)
+        self.wait_until(relayed)
+
+        # Keep going until no more transactions are announced, so that
+        # announcements still queued when the last node got the transactions
+        # are counted. Reconciliation rounds and pings go on regardless.
+        last = None
+
+        def settled():
+            nonlocal last
+            advance_clock()
+            current, last = last, self.bytes_sent_per_msg()
+            return current is not None and all(current.get(msg_type) == last.get(msg_type) for msg_type in ("inv", "getdata", "tx"))
+        self.wait_until(settled)
+        return last
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        # The pre-mined chain only has 25 mature outputs for the wallet, so
+        # split one of them and confirm the split on all nodes, which are not
+        # connected yet.
+        self.wallet.send_self_transfer_multi(from_node=self.nodes[0], num_outputs=NUM_TXS)
+        block_hash = self.generate(self.wallet, 1, sync_fun=self.no_op)[0]
+        block = self.nodes[0].getblock(block_hash, 0)
+        for node in self.nodes[1:]:
+            node.submitblock(block)
+        # Spend confirmed outputs only, so that no transaction depends on another.
+        txs = [self.wallet.create_self_transfer(confirmed_only=True) for _ in range(NUM_TXS)]
+
+        self.log.info("Relay transactions by flooding")
+        flood = self.relay_txs(txs)
+        self.log.info(f"inv bytes per transaction: {flood['inv'] / NUM_TXS:.1f}")
+        assert "reqrecon" not in flood
+
+        self.log.info("Relay the same transactions with reconciliation")
+        self.stop_nodes()
+        for i in range(self.num_nodes):
+            # Start over from an empty mempool.
+            (self.nodes[i].chain_path / "mempool.dat").unlink()
+        self.start_nodes(extra_args=[["-txreconciliation"]] * self.num_nodes)
+        recon = self.relay_txs(txs)
+        recon_bytes = sum(recon.get(msg_type, 0) for msg_type in ("reqrecon", "sketch", "reqsketchext", "reconcildiff"))
+        self.log.info(f"inv bytes per transaction: {recon['inv'] / NUM_TXS:.1f}, reconciliation bytes per transaction: {recon_bytes / NUM_TXS:.1f}")
+        assert_greater_than(recon["reqrecon"], 0)
+        assert_greater_than(recon["sketch"], 0)
+        assert_greater_than(flood["inv"], recon["inv"])
+
+
+if __name__ == '__main__':
+    TxReconciliationTest(__file__).main()